@@ -547,6 +547,9 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
   // Number of variables for the compiled computation.
   static constexpr size_t kNumVariables = {{VARIABLE_NUM}};
 
+  // Byte size of the arena accepted by the temp_arena constructor.
+  static constexpr size_t kTempArenaBytes = {{TEMP_BYTES_ALIGNED}};
+
   // Byte size of each argument buffer. There are kNumArgs entries.
   static const ::int64_t ArgSize(::tensorflow::int32 index) {
     return BufferInfos()[ArgIndexToBufferIndex()[index]].size();
@@ -580,6 +583,12 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
             AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS)
       : XlaCompiledCpuFunction(StaticData(), alloc_mode) {}
 
+  // Places the temp buffers in `temp_arena`, which must be aligned to
+  // cpu_function_runtime::Align() and hold kTempArenaBytes bytes. Arguments
+  // must be set with set_argN_data. See XlaCompiledCpuFunction.
+  explicit {{CLASS}}(void* temp_arena)
+      : XlaCompiledCpuFunction(StaticData(), temp_arena) {}
+
   {{CLASS}}(const {{CLASS}}&) = delete;
   {{CLASS}}& operator=(const {{CLASS}}&) = delete;
 
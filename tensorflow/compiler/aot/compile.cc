@@ -160,6 +160,7 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
   aot_opts.set_use_mlir_hlo_lowering(use_mlir_hlo_lowering);
+  aot_opts.set_share_constants(flags.share_constants);
 
   if (flags.sanitize_dataflow) {
     aot_opts.set_sanitize_dataflow(flags.sanitize_dataflow);
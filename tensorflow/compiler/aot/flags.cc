@@ -55,6 +55,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"share_constants", &flags->share_constants,
+       "If set, constants (e.g. model weights) are emitted as symbols named "
+       "after their contents, so that several generated object files that "
+       "embed the same constants carry a single copy once linked into the "
+       "same binary."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
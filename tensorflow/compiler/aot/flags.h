@@ -43,6 +43,7 @@ struct MainFlags {
   string out_session_module;
   string mlir_components;
   bool experimental_quantize = false;
+  bool share_constants = false;
 
   // Sanitizer pass options
   bool sanitize_dataflow = false;
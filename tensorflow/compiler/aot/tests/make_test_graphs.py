@@ -127,6 +127,15 @@ def tffunction(_):
   test_func(x, y, name='func_call')  # pylint: disable=unexpected-keyword-arg
 
 
+def tfsignatures(_):
+  # Two signatures that share the weight constant, see
+  # tf_library_signatures.
+  x = array_ops.placeholder(dtypes.float32, name='x_hold')
+  w = constant_op.constant([[1.0, 2.0], [3.0, 4.0]], name='w_const')
+  math_ops.matmul(x, w, name='x_w_prod')
+  math_ops.add(x, w, name='x_w_sum')
+
+
 def tfsplits(_):
   """A more complex graph, including splits."""
   x = array_ops.placeholder(dtypes.float32, shape=[2, 2], name='x')
@@ -226,6 +235,7 @@ def main(_):
   write_graph(tfgather, FLAGS.out_dir)
   write_graph(tfmatmul, FLAGS.out_dir)
   write_graph(tfmatmulandadd, FLAGS.out_dir)
+  write_graph(tfsignatures, FLAGS.out_dir)
   write_graph(tfsplits, FLAGS.out_dir)
   write_graph(tftop_k, FLAGS.out_dir)
   write_graph(tfvariable, FLAGS.out_dir)
@@ -0,0 +1,73 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/tests/test_graph_tfsignatures.h"
+#include "tensorflow/compiler/xla/cpu_function_runtime.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+TEST(TFCompileSignaturesTest, ArenaFitsEverySignature) {
+  EXPECT_GE(kTestGraphTfsignaturesTempArenaBytes,
+            SignaturesProdComp::kTempArenaBytes);
+  EXPECT_GE(kTestGraphTfsignaturesTempArenaBytes,
+            SignaturesSumComp::kTempArenaBytes);
+}
+
+TEST(TFCompileSignaturesTest, SignaturesShareTempArena) {
+  void* arena = port::AlignedMalloc(kTestGraphTfsignaturesTempArenaBytes,
+                                    xla::cpu_function_runtime::Align());
+  ASSERT_NE(arena, nullptr);
+  {
+    SignaturesProdComp prod(arena);
+    SignaturesSumComp sum(arena);
+
+    XLA_ALIGN float x[4] = {1, 2, 3, 4};
+    prod.set_arg0_data(x);
+    sum.set_arg0_data(x);
+
+    // Both signatures use the weight [[1, 2], [3, 4]]. The results live in
+    // the shared arena, so each one is checked before the other signature
+    // runs.
+    EXPECT_TRUE(prod.Run());
+    EXPECT_EQ(prod.error_msg(), "");
+    const float prod_results[4] = {7, 10, 15, 22};
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(prod.result0_data()[i], prod_results[i]);
+    }
+
+    EXPECT_TRUE(sum.Run());
+    EXPECT_EQ(sum.error_msg(), "");
+    const float sum_results[4] = {2, 4, 6, 8};
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(sum.result0_data()[i], sum_results[i]);
+    }
+
+    // Running the first signature again must not depend on any state left
+    // in the arena by the second one.
+    EXPECT_TRUE(prod.Run());
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(prod.result0_data()[i], prod_results[i]);
+    }
+  }
+  port::AlignedFree(arena);
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -481,6 +481,111 @@ def tf_library(
             tags = tags,
         )
 
+def tf_library_signatures(
+        name,
+        graph,
+        signatures,
+        tfcompile_flags = None,
+        visibility = None,
+        testonly = None,
+        tags = [],
+        **kwargs):
+    """Compiles several signatures of one TensorFlow graph with shared weights.
+
+    Every entry of `signatures` is compiled by tf_library into its own
+    generated class. The constants of all signatures are emitted with
+    --share_constants, so that weights common to several signatures are only
+    stored once in the final binary. The generated classes can also share a
+    single temp arena, see the temp_arena constructor of
+    XlaCompiledCpuFunction.
+
+    Given an invocation of tf_library_signatures(name="foo", ...), generates the
+    following build targets:
+      foo_<signature>: The tf_library of each signature.
+      foo:             A cc_library depending on all of the above, whose header
+                       foo.h includes the header of every signature and defines
+                       kFooTempArenaBytes, the size of an arena that fits the
+                       temp buffers of any of the signatures.
+
+    Args:
+      name: The name of the build rule.
+      graph: The TensorFlow GraphDef to compile, as in tf_library.
+      signatures: A dict from signature name to a dict with the "config" and
+        "cpp_class" of that signature, as in tf_library.
+      tfcompile_flags: Extra flags to pass to tfcompile, as a list.
+      visibility: Bazel build visibility.
+      testonly:   Bazel testonly attribute.
+      tags: tags to apply to subsidiary build rules.
+      **kwargs: Passed to every tf_library.
+    """
+    if not signatures:
+        fail("signatures must not be empty")
+
+    flags = (tfcompile_flags or []) + ["--share_constants"]
+    sig_deps = []
+    sig_headers = []
+    arena_bytes = None
+    for sig_name in sorted(signatures.keys()):
+        sig = signatures[sig_name]
+        sig_lib = name + "_" + sig_name
+        tf_library(
+            name = sig_lib,
+            graph = graph,
+            config = sig["config"],
+            cpp_class = sig["cpp_class"],
+            tfcompile_flags = flags,
+            visibility = visibility,
+            testonly = testonly,
+            tags = tags,
+            **kwargs
+        )
+        sig_deps.append(":" + sig_lib)
+        sig_headers.append(native.package_name() + "/" + sig_lib + ".h")
+        sig_bytes = "::" + sig["cpp_class"] + "::kTempArenaBytes"
+        if arena_bytes == None:
+            arena_bytes = sig_bytes
+        else:
+            arena_bytes = "std::max<size_t>(%s, %s)" % (arena_bytes, sig_bytes)
+
+    arena_name = "k" + "".join([
+        part.capitalize()
+        for part in name.split("_")
+    ]) + "TempArenaBytes"
+    guard = ("TFCOMPILE_GENERATED_" + native.package_name() + "_" +
+             name + "_H_").replace("/", "_").upper()
+    lines = [
+        "// Generated by tf_library_signatures. DO NOT EDIT!",
+        "#ifndef " + guard,
+        "#define " + guard,
+        "",
+        "#include <algorithm>",
+        "#include <cstddef>",
+        "",
+    ] + ["#include \"%s\"" % h for h in sig_headers] + [
+        "",
+        "// Size of an arena that fits the temp buffers of every signature.",
+        "constexpr size_t %s = %s;" % (arena_name, arena_bytes),
+        "",
+        "#endif  // " + guard,
+    ]
+    header_file = name + ".h"
+    native.genrule(
+        name = "gen_" + name + "_header",
+        outs = [header_file],
+        cmd = "cat > $@ <<'EOF'\n" + "\n".join(lines) + "\nEOF",
+        visibility = visibility,
+        testonly = testonly,
+        tags = tags,
+    )
+    native.cc_library(
+        name = name,
+        hdrs = [header_file],
+        visibility = visibility,
+        testonly = testonly,
+        deps = sig_deps,
+        tags = tags,
+    )
+
 def target_llvm_triple():
     """Returns the target LLVM triple to be used for compiling the target."""
 
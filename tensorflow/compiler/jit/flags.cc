@@ -149,7 +149,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_prefix",
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
-           "\"xla_compile_cache\"")};
+           "\"xla_compile_cache\""),
+      Flag("tf_xla_shape_buckets",
+           &mark_for_compilation_flags->tf_xla_shape_buckets,
+           "If non-empty, argument dimensions whose sizes vary between "
+           "executions of a cluster are compiled as dynamic dimensions padded "
+           "up to a bucket size, to limit recompilation. Either \"pow2\" or a "
+           "comma-separated list of increasing sizes. Empty by default.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -200,6 +206,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_shape_buckets = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
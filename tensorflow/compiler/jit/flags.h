@@ -97,6 +97,12 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If non-empty, argument dimensions whose sizes vary between executions of
+  // a cluster are padded up to these buckets instead of triggering a
+  // recompilation for every size: either "pow2" or a comma-separated list of
+  // increasing sizes. Empty (disabled) by default.
+  string tf_xla_shape_buckets;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
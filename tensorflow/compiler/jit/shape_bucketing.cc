@@ -0,0 +1,119 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/types/variant.h"
+#include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64_t kDynamicSize = -1;
+
+}  // namespace
+
+/*static*/ StatusOr<std::unique_ptr<ShapeBucketer>> ShapeBucketer::Create(
+    absl::string_view spec) {
+  spec = absl::StripAsciiWhitespace(spec);
+  if (spec == "pow2") {
+    return std::make_unique<ShapeBucketer>(std::vector<int64_t>());
+  }
+  std::vector<int64_t> buckets;
+  for (absl::string_view bucket : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(bucket), &size) ||
+        size <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket '", bucket,
+                                     "' in shape bucket specification '", spec,
+                                     "'.");
+    }
+    if (!buckets.empty() && size <= buckets.back()) {
+      return errors::InvalidArgument(
+          "Shape buckets must be increasing, got '", spec, "'.");
+    }
+    buckets.push_back(size);
+  }
+  return std::make_unique<ShapeBucketer>(std::move(buckets));
+}
+
+ShapeBucketer::ShapeBucketer(std::vector<int64_t> buckets)
+    : buckets_(std::move(buckets)) {}
+
+std::optional<int64_t> ShapeBucketer::BucketFor(int64_t size) const {
+  size = std::max<int64_t>(size, 1);
+  if (buckets_.empty()) {
+    int64_t bucket = 1;
+    while (bucket < size) bucket <<= 1;
+    return bucket;
+  }
+  auto it = std::lower_bound(buckets_.begin(), buckets_.end(), size);
+  if (it == buckets_.end()) return std::nullopt;
+  return *it;
+}
+
+int ShapeBucketer::BucketArguments(const std::string& cluster,
+                                   std::vector<XlaCompiler::Argument>* args) {
+  mutex_lock lock(mu_);
+  std::vector<std::vector<int64_t>>& first_sizes = first_sizes_[cluster];
+  first_sizes.resize(args->size());
+
+  int num_bucketed = 0;
+  for (int i = 0; i < args->size(); ++i) {
+    XlaCompiler::Argument& arg = (*args)[i];
+    if (arg.kind != XlaCompiler::Argument::kParameter ||
+        !absl::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    const TensorShape& shape = absl::get<TensorShape>(arg.shape);
+    std::vector<int64_t>& sizes = first_sizes[i];
+    if (sizes.size() != shape.dims()) {
+      // First execution, or the rank changed: start over.
+      sizes.assign(shape.dim_sizes().begin(), shape.dim_sizes().end());
+      continue;
+    }
+
+    std::vector<std::pair<int, int64_t>> bounds;
+    for (int d = 0; d < shape.dims(); ++d) {
+      if (sizes[d] != kDynamicSize && sizes[d] != shape.dim_size(d)) {
+        sizes[d] = kDynamicSize;
+      }
+      if (sizes[d] != kDynamicSize) continue;
+      if (std::optional<int64_t> bucket = BucketFor(shape.dim_size(d))) {
+        bounds.emplace_back(d, *bucket);
+      }
+    }
+    if (bounds.empty()) continue;
+
+    xla::Shape xla_shape;
+    if (!TensorShapeToXLAShape(arg.type, shape, &xla_shape).ok()) continue;
+    for (const auto& [dimension, bound] : bounds) {
+      xla_shape.set_dimensions(dimension, bound);
+      xla_shape.set_dynamic_dimension(dimension, true);
+    }
+    arg.shape = std::move(xla_shape);
+    num_bucketed += bounds.size();
+  }
+  return num_bucketed;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,74 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+
+// Limits recompilation of clusters whose input shapes vary from execution to
+// execution (e.g. sequence lengths in NLP models).
+//
+// The first time a cluster is compiled its arguments keep their static shapes.
+// Once a dimension of a parameter has been seen with two different sizes, it is
+// compiled from then on as a bounded dynamic dimension, with the bound rounded
+// up to a bucket size. XLA pads such dimensions internally and masks the
+// padding, so executions with any size up to the bound share one executable;
+// the launch code pads the inputs to the bound and slices the outputs back to
+// their true sizes.
+class ShapeBucketer {
+ public:
+  // Creates a bucketer from `spec`, which is either "pow2" for power-of-two
+  // buckets or a comma-separated list of increasing bucket sizes.
+  static StatusOr<std::unique_ptr<ShapeBucketer>> Create(
+      absl::string_view spec);
+
+  // Buckets are powers of two if `buckets` is empty.
+  explicit ShapeBucketer(std::vector<int64_t> buckets);
+
+  // Returns the smallest bucket that holds `size`, or std::nullopt if `size`
+  // is larger than the largest bucket.
+  std::optional<int64_t> BucketFor(int64_t size) const;
+
+  // Records the parameter shapes in `args` for `cluster` and turns the
+  // dimensions that have been seen with different sizes into bounded dynamic
+  // dimensions. Returns the number of dimensions that were bucketed.
+  int BucketArguments(const std::string& cluster,
+                      std::vector<XlaCompiler::Argument>* args);
+
+ private:
+  const std::vector<int64_t> buckets_;
+
+  mutex mu_;
+  // For every cluster and argument, the size first seen for each dimension, or
+  // -1 once the dimension has been seen with a different size.
+  absl::flat_hash_map<std::string, std::vector<std::vector<int64_t>>>
+      first_sizes_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
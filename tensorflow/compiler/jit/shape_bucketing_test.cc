@@ -0,0 +1,104 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+XlaCompiler::Argument ParameterArg(const TensorShape& shape) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+TEST(ShapeBucketerTest, CreateParsesSpec) {
+  TF_ASSERT_OK_AND_ASSIGN(auto pow2, ShapeBucketer::Create("pow2"));
+  EXPECT_EQ(pow2->BucketFor(5), 8);
+  TF_ASSERT_OK_AND_ASSIGN(auto list, ShapeBucketer::Create("16, 64,256"));
+  EXPECT_EQ(list->BucketFor(64), 64);
+
+  EXPECT_FALSE(ShapeBucketer::Create("").ok());
+  EXPECT_FALSE(ShapeBucketer::Create("16,abc").ok());
+  EXPECT_FALSE(ShapeBucketer::Create("16,0").ok());
+  EXPECT_FALSE(ShapeBucketer::Create("64,16").ok());
+}
+
+TEST(ShapeBucketerTest, BucketFor) {
+  ShapeBucketer pow2({});
+  EXPECT_EQ(pow2.BucketFor(0), 1);
+  EXPECT_EQ(pow2.BucketFor(1), 1);
+  EXPECT_EQ(pow2.BucketFor(17), 32);
+  EXPECT_EQ(pow2.BucketFor(1024), 1024);
+
+  ShapeBucketer list({16, 64});
+  EXPECT_EQ(list.BucketFor(1), 16);
+  EXPECT_EQ(list.BucketFor(17), 64);
+  EXPECT_EQ(list.BucketFor(65), std::nullopt);
+}
+
+TEST(ShapeBucketerTest, BucketsOnlyVaryingDimensions) {
+  ShapeBucketer bucketer({});
+
+  std::vector<XlaCompiler::Argument> args = {ParameterArg({3, 10})};
+  EXPECT_EQ(bucketer.BucketArguments("cluster", &args), 0);
+  EXPECT_TRUE(absl::holds_alternative<TensorShape>(args[0].shape));
+
+  // Same shape again: still static.
+  args = {ParameterArg({3, 10})};
+  EXPECT_EQ(bucketer.BucketArguments("cluster", &args), 0);
+
+  // Dimension 0 varies, dimension 1 does not.
+  args = {ParameterArg({5, 10})};
+  EXPECT_EQ(bucketer.BucketArguments("cluster", &args), 1);
+  ASSERT_TRUE(absl::holds_alternative<xla::Shape>(args[0].shape));
+  const xla::Shape& shape = absl::get<xla::Shape>(args[0].shape);
+  EXPECT_TRUE(shape.is_dynamic_dimension(0));
+  EXPECT_EQ(shape.dimensions(0), 8);
+  EXPECT_FALSE(shape.is_dynamic_dimension(1));
+  EXPECT_EQ(shape.dimensions(1), 10);
+
+  // Once dynamic, the dimension stays bucketed.
+  args = {ParameterArg({3, 10})};
+  EXPECT_EQ(bucketer.BucketArguments("cluster", &args), 1);
+  EXPECT_EQ(absl::get<xla::Shape>(args[0].shape).dimensions(0), 4);
+
+  // Other clusters are tracked separately.
+  args = {ParameterArg({5, 10})};
+  EXPECT_EQ(bucketer.BucketArguments("other_cluster", &args), 0);
+}
+
+TEST(ShapeBucketerTest, IgnoresConstantsAndOversizedDimensions) {
+  ShapeBucketer bucketer({16});
+
+  std::vector<XlaCompiler::Argument> args = {ParameterArg({4})};
+  args.push_back(ParameterArg({4}));
+  args[1].kind = XlaCompiler::Argument::kConstant;
+  EXPECT_EQ(bucketer.BucketArguments("cluster", &args), 0);
+
+  args = {ParameterArg({32}), ParameterArg({8})};
+  args[1].kind = XlaCompiler::Argument::kConstant;
+  EXPECT_EQ(bucketer.BucketArguments("cluster", &args), 0);
+  EXPECT_TRUE(absl::holds_alternative<TensorShape>(args[0].shape));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,137 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs an auto-clustered graph with --tf_xla_shape_buckets=pow2 over several
+// batch sizes, so that most sizes execute in a padded bucket, and checks the
+// results against TF.
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+// Records the largest number of dynamic dimensions of any JIT compilation.
+class DynamicDimensionListener : public XlaActivityListener {
+ public:
+  explicit DynamicDimensionListener(int* max_dynamic_dimensions)
+      : max_dynamic_dimensions_(max_dynamic_dimensions) {}
+
+  Status Listen(
+      const XlaAutoClusteringActivity& auto_clustering_activity) override {
+    return OkStatus();
+  }
+
+  Status Listen(
+      const XlaJitCompilationActivity& jit_compilation_activity) override {
+    *max_dynamic_dimensions_ =
+        std::max(*max_dynamic_dimensions_,
+                 jit_compilation_activity.num_dynamic_dimensions());
+    return OkStatus();
+  }
+
+  Status Listen(const XlaOptimizationRemark& optimization_remark) override {
+    return OkStatus();
+  }
+
+ private:
+  int* max_dynamic_dimensions_;
+};
+
+// Sums and averages a [batch, 4] input over the batch dimension, so padding
+// rows would change both results.
+GraphDef GetTestGraph() {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  const auto shape = ops::Placeholder::Shape(PartialTensorShape({-1, 4}));
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT, shape);
+  auto b = ops::Placeholder(root.WithOpName("b"), DT_FLOAT, shape);
+  auto product = ops::Mul(root.WithOpName("product"), a, b);
+  auto sum = ops::Sum(root.WithOpName("sum"), product, 0);
+  auto mean = ops::Mean(root.WithOpName("mean"), a, 0);
+  auto result = ops::Add(root.WithOpName("result"), sum, mean);
+  ops::Identity(root.WithOpName("out"), result);
+  GraphDef graph;
+  TF_CHECK_OK(root.ToGraphDef(&graph));
+  return graph;
+}
+
+Tensor CreateInputTensor(int batch, float offset) {
+  Tensor tensor(DT_FLOAT, TensorShape({batch, 4}));
+  for (int64_t i = 0; i < tensor.NumElements(); ++i) {
+    tensor.flat<float>()(i) = offset + i;
+  }
+  return tensor;
+}
+
+Status Run(Session* session, int batch, Tensor* output) {
+  std::vector<Tensor> outputs;
+  TF_RETURN_IF_ERROR(session->Run({{"a", CreateInputTensor(batch, 1)},
+                                   {"b", CreateInputTensor(batch, -7)}},
+                                  {"out"}, {}, &outputs));
+  *output = outputs[0];
+  return OkStatus();
+}
+
+TEST(XlaShapeBucketingTest, PaddedBucketsMatchUnpaddedExecution) {
+  int max_dynamic_dimensions = 0;
+  RegisterXlaActivityListener(
+      std::make_unique<DynamicDimensionListener>(&max_dynamic_dimensions));
+
+  const GraphDef graph = GetTestGraph();
+  std::unique_ptr<Session> tf_session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(tf_session->Create(graph));
+
+  // A single session, so that its compilation cache sees every batch size.
+  SessionOptions xla_options;
+  auto& optimizer_options =
+      *xla_options.config.mutable_graph_options()->mutable_optimizer_options();
+  optimizer_options.set_global_jit_level(OptimizerOptions::ON_1);
+  optimizer_options.set_cpu_global_jit(true);
+  std::unique_ptr<Session> xla_session(NewSession(xla_options));
+  TF_ASSERT_OK(xla_session->Create(graph));
+
+  // Sizes 3, 5, 6 and 7 run padded to the buckets 4 and 8.
+  for (int batch : {1, 2, 3, 4, 5, 6, 7, 8}) {
+    SCOPED_TRACE(batch);
+    Tensor expected, actual;
+    TF_ASSERT_OK(Run(tf_session.get(), batch, &expected));
+    TF_ASSERT_OK(Run(xla_session.get(), batch, &actual));
+    test::ExpectClose(expected, actual, /*atol=*/1e-3, /*rtol=*/1e-5);
+  }
+  EXPECT_GT(max_dynamic_dimensions, 0);
+
+  TF_ASSERT_OK(tf_session->Close());
+  TF_ASSERT_OK(xla_session->Close());
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  tensorflow::GetMarkForCompilationPassFlags()->tf_xla_shape_buckets = "pow2";
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
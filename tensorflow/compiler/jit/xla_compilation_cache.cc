@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/protobuf_util.h"
 #include "tensorflow/compiler/xla/service/compiler.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
@@ -57,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/fingerprint.h"
@@ -71,6 +73,7 @@ limitations under the License.
 #include "tensorflow/core/tpu/tpu_defs.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/stream_executor/host/host_platform_id.h"
 
 namespace tensorflow {
 namespace {
@@ -140,9 +143,26 @@ std::string XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) {
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
+      key.compiler_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.device_type());
 }
 
+// Fingerprints what a serialized executable depends on besides its HLO: the
+// XLA flags and, since host executables hold machine code tuned for the host,
+// the host CPU. Entries written on other hosts or with other flags then miss
+// in the persistent cache instead of failing to load.
+uint64 CompilerFingerprint(const xla::LocalClient& client) {
+  uint64 fingerprint =
+      DeterministicProtoHash64(xla::GetDebugOptionsFromFlags());
+  if (client.platform()->id() == stream_executor::host::kHostPlatformId) {
+    fingerprint =
+        Hash64Combine(fingerprint, Hash64(port::CPUVendorIDString()));
+    fingerprint = Hash64Combine(fingerprint, port::CPUFamily());
+    fingerprint = Hash64Combine(fingerprint, port::CPUModelNum());
+  }
+  return fingerprint;
+}
+
 }  // namespace
 
 constexpr int64_t XlaCompilationCache::kDefaultCompilationThreshold;
@@ -158,7 +178,12 @@ XlaCompilationCache::XlaCompilationCache(Config config,
       device_type_(std::move(device_type)),
       disable_strict_signature_checks_(config.disable_strict_signature_checks),
       persistance_prefix_(config.persistance_prefix),
-      persistent_cache_directory_(config.persistent_cache_directory) {}
+      persistent_cache_directory_(config.persistent_cache_directory),
+      shape_bucketer_(std::move(config.shape_bucketer)) {
+  if (!persistent_cache_directory_.empty()) {
+    compiler_fingerprint_ = CompilerFingerprint(*client_);
+  }
+}
 
 XlaCompilationCache::~XlaCompilationCache() {
   // Ensure any use of our programs have completed by waiting for all stream
@@ -195,6 +220,9 @@ string XlaCompilationCache::Signature::HumanString() const {
   for (const auto& a : args) {
     absl::visit(SignatureHumanStringAppender(&result), a);
   }
+  for (const auto& [arg_num, dimension] : dynamic_dimensions) {
+    absl::StrAppend(&result, ",dynamic(", arg_num, ":", dimension, ")");
+  }
   return result;
 }
 
@@ -206,7 +234,7 @@ bool XlaCompilationCache::Signature::operator==(const Signature& other) const {
       return false;
     }
   }
-  return true;
+  return dynamic_dimensions == other.dynamic_dimensions;
 }
 
 uint64 XlaCompilationCache::Signature::Hash::operator()(
@@ -215,6 +243,10 @@ uint64 XlaCompilationCache::Signature::Hash::operator()(
   for (const auto& arg : signature.args) {
     h = absl::visit(SignatureHashCombiner(h), arg);
   }
+  for (const auto& [arg_num, dimension] : signature.dynamic_dimensions) {
+    h = Hash64Combine(h, std::hash<int>()(arg_num));
+    h = Hash64Combine(h, std::hash<int>()(dimension));
+  }
   return h;
 }
 
@@ -234,6 +266,14 @@ StatusOr<XlaCompilationCache::Signature> XlaCompilationCache::BuildSignature(
       case XlaCompiler::Argument::kResource:
         signature.args.push_back(
             TensorTypeAndShape(arg.type, arg.DimensionSizesAsInlinedVector()));
+        if (const xla::Shape* shape = absl::get_if<xla::Shape>(&arg.shape)) {
+          for (int d = 0; shape->IsArray() && d < shape->rank(); ++d) {
+            if (shape->is_dynamic_dimension(d)) {
+              signature.dynamic_dimensions.emplace_back(
+                  signature.args.size() - 1, d);
+            }
+          }
+        }
         break;
       default:
         return errors::InvalidArgument(
@@ -285,6 +325,11 @@ Status XlaCompilationCache::BuildExecutable(
       GetShapePointers(result.xla_input_shapes);
   xla::ExecutableBuildOptions build_options =
       GetBuildOptions(options, result, client_->default_device_ordinal());
+  if (!persistent_cache_directory_.empty()) {
+    // Lets XLA:CPU export the executable into the persistent cache without
+    // compiling it again.
+    build_options.mutable_debug_options()->set_xla_cpu_keep_object_code(true);
+  }
   TF_ASSIGN_OR_RETURN(
       auto executables,
       client_->Compile(*result.computation, argument_layouts, build_options));
@@ -539,11 +584,18 @@ Status XlaCompilationCache::CompileStrict(
     VLOG(1) << "Loading cached entry for: " << sig.HumanString();
     StatusOr<std::unique_ptr<xla::LocalExecutable>> executable = LoadExecutable(
         options, entry->compilation_result, serialized_entry->executable());
-    entry->compilation_status = executable.status();
     if (executable.ok()) {
+      entry->compilation_status = OkStatus();
       entry->executable = *std::move(executable);
+    } else {
+      // A stale entry (e.g. one written by an older compiler) is not fatal;
+      // compile from scratch and overwrite it below.
+      VLOG(1) << "Failed to load cached entry for: " << sig.HumanString()
+              << ": " << executable.status();
+      serialized_entry.reset();
     }
-  } else {
+  }
+  if (!serialized_entry.has_value()) {
     entry->compilation_status =
         BuildExecutable(options, entry->compilation_result, &entry->executable);
 
@@ -587,6 +639,8 @@ Status XlaCompilationCache::CompileStrict(
       it->second.cumulative_compile_time_us);
   jit_compilation_activity.set_used_persistent_cache(
       serialized_entry.has_value());
+  jit_compilation_activity.set_num_dynamic_dimensions(
+      sig.dynamic_dimensions.size());
   TF_RETURN_IF_ERROR(BroadcastXlaActivity(std::move(jit_compilation_activity)));
 
   return OkStatus();
@@ -698,13 +752,26 @@ bool XlaCompilationCache::ShouldCompileCluster(CompileMode compile_mode,
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
     const XlaCompiler::Options& options, const NameAttrList& function,
-    const std::vector<XlaCompiler::Argument>& args, OpKernelContext* ctx,
+    const std::vector<XlaCompiler::Argument>& input_args, OpKernelContext* ctx,
     CompileScope scope, CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   DCHECK_NE(out_executable, nullptr);
   VLOG(2) << "XlaCompilationCache::Compile " << DebugString();
 
+  // Round the sizes of dimensions that vary between executions up to shape
+  // buckets, so that executions with nearby shapes share an executable.
+  std::vector<XlaCompiler::Argument> bucketed_args;
+  if (shape_bucketer_ != nullptr && scope == CompileScope::kFunction) {
+    bucketed_args = input_args;
+    if (shape_bucketer_->BucketArguments(function.name(), &bucketed_args) ==
+        0) {
+      bucketed_args.clear();
+    }
+  }
+  const std::vector<XlaCompiler::Argument>& args =
+      bucketed_args.empty() ? input_args : bucketed_args;
+
   if (VLOG_IS_ON(2)) {
     VLOG(2) << "num_inputs=" << args.size();
     for (int i = 0, end = args.size(); i < end; i++) {
@@ -834,6 +901,7 @@ XlaSerializedCacheKey XlaCompilationCache::BuildSerializedCacheKey(
       DeterministicProtoHash64(hlo_module));
   serialized_cache_key.set_device_type(device_type_.type_string());
   serialized_cache_key.set_prefix(persistance_prefix_);
+  serialized_cache_key.set_compiler_fingerprint(compiler_fingerprint_);
   return serialized_cache_key;
 }
 
@@ -891,10 +959,15 @@ StatusOr<XlaSerializedCacheEntry> XlaCompilationCache::SerializeEntry(
   *serialized_entry.mutable_key() = BuildSerializedCacheKey(sig, hlo_module);
   *serialized_entry.mutable_hlo_module() = hlo_module;
 
-  TF_ASSIGN_OR_RETURN(
-      std::unique_ptr<xla::AotCompilationResult> aot_result,
-      BuildSerializedExecutable(options, entry.compilation_result));
-  TF_ASSIGN_OR_RETURN(std::string serialized, aot_result->SerializeAsString());
+  StatusOr<std::unique_ptr<xla::AotCompilationResult>> aot_result =
+      client_->backend().compiler()->Export(
+          entry.executable->executable());
+  if (aot_result.status().code() == error::UNIMPLEMENTED) {
+    aot_result = BuildSerializedExecutable(options, entry.compilation_result);
+  }
+  TF_RETURN_IF_ERROR(aot_result.status());
+  TF_ASSIGN_OR_RETURN(std::string serialized,
+                      (*aot_result)->SerializeAsString());
   serialized_entry.set_executable(std::move(serialized));
   return serialized_entry;
 }
@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
@@ -71,6 +72,11 @@ class XlaCompilationCache : public ResourceBase {
 
     // The cache persistence prefix to use if serializing/deserialzing entries.
     std::string persistance_prefix;
+
+    // If set, dimensions of function arguments whose sizes vary between
+    // executions are compiled as bounded dynamic dimensions, rounded up to
+    // this bucketer's buckets.
+    std::unique_ptr<ShapeBucketer> shape_bucketer;
   };
   XlaCompilationCache(Config config, xla::LocalClient* client,
                       DeviceType device_type);
@@ -144,6 +150,11 @@ class XlaCompilationCache : public ResourceBase {
         std::pair<DataType, absl::InlinedVector<int64_t, 4>>;
     absl::InlinedVector<absl::variant<Tensor, TensorTypeAndShape>, 8> args;
 
+    // The (argument number, dimension) pairs of parameter dimensions that are
+    // compiled as bounded dynamic dimensions (see ShapeBucketer). The sizes of
+    // these dimensions in `args` are their bounds.
+    absl::InlinedVector<std::pair<int, int>, 4> dynamic_dimensions;
+
     bool operator==(const Signature& other) const;
 
     struct Hash {
@@ -200,6 +211,11 @@ class XlaCompilationCache : public ResourceBase {
   const DeviceType device_type_;
   bool disable_strict_signature_checks_;
   std::string persistance_prefix_;
+  // Fingerprint of the XLA flags and host the executables are compiled for,
+  // stored in serialized cache keys. Only computed when the persistent cache
+  // is enabled.
+  uint64 compiler_fingerprint_ = 0;
+  std::unique_ptr<ShapeBucketer> shape_bucketer_;
 
   // The value associated with a cache entry.
   struct Entry {
@@ -228,6 +244,8 @@ class XlaCompilationCache : public ResourceBase {
       const Signature& sig, const xla::HloModuleProto& hlo_module) const;
 
   // Serializes the signature and its corresponding entry to a proto message.
+  // The already compiled executable is exported if the compiler supports it,
+  // otherwise the computation is compiled again ahead-of-time.
   StatusOr<XlaSerializedCacheEntry> SerializeEntry(
       const XlaCompiler::Options& options, const Signature& sig,
       const Entry& entry) TF_EXCLUSIVE_LOCKS_REQUIRED(entry.mu);
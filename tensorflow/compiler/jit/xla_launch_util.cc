@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
+#include <cstring>
 #include <memory>
 
 #include "absl/algorithm/container.h"
@@ -243,6 +244,86 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Fills in `execution_input` with a copy of `t` laid out for the bounded
+// dynamic `device_shape`: the elements are stored densely at the start of a
+// buffer sized for the bounds, followed by the actual size of every dimension
+// as int32 metadata. This is the layout expected by XLA's PadToStatic.
+static Status PopulateDynamicExecutionInputBuffer(
+    xla::ExecutionInput& execution_input, const Tensor& t,
+    const xla::Shape& device_shape, se::Stream* stream,
+    xla::TransferManager* transfer_manager, int device_ordinal,
+    se::DeviceMemoryAllocator* allocator) {
+  TF_RET_CHECK(device_shape.rank() == t.dims());
+  const int64_t data_size = xla::ShapeUtil::ByteSizeOf(
+      xla::ShapeUtil::MakeStaticShape(device_shape));
+  const int64_t buffer_size =
+      transfer_manager->GetByteSizeRequirement(device_shape);
+  TF_RET_CHECK(t.TotalBytes() <= data_size);
+  TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory buffer,
+                      allocator->Allocate(device_ordinal, buffer_size));
+
+  auto metadata = std::make_shared<std::vector<int32_t>>(t.dims());
+  for (int d = 0; d < t.dims(); ++d) {
+    TF_RET_CHECK(t.dim_size(d) <= device_shape.dimensions(d));
+    (*metadata)[d] = t.dim_size(d);
+  }
+  const int64_t metadata_size = metadata->size() * sizeof(int32_t);
+  TF_RET_CHECK(data_size + metadata_size <= buffer_size);
+
+  se::DeviceMemoryBase dst = buffer.cref();
+  se::DeviceMemoryBase src = XlaTensor::DeviceMemoryFromTensor(t);
+  se::DeviceMemoryBase dst_metadata(
+      static_cast<char*>(dst.opaque()) + data_size, metadata_size);
+  if (stream == nullptr) {
+    // Host platform: buffers are host memory.
+    if (t.TotalBytes() > 0) {
+      std::memcpy(dst.opaque(), src.opaque(), t.TotalBytes());
+    }
+    std::memcpy(dst_metadata.opaque(), metadata->data(), metadata_size);
+  } else {
+    if (t.TotalBytes() > 0) {
+      stream->ThenMemcpy(&dst, src, t.TotalBytes());
+    }
+    stream->ThenMemcpy(&dst_metadata, metadata->data(), metadata_size);
+    // Keep the metadata alive until the transfer is done.
+    stream->ThenDoHostCallback([metadata]() {});
+  }
+
+  *execution_input.MutableBuffer(xla::ShapeIndex{}) = std::move(buffer);
+  return OkStatus();
+}
+
+// Reads the actual dimension sizes of the dynamic arrays in `output` from
+// host memory. This is TransferManager::ReadDynamicShapes for the host
+// platform, which runs without a stream.
+static Status ReadDynamicShapesOnHost(const xla::ShapedBuffer& output,
+                                      xla::TransferManager* transfer_manager,
+                                      xla::Shape* device_shape) {
+  TF_RETURN_IF_ERROR(output.buffers().ForEachElementWithStatus(
+      [&](const xla::ShapeIndex& index, const se::DeviceMemoryBase& buffer) {
+        xla::Shape* subshape =
+            xla::ShapeUtil::GetMutableSubshape(device_shape, index);
+        if (subshape->IsTuple() || subshape->is_static()) {
+          return OkStatus();
+        }
+        const int64_t offset = xla::ShapeUtil::ByteSizeOf(
+            xla::ShapeUtil::MakeStaticShape(*subshape));
+        const int64_t metadata_size =
+            subshape->rank() * static_cast<int64_t>(sizeof(int32_t));
+        TF_RET_CHECK(offset + metadata_size <= buffer.size());
+        const char* metadata = static_cast<const char*>(buffer.opaque());
+        for (int64_t i = 0; i < subshape->rank(); ++i) {
+          int32_t size;
+          std::memcpy(&size, metadata + offset + i * sizeof(int32_t),
+                      sizeof(int32_t));
+          subshape->set_dimensions(i, size);
+        }
+        return OkStatus();
+      }));
+  device_shape->clear_dynamic_dimensions();
+  return OkStatus();
+}
+
 StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -295,6 +376,19 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, host_shape);
     xla::ExecutionInput& execution_input = arguments.back();
+    if (device_shape.IsArray() && device_shape.is_dynamic() &&
+        !allocate_xla_tensors_) {
+      // The cluster was compiled with bucketed (bounded dynamic) shapes; the
+      // input has to be copied into a buffer of the bucket size.
+      se::Stream* stream = ctx->op_device_context()
+                               ? ctx->op_device_context()->stream()
+                               : nullptr;
+      TF_RETURN_IF_ERROR(PopulateDynamicExecutionInputBuffer(
+          execution_input, *t, device_shape, stream,
+          client_->backend().transfer_manager(), device_ordinal_,
+          xla_allocator_));
+      continue;
+    }
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                  donate_buffer, device_ordinal_,
@@ -518,8 +612,13 @@ Status XlaComputationLaunchContext::PopulateOutputs(
                         xla::TransferManager::GetForPlatform(platform));
 
     xla::Shape output_device_shape = output.on_device_shape();
-    TF_RETURN_IF_ERROR(transfer_manager->ReadDynamicShapes(
-        stream, &output, &output_device_shape));
+    if (stream != nullptr) {
+      TF_RETURN_IF_ERROR(transfer_manager->ReadDynamicShapes(
+          stream, &output, &output_device_shape));
+    } else {
+      TF_RETURN_IF_ERROR(ReadDynamicShapesOnHost(output, transfer_manager,
+                                                 &output_device_shape));
+    }
 
     output.set_shapes(output_device_shape, output_device_shape);
     for (int i = 0; i < ctx->num_outputs(); ++i) {
@@ -58,6 +58,16 @@ Status BuildXlaCompilationCache(DeviceBase* device, FunctionLibraryRuntime* flr,
     return OkStatus();
   }
 
+  // Shape bucketing relies on XlaComputationLaunchContext padding inputs and
+  // slicing outputs, which is only done for tensors that are not XlaTensors,
+  // i.e. when not running on an XLA device.
+  const std::string& shape_buckets =
+      GetMarkForCompilationPassFlags()->tf_xla_shape_buckets;
+  if (!shape_buckets.empty()) {
+    TF_ASSIGN_OR_RETURN(cache_config.shape_bucketer,
+                        ShapeBucketer::Create(shape_buckets));
+  }
+
   auto platform =
       se::MultiPlatformManager::PlatformWithId(platform_info.platform_id());
   if (!platform.ok()) {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -150,6 +151,32 @@ TEST(XlaCompiledCpuFunctionTest, MallocFreeContiguousBuffers) {
   xla::cpu_function_runtime::FreeContiguous(base);
 }
 
+TEST(XlaCompiledCpuFunctionTest, AssignContiguousBuffers) {
+  static constexpr intptr_t sizes[5] = {1, -1, 32, 64, 3};
+  std::vector<BufferInfo> buffer_infos = SizesToBufferInfos(sizes, 5);
+  const size_t arena_size = AlignedBufferBytesFromSizes(sizes, 5);
+  EXPECT_EQ(arena_size, 256);
+
+  // Two sets of buffers can be parceled out of the same caller-owned arena.
+  void* arena = tensorflow::port::AlignedMalloc(
+      arena_size, xla::cpu_function_runtime::Align());
+  void* bufA[5];
+  void* bufB[5];
+  AssignContiguousBuffers(buffer_infos.data(), 5,
+                          /*allocate_entry_params=*/false, bufA, arena);
+  AssignContiguousBuffers(buffer_infos.data(), 5,
+                          /*allocate_entry_params=*/false, bufB, arena);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(bufA[i], bufB[i]);
+  }
+  EXPECT_EQ(bufA[0], add_ptr(arena, 0));
+  EXPECT_EQ(bufA[1], nullptr);
+  EXPECT_EQ(bufA[2], add_ptr(arena, 64));
+  EXPECT_EQ(bufA[3], add_ptr(arena, 128));
+  EXPECT_EQ(bufA[4], add_ptr(arena, 192));
+  tensorflow::port::AlignedFree(arena);
+}
+
 void CheckRoundTripIsOk(const BufferInfo& buffer_info) {
   BufferInfo round_trip(buffer_info.Encode());
   ASSERT_EQ(round_trip, buffer_info);
@@ -23,6 +23,18 @@ namespace tensorflow {
 
 XlaCompiledCpuFunction::XlaCompiledCpuFunction(const StaticData& static_data,
                                                AllocMode alloc_mode)
+    : XlaCompiledCpuFunction(static_data, alloc_mode, /*temp_arena=*/nullptr) {
+}
+
+XlaCompiledCpuFunction::XlaCompiledCpuFunction(const StaticData& static_data,
+                                               void* temp_arena)
+    : XlaCompiledCpuFunction(static_data,
+                             AllocMode::RESULTS_PROFILES_AND_TEMPS_ONLY,
+                             temp_arena) {}
+
+XlaCompiledCpuFunction::XlaCompiledCpuFunction(const StaticData& static_data,
+                                               AllocMode alloc_mode,
+                                               void* temp_arena)
     : raw_function_(static_data.raw_function_),
       result_index_(static_data.result_index_),
       buffer_table_(new void*[static_data.num_buffers_]),
@@ -35,13 +47,20 @@ XlaCompiledCpuFunction::XlaCompiledCpuFunction(const StaticData& static_data,
       result_names_(static_data.result_names_),
       program_shape_(static_data.program_shape_),
       hlo_profile_printer_data_(static_data.hlo_profile_printer_data_) {
-  bool allocate_entry_params =
-      alloc_mode == AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS;
-  // Allocate arg and temp buffers.
-  alloc_buffer_table_ = xla::cpu_function_runtime::MallocContiguousBuffers(
-      static_data.buffer_infos_, static_data.num_buffers_,
-      /*allocate_entry_params=*/allocate_entry_params, buffer_table_,
-      /*annotate_initialized=*/true);
+  if (temp_arena != nullptr) {
+    // The caller owns the temp buffers; entry parameters are set separately.
+    xla::cpu_function_runtime::AssignContiguousBuffers(
+        static_data.buffer_infos_, static_data.num_buffers_,
+        /*allocate_entry_params=*/false, buffer_table_, temp_arena);
+  } else {
+    bool allocate_entry_params =
+        alloc_mode == AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS;
+    // Allocate arg and temp buffers.
+    alloc_buffer_table_ = xla::cpu_function_runtime::MallocContiguousBuffers(
+        static_data.buffer_infos_, static_data.num_buffers_,
+        /*allocate_entry_params=*/allocate_entry_params, buffer_table_,
+        /*annotate_initialized=*/true);
+  }
   // If Hlo profiling is enabled the generated code expects an appropriately
   // sized buffer to be passed in as the last argument.  If Hlo profiling is
   // disabled the last function argument is still present in the function
@@ -52,6 +71,13 @@ XlaCompiledCpuFunction::XlaCompiledCpuFunction(const StaticData& static_data,
   }
 }
 
+/*static*/ size_t XlaCompiledCpuFunction::TempArenaSize(
+    const StaticData& static_data) {
+  return xla::cpu_function_runtime::AlignedBufferBytes(
+      static_data.buffer_infos_, static_data.num_buffers_,
+      /*allocate_entry_params=*/false);
+}
+
 bool XlaCompiledCpuFunction::Run() {
   XlaCustomCallStatus status;
   raw_function_(buffer_table_[result_index_], &run_options_, nullptr,
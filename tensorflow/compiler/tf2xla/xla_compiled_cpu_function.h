@@ -121,8 +121,23 @@ class XlaCompiledCpuFunction {
       const StaticData& static_data,
       AllocMode alloc_mode =
           AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS);
+
+  // Places the result and temp buffers in the caller-owned `temp_arena`
+  // instead of allocating them. Argument buffers must be set with
+  // set_arg_data, as in AllocMode::RESULTS_PROFILES_AND_TEMPS_ONLY. The arena
+  // must be aligned to cpu_function_runtime::Align(), hold at least
+  // TempArenaSize(static_data) bytes and outlive this object.
+  //
+  // Several functions, e.g. the signatures of one model, may share an arena
+  // as long as they are not run concurrently. Results are only valid until
+  // another function runs on the same arena.
+  XlaCompiledCpuFunction(const StaticData& static_data, void* temp_arena);
   virtual ~XlaCompiledCpuFunction();
 
+  // Returns the number of bytes of the result and temp buffers of a function
+  // with `static_data`, i.e. the size of the arena it needs.
+  static size_t TempArenaSize(const StaticData& static_data);
+
   XlaCompiledCpuFunction(const XlaCompiledCpuFunction&) = delete;
   XlaCompiledCpuFunction& operator=(const XlaCompiledCpuFunction&) = delete;
 
@@ -346,6 +361,12 @@ class XlaCompiledCpuFunction {
   }
 
  private:
+  // Shared by the public constructors. Buffers are carved out of `temp_arena`
+  // when it is non-null, otherwise they are allocated according to
+  // `alloc_mode`.
+  XlaCompiledCpuFunction(const StaticData& static_data, AllocMode alloc_mode,
+                         void* temp_arena);
+
   const RawFunction raw_function_;
   const size_t result_index_;
 
@@ -367,7 +388,7 @@ class XlaCompiledCpuFunction {
   const int32 num_variables_;
 
   // Backing memory for buffer_table_ and args_, the latter depending on
-  // AllocMode.
+  // AllocMode. Null if the buffers live in a caller-owned temp arena.
   void* alloc_buffer_table_ = nullptr;
 
   // Backing memory for profiling counters.
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/stream_executor/multi_platform_manager.h"
 #include "tensorflow/stream_executor/platform.h"
@@ -229,6 +230,33 @@ TEST(XlaJitCompiledCpuFunction, Sum) {
   EXPECT_TRUE(ShapeUtil::Compatible(result0, s32));
 }
 
+TEST(XlaJitCompiledCpuFunction, SharedTempArena) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<XlaJitCompiledCpuFunction> jit,
+      XlaJitCompiledCpuFunction::Compile(SumGraph(), SumConfig(),
+                                         xla::ExecutableBuildOptions()));
+  const size_t arena_size =
+      XlaCompiledCpuFunction::TempArenaSize(jit->StaticData());
+  EXPECT_GT(arena_size, 0);
+  void* arena = tensorflow::port::AlignedMalloc(
+      arena_size, xla::cpu_function_runtime::Align());
+
+  // Two functions sharing an arena run one after the other.
+  XlaCompiledCpuFunction first(jit->StaticData(), arena);
+  XlaCompiledCpuFunction second(jit->StaticData(), arena);
+  int32 x = 10, y = 32;
+  first.set_arg_data(0, &x);
+  first.set_arg_data(1, &y);
+  second.set_arg_data(0, &y);
+  second.set_arg_data(1, &y);
+
+  EXPECT_TRUE(first.Run());
+  EXPECT_EQ(*static_cast<int32*>(first.result_data(0)), 42);
+  EXPECT_TRUE(second.Run());
+  EXPECT_EQ(*static_cast<int32*>(second.result_data(0)), 64);
+  tensorflow::port::AlignedFree(arena);
+}
+
 TEST(XlaJitCompiledCpuFunction, SumVariable) {
   GraphDef graph_def = SumGraphVariable();
   tf2xla::Config config = SumConfigVariable();
@@ -84,6 +84,14 @@ void* MallocContiguousBuffers(const BufferInfo* buffer_infos, size_t n,
       ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(contiguous, total);
     }
   }
+  AssignContiguousBuffers(buffer_infos, n, allocate_entry_params, bufs,
+                          contiguous);
+  return contiguous;
+}
+
+void AssignContiguousBuffers(const BufferInfo* buffer_infos, size_t n,
+                             bool allocate_entry_params, void** bufs,
+                             void* contiguous) {
   uintptr_t pos = reinterpret_cast<uintptr_t>(contiguous);
   for (size_t i = 0; i < n; ++i) {
     bool should_allocate =
@@ -96,7 +104,6 @@ void* MallocContiguousBuffers(const BufferInfo* buffer_infos, size_t n,
       bufs[i] = nullptr;
     }
   }
-  return contiguous;
 }
 
 void FreeContiguous(void* contiguous) {
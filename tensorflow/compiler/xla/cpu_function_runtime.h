@@ -172,6 +172,14 @@ void* MallocContiguousBuffers(const BufferInfo* buffer_infos, size_t n,
                               bool allocate_entry_params, void** bufs,
                               bool annotate_initialized);
 
+// AssignContiguousBuffers is like MallocContiguousBuffers, but parcels out the
+// caller-provided block `contiguous` instead of allocating one.  `contiguous`
+// must be aligned to Align() and hold at least
+// AlignedBufferBytes(buffer_infos, n, allocate_entry_params) bytes.
+void AssignContiguousBuffers(const BufferInfo* buffer_infos, size_t n,
+                             bool allocate_entry_params, void** bufs,
+                             void* contiguous);
+
 // FreeContiguous frees the contiguous block of memory allocated by
 // MallocContiguousBuffers.
 void FreeContiguous(void* contiguous);
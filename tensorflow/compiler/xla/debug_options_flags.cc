@@ -80,6 +80,9 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_all_reduce_combine_threshold_bytes(30 * 1024 * 1024);
   opts.set_xla_gpu_enable_async_all_reduce(true);
   opts.set_xla_cpu_enable_xprof_traceme(false);
+  opts.set_xla_cpu_parallel_codegen_split_count(1);
+  opts.set_xla_cpu_parallel_tasks_per_thread(1);
+  opts.set_xla_cpu_keep_object_code(false);
   opts.set_xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found(false);
   opts.set_xla_multiheap_size_constraint_per_heap(-1);
   opts.set_xla_detailed_logging_and_dumping(true);
@@ -630,6 +633,41 @@ static void AllocateFlags() {
       flag_values->xla_cpu_enable_xprof_traceme(),
       "If true, XLA CPU generates code to call "
       "TraceMe::Activity{Start|End} around HLO operations."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      flag_values->xla_cpu_parallel_codegen_split_count(),
+      "Split the LLVM module of XLA:CPU executables into this many "
+      "partitions and optimize and compile them concurrently."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_parallel_tasks_per_thread",
+      int32_setter_for(&DebugOptions::set_xla_cpu_parallel_tasks_per_thread),
+      flag_values->xla_cpu_parallel_tasks_per_thread(),
+      "Maximum number of loop partitions per intra-op thread that XLA:CPU "
+      "creates for a parallelized instruction."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_profile_guided_optimization_profile",
+      string_setter_for(
+          &DebugOptions::set_xla_cpu_profile_guided_optimization_profile),
+      flag_values->xla_cpu_profile_guided_optimization_profile(),
+      "Path of a *.hlo_execution_profile_data file (written with "
+      "--xla_hlo_profile and --xla_dump_to) from a previous run of the same "
+      "module. XLA:CPU uses the measured costs for fusion and parallel task "
+      "assignment decisions."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_memory_limit_bytes",
+      int64_setter_for(&DebugOptions::set_xla_cpu_memory_limit_bytes),
+      flag_values->xla_cpu_memory_limit_bytes(),
+      "If positive, XLA:CPU uses a memory minimizing schedule and "
+      "rematerializes instructions to keep the peak memory of a module below "
+      "this many bytes."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_keep_object_code",
+      bool_setter_for(&DebugOptions::set_xla_cpu_keep_object_code),
+      flag_values->xla_cpu_keep_object_code(),
+      "If true, XLA:CPU executables keep the object code emitted by the JIT "
+      "so that they can be exported."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found",
       bool_setter_for(
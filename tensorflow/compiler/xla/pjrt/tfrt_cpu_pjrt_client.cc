@@ -26,6 +26,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include "absl/algorithm/container.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -493,58 +494,59 @@ StatusOr<std::unique_ptr<PjRtBuffer>> TfrtCpuClient::BufferFromHostBuffer(
                         MaybeOwningCpuMemory::AllocateShared(byte_size));
     auto dst_data_ptr = device_buffer->data();
     buffers.push_back(device_buffer);
+    std::shared_ptr<TransposePlan> transpose;
     if (!has_default_layout) {
       // If the input array does not have a major-to-minor layout, transpose it
-      // into major-to-minor layout. Currently we choose to always do this
-      // synchronously.
-      // TODO(phawkins): consider performing the transpose asynchronously.
+      // into major-to-minor layout.
       // TODO(phawkins): parallelize the transpose.
-      std::shared_ptr<TransposePlan> transpose;
-      {
-        absl::InlinedVector<int64_t, 4> permutation(dims.size());
-        absl::c_iota(permutation, 0);
-        absl::MutexLock lock(&transpose_mu_);
-        TF_ASSIGN_OR_RETURN(
-            transpose, transpose_cache_.GetOrCreate(
-                           primitive_util::ByteWidth(type), dims, permutation,
-                           TransposePlan::Striding{*byte_strides}));
+      absl::InlinedVector<int64_t, 4> permutation(dims.size());
+      absl::c_iota(permutation, 0);
+      absl::MutexLock lock(&transpose_mu_);
+      TF_ASSIGN_OR_RETURN(
+          transpose, transpose_cache_.GetOrCreate(
+                         primitive_util::ByteWidth(type), dims, permutation,
+                         TransposePlan::Striding{*byte_strides}));
+    }
+    bool should_sync_copy =
+        host_buffer_semantics ==
+            HostBufferSemantics::kImmutableOnlyDuringCall ||
+        (byte_size < kSmallDataTransferByteSize);
+    if (should_sync_copy) {
+      if (transpose) {
+        transpose->Execute(data, dst_data_ptr);
+      } else {
+        std::memcpy(dst_data_ptr, data, byte_size);
       }
-      transpose->Execute(data, dst_data_ptr);
       if (on_done_with_host_buffer) {
         on_done_with_host_buffer();
         on_done_with_host_buffer = nullptr;
       }
     } else {
-      bool should_sync_copy =
-          host_buffer_semantics ==
-              HostBufferSemantics::kImmutableOnlyDuringCall ||
-          (byte_size < kSmallDataTransferByteSize);
-      if (should_sync_copy) {
-        std::memcpy(dst_data_ptr, data, byte_size);
-        if (on_done_with_host_buffer) {
-          on_done_with_host_buffer();
-          on_done_with_host_buffer = nullptr;
-        }
-      } else {
-        tfrt::AsyncValueRef<CpuEvent> copy_event =
-            tfrt::MakeConstructedAsyncValueRef<CpuEvent>(host_ctx_.get());
-        definition_events.push_back(copy_event.CopyRef());
-        tfrt::EnqueueWork(
-            host_ctx_.get(),
-            [device_buffer = std::move(device_buffer), dst_data_ptr, data,
-             byte_size, copy_event = std::move(copy_event),
-             on_done_with_host_buffer =
-                 std::move(on_done_with_host_buffer)]() mutable {
-              tensorflow::profiler::TraceMe traceme("H2D Dispatch");
+      // The host buffer outlives the copy, so perform it on the host context
+      // and let consumers wait on `copy_event` rather than on this thread.
+      tfrt::AsyncValueRef<CpuEvent> copy_event =
+          tfrt::MakeConstructedAsyncValueRef<CpuEvent>(host_ctx_.get());
+      definition_events.push_back(copy_event.CopyRef());
+      tfrt::EnqueueWork(
+          host_ctx_.get(),
+          [device_buffer = std::move(device_buffer), dst_data_ptr, data,
+           byte_size, transpose = std::move(transpose),
+           copy_event = std::move(copy_event),
+           on_done_with_host_buffer =
+               std::move(on_done_with_host_buffer)]() mutable {
+            tensorflow::profiler::TraceMe traceme("H2D Dispatch");
+            if (transpose) {
+              transpose->Execute(data, dst_data_ptr);
+            } else {
               std::memcpy(dst_data_ptr, data, byte_size);
-              if (on_done_with_host_buffer) {
-                on_done_with_host_buffer();
-                on_done_with_host_buffer = nullptr;
-              }
-              // Signal copy is complete.
-              copy_event.SetStateConcrete();
-            });
-      }
+            }
+            if (on_done_with_host_buffer) {
+              on_done_with_host_buffer();
+              on_done_with_host_buffer = nullptr;
+            }
+            // Signal copy is complete.
+            copy_event.SetStateConcrete();
+          });
     }
   }
   auto tracked_device_buffer = std::make_shared<TrackedTfrtCpuDeviceBuffer>(
@@ -1499,6 +1501,17 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   std::vector<tfrt::RCReference<tfrt::AsyncValue>> input_deps;
   input_deps.reserve(argument_handles.size());
 
+  // Donated buffers that alias memory the client does not own (e.g. zero-copy
+  // host buffers) must not be written by the computation. They are copied into
+  // owned memory right before the computation runs instead; `donation_copies`
+  // keeps the source buffers alive until then.
+  struct DonationCopy {
+    std::shared_ptr<TrackedTfrtCpuDeviceBuffer> source;
+    absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4> src;
+    absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4> dst;
+  };
+  std::vector<DonationCopy> donation_copies;
+
   auto donate_it = parameters_that_must_be_donated_.begin();
 
   for (int i = 0; i < argument_handles.size(); ++i) {
@@ -1547,6 +1560,26 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
         }
       }
     }
+    if (must_donate && absl::c_any_of(device_buffer->Buffers(),
+                                      [](const auto& buffer) {
+                                        return !buffer->owns_data();
+                                      })) {
+      DonationCopy copy;
+      copy.source = device_buffer.buffer();
+      absl::InlinedVector<std::shared_ptr<MaybeOwningCpuMemory>, 4> leaves;
+      for (const auto& buffer : device_buffer->Buffers()) {
+        TF_ASSIGN_OR_RETURN(auto owned, MaybeOwningCpuMemory::AllocateShared(
+                                            buffer->size()));
+        copy.src.push_back(buffer);
+        copy.dst.push_back(owned);
+        leaves.push_back(std::move(owned));
+      }
+      tracked_buffers.push_back(std::make_shared<TrackedTfrtCpuDeviceBuffer>(
+          device_buffer->is_tuple(), std::move(leaves),
+          absl::InlinedVector<tfrt::AsyncValueRef<CpuEvent>, 4>()));
+      donation_copies.push_back(std::move(copy));
+      continue;
+    }
     tracked_buffers.push_back(device_buffer.buffer());
   }
 
@@ -1624,6 +1657,13 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
 
     XlaCustomCallStatus status;
 
+    for (const DonationCopy& copy : donation_copies) {
+      for (int i = 0; i < copy.src.size(); ++i) {
+        std::memcpy(copy.dst[i]->data(), copy.src[i]->data(),
+                    copy.src[i]->size());
+      }
+    }
+
     // Call generated function.
     cpu_executable->compute_function()(result_buffer, &run_options, nullptr,
                                        buffer_pointers.data(), &status,
@@ -1659,7 +1699,8 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
          compute_reservation = std::move(compute_reservation),
          tracked_buffers = std::move(tracked_buffers),
          execute_event = execute_event.CopyRef(),
-         input_deps_avs = std::move(input_deps_avs_copy)]() mutable {
+         input_deps_avs = std::move(input_deps_avs_copy),
+         donation_copies = std::move(donation_copies)]() mutable {
           for (const auto& av : input_deps_avs) {
             if (auto* error = av->GetErrorIfPresent()) {
               execute_event.SetError(absl::StrCat(
@@ -1675,6 +1716,15 @@ StatusOr<PjRtExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
 
           XlaCustomCallStatus status;
 
+          for (DonationCopy& copy : donation_copies) {
+            for (int i = 0; i < copy.src.size(); ++i) {
+              std::memcpy(copy.dst[i]->data(), copy.src[i]->data(),
+                          copy.src[i]->size());
+            }
+          }
+          // The host may reclaim the donated memory from here on.
+          donation_copies.clear();
+
           // Call generated function.
           cpu_executable->compute_function()(result_buffer, &run_options,
                                              nullptr, buffer_pointers.data(),
@@ -0,0 +1,118 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+
+namespace xla {
+namespace {
+
+// Returns an executable computing `p + 1` in place of its parameter `p`.
+std::unique_ptr<PjRtExecutable> CompileDonatingIncrement(PjRtClient* client) {
+  XlaBuilder builder("increment");
+  XlaOp p = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {4}), "p");
+  Add(p, ConstantR0<float>(&builder, 1.0f));
+  builder.SetUpAlias(/*output_index=*/{}, /*param_number=*/0,
+                     /*param_index=*/{});
+  XlaComputation computation = builder.Build().ValueOrDie();
+  return client->Compile(computation, CompileOptions()).ValueOrDie();
+}
+
+TEST(TfrtCpuClientTest, DonatedZeroCopyBufferIsNotWritten) {
+  alignas(64) float data[] = {1, 2, 3, 4};
+  std::atomic<bool> done_with_host_buffer{false};
+  auto client = *GetTfrtCpuClient(/*asynchronous=*/true);
+  auto* device = client->addressable_devices()[0];
+  auto buffer = *client->BufferFromHostBuffer(
+      data, F32, {4}, std::nullopt,
+      PjRtClient::HostBufferSemantics::kZeroCopy,
+      [&]() { done_with_host_buffer = true; }, device);
+  auto executable = CompileDonatingIncrement(client.get());
+
+  auto results = *executable->Execute({{buffer.get()}}, ExecuteOptions());
+  EXPECT_TRUE(buffer->IsDeleted());
+  auto literal = *results[0][0]->ToLiteralSync();
+
+  EXPECT_TRUE(LiteralTestUtil::Equal(LiteralUtil::CreateR1<float>({2, 3, 4, 5}),
+                                     *literal));
+  // The computation wrote to a copy, and let go of the host buffer before it
+  // finished.
+  EXPECT_THAT(data, ::testing::ElementsAre(1, 2, 3, 4));
+  EXPECT_TRUE(done_with_host_buffer);
+}
+
+TEST(TfrtCpuClientTest, ChainsExecutionsOnDonatedBuffers) {
+  alignas(64) float data[] = {1, 2, 3, 4};
+  auto client = *GetTfrtCpuClient(/*asynchronous=*/true);
+  auto* device = client->addressable_devices()[0];
+  auto buffer = *client->BufferFromHostBuffer(
+      data, F32, {4}, std::nullopt,
+      PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+      device);
+  auto executable = CompileDonatingIncrement(client.get());
+
+  // Each execution consumes the output of the previous one without waiting
+  // for it on the host.
+  std::unique_ptr<PjRtBuffer> current = std::move(buffer);
+  for (int i = 0; i < 8; ++i) {
+    auto results = *executable->Execute({{current.get()}}, ExecuteOptions());
+    EXPECT_TRUE(current->IsDeleted());
+    current = std::move(results[0][0]);
+  }
+  auto literal = *current->ToLiteralSync();
+
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR1<float>({9, 10, 11, 12}), *literal));
+}
+
+TEST(TfrtCpuClientTest, TransposesLargeHostBufferAsynchronously) {
+  // Large enough to be copied off the calling thread.
+  constexpr int64_t kRows = 256;
+  constexpr int64_t kCols = 128;
+  std::vector<float> data(kRows * kCols);
+  for (int64_t i = 0; i < kRows; ++i) {
+    for (int64_t j = 0; j < kCols; ++j) {
+      // Column-major storage.
+      data[j * kRows + i] = i * kCols + j;
+    }
+  }
+  auto client = *GetTfrtCpuClient(/*asynchronous=*/true);
+  auto* device = client->addressable_devices()[0];
+  std::vector<int64_t> byte_strides = {sizeof(float), kRows * sizeof(float)};
+  auto buffer = *client->BufferFromHostBuffer(
+      data.data(), F32, {kRows, kCols}, byte_strides,
+      PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes,
+      nullptr, device);
+  auto literal = *buffer->ToLiteralSync();
+
+  for (int64_t i = 0; i < kRows; ++i) {
+    for (int64_t j = 0; j < kCols; ++j) {
+      ASSERT_EQ(literal->Get<float>({i, j}), i * kCols + j);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xla
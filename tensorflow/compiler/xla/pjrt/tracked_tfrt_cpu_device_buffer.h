@@ -102,6 +102,8 @@ class TrackedTfrtCpuDeviceBuffer {
 
   ~TrackedTfrtCpuDeviceBuffer();
 
+  bool is_tuple() const { return is_tuple_; }
+
   absl::Span<const std::shared_ptr<MaybeOwningCpuMemory>> Buffers() {
     return buffers_;
   }
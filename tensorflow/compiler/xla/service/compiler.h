@@ -284,6 +284,14 @@ class Compiler {
     return Unimplemented("LoadAotCompilationResult unimplemented.");
   }
 
+  // Returns an AotCompilationResult holding an already compiled `executable`,
+  // so that it can be serialized and loaded in another process without
+  // compiling it again.
+  virtual StatusOr<std::unique_ptr<AotCompilationResult>> Export(
+      Executable* executable) const {
+    return Unimplemented("Export unimplemented.");
+  }
+
   // Compiles a set of HLO modules that can run in parallel, potentially
   // communicating data between the modules, and returns a corresponding
   // sequence of executable objects.
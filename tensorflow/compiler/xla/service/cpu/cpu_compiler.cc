@@ -21,6 +21,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <stack>
 #include <string>
 #include <tuple>
@@ -37,6 +38,8 @@ limitations under the License.
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
@@ -47,9 +50,11 @@ limitations under the License.
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"  // from @llvm-project
 #include "mlir/Conversion/ArithmeticToLLVM/ArithmeticToLLVM.h"  // from @llvm-project
 #include "mlir/Conversion/BufferizationToMemRef/BufferizationToMemRef.h"  // from @llvm-project
@@ -92,6 +97,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/xla/ir/xla_framework.h"
 #include "tensorflow/compiler/mlir/xla/transforms/xla_passes.h"
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/protobuf_util.h"
@@ -121,6 +127,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/measured_hlo_profile.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
@@ -147,6 +154,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/indexed_array_analysis.h"
@@ -185,8 +193,15 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/casts.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numbers.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace {
@@ -605,8 +620,20 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
 
   pipeline.AddPass<ReshapeDecomposer>();
 
+  // Measured costs from a previous profiled run of this module, if any.
+  std::unique_ptr<MeasuredHloProfile> profile;
+  const std::string& profile_path =
+      module->config()
+          .debug_options()
+          .xla_cpu_profile_guided_optimization_profile();
+  if (!profile_path.empty()) {
+    TF_ASSIGN_OR_RETURN(profile, MeasuredHloProfile::Load(profile_path));
+    VLOG(1) << "Loaded HLO profile " << profile_path << " with "
+            << profile->slow_fusion_count() << " slow fusions.";
+  }
+
   // Add a fusion pass now that layout assignment is done.
-  pipeline.AddPass<CpuInstructionFusion>();
+  pipeline.AddPass<CpuInstructionFusion>(profile.get());
 
   // The LayoutAssignment pass may leave behind kCopy instructions which are
   // duplicate or NOPs, so remove them with algebraic simplification and CSE.
@@ -629,18 +656,27 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
   }();
 
   // Outline ops in the entry computation into calls to subcomputations.
-  const int max_parallelism =
+  const int num_threads =
       module->config().intra_op_parallelism_threads() > 0
           ? module->config().intra_op_parallelism_threads()
           : tensorflow::port::NumSchedulableCPUs();
+  // Partitions of a parallel loop are load balanced at runtime, so splitting
+  // loops into more partitions than there are threads can pay off.
+  const int max_parallelism =
+      num_threads *
+      std::max(1, module->config()
+                      .debug_options()
+                      .xla_cpu_parallel_tasks_per_thread());
   if (!is_aot_compile) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
     // Note this is not run for AOT because it would bring in thread pool
     // and thread synchronization dependencies which would likely increase
     // binary size (and most AOT applications are single-threaded).
     // TODO(b/29630486) Support multi-threaded AOT.
-    pipeline.AddPass<ParallelTaskAssigner>(
-        max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    pipeline.AddPass<ParallelTaskAssigner>(max_parallelism,
+                                           ShapeSizeBytesFunction(),
+                                           target_machine_features,
+                                           profile.get());
   }
   // Copy insertion should be performed immediately before IR emission to
   // avoid inserting unnecessary copies (later pass adds an instruction which
@@ -651,7 +687,16 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
   pipeline.AddPass<HloDCE>();
   pipeline.AddPass<CopyInsertion>();
   pipeline.AddPass<HloDCE>();
-  return pipeline.Run(module).status();
+  TF_RETURN_IF_ERROR(pipeline.Run(module).status());
+
+  // Rematerialization must run last: CSE would undo it, and it requires the
+  // schedule the module is emitted with.
+  const int64_t memory_limit_bytes =
+      module->config().debug_options().xla_cpu_memory_limit_bytes();
+  if (memory_limit_bytes > 0) {
+    TF_RETURN_IF_ERROR(RematerializeToMemoryLimit(module, memory_limit_bytes));
+  }
+  return OkStatus();
 }
 
 Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
@@ -704,7 +749,8 @@ llvm::CodeGenOpt::Level CodeGenOptLevel(const HloModuleConfig& module_config) {
 std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
     const HloModule& hlo_module,
     const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
-    const LLVMCompiler::ModuleHook& user_post_optimization_hook) {
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    absl::string_view filename_suffix = "") {
   // Create the IR hooks. If applicable, each IR hook does the following:
   //
   //  * Calls the user supplied module hook.
@@ -712,14 +758,15 @@ std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
   //    --xla_dump_to
   const HloModule* hlo_module_ptr = &hlo_module;
   auto hook = [user_pre_optimization_hook, user_post_optimization_hook,
-               hlo_module_ptr](bool optimized,
-                               const llvm::Module& llvm_module) {
+               hlo_module_ptr, filename_suffix = std::string(filename_suffix)](
+                  bool optimized, const llvm::Module& llvm_module) {
     const auto& user_hook =
         !optimized ? user_pre_optimization_hook : user_post_optimization_hook;
     if (user_hook) {
       user_hook(llvm_module);
     }
-    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized);
+    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized,
+                             filename_suffix);
   };
   return {[hook](const llvm::Module& llvm_module) {
             return hook(/*optimized=*/false, llvm_module);
@@ -781,6 +828,59 @@ Status CreateHloProfilingArtifacts(
 
 }  // namespace
 
+Status CpuCompiler::RematerializeToMemoryLimit(HloModule* module,
+                                               int64_t memory_limit_bytes) {
+  // Returns the total size of the buffers of `module` under its schedule.
+  auto assigned_bytes = [&]() -> StatusOr<int64_t> {
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<BufferAssignment> assignment,
+        BufferAssigner::Run(
+            module, std::make_unique<SequentialHloOrdering>(module->schedule()),
+            BufferSizeBytesFunction(), memory_alignment,
+            /*allocate_buffers_for_constants=*/true));
+    return assignment->GetStats().total_allocation_bytes;
+  };
+
+  HloMemoryScheduler scheduler(
+      BufferSizeBytesFunction(),
+      ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler));
+  TF_RETURN_IF_ERROR(scheduler.Run(module).status());
+  TF_ASSIGN_OR_RETURN(int64_t bytes_before, assigned_bytes());
+
+  // Only recompute instructions: compressing buffers is not supported by the
+  // CPU backend.
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization rematerialization(
+      ShapeSizeBytesFunction(), memory_limit_bytes, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+      /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly);
+  TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(module));
+  TF_ASSIGN_OR_RETURN(int64_t bytes_after, assigned_bytes());
+
+  using tensorflow::strings::HumanReadableNumBytes;
+  LOG(INFO) << "Module " << module->name() << " with memory limit "
+            << HumanReadableNumBytes(memory_limit_bytes) << ": buffers take "
+            << HumanReadableNumBytes(bytes_before) << " before and "
+            << HumanReadableNumBytes(bytes_after) << " after rematerialization"
+            << (changed ? "" : " (no instructions rematerialized)")
+            << "; estimated peak memory "
+            << HumanReadableNumBytes(sizes.before_bytes) << " -> "
+            << HumanReadableNumBytes(sizes.after_bytes) << ".";
+  return OkStatus();
+}
+
+StatusOr<HloSchedule> CpuCompiler::ScheduleForEmission(
+    const HloModule* module, const ModuleSchedulerAlgorithm& algorithm) {
+  // Rematerialization only holds under the schedule it ran with.
+  if (module->config().debug_options().xla_cpu_memory_limit_bytes() > 0 &&
+      module->has_schedule()) {
+    return module->schedule();
+  }
+  return ScheduleModule(module, BufferSizeBytesFunction(), algorithm);
+}
+
 StatusOr<std::unique_ptr<HloModule>> CpuCompiler::RunHloPasses(
     std::unique_ptr<HloModule> module, se::StreamExecutor* /*stream_exec*/,
     const CompileOptions& /*options*/) {
@@ -800,9 +900,9 @@ StatusOr<std::unique_ptr<BufferAssignment>> CpuCompiler::AssignBuffers(
   // Using this sequence enables tighter buffer liveness analysis and reduced
   // memory usage (as compared to using DependencyHloOrdering).
   TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module, BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+                      ScheduleForEmission(module,
+                                          ComputationSchedulerToModuleScheduler(
+                                              DFSMemoryScheduler)));
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -817,16 +917,142 @@ StatusOr<std::unique_ptr<BufferAssignment>> CpuCompiler::AssignBuffers(
 
 namespace {
 
+// Splits `llvm_module` into at most `num_partitions` modules and optimizes
+// and compiles them to object code concurrently on `thread_pool`, then adds
+// the object files to `jit` in partition order.
+//
+// Local symbols are externalized by the split, so that subcomputations can be
+// spread over partitions, and each partition is moved to its own LLVMContext
+// since contexts are not thread-safe. The split only depends on the module, so
+// the generated code doesn't depend on how the partitions are scheduled.
+Status CompileInParallel(
+    const HloModule& hlo_module, std::unique_ptr<llvm::Module> llvm_module,
+    int num_partitions, tensorflow::thread::ThreadPool* thread_pool,
+    const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    const std::function<void(const llvm::object::ObjectFile&)>&
+        post_codegen_hook,
+    SimpleOrcJIT* jit) {
+  XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Parallel LLVM codegen");
+  const HloModuleConfig& config = hlo_module.config();
+
+  int num_functions = 0;
+  for (const llvm::Function& function : llvm_module->functions()) {
+    if (!function.isDeclaration()) {
+      ++num_functions;
+    }
+  }
+
+  struct Partition {
+    std::unique_ptr<llvm::LLVMContext> context;
+    std::unique_ptr<llvm::Module> module;
+  };
+  std::vector<Partition> partitions;
+  llvm::SplitModule(
+      *llvm_module,
+      std::max<unsigned>(1, std::min<unsigned>(num_partitions, num_functions)),
+      [&](std::unique_ptr<llvm::Module> module) {
+        // Switch to a new context by writing and re-parsing the bitcode.
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*module, os);
+        Partition partition;
+        partition.context = std::make_unique<llvm::LLVMContext>();
+        partition.module = llvm::cantFail(llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(),
+                                                  bitcode.size()),
+                                  module->getModuleIdentifier()),
+            *partition.context));
+        partitions.push_back(std::move(partition));
+      },
+      /*PreserveLocals=*/false);
+  llvm_module.reset();
+  VLOG(1) << "Compiling " << hlo_module.name() << " in " << partitions.size()
+          << " partitions";
+
+  // Target machines are not thread-safe either, so each partition gets one.
+  std::vector<std::unique_ptr<llvm::TargetMachine>> target_machines;
+  for (int i = 0; i < partitions.size(); ++i) {
+    target_machines.push_back(SimpleOrcJIT::InferTargetMachineForJIT(
+        CompilerTargetOptions(config), CodeGenOptLevel(config)));
+  }
+
+  // The IR hooks are called for every partition; serialize the calls since
+  // user hooks are not expected to be thread-safe.
+  tensorflow::mutex hooks_mu;
+  auto serialized = [&hooks_mu](LLVMCompiler::ModuleHook hook) {
+    return [&hooks_mu, hook](const llvm::Module& module) {
+      tensorflow::mutex_lock lock(hooks_mu);
+      hook(module);
+    };
+  };
+
+  std::vector<StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> obj_files(
+      partitions.size());
+  tensorflow::BlockingCounter counter(partitions.size());
+  for (int i = 0; i < partitions.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      LLVMCompiler::ModuleHook pre_optimization_ir_hook;
+      LLVMCompiler::ModuleHook post_optimization_ir_hook;
+      std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
+          GetIRModuleHooks(hlo_module, user_pre_optimization_hook,
+                           user_post_optimization_hook,
+                           absl::StrCat("part", i));
+      CompilerFunctor compiler(
+          target_machines[i].get(), CodeGenOptLevel(config),
+          options::OptimizeForSizeRequested(config),
+          config.debug_options().xla_llvm_disable_expensive_passes(),
+          llvm_ir::GetCpuFastMathFlags(config),
+          serialized(std::move(pre_optimization_ir_hook)),
+          serialized(std::move(post_optimization_ir_hook)));
+      llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> obj_file =
+          compiler(*partitions[i].module);
+      if (obj_file) {
+        obj_files[i] = std::move(*obj_file);
+      } else {
+        obj_files[i] =
+            InternalError("Compiling LLVM module partition %d failed: %s", i,
+                          llvm::toString(obj_file.takeError()));
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (StatusOr<std::unique_ptr<llvm::MemoryBuffer>>& obj_file : obj_files) {
+    TF_RETURN_IF_ERROR(obj_file.status());
+    if (post_codegen_hook) {
+      llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> object =
+          llvm::object::ObjectFile::createObjectFile(
+              (*obj_file)->getMemBufferRef());
+      if (!object) {
+        return InternalError("Reading compiled object file failed: %s",
+                             llvm::toString(object.takeError()));
+      }
+      post_codegen_hook(**object);
+    }
+    if (llvm::Error error = jit->AddObjFile(*std::move(obj_file))) {
+      return InternalError("Adding object file to the JIT failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  }
+  return OkStatus();
+}
+
 // Post-compilation callback functor for use by SimpleOrcJIT.
 //
 // Dumps machine code if dumping is enabled for the module.
 struct OrcJITPostCompilationHook {
   // Gets an std::function that implements this hook.
+  // If `obj_files` is not null, the contents of every object file produced
+  // by the JIT are appended to it.
   static std::function<void(const llvm::object::ObjectFile& obj_file)> Create(
-      const HloModule* module) {
+      const HloModule* module,
+      std::shared_ptr<std::vector<std::string>> obj_files = nullptr) {
     // This struct is not copyable, but std::functions must be.  So to create an
     // std::function out of this struct, we have to wrap it in a shared_ptr.
-    auto wrapped = std::make_shared<OrcJITPostCompilationHook>(module);
+    auto wrapped = std::make_shared<OrcJITPostCompilationHook>(
+        module, std::move(obj_files));
     return [wrapped](const llvm::object::ObjectFile& obj_file) {
       (*wrapped)(obj_file);
     };
@@ -834,11 +1060,17 @@ struct OrcJITPostCompilationHook {
 
   // Constructor can't be private because we want to call it from
   // std::make_shared, but users should call Create() instead.
-  explicit OrcJITPostCompilationHook(const HloModule* module)
-      : module(module) {}
+  OrcJITPostCompilationHook(
+      const HloModule* module,
+      std::shared_ptr<std::vector<std::string>> obj_files)
+      : module(module), obj_files(std::move(obj_files)) {}
 
  private:
   void operator()(const llvm::object::ObjectFile& obj_file) {
+    if (obj_files) {
+      obj_files->emplace_back(obj_file.getData().data(),
+                              obj_file.getData().size());
+    }
     if (!DumpingEnabledForHloModule(*module)) {
       return;
     }
@@ -848,6 +1080,7 @@ struct OrcJITPostCompilationHook {
   }
 
   const HloModule* module;
+  std::shared_ptr<std::vector<std::string>> obj_files;
 };
 
 void InitializeLLVMCommandLineOptions(const HloModuleConfig& config) {
@@ -1094,14 +1327,21 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   auto llvm_module =
       std::make_unique<llvm::Module>("__compute_module", *llvm_context);
 
+  // Keep the object code emitted by the JIT if the executable is going to be
+  // exported and reloaded without recompiling (see CpuCompiler::Export).
+  std::shared_ptr<std::vector<std::string>> obj_files;
+  if (module->config().debug_options().xla_cpu_keep_object_code()) {
+    obj_files = std::make_shared<std::vector<std::string>>();
+  }
+  std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook =
+      OrcJITPostCompilationHook::Create(module.get(), obj_files);
   auto jit = SimpleOrcJIT::Create(
       CompilerTargetOptions(module->config()),
       CodeGenOptLevel(module->config()),
       options::OptimizeForSizeRequested(module->config()),
       module->config().debug_options().xla_llvm_disable_expensive_passes(),
       llvm_ir::GetCpuFastMathFlags(module->config()), pre_optimization_ir_hook,
-      post_optimization_ir_hook,
-      OrcJITPostCompilationHook::Create(module.get()));
+      post_optimization_ir_hook, post_codegen_hook);
   if (!jit) {
     return InternalError("Creating JIT failed: %s",
                          llvm::toString(jit.takeError()));
@@ -1131,9 +1371,9 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   // computation. Using this sequence enables tighter buffer liveness analysis
   // and reduced memory usage (as compared to using DependencyHloOrdering).
   TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module.get(), BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+                      ScheduleForEmission(module.get(),
+                                          ComputationSchedulerToModuleScheduler(
+                                              DFSMemoryScheduler)));
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -1204,13 +1444,35 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (split_count > 1) {
+    tensorflow::thread::ThreadPool* thread_pool = options.thread_pool;
+    std::optional<tensorflow::thread::ThreadPool> overriding_thread_pool;
+    if (thread_pool == nullptr) {
+      overriding_thread_pool.emplace(
+          tensorflow::Env::Default(), "xla_cpu_parallel_codegen",
+          std::min(split_count, tensorflow::port::MaxParallelism()));
+      thread_pool = &*overriding_thread_pool;
+    }
+    TF_RETURN_IF_ERROR(CompileInParallel(
+        *module, std::move(llvm_module), split_count, thread_pool,
+        user_pre_optimization_hook_, user_post_optimization_hook_,
+        post_codegen_hook, jit->get()));
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
       std::move(hlo_profile_printer_data), std::move(hlo_profile_index_map));
+  // The CpuExecutable constructor looks up the entry function, which forces
+  // the JIT to materialize all of the object code.
+  if (obj_files) {
+    cpu_executable->set_obj_files(std::move(*obj_files));
+  }
 
   if (embed_ir_in_executable) {
     cpu_executable->set_ir_module_string(ir_module_string);
@@ -1278,6 +1540,33 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
   if (aot_options.PlatformId() != se::host::kHostPlatformId) {
     return InvalidArgument("Incompatible AOT compilation platform");
   }
+
+  // Plain AotCompilationOptions (as used by LocalClient::CompileAheadOfTime)
+  // ask for executables that can be loaded back into the JIT on this host, so
+  // compile them as usual and export the object code.
+  if (dynamic_cast<const CpuAotCompilationOptions*>(&aot_options) == nullptr) {
+    CompileOptions compile_options{aot_options.device_allocator()};
+    std::vector<std::unique_ptr<AotCompilationResult>> results;
+    for (std::unique_ptr<HloModule>& module : modules) {
+      DebugOptions debug_options = module->config().debug_options();
+      debug_options.set_xla_cpu_keep_object_code(true);
+      module->config().set_debug_options(debug_options);
+      if (!aot_options.run_backend_only()) {
+        TF_ASSIGN_OR_RETURN(module,
+                            RunHloPasses(std::move(module),
+                                         aot_options.executor(),
+                                         compile_options));
+      }
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<Executable> executable,
+                          RunBackend(std::move(module), aot_options.executor(),
+                                     compile_options));
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<AotCompilationResult> result,
+                          Export(executable.get()));
+      results.push_back(std::move(result));
+    }
+    return std::move(results);
+  }
+
   const CpuAotCompilationOptions& options =
       static_cast<const CpuAotCompilationOptions&>(aot_options);
   llvm::Triple triple(llvm::Triple::normalize(options.triple()));
@@ -1340,8 +1629,7 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
         RunHloPasses(module, /*is_aot_compile=*/true, target_machine.get(),
                      /*is_mlir_compile=*/options.use_mlir_hlo_lowering()));
 
-    TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                        ScheduleModule(module, BufferSizeBytesFunction()));
+    TF_ASSIGN_OR_RETURN(HloSchedule schedule, ScheduleForEmission(module));
 
     // Run buffer analysis on the HLO graph. This analysis figures out which
     // temporary buffers are required to run the computation.
@@ -1418,7 +1706,8 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
           // TODO(b/66051036): Run full msan for AOT.
           /*emit_code_for_msan=*/false);
 
-      TF_RETURN_IF_ERROR(ir_emitter.EmitConstantGlobals());
+      TF_RETURN_IF_ERROR(ir_emitter.EmitConstantGlobals(
+          /*share_across_object_files=*/options.share_constants()));
 
       for (ComputationToEmit subcomputation :
            SubcomputationEmissionOrder(computation)) {
@@ -1496,6 +1785,163 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
   return std::move(results);
 }
 
+namespace {
+
+// The logical buffers assigned to an allocation are identified by ids that are
+// not stable across HloModule serialization, so only the allocations
+// themselves are compared when loading an exported executable.
+BufferAllocationProto AllocationProtoWithoutAssignments(
+    const BufferAllocation& allocation) {
+  BufferAllocationProto proto = allocation.ToProto();
+  proto.clear_assigned();
+  return proto;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<AotCompilationResult>> CpuCompiler::Export(
+    Executable* executable) const {
+  auto* cpu_executable = tensorflow::down_cast<CpuExecutable*>(executable);
+  const HloModuleConfig& config = cpu_executable->module().config();
+  if (config.hlo_profiling_enabled()) {
+    return Unimplemented(
+        "Exporting CPU executables with HLO profiling is not supported.");
+  }
+  if (cpu_executable->obj_files().empty()) {
+    return FailedPrecondition(
+        "CPU executable for %s has no object code to export; compile it with "
+        "xla_cpu_keep_object_code.",
+        cpu_executable->module().name());
+  }
+
+  CpuExecutableProto proto;
+  *proto.mutable_hlo_module_proto() = cpu_executable->module().ToProto();
+  for (const BufferAllocation& allocation :
+       cpu_executable->buffer_assignment().Allocations()) {
+    *proto.add_buffer_allocations() =
+        AllocationProtoWithoutAssignments(allocation);
+  }
+  for (const std::string& obj_file : cpu_executable->obj_files()) {
+    proto.add_obj_files(obj_file);
+  }
+  proto.set_entry_function_name(cpu_executable->entry_function_name());
+
+  // The JIT's own target machine is released once compilation is done, so
+  // infer it again; it only depends on the host and the module config.
+  std::unique_ptr<llvm::TargetMachine> target_machine =
+      SimpleOrcJIT::InferTargetMachineForJIT(CompilerTargetOptions(config),
+                                             CodeGenOptLevel(config));
+  proto.set_target_triple(target_machine->getTargetTriple().getTriple());
+  proto.set_target_cpu(target_machine->getTargetCPU().str());
+  proto.set_target_features(target_machine->getTargetFeatureString().str());
+  return std::unique_ptr<AotCompilationResult>(
+      new CpuExecutableAotCompilationResult(std::move(proto)));
+}
+
+StatusOr<std::unique_ptr<AotCompilationResult>>
+CpuCompiler::LoadAotCompilationResult(
+    const std::string& serialized_aot_result) {
+  return CpuExecutableAotCompilationResult::FromString(serialized_aot_result);
+}
+
+StatusOr<std::unique_ptr<Executable>>
+CpuExecutableAotCompilationResult::LoadExecutable(
+    Compiler* compiler, se::StreamExecutor* executor) const {
+  TF_ASSIGN_OR_RETURN(
+      HloModuleConfig config,
+      HloModule::CreateModuleConfigFromProto(proto_.hlo_module_proto(),
+                                             GetDebugOptionsFromFlags()));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<HloModule> module,
+      HloModule::CreateFromProto(proto_.hlo_module_proto(), config));
+
+  auto jit = SimpleOrcJIT::Create(
+      CompilerTargetOptions(config), CodeGenOptLevel(config),
+      options::OptimizeForSizeRequested(config),
+      config.debug_options().xla_llvm_disable_expensive_passes(),
+      llvm_ir::GetCpuFastMathFlags(config),
+      /*pre_optimization_hook=*/nullptr,
+      /*post_optimization_hook=*/nullptr,
+      /*post_codegen_hook=*/nullptr);
+  if (!jit) {
+    return InternalError("Creating JIT failed: %s",
+                         llvm::toString(jit.takeError()));
+  }
+
+  // Object code is only usable on the target it was generated for.
+  const llvm::TargetMachine* target_machine = (*jit)->target_machine();
+  const std::string target_triple =
+      target_machine->getTargetTriple().getTriple();
+  const std::string target_cpu = target_machine->getTargetCPU().str();
+  const std::string target_features =
+      target_machine->getTargetFeatureString().str();
+  if (target_triple != proto_.target_triple() ||
+      target_cpu != proto_.target_cpu() ||
+      target_features != proto_.target_features()) {
+    return FailedPrecondition(
+        "Serialized CPU executable was compiled for %s (cpu: %s, features: "
+        "%s), but the host target is %s (cpu: %s, features: %s).",
+        proto_.target_triple(), proto_.target_cpu(), proto_.target_features(),
+        target_triple, target_cpu, target_features);
+  }
+
+  // The object code addresses buffers by allocation index and offset, so the
+  // buffer assignment recomputed for the module must match the one it was
+  // compiled against.
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<BufferAssignment> assignment,
+      tensorflow::down_cast<CpuCompiler*>(compiler)->AssignBuffers(
+          module.get()));
+  const std::vector<BufferAllocation>& allocations =
+      assignment->Allocations();
+  if (allocations.size() != proto_.buffer_allocations_size()) {
+    return FailedPrecondition(
+        "Serialized CPU executable has %d buffer allocations, but %d were "
+        "assigned when loading it.",
+        proto_.buffer_allocations_size(), allocations.size());
+  }
+  for (int64_t i = 0; i < allocations.size(); ++i) {
+    BufferAllocationProto allocation =
+        AllocationProtoWithoutAssignments(allocations[i]);
+    if (!protobuf_util::ProtobufEquals(allocation,
+                                       proto_.buffer_allocations(i))) {
+      return FailedPrecondition(
+          "Buffer allocation %d of the serialized CPU executable does not "
+          "match the one assigned when loading it: %s vs %s",
+          i, proto_.buffer_allocations(i).ShortDebugString(),
+          allocation.ShortDebugString());
+    }
+  }
+
+  for (const std::string& obj_file : proto_.obj_files()) {
+    if (llvm::Error error = (*jit)->AddObjFile(
+            llvm::MemoryBuffer::getMemBufferCopy(obj_file))) {
+      return InternalError("Adding object file to the JIT failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  }
+  // CpuExecutable CHECK-fails if the entry function is missing, so look it up
+  // here first to report corrupt entries as errors.
+  llvm::Expected<llvm::JITEvaluatedSymbol> entry_symbol =
+      (*jit)->FindCompiledSymbol(proto_.entry_function_name());
+  if (!entry_symbol) {
+    return InternalError("Entry function %s not found: %s",
+                         proto_.entry_function_name(),
+                         llvm::toString(entry_symbol.takeError()));
+  }
+
+  auto cpu_executable = std::make_unique<CpuExecutable>(
+      std::move(*jit), std::move(assignment), std::move(module),
+      proto_.entry_function_name(),
+      /*hlo_profile_printer_data=*/nullptr,
+      /*hlo_profile_index_map=*/nullptr);
+  cpu_executable->set_obj_files(std::vector<std::string>(
+      proto_.obj_files().begin(), proto_.obj_files().end()));
+  cpu_executable->set_debug_info(
+      cpu_executable->buffer_assignment().GetStats().ToString());
+  return std::unique_ptr<Executable>(std::move(cpu_executable));
+}
+
 se::Platform::Id CpuCompiler::PlatformId() const {
   return se::host::kHostPlatformId;
 }
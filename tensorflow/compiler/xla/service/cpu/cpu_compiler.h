@@ -23,6 +23,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 #include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
+#include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/llvm_compiler.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -72,6 +74,12 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   bool use_mlir_hlo_lowering() const { return use_mlir_hlo_lowering_; }
   void set_use_mlir_hlo_lowering(bool value) { use_mlir_hlo_lowering_ = value; }
 
+  // If true, constants are emitted as content-addressed linkonce_odr symbols
+  // so that object files compiled from the same weights can share them once
+  // linked into one binary.
+  bool share_constants() const { return share_constants_; }
+  void set_share_constants(bool value) { share_constants_ = value; }
+
  private:
   const std::string triple_;
   const std::string cpu_name_;
@@ -79,6 +87,7 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const std::string entry_point_name_;
   const RelocationModel relocation_model_;
   bool use_mlir_hlo_lowering_ = false;
+  bool share_constants_ = false;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
@@ -118,6 +127,38 @@ class CpuAotCompilationResult : public AotCompilationResult {
   std::unique_ptr<HloProfilePrinterData> hlo_profile_printer_data_;
 };
 
+// The result of exporting a CpuExecutable compiled by the JIT: the optimized
+// module together with the object code generated for it, which can be loaded
+// in another process on a host with the same target without running LLVM.
+class CpuExecutableAotCompilationResult : public AotCompilationResult {
+ public:
+  static StatusOr<std::unique_ptr<CpuExecutableAotCompilationResult>>
+  FromString(const std::string& serialized) {
+    CpuExecutableProto proto;
+    if (!proto.ParseFromString(serialized)) {
+      return InternalError("Failed to parse serialized CpuExecutableProto.");
+    }
+    return std::unique_ptr<CpuExecutableAotCompilationResult>(
+        new CpuExecutableAotCompilationResult(std::move(proto)));
+  }
+
+  explicit CpuExecutableAotCompilationResult(CpuExecutableProto proto)
+      : proto_(std::move(proto)) {}
+  ~CpuExecutableAotCompilationResult() override = default;
+
+  StatusOr<std::string> SerializeAsString() const override {
+    return proto_.SerializeAsString();
+  }
+
+  StatusOr<std::unique_ptr<Executable>> LoadExecutable(
+      Compiler* compiler, se::StreamExecutor* executor) const override;
+
+  const CpuExecutableProto& proto() const { return proto_; }
+
+ private:
+  CpuExecutableProto proto_;
+};
+
 // CPU-targeting implementation of the XLA Compiler interface.
 //
 // The compiler translates XLA HLO code into LLVM IR and uses LLVM's JIT
@@ -148,6 +189,12 @@ class CpuCompiler : public LLVMCompiler {
   CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
                      const AotCompilationOptions& options) override;
 
+  StatusOr<std::unique_ptr<AotCompilationResult>> Export(
+      Executable* executable) const override;
+
+  StatusOr<std::unique_ptr<AotCompilationResult>> LoadAotCompilationResult(
+      const std::string& serialized_aot_result) override;
+
   se::Platform::Id PlatformId() const override;
 
   HloCostAnalysis::ShapeSizeFunction ShapeSizeBytesFunction() const override;
@@ -173,6 +220,16 @@ class CpuCompiler : public LLVMCompiler {
       HloModule* module, bool is_aot_compile,
       LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile);
 
+  // Schedules `module` to minimize memory and rematerializes instructions
+  // until its buffers fit in `memory_limit_bytes`, where possible. The
+  // resulting schedule is kept in the module for the backend to emit.
+  Status RematerializeToMemoryLimit(HloModule* module,
+                                    int64_t memory_limit_bytes);
+
+  // Returns the order in which to emit the instructions of `module`.
+  StatusOr<HloSchedule> ScheduleForEmission(
+      const HloModule* module, const ModuleSchedulerAlgorithm& algorithm = {});
+
   mutable std::unique_ptr<HloProto> hlo_proto_;
 
   CpuCompiler(const CpuCompiler&) = delete;
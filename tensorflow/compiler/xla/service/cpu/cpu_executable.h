@@ -72,6 +72,19 @@ class CpuExecutable : public Executable {
     ir_module_string_ = ir_module_string;
   }
 
+  // The object files the JIT generated for this executable, if it was compiled
+  // with xla_cpu_keep_object_code. Kept so that the executable can be exported
+  // and loaded in another process without running LLVM again (see
+  // CpuCompiler::Export).
+  const std::vector<std::string>& obj_files() const { return obj_files_; }
+
+  void set_obj_files(std::vector<std::string> obj_files) {
+    obj_files_ = std::move(obj_files);
+  }
+
+  // Mangled name of the entry computation function in the object files.
+  const std::string& entry_function_name() const { return module_name_; }
+
   static int64_t ShapeSizeBytes(const Shape& shape);
 
   // Type of the computation function we expect in the JIT.
@@ -137,6 +150,8 @@ class CpuExecutable : public Executable {
   // positives.
   std::string ir_module_string_;
 
+  std::vector<std::string> obj_files_;
+
   // Unique identifier.
   std::string module_name_;
 
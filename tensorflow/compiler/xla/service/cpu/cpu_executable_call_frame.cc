@@ -0,0 +1,126 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable_call_frame.h"
+
+#include <optional>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/memory/memory.h"
+#include "tensorflow/compiler/xla/service/cpu/buffer_info_util.h"
+#include "tensorflow/compiler/xla/service/custom_call_status_internal.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace cpu {
+
+CpuExecutableCallFrame::CpuExecutableCallFrame(const CpuExecutable& executable)
+    : executable_(executable) {}
+
+CpuExecutableCallFrame::~CpuExecutableCallFrame() {
+  cpu_function_runtime::FreeContiguous(temp_buffers_);
+}
+
+/*static*/ StatusOr<std::unique_ptr<CpuExecutableCallFrame>>
+CpuExecutableCallFrame::Create(const CpuExecutable& executable) {
+  const HloModule& module = executable.module();
+  bool has_aliasing = false;
+  module.input_output_alias_config().ForEachAlias(
+      [&](const ShapeIndex&, const HloInputOutputAliasConfig::Alias&) {
+        has_aliasing = true;
+      });
+  if (has_aliasing) {
+    return Unimplemented(
+        "Call frames do not support executables with input/output aliasing");
+  }
+
+  const BufferAssignment& assignment = executable.buffer_assignment();
+  auto frame = absl::WrapUnique(new CpuExecutableCallFrame(executable));
+  frame->arg_allocations_.assign(
+      module.entry_computation()->num_parameters(), -1);
+  for (const BufferAllocation& allocation : assignment.Allocations()) {
+    if (!allocation.is_entry_computation_parameter()) {
+      continue;
+    }
+    if (!allocation.param_shape_index().empty()) {
+      return Unimplemented(
+          "Call frames do not support tuple-shaped parameter %d",
+          allocation.parameter_number());
+    }
+    frame->arg_allocations_[allocation.parameter_number()] =
+        allocation.index();
+  }
+
+  const HloInstruction* root = module.entry_computation()->root_instruction();
+  for (const ShapeUtil::IndexedShape& leaf :
+       ShapeUtil::GetLeafShapes(root->shape())) {
+    TF_ASSIGN_OR_RETURN(BufferAllocation::Slice slice,
+                        assignment.GetUniqueSlice(root, leaf.index));
+    if (slice.allocation()->is_constant()) {
+      return Unimplemented(
+          "Call frames do not support constant outputs (output %s)",
+          leaf.index.ToString());
+    }
+    frame->result_slices_.push_back(slice);
+  }
+
+  frame->buffer_infos_ = CreateBufferInfosFromBufferAssignment(assignment);
+  frame->buffer_table_.resize(frame->buffer_infos_.size());
+  frame->temp_buffers_ = cpu_function_runtime::MallocContiguousBuffers(
+      frame->buffer_infos_.data(), frame->buffer_infos_.size(),
+      /*allocate_entry_params=*/false, frame->buffer_table_.data(),
+      /*annotate_initialized=*/true);
+
+  if (executable.hlo_profiling_enabled()) {
+    frame->profile_counters_.resize(
+        executable.hlo_profile_printer_data().profile_counters_size());
+  }
+  return std::move(frame);
+}
+
+void CpuExecutableCallFrame::set_arg_data(int index, const void* data) {
+  int64_t allocation = arg_allocations_[index];
+  if (allocation >= 0) {
+    buffer_table_[allocation] = const_cast<void*>(data);
+  }
+}
+
+void* CpuExecutableCallFrame::result_data(int index) const {
+  const BufferAllocation::Slice& slice = result_slices_[index];
+  return static_cast<char*>(buffer_table_[slice.index()]) + slice.offset();
+}
+
+Status CpuExecutableCallFrame::Run(const ExecutableRunOptions& run_options) {
+  XlaCustomCallStatus status;
+  // As in CpuExecutable::ExecuteComputeFunction, all inputs and outputs of the
+  // entry computation live in the buffer table.
+  executable_.compute_function()(
+      /*result=*/nullptr, &run_options, /*args=*/nullptr, buffer_table_.data(),
+      &status, profile_counters_.empty() ? nullptr : profile_counters_.data());
+
+  std::optional<absl::string_view> error_message =
+      CustomCallStatusGetMessage(&status);
+  if (error_message) {
+    return InternalError("CustomCall failed: %s", *error_message);
+  }
+  return OkStatus();
+}
+
+}  // namespace cpu
+}  // namespace xla
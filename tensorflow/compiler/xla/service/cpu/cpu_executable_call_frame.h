@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_EXECUTABLE_CALL_FRAME_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_EXECUTABLE_CALL_FRAME_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/cpu_function_runtime.h"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/compiler/xla/service/buffer_assignment.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// A low-latency way to run a JIT-compiled CpuExecutable repeatedly, in the
+// style of tfcompile's XlaCompiledCpuFunction.
+//
+// CpuExecutable::ExecuteAsyncOnStream allocates all temporary and output
+// buffers, builds ShapedBuffers for the result and hops to the stream's
+// thread on every call, which dominates the run time of small computations.
+// A call frame allocates the temporary and output buffers once, in a single
+// contiguous block, and Run() calls the compiled function directly on the
+// calling thread. Results are left in the preallocated buffers, where they are
+// overwritten by the next call.
+//
+// A call frame is not thread-safe; use one per thread. The executable must
+// outlive its call frames. Only executables whose parameters are arrays and
+// that have no input/output aliasing are supported.
+class CpuExecutableCallFrame {
+ public:
+  static StatusOr<std::unique_ptr<CpuExecutableCallFrame>> Create(
+      const CpuExecutable& executable);
+  ~CpuExecutableCallFrame();
+
+  int num_args() const { return arg_allocations_.size(); }
+
+  // Sets the buffer of parameter `index`, which must hold the parameter in
+  // its entry computation layout. The buffer is only read during Run().
+  void set_arg_data(int index, const void* data);
+
+  // The number of array outputs, in the order of the leaves of the result
+  // shape.
+  int num_results() const { return result_slices_.size(); }
+
+  // Returns the buffer of output `index`. It is valid until the next call to
+  // Run() or until the destruction of the call frame, whichever comes first.
+  // The buffer may be one of the argument buffers if the computation forwards
+  // a parameter.
+  void* result_data(int index) const;
+
+  // The size of output `index` in bytes.
+  int64_t result_size(int index) const {
+    return result_slices_[index].size();
+  }
+
+  // Runs the computation on the calling thread. `run_options` has to provide
+  // an intra-op thread pool unless the executable was compiled for
+  // single-threaded execution.
+  Status Run(const ExecutableRunOptions& run_options);
+
+ private:
+  explicit CpuExecutableCallFrame(const CpuExecutable& executable);
+
+  const CpuExecutable& executable_;
+  std::vector<cpu_function_runtime::BufferInfo> buffer_infos_;
+
+  // The buffer table passed to the compiled function.
+  std::vector<void*> buffer_table_;
+  // Head of the contiguous block holding the temporary buffers.
+  void* temp_buffers_ = nullptr;
+
+  // Buffer allocation of every parameter, or -1 for unused parameters.
+  std::vector<int64_t> arg_allocations_;
+  std::vector<BufferAllocation::Slice> result_slices_;
+
+  // Profile counters written by executables compiled with HLO profiling.
+  std::vector<int64_t> profile_counters_;
+
+  CpuExecutableCallFrame(const CpuExecutableCallFrame&) = delete;
+  CpuExecutableCallFrame& operator=(const CpuExecutableCallFrame&) = delete;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_EXECUTABLE_CALL_FRAME_H_
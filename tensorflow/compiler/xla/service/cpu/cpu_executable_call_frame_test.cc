@@ -0,0 +1,169 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable_call_frame.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/service/transfer_manager.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+LocalClient* GetHostClient() {
+  se::Platform* platform = PlatformUtil::GetPlatform("Host").ValueOrDie();
+  return ClientLibrary::GetOrCreateLocalClient(platform).ValueOrDie();
+}
+
+// Compiles (x + y, x * y) on f32[n] operands.
+std::unique_ptr<LocalExecutable> CompileAddMul(LocalClient* client,
+                                               int64_t n) {
+  XlaBuilder builder("AddMul");
+  Shape shape = ShapeUtil::MakeShape(F32, {n});
+  XlaOp x = Parameter(&builder, 0, shape, "x");
+  XlaOp y = Parameter(&builder, 1, shape, "y");
+  Tuple(&builder, {Add(x, y), Mul(x, y)});
+  XlaComputation computation = builder.Build().ConsumeValueOrDie();
+  auto executables =
+      client->Compile(computation, {&shape, &shape}, ExecutableBuildOptions())
+          .ConsumeValueOrDie();
+  return std::move(executables[0]);
+}
+
+const CpuExecutable& AsCpuExecutable(const LocalExecutable& executable) {
+  return *static_cast<const CpuExecutable*>(executable.executable());
+}
+
+ExecutableRunOptions HostRunOptions(LocalClient* client) {
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(
+      client->backend().eigen_intra_op_thread_pool_device());
+  return run_options;
+}
+
+TEST(CpuExecutableCallFrameTest, RunsTupleResult) {
+  LocalClient* client = GetHostClient();
+  std::unique_ptr<LocalExecutable> executable = CompileAddMul(client, 4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CpuExecutableCallFrame> frame,
+      CpuExecutableCallFrame::Create(AsCpuExecutable(*executable)));
+  ASSERT_EQ(frame->num_args(), 2);
+  ASSERT_EQ(frame->num_results(), 2);
+  EXPECT_EQ(frame->result_size(0), 4 * sizeof(float));
+
+  ExecutableRunOptions run_options = HostRunOptions(client);
+  // Run twice to check that the preallocated buffers are reusable.
+  for (float scale : {1.0f, 2.0f}) {
+    float x[4] = {1 * scale, 2 * scale, 3 * scale, 4 * scale};
+    float y[4] = {5, 6, 7, 8};
+    frame->set_arg_data(0, x);
+    frame->set_arg_data(1, y);
+    TF_ASSERT_OK(frame->Run(run_options));
+
+    const float* sum = static_cast<const float*>(frame->result_data(0));
+    const float* product = static_cast<const float*>(frame->result_data(1));
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(sum[i], x[i] + y[i]);
+      EXPECT_EQ(product[i], x[i] * y[i]);
+    }
+  }
+}
+
+TEST(CpuExecutableCallFrameTest, ForwardsParameter) {
+  LocalClient* client = GetHostClient();
+  XlaBuilder builder("Identity");
+  Shape shape = ShapeUtil::MakeShape(S32, {3});
+  Parameter(&builder, 0, shape, "x");
+  XlaComputation computation = builder.Build().ConsumeValueOrDie();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executables,
+      client->Compile(computation, {&shape}, ExecutableBuildOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CpuExecutableCallFrame> frame,
+      CpuExecutableCallFrame::Create(AsCpuExecutable(*executables[0])));
+
+  int32_t x[3] = {7, 8, 9};
+  frame->set_arg_data(0, x);
+  TF_ASSERT_OK(frame->Run(HostRunOptions(client)));
+  ASSERT_EQ(frame->num_results(), 1);
+  EXPECT_EQ(std::memcmp(frame->result_data(0), x, sizeof(x)), 0);
+}
+
+// Runs a tiny computation through LocalExecutable::Run, which allocates the
+// result and temporaries and hops to the host stream on every call.
+void BM_LocalExecutableRun(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  LocalClient* client = GetHostClient();
+  std::unique_ptr<LocalExecutable> executable = CompileAddMul(client, n);
+
+  Shape shape = ShapeUtil::MakeShape(F32, {n});
+  se::DeviceMemoryAllocator* allocator = client->backend().memory_allocator();
+  TransferManager* transfer_manager = client->backend().transfer_manager();
+  auto stream = client->mutable_backend()
+                    ->BorrowStream(client->default_device_ordinal())
+                    .ValueOrDie();
+  auto buffer = transfer_manager
+                    ->AllocateScopedShapedBuffer(shape, allocator,
+                                                 /*device_ordinal=*/0)
+                    .ConsumeValueOrDie();
+  TF_CHECK_OK(transfer_manager->TransferLiteralToDevice(
+      stream.get(), LiteralUtil::CreateFull<float>({n}, 1.0f), buffer));
+
+  ExecutableRunOptions run_options = HostRunOptions(client);
+  run_options.set_allocator(allocator).set_stream(stream.get());
+  for (auto s : state) {
+    auto result = executable->Run({&buffer, &buffer}, run_options);
+    TF_CHECK_OK(result.status());
+    TF_CHECK_OK(stream->BlockHostUntilDone());
+  }
+}
+
+// Runs the same computation through a call frame.
+void BM_CallFrameRun(::testing::benchmark::State& state) {
+  const int64_t n = state.range(0);
+  LocalClient* client = GetHostClient();
+  std::unique_ptr<LocalExecutable> executable = CompileAddMul(client, n);
+  std::unique_ptr<CpuExecutableCallFrame> frame =
+      CpuExecutableCallFrame::Create(AsCpuExecutable(*executable))
+          .ConsumeValueOrDie();
+
+  std::vector<float> x(n, 1.0f);
+  frame->set_arg_data(0, x.data());
+  frame->set_arg_data(1, x.data());
+  ExecutableRunOptions run_options = HostRunOptions(client);
+  for (auto s : state) {
+    TF_CHECK_OK(frame->Run(run_options));
+  }
+}
+
+BENCHMARK(BM_LocalExecutableRun)->Arg(1)->Arg(64)->Arg(4096);
+BENCHMARK(BM_CallFrameRun)->Arg(1)->Arg(64)->Arg(4096);
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
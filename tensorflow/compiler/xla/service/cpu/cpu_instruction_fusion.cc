@@ -76,6 +76,10 @@ FusionDecision CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
 
   constexpr int kFusionThresholdBytes = 16 * 1024;
 
+  if (profile_ != nullptr && profile_->IsSlowFusion(*producer, *consumer)) {
+    return "Not fusing: fusion was measured to be slow in the HLO profile.";
+  }
+
   if (CanBeOutputFused(producer, consumer)) {
     VLOG(2) << "Fusion OK: Can create output fusion.";
     return {};
@@ -197,6 +201,21 @@ HloInstruction::FusionKind CpuInstructionFusion::ChooseKind(
              : HloInstruction::FusionKind::kLoop;
 }
 
+HloInstruction* CpuInstructionFusion::Fuse(HloInstruction* producer,
+                                           HloInstruction* consumer,
+                                           HloComputation* computation) {
+  // The clones in the fusion computation get new unique names. Record the
+  // original ones, which the clones inherit with the metadata, so that HLO
+  // profiles of this fusion can be matched against a later compilation.
+  for (HloInstruction* instruction : {producer, consumer}) {
+    if (instruction->opcode() != HloOpcode::kFusion &&
+        instruction->metadata().pre_fusion_name().empty()) {
+      instruction->set_metadata_pre_fusion_name(instruction->name());
+    }
+  }
+  return InstructionFusion::Fuse(producer, consumer, computation);
+}
+
 HloInstruction* CpuInstructionFusion::FuseInstruction(
     HloInstruction* fusion_instruction, HloInstruction* producer) {
   auto evaluation = fusion_node_evaluations_.find(fusion_instruction);
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_INSTRUCTION_FUSION_H_
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/cpu/measured_hlo_profile.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
@@ -26,8 +27,11 @@ namespace cpu {
 
 class CpuInstructionFusion : public InstructionFusion {
  public:
-  CpuInstructionFusion()
-      : InstructionFusion(CpuInstructionFusion::IsExpensive) {}
+  // If `profile` is not null, fusions that were measured to be slow in it are
+  // not formed again.
+  explicit CpuInstructionFusion(const MeasuredHloProfile* profile = nullptr)
+      : InstructionFusion(CpuInstructionFusion::IsExpensive),
+        profile_(profile) {}
   ~CpuInstructionFusion() override = default;
 
   StatusOr<bool> Run(HloModule* module) override {
@@ -40,6 +44,8 @@ class CpuInstructionFusion : public InstructionFusion {
                             int64_t operand_index) override;
   HloInstruction::FusionKind ChooseKind(
       const HloInstruction* producer, const HloInstruction* consumer) override;
+  HloInstruction* Fuse(HloInstruction* producer, HloInstruction* consumer,
+                       HloComputation* computation) override;
 
  private:
   HloInstruction* FuseInstruction(HloInstruction* fusion_instruction,
@@ -49,6 +55,8 @@ class CpuInstructionFusion : public InstructionFusion {
   // indexed with different index vectors.
   absl::flat_hash_map<const HloInstruction*, FusionNodeIndexingEvaluation>
       fusion_node_evaluations_;
+
+  const MeasuredHloProfile* profile_;
 };
 
 }  // namespace cpu
@@ -21,6 +21,8 @@ limitations under the License.
 namespace {
 
 const char* const kXlaOptimizeForSizeCpuOption = "xla_cpu_optimize_for_size";
+const char* const kXlaDisableVectorizedReduce =
+    "xla_cpu_disable_vectorized_reduce";
 const char* const kLlvmIrDotTilingFactor = "xla_llvm_dot_tiling_factor";
 const char* const kXlaForceEnableExperimentalLlvmIrGemm =
     "xla_force_enable_experimental_llvm_ir_gemm";
@@ -41,7 +43,8 @@ bool OptimizeForSizeRequested(const HloModuleConfig& config) {
 bool VectorizedReduceDisabled(const HloModuleConfig& config) {
   const auto& extra_options_map =
       config.debug_options().xla_backend_extra_options();
-  return extra_options_map.count(kXlaOptimizeForSizeCpuOption) > 0;
+  return extra_options_map.count(kXlaOptimizeForSizeCpuOption) > 0 ||
+         extra_options_map.count(kXlaDisableVectorizedReduce) > 0;
 }
 
 std::optional<int64_t> LlvmIrGemvTilingFactor(const HloModuleConfig& config) {
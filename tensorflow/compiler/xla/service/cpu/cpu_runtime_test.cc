@@ -15,15 +15,19 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "absl/strings/str_format.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_custom_call_status.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
@@ -251,5 +255,98 @@ TEST_F(CpuRuntimeTest, FailureStatus) {
   ASSERT_FALSE(__xla_cpu_runtime_StatusIsSuccess(&success_status));
 }
 
+// Partition function for the ParallelForkJoin tests: counts the visits of
+// every index in the partition, records the params it was passed and fails on
+// partitions starting at 'kFailAt'.
+constexpr int64_t kFailAt = 24;
+void CountingPartitionFunction(void* /*result*/, const void* /*run_options*/,
+                               const void** params, void** buffer_table,
+                               void* status, int64_t* partition,
+                               uint64_t* /*prof_counters*/) {
+  auto* counts = static_cast<std::atomic<int>*>(buffer_table[0]);
+  for (int64_t i = partition[0]; i < partition[1]; ++i) {
+    counts[i].fetch_add(1);
+  }
+  auto* partition_params = static_cast<const void**>(buffer_table[1]);
+  partition_params[partition[0] / (partition[1] - partition[0])] = params;
+  if (partition[0] == kFailAt) {
+    XlaCustomCallStatusSetFailure(static_cast<XlaCustomCallStatus*>(status),
+                                  "Failed", 6);
+  }
+}
+
+// Runs CountingPartitionFunction on 'num_partitions' partitions. The params
+// passed to each partition are stored in 'partition_params' if not null.
+void RunParallelForkJoin(
+    int num_threads, int32_t num_partitions, int64_t partition_size,
+    std::vector<std::atomic<int>>* counts, XlaCustomCallStatus* status,
+    const void** params = nullptr,
+    std::vector<const void**>* partition_params = nullptr) {
+  tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(), "XLAEigen",
+                                      num_threads);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+
+  std::vector<int64_t> partitions;
+  for (int32_t i = 0; i < num_partitions; ++i) {
+    partitions.push_back(i * partition_size);
+    partitions.push_back((i + 1) * partition_size);
+  }
+  std::vector<const void**> unused_params;
+  if (partition_params == nullptr) partition_params = &unused_params;
+  partition_params->assign(num_partitions, nullptr);
+  void* buffer_table[] = {counts->data(), partition_params->data()};
+  __xla_cpu_runtime_ParallelForkJoin(
+      /*result_ptr=*/nullptr, &run_options, params, buffer_table, status,
+      /*prof_counters=*/nullptr, num_partitions, partitions.data(),
+      /*num_partitioned_dims=*/1,
+      reinterpret_cast<void*>(&CountingPartitionFunction));
+}
+
+TEST_F(CpuRuntimeTest, ParallelForkJoinRunsEveryPartitionOnce) {
+  // More partitions than threads: partitions are claimed dynamically.
+  constexpr int32_t kNumPartitions = 64;
+  constexpr int64_t kPartitionSize = 3;
+  std::vector<std::atomic<int>> counts(kNumPartitions * kPartitionSize);
+  XlaCustomCallStatus status;
+  RunParallelForkJoin(/*num_threads=*/4, kNumPartitions, kPartitionSize,
+                      &counts, &status);
+  ASSERT_TRUE(__xla_cpu_runtime_StatusIsSuccess(&status));
+  for (const std::atomic<int>& count : counts) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+TEST_F(CpuRuntimeTest, ParallelForkJoinPassesParamsToFirstPartition) {
+  constexpr int32_t kNumPartitions = 8;
+  std::vector<std::atomic<int>> counts(kNumPartitions);
+  XlaCustomCallStatus status;
+  const void* param = &counts;
+  std::vector<const void**> partition_params;
+  RunParallelForkJoin(/*num_threads=*/4, kNumPartitions,
+                      /*partition_size=*/1, &counts, &status, &param,
+                      &partition_params);
+  ASSERT_TRUE(__xla_cpu_runtime_StatusIsSuccess(&status));
+  EXPECT_EQ(partition_params[0], &param);
+  for (int32_t i = 1; i < kNumPartitions; ++i) {
+    EXPECT_EQ(partition_params[i], nullptr);
+  }
+}
+
+TEST_F(CpuRuntimeTest, ParallelForkJoinReportsPartitionErrors) {
+  constexpr int32_t kNumPartitions = 16;
+  std::vector<std::atomic<int>> counts(kNumPartitions * 2);
+  XlaCustomCallStatus status;
+  RunParallelForkJoin(/*num_threads=*/2, kNumPartitions,
+                      /*partition_size=*/2, &counts, &status);
+  ASSERT_FALSE(__xla_cpu_runtime_StatusIsSuccess(&status));
+  EXPECT_THAT(std::string(*CustomCallStatusGetMessage(&status)),
+              ::testing::HasSubstr("Partition 12 error: Failed"));
+  for (const std::atomic<int>& count : counts) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
 }  // namespace
 }  // namespace xla
@@ -35,6 +35,7 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/CodeGen/TargetRegisterInfo.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/BasicBlock.h"
@@ -81,6 +82,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/math/math_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -258,24 +260,61 @@ Status IrEmitter::HandleBitcast(HloInstruction* bitcast) {
   return OkStatus();
 }
 
-llvm::Constant* IrEmitter::EmitGlobalForLiteral(const Literal& literal) {
+// Returns a symbol name for a constant that only depends on its contents.
+static std::string SharedConstantName(const Literal& literal) {
+  tensorflow::Fprint128 fingerprint =
+      tensorflow::Fingerprint128(absl::string_view(
+          static_cast<const char*>(literal.untyped_data()),
+          literal.size_bytes()));
+  uint64_t shape_fingerprint = tensorflow::Fingerprint64(
+      literal.shape().ToString(/*print_layout=*/true));
+  return absl::StrFormat(
+      "__xla_constant_%016x%016x", fingerprint.high64,
+      tensorflow::FingerprintCat64(fingerprint.low64, shape_fingerprint));
+}
+
+llvm::Constant* IrEmitter::EmitGlobalForLiteral(
+    const Literal& literal, bool share_across_object_files) {
   llvm::Constant* initializer =
       llvm_ir::ConvertLiteralToIrConstant(literal, module_);
-  llvm::GlobalVariable* result_global = new llvm::GlobalVariable(
-      /*Module=*/*module_,
-      /*Type=*/initializer->getType(),
-      /*isConstant=*/true,
-      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
-      /*Initializer=*/initializer,
-      /*Name=*/"");
+  llvm::GlobalVariable* result_global;
+  if (share_across_object_files) {
+    // Identical constants get the same name in every object file, and
+    // linkonce_odr lets the linker merge them.
+    std::string name = SharedConstantName(literal);
+    result_global = module_->getGlobalVariable(name, /*AllowInternal=*/true);
+    if (result_global != nullptr) {
+      return llvm::ConstantExpr::getBitCast(
+          result_global, IrShapeType(literal.shape())->getPointerTo());
+    }
+    result_global = new llvm::GlobalVariable(
+        /*Module=*/*module_,
+        /*Type=*/initializer->getType(),
+        /*isConstant=*/true,
+        /*Linkage=*/llvm::GlobalValue::LinkOnceODRLinkage,
+        /*Initializer=*/initializer,
+        /*Name=*/name);
+    result_global->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    if (llvm::Triple(module_->getTargetTriple()).supportsCOMDAT()) {
+      result_global->setComdat(module_->getOrInsertComdat(name));
+    }
+  } else {
+    result_global = new llvm::GlobalVariable(
+        /*Module=*/*module_,
+        /*Type=*/initializer->getType(),
+        /*isConstant=*/true,
+        /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+        /*Initializer=*/initializer,
+        /*Name=*/"");
+    result_global->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
+  }
   result_global->setAlignment(
       llvm::Align(MinimumAlignmentForShape(literal.shape())));
-  result_global->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
   return llvm::ConstantExpr::getBitCast(
       result_global, IrShapeType(literal.shape())->getPointerTo());
 }
 
-Status IrEmitter::EmitConstantGlobals() {
+Status IrEmitter::EmitConstantGlobals(bool share_across_object_files) {
   for (const BufferAllocation& allocation : assignment_.Allocations()) {
     if (!allocation.is_constant()) {
       continue;
@@ -287,7 +326,8 @@ Status IrEmitter::EmitConstantGlobals() {
     if (it != emitted_literals_.end()) {
       global_for_const = it->second;
     } else {
-      global_for_const = EmitGlobalForLiteral(literal);
+      global_for_const =
+          EmitGlobalForLiteral(literal, share_across_object_files);
       InsertOrDie(&emitted_literals_, &literal, global_for_const);
     }
 
@@ -672,13 +712,29 @@ Status IrEmitter::HandleReduceWindow(HloInstruction* reduce_window) {
   //         value = function(value, input(I));
   //     output(O) = value;
   //
-  // This is completely un-optimized and just here to have something
-  // that works.
+  // EmitVectorizedReduceWindow handles the common case of windows that are
+  // neither strided nor padded along the minor dimension, e.g. pooling over
+  // the spatial dimensions of an NHWC tensor.
   bool saved_allow_reassociation = allow_reassociation_;
   allow_reassociation_ = true;
-  Status status = DefaultAction(reduce_window);
-  allow_reassociation_ = saved_allow_reassociation;
-  return status;
+  auto cleanup = absl::MakeCleanup([saved_allow_reassociation, this]() {
+    allow_reassociation_ = saved_allow_reassociation;
+  });
+  if (!options::VectorizedReduceDisabled(hlo_module_config_)) {
+    std::string vectorization_failure_reason;
+    TF_ASSIGN_OR_RETURN(bool vectorization_successful,
+                        EmitVectorizedReduceWindow(
+                            reduce_window, &vectorization_failure_reason));
+    if (vectorization_successful) {
+      VLOG(1) << "Successfully vectorized reduce-window "
+              << reduce_window->ToString();
+      return OkStatus();
+    }
+    VLOG(1) << "Could not vectorize reduce-window " << reduce_window->ToString()
+            << ": " << vectorization_failure_reason;
+  }
+
+  return DefaultAction(reduce_window);
 }
 
 Status IrEmitter::HandleSelectAndScatter(HloInstruction* select_and_scatter) {
@@ -1619,29 +1675,10 @@ IrEmitter::EmitInnerLoopForVectorizedReduction(
     const ShardedVectorType& accumulator_type, HloInstruction* init_value,
     HloInstruction* arg, absl::Span<const int64_t> dimensions,
     llvm::Align element_alignment) {
-  ShardedVector accumulator;
-  accumulator.reserve(accumulator_type.size());
-  for (auto accumulator_shard_type : accumulator_type) {
-    accumulator.push_back(llvm_ir::EmitAllocaAtFunctionEntry(
-        accumulator_shard_type, "accumulator", &b_, 0));
-  }
-
   llvm::Value* init_value_ssa =
       Load(IrShapeType(init_value->shape()), GetEmittedValueFor(init_value));
-
-  for (llvm::Value* accumulator_shard : accumulator) {
-    llvm::Value* initial_value;
-    auto shard_type =
-        llvm::cast<llvm::AllocaInst>(accumulator_shard)->getAllocatedType();
-    if (auto vector_type = llvm::dyn_cast<llvm::VectorType>(shard_type)) {
-      initial_value =
-          VectorSplat(vector_type->getElementCount(), init_value_ssa);
-    } else {
-      initial_value = init_value_ssa;
-    }
-
-    AlignedStore(initial_value, accumulator_shard, element_alignment);
-  }
+  ShardedVector accumulator = EmitShardedAccumulators(
+      accumulator_type, init_value_ssa, element_alignment);
 
   llvm_ir::ForLoopNest reduction_loop_nest(IrName(arg, "vectorized_inner"),
                                            &b_);
@@ -1663,34 +1700,68 @@ IrEmitter::EmitInnerLoopForVectorizedReduction(
   llvm_ir::IrArray::Index input_index(input_multi_index, arg->shape(),
                                       b_.getInt64Ty());
 
-  llvm::Value* input_address = BitCast(
-      arg_array.EmitArrayElementAddress(input_index, &b_), b_.getInt8PtrTy());
+  EmitShardedAccumulate(reduction_generator, accumulator,
+                        arg_array.EmitArrayElementAddress(input_index, &b_),
+                        element_alignment, arg_array);
+
+  SetToFirstInsertPoint(reduction_loop_nest.GetOuterLoopExitBasicBlock(), &b_);
+
+  return LoadShardedAccumulators(accumulator, element_alignment);
+}
+
+IrEmitter::ShardedVector IrEmitter::EmitShardedAccumulators(
+    const ShardedVectorType& accumulator_type, llvm::Value* init_value,
+    llvm::Align element_alignment) {
+  ShardedVector accumulators;
+  accumulators.reserve(accumulator_type.size());
+  for (llvm::Type* shard_type : accumulator_type) {
+    llvm::Value* accumulator_shard = llvm_ir::EmitAllocaAtFunctionEntry(
+        shard_type, "accumulator", &b_, 0);
+    llvm::Value* initial_value;
+    if (auto vector_type = llvm::dyn_cast<llvm::VectorType>(shard_type)) {
+      initial_value = VectorSplat(vector_type->getElementCount(), init_value);
+    } else {
+      initial_value = init_value;
+    }
+
+    AlignedStore(initial_value, accumulator_shard, element_alignment);
+    accumulators.push_back(accumulator_shard);
+  }
+  return accumulators;
+}
+
+void IrEmitter::EmitShardedAccumulate(
+    const ReductionGenerator& reduction_generator,
+    const ShardedVector& accumulators, llvm::Value* input_address,
+    llvm::Align element_alignment, const llvm_ir::IrArray& containing_array) {
+  input_address = BitCast(input_address, b_.getInt8PtrTy());
 
-  for (int i = 0; i < accumulator.size(); i++) {
+  for (int i = 0; i < accumulators.size(); i++) {
     auto input_address_typed =
-        BitCast(input_address, accumulator[i]->getType());
-    auto alloca = llvm::cast<llvm::AllocaInst>(accumulator[i]);
+        BitCast(input_address, accumulators[i]->getType());
+    auto alloca = llvm::cast<llvm::AllocaInst>(accumulators[i]);
     auto current_accumulator_value = AlignedLoad(
-        alloca->getAllocatedType(), accumulator[i], element_alignment);
+        alloca->getAllocatedType(), accumulators[i], element_alignment);
     auto addend = AlignedLoad(alloca->getAllocatedType(), input_address_typed,
                               element_alignment);
-    arg_array.AnnotateLoadStoreInstructionWithMetadata(addend);
+    containing_array.AnnotateLoadStoreInstructionWithMetadata(addend);
 
     auto reduced_result =
         reduction_generator(&b_, current_accumulator_value, addend);
-    AlignedStore(reduced_result, accumulator[i], element_alignment);
+    AlignedStore(reduced_result, accumulators[i], element_alignment);
 
-    if (i != (accumulator.size() - 1)) {
+    if (i != (accumulators.size() - 1)) {
       input_address = ConstInBoundsGEP1_32(reduced_result->getType(),
                                            input_address_typed, 1);
     }
   }
+}
 
-  SetToFirstInsertPoint(reduction_loop_nest.GetOuterLoopExitBasicBlock(), &b_);
-
+IrEmitter::ShardedVector IrEmitter::LoadShardedAccumulators(
+    const ShardedVector& accumulators, llvm::Align element_alignment) {
   ShardedVector result_ssa;
-  result_ssa.reserve(accumulator.size());
-  for (auto accumulator_shard : accumulator) {
+  result_ssa.reserve(accumulators.size());
+  for (auto accumulator_shard : accumulators) {
     auto alloca = llvm::cast<llvm::AllocaInst>(accumulator_shard);
     result_ssa.push_back(AlignedLoad(alloca->getAllocatedType(),
                                      accumulator_shard, element_alignment));
@@ -1698,6 +1769,60 @@ IrEmitter::EmitInnerLoopForVectorizedReduction(
   return result_ssa;
 }
 
+llvm::Value* IrEmitter::EmitHorizontalReduction(
+    const ReductionGenerator& reduction_generator, const ShardedVector& value) {
+  llvm::Value* result = nullptr;
+  for (llvm::Value* shard : value) {
+    if (auto vector_type =
+            llvm::dyn_cast<llvm::FixedVectorType>(shard->getType())) {
+      // Shards are power-of-two sized, so we can reduce them by repeatedly
+      // combining their low and high halves.
+      for (int width = vector_type->getNumElements(); width > 1; width /= 2) {
+        llvm::SmallVector<int, 16> low_half, high_half;
+        for (int i = 0; i < width / 2; i++) {
+          low_half.push_back(i);
+          high_half.push_back(i + width / 2);
+        }
+        shard =
+            reduction_generator(&b_, b_.CreateShuffleVector(shard, low_half),
+                                b_.CreateShuffleVector(shard, high_half));
+      }
+      shard = b_.CreateExtractElement(shard, b_.getInt32(0));
+    }
+    result = result ? reduction_generator(&b_, result, shard) : shard;
+  }
+  return result;
+}
+
+std::vector<llvm::Value*> IrEmitter::AddLoopsForOutputDimensions(
+    const HloInstruction& op, int64_t num_excluded_minor_dimensions,
+    llvm_ir::ForLoopNest* loop_nest) {
+  const Shape& shape = op.shape();
+  const int64_t num_dims = shape.dimensions_size();
+  std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds;
+  if (ShouldEmitParallelLoopFor(op)) {
+    dynamic_loop_bounds = compute_function_->GetDynamicLoopBounds();
+  }
+
+  // Add loops from outer-most to inner-most dimensions, like
+  // ParallelLoopEmitter does.
+  std::vector<llvm::Value*> multi_index(num_dims);
+  for (int i = num_dims - 1; i >= num_excluded_minor_dimensions; --i) {
+    const int64_t dimension = LayoutUtil::Minor(shape.layout(), i);
+    const int bounds_index = num_dims - 1 - i;
+    const std::string suffix = absl::StrFormat("dim.%d", dimension);
+    std::unique_ptr<llvm_ir::ForLoop> loop;
+    if (bounds_index < dynamic_loop_bounds.size()) {
+      loop = loop_nest->AddLoop(suffix, dynamic_loop_bounds[bounds_index].first,
+                                dynamic_loop_bounds[bounds_index].second);
+    } else {
+      loop = loop_nest->AddLoop(0, shape.dimensions(dimension), suffix);
+    }
+    multi_index[dimension] = loop->GetIndVarValue();
+  }
+  return multi_index;
+}
+
 void IrEmitter::EmitShardedVectorStore(
     llvm::Value* store_address, const std::vector<llvm::Value*>& value_to_store,
     llvm::Align alignment, const llvm_ir::IrArray& containing_array) {
@@ -1727,7 +1852,8 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
     return false;
   }
 
-  if (!ReductionPreservesLayout(*reduce)) {
+  if (ShapeUtil::IsZeroElementArray(arg->shape())) {
+    *failure_reason = "reduction of zero-element array";
     return false;
   }
 
@@ -1763,8 +1889,18 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type())));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
+    return EmitVectorizedRowReduce(reduce, arg, init_value, dimensions,
+                                   reduction_generator, vectorization_factor,
+                                   element_alignment);
+  }
+
+  if (!ReductionPreservesLayout(*reduce)) {
+    *failure_reason = "reduction does not preserve the layout";
+    return false;
+  }
+
+  if (PartitionsMinorDimensions(*reduce, /*num_minor_dimensions=*/1)) {
+    *failure_reason = "minor dimension is partitioned into parallel tasks";
     return false;
   }
 
@@ -1792,17 +1928,8 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   //  }
 
   llvm_ir::ForLoopNest loop_nest(IrName(reduce), &b_);
-  std::vector<llvm::Value*> array_multi_index(
-      reduce->shape().dimensions_size());
-  for (int i = LayoutUtil::MinorToMajor(reduce->shape()).size() - 1; i > 0;
-       --i) {
-    int64_t dimension = LayoutUtil::Minor(reduce->shape().layout(), i);
-    int64_t start_index = 0;
-    int64_t end_index = reduce->shape().dimensions(dimension);
-    std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
-        start_index, end_index, absl::StrFormat("dim.%d", dimension));
-    array_multi_index[dimension] = loop->GetIndVarValue();
-  }
+  std::vector<llvm::Value*> array_multi_index = AddLoopsForOutputDimensions(
+      *reduce, /*num_excluded_minor_dimensions=*/1, &loop_nest);
 
   int64_t innermost_dimension = LayoutUtil::Minor(reduce->shape().layout(), 0);
   int64_t innermost_dimension_size =
@@ -1887,6 +2014,350 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   return true;
 }
 
+StatusOr<bool> IrEmitter::EmitVectorizedRowReduce(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    absl::Span<const int64_t> dimensions,
+    const ReductionGenerator& reduction_generator, int vectorization_factor,
+    llvm::Align element_alignment) {
+  const Shape& arg_shape = arg->shape();
+  const PrimitiveType element_type = reduce->shape().element_type();
+  const int64_t minor_dimension = LayoutUtil::Minor(arg_shape.layout(), 0);
+  const int64_t minor_dimension_size = arg_shape.dimensions(minor_dimension);
+
+  // We reduce the minor dimension in chunks of vector_width elements and
+  // peel off the remaining tail_width elements. Both are sharded vectors, so
+  // neither needs to be a power of two.
+  const int64_t vector_width =
+      std::min<int64_t>(vectorization_factor, minor_dimension_size);
+  const int64_t vectorized_end =
+      (minor_dimension_size / vector_width) * vector_width;
+  const int64_t tail_width = minor_dimension_size % vector_width;
+
+  std::vector<int64_t> outer_reduced_dimensions;
+  for (int64_t dimension : dimensions) {
+    if (dimension != minor_dimension) {
+      outer_reduced_dimensions.push_back(dimension);
+    }
+  }
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(reduce));
+
+  // We're reducing over the minor dimension R0 (and maybe other dimensions
+  // R1).  We lower the reduction loop as:
+  //
+  //  for (o in output) {
+  //    vector_acc = init
+  //    tail_acc = init
+  //    for (r1 in R1) {
+  //      for (r0 in [0, vectorized_end) with stride vector_width) {
+  //        vector_acc = elementwise_reduce(vector_acc, input[o, r1, r0])
+  //      }
+  //      tail_acc = elementwise_reduce(tail_acc, input[o, r1, vectorized_end])
+  //    }
+  //    output[o] = reduce(horizontal_reduce(vector_acc),
+  //                       horizontal_reduce(tail_acc))
+  //  }
+  //
+  // This applies the init value more than once, which is fine because it has
+  // to be an identity of the reduction function.
+  llvm_ir::ForLoopNest output_loop_nest(IrName(reduce), &b_);
+  std::vector<llvm::Value*> output_multi_index = AddLoopsForOutputDimensions(
+      *reduce, /*num_excluded_minor_dimensions=*/0, &output_loop_nest);
+  if (llvm::BasicBlock* output_body_bb =
+          output_loop_nest.GetInnerLoopBodyBasicBlock()) {
+    SetToFirstInsertPoint(output_body_bb, &b_);
+  }
+
+  llvm::Value* init_value_ssa =
+      Load(IrShapeType(init_value->shape()), GetEmittedValueFor(init_value));
+  ShardedVector vector_accumulator = EmitShardedAccumulators(
+      CreateShardedVectorType(element_type, vector_width), init_value_ssa,
+      element_alignment);
+  ShardedVector tail_accumulator;
+  if (tail_width > 0) {
+    tail_accumulator = EmitShardedAccumulators(
+        CreateShardedVectorType(element_type, tail_width), init_value_ssa,
+        element_alignment);
+  }
+
+  llvm_ir::ForLoopNest reduction_loop_nest(IrName(arg, "vectorized_row"),
+                                           &b_);
+  std::vector<llvm::Value*> input_multi_index =
+      reduction_loop_nest.AddLoopsForShapeOnDimensions(
+          arg_shape, outer_reduced_dimensions, "reduction_dim");
+  if (llvm::BasicBlock* reduction_body_bb =
+          reduction_loop_nest.GetInnerLoopBodyBasicBlock()) {
+    SetToFirstInsertPoint(reduction_body_bb, &b_);
+  }
+
+  // The output dimensions are the dimensions of arg that are not reduced.
+  auto output_it = output_multi_index.begin();
+  for (int64_t dimension = 0; dimension < arg_shape.rank(); ++dimension) {
+    if (!absl::c_linear_search(dimensions, dimension)) {
+      input_multi_index[dimension] = *output_it++;
+    }
+  }
+  CHECK(output_it == output_multi_index.end());
+
+  llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+  llvm_ir::ForLoopNest minor_loop_nest(IrName(arg, "vectorized_minor"), &b_);
+  std::unique_ptr<llvm_ir::ForLoop> minor_loop =
+      minor_loop_nest.AddLoop(0, vectorized_end, vector_width,
+                              absl::StrFormat("dim.%d", minor_dimension));
+  SetToFirstInsertPoint(minor_loop->GetBodyBasicBlock(), &b_);
+  input_multi_index[minor_dimension] = minor_loop->GetIndVarValue();
+  EmitShardedAccumulate(
+      reduction_generator, vector_accumulator,
+      arg_array.EmitArrayElementAddress(
+          llvm_ir::IrArray::Index(input_multi_index, arg_shape,
+                                  b_.getInt64Ty()),
+          &b_),
+      element_alignment, arg_array);
+  SetToFirstInsertPoint(minor_loop->GetExitBasicBlock(), &b_);
+
+  if (tail_width > 0) {
+    input_multi_index[minor_dimension] = b_.getInt64(vectorized_end);
+    EmitShardedAccumulate(
+        reduction_generator, tail_accumulator,
+        arg_array.EmitArrayElementAddress(
+            llvm_ir::IrArray::Index(input_multi_index, arg_shape,
+                                    b_.getInt64Ty()),
+            &b_),
+        element_alignment, arg_array);
+  }
+
+  if (llvm::BasicBlock* reduction_exit_bb =
+          reduction_loop_nest.GetOuterLoopExitBasicBlock()) {
+    SetToFirstInsertPoint(reduction_exit_bb, &b_);
+  }
+
+  llvm::Value* result = EmitHorizontalReduction(
+      reduction_generator,
+      LoadShardedAccumulators(vector_accumulator, element_alignment));
+  if (tail_width > 0) {
+    result = reduction_generator(
+        &b_, result,
+        EmitHorizontalReduction(
+            reduction_generator,
+            LoadShardedAccumulators(tail_accumulator, element_alignment)));
+  }
+
+  llvm_ir::IrArray target_array = GetIrArrayFor(reduce);
+  target_array.EmitWriteArrayElement(
+      llvm_ir::IrArray::Index(output_multi_index, reduce->shape(),
+                              b_.getInt64Ty()),
+      result, &b_);
+
+  if (llvm::BasicBlock* output_exit_bb =
+          output_loop_nest.GetOuterLoopExitBasicBlock()) {
+    SetToFirstInsertPoint(output_exit_bb, &b_);
+  }
+
+  return true;
+}
+
+StatusOr<bool> IrEmitter::EmitVectorizedReduceWindow(
+    HloInstruction* reduce_window, std::string* failure_reason) {
+  const Shape& shape = reduce_window->shape();
+  if (!shape.IsArray()) {
+    *failure_reason = "vectorization of variadic reduce-window not implemented";
+    return false;
+  }
+
+  HloInstruction* operand = reduce_window->mutable_operand(0);
+  HloInstruction* init_value = reduce_window->mutable_operand(1);
+  const Window& window = reduce_window->window();
+  if (shape.rank() == 0 || ShapeUtil::IsZeroElementArray(shape)) {
+    *failure_reason = "scalar or zero-element output";
+    return false;
+  }
+
+  if (!LayoutUtil::Equal(operand->shape().layout(), shape.layout())) {
+    *failure_reason = "operand and output layouts differ";
+    return false;
+  }
+
+  if (window_util::HasDilation(window)) {
+    *failure_reason = "dilated windows not implemented";
+    return false;
+  }
+
+  // Consecutive output elements along the minor dimension read consecutive
+  // input elements only if the window is neither strided nor padded there.
+  const int64_t minor_dimension = LayoutUtil::Minor(shape.layout(), 0);
+  const WindowDimension& minor_window_dimension =
+      window.dimensions(minor_dimension);
+  if (minor_window_dimension.stride() != 1 ||
+      minor_window_dimension.padding_low() != 0 ||
+      minor_window_dimension.padding_high() != 0) {
+    *failure_reason = "window is strided or padded along the minor dimension";
+    return false;
+  }
+
+  if (PartitionsMinorDimensions(*reduce_window, /*num_minor_dimensions=*/1)) {
+    *failure_reason = "minor dimension is partitioned into parallel tasks";
+    return false;
+  }
+
+  ReductionGenerator reduction_generator =
+      MatchReductionGenerator(reduce_window->to_apply(), failure_reason);
+  if (!reduction_generator) {
+    return false;
+  }
+
+  const PrimitiveType element_type = shape.element_type();
+  if (target_machine_features_.vector_register_byte_size(
+          *compute_function_->function()) <
+      ShapeUtil::ByteSizeOfPrimitiveType(element_type)) {
+    *failure_reason = "no vector registers for the element type";
+    return false;
+  }
+
+  const int vectorization_factor =
+      target_machine_features_.vectorization_factor_in_bytes() /
+      ShapeUtil::ByteSizeOfPrimitiveType(element_type);
+  llvm::Align element_alignment(tensorflow::MathUtil::GCD<unsigned>(
+      ShapeUtil::ByteSizeOfPrimitiveType(element_type),
+      MinimumAlignmentForPrimitiveType(element_type)));
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(reduce_window));
+
+  //  for (o1 in output dimensions but the minor one D0) {
+  //    for (o0 in D0 with stride VS) {
+  //      vector_acc = init
+  //      for (w in window) {
+  //        if (input[o1 * stride + w - pad_low, o0 + w0] is in bounds) {
+  //          vector_acc = elementwise_reduce(vector_acc, input[...])
+  //        }
+  //      }
+  //      output[o1, o0] = vector_acc
+  //    }
+  //  }
+  llvm_ir::ForLoopNest loop_nest(IrName(reduce_window), &b_);
+  std::vector<llvm::Value*> output_multi_index = AddLoopsForOutputDimensions(
+      *reduce_window, /*num_excluded_minor_dimensions=*/1, &loop_nest);
+  if (llvm::BasicBlock* innermost_body_bb =
+          loop_nest.GetInnerLoopBodyBasicBlock()) {
+    SetToFirstInsertPoint(innermost_body_bb, &b_);
+  }
+
+  llvm_ir::IrArray target_array = GetIrArrayFor(reduce_window);
+  auto emit_vectorized_elements = [&](llvm::Value* minor_index,
+                                      int64_t element_count) -> Status {
+    output_multi_index[minor_dimension] = minor_index;
+    llvm_ir::IrArray::Index output_index(output_multi_index, shape,
+                                         b_.getInt64Ty());
+    TF_ASSIGN_OR_RETURN(
+        ShardedVector result,
+        EmitInnerLoopForVectorizedReduceWindow(
+            reduction_generator, output_index,
+            CreateShardedVectorType(element_type, element_count), init_value,
+            operand, window, element_alignment));
+    EmitShardedVectorStore(
+        target_array.EmitArrayElementAddress(output_index, &b_), result,
+        element_alignment, target_array);
+    return OkStatus();
+  };
+
+  const int64_t minor_dimension_size = shape.dimensions(minor_dimension);
+  const int64_t vectorized_end =
+      (minor_dimension_size / vectorization_factor) * vectorization_factor;
+  if (vectorized_end > 0) {
+    llvm_ir::ForLoopNest minor_loop_nest(IrName(reduce_window, "vectorized"),
+                                         &b_);
+    std::unique_ptr<llvm_ir::ForLoop> loop =
+        minor_loop_nest.AddLoop(0, vectorized_end, vectorization_factor,
+                                absl::StrFormat("dim.%d", minor_dimension));
+    SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &b_);
+    TF_RETURN_IF_ERROR(
+        emit_vectorized_elements(loop->GetIndVarValue(), vectorization_factor));
+    SetToFirstInsertPoint(loop->GetExitBasicBlock(), &b_);
+  }
+
+  // Peel out an "epilogue" for the remaining elements, as in
+  // EmitVectorizedReduce.
+  if (minor_dimension_size % vectorization_factor) {
+    TF_RETURN_IF_ERROR(
+        emit_vectorized_elements(b_.getInt64(vectorized_end),
+                                 minor_dimension_size % vectorization_factor));
+  }
+
+  if (llvm::BasicBlock* outermost_loop_exit_block =
+          loop_nest.GetOuterLoopExitBasicBlock()) {
+    SetToFirstInsertPoint(outermost_loop_exit_block, &b_);
+  }
+
+  return true;
+}
+
+StatusOr<IrEmitter::ShardedVector>
+IrEmitter::EmitInnerLoopForVectorizedReduceWindow(
+    const ReductionGenerator& reduction_generator,
+    const llvm_ir::IrArray::Index& output_index,
+    const ShardedVectorType& accumulator_type, HloInstruction* init_value,
+    HloInstruction* operand, const Window& window,
+    llvm::Align element_alignment) {
+  llvm::Value* init_value_ssa =
+      Load(IrShapeType(init_value->shape()), GetEmittedValueFor(init_value));
+  ShardedVector accumulator = EmitShardedAccumulators(
+      accumulator_type, init_value_ssa, element_alignment);
+
+  // Walk the window in the layout order of the operand.
+  const Shape& operand_shape = operand->shape();
+  const int64_t rank = operand_shape.rank();
+  llvm_ir::ForLoopNest window_loop_nest(IrName(operand, "vectorized_window"),
+                                        &b_);
+  std::vector<llvm::Value*> window_multi_index(rank);
+  for (int i = rank - 1; i >= 0; --i) {
+    const int64_t dimension = LayoutUtil::Minor(operand_shape.layout(), i);
+    window_multi_index[dimension] =
+        window_loop_nest
+            .AddLoop(0, window.dimensions(dimension).size(),
+                     absl::StrFormat("window.%d", dimension))
+            ->GetIndVarValue();
+  }
+  SetToFirstInsertPoint(window_loop_nest.GetInnerLoopBodyBasicBlock(), &b_);
+
+  // Without dilation only padded dimensions can be out of bounds.  The minor
+  // dimension is never padded, so all elements of the vector are either in or
+  // out of bounds together.
+  std::vector<llvm::Value*> input_multi_index(rank);
+  llvm::Value* in_bounds = b_.getInt1(true);
+  for (int64_t i = 0; i < rank; ++i) {
+    const WindowDimension& window_dimension = window.dimensions(i);
+    llvm::Value* input_index =
+        NSWAdd(NSWMul(output_index[i], b_.getInt64(window_dimension.stride())),
+               window_multi_index[i]);
+    if (window_dimension.padding_low() != 0) {
+      input_index =
+          NSWSub(input_index, b_.getInt64(window_dimension.padding_low()));
+    }
+    if (window_dimension.padding_low() != 0 ||
+        window_dimension.padding_high() != 0) {
+      // We must check whether 0 <= input_index < bound. The check against the
+      // upper bound as an unsigned comparison also catches negative values.
+      in_bounds = And(in_bounds,
+                      ICmpULT(input_index,
+                              b_.getInt64(operand_shape.dimensions(i))));
+    }
+    input_multi_index[i] = input_index;
+  }
+
+  llvm_ir::LlvmIfData if_in_bounds =
+      llvm_ir::EmitIfThenElse(in_bounds, "in_bounds", &b_, /*emit_else=*/false);
+  SetToFirstInsertPoint(if_in_bounds.true_block, &b_);
+  llvm_ir::IrArray operand_array(GetIrArrayFor(operand));
+  llvm_ir::IrArray::Index input_index(input_multi_index, operand_shape,
+                                      b_.getInt64Ty());
+  EmitShardedAccumulate(reduction_generator, accumulator,
+                        operand_array.EmitArrayElementAddress(input_index, &b_),
+                        element_alignment, operand_array);
+
+  SetToFirstInsertPoint(window_loop_nest.GetOuterLoopExitBasicBlock(), &b_);
+
+  return LoadShardedAccumulators(accumulator, element_alignment);
+}
+
 Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto arg = reduce->mutable_operand(0);
   auto init_value = reduce->mutable_operand(1);
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_array.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_builder_mixin.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/llvm_loop.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/loop_emitter.h"
 #include "tensorflow/compiler/xla/service/name_uniquer.h"
@@ -128,7 +129,12 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   llvm::IRBuilder<>* builder() { return &b_; }
 
   // Emit an LLVM global variable for every constant buffer allocation.
-  Status EmitConstantGlobals();
+  //
+  // If "share_across_object_files" is set, the globals are named after their
+  // contents and get linkonce_odr linkage, so that the linker keeps a single
+  // copy of identical constants (e.g. the weights of a model) that were
+  // compiled into several object files.
+  Status EmitConstantGlobals(bool share_across_object_files = false);
 
  protected:
   //
@@ -421,6 +427,77 @@ class IrEmitter : public DfsHloVisitorWithDefault,
       HloInstruction* arg, absl::Span<const int64_t> dimensions,
       llvm::Align element_alignment);
 
+  // Emits a vectorized reduction over the most minor dimension of "arg" (and
+  // possibly other dimensions).  Each output element is computed by reducing
+  // vector-sized chunks of the minor dimension into a sharded vector
+  // accumulator, which is reduced horizontally at the end.  Helper function
+  // for EmitVectorizedReduce.
+  StatusOr<bool> EmitVectorizedRowReduce(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      absl::Span<const int64_t> dimensions,
+      const ReductionGenerator& reduction_generator, int vectorization_factor,
+      llvm::Align element_alignment);
+
+  // Tries to codegen a reduce-window operation using vectorized instructions,
+  // computing several consecutive elements of the most minor output dimension
+  // at once.  Returns true if successful, and false on failure.  On failure,
+  // sets "failure_reason" to a string describing why it could not vectorize
+  // the reduce-window.
+  StatusOr<bool> EmitVectorizedReduceWindow(HloInstruction* reduce_window,
+                                            std::string* failure_reason);
+
+  // Emits the loop nest over the window of a reduce-window for the output
+  // elements starting at "output_index".  Helper function for
+  // EmitVectorizedReduceWindow.
+  StatusOr<ShardedVector> EmitInnerLoopForVectorizedReduceWindow(
+      const ReductionGenerator& reduction_generator,
+      const llvm_ir::IrArray::Index& output_index,
+      const ShardedVectorType& accumulator_type, HloInstruction* init_value,
+      HloInstruction* operand, const Window& window,
+      llvm::Align element_alignment);
+
+  // Emits stack slots of type "accumulator_type" for a sharded vector
+  // accumulator, initialized to splats of "init_value".
+  ShardedVector EmitShardedAccumulators(
+      const ShardedVectorType& accumulator_type, llvm::Value* init_value,
+      llvm::Align element_alignment);
+
+  // Loads a sharded vector of the accumulator's type from "input_address" and
+  // reduces it into "accumulators" with "reduction_generator".
+  void EmitShardedAccumulate(const ReductionGenerator& reduction_generator,
+                             const ShardedVector& accumulators,
+                             llvm::Value* input_address,
+                             llvm::Align element_alignment,
+                             const llvm_ir::IrArray& containing_array);
+
+  // Loads the current value of the sharded vector accumulator.
+  ShardedVector LoadShardedAccumulators(const ShardedVector& accumulators,
+                                        llvm::Align element_alignment);
+
+  // Reduces all elements of "value" to a scalar with "reduction_generator".
+  llvm::Value* EmitHorizontalReduction(
+      const ReductionGenerator& reduction_generator,
+      const ShardedVector& value);
+
+  // Adds loops over all dimensions of the shape of "op" but the
+  // "num_excluded_minor_dimensions" most minor ones to "loop_nest", from major
+  // to minor.  If "op" is partitioned into parallel tasks, the partitioned
+  // dimensions use the dynamic loop bounds of the computation; see
+  // PartitionsMinorDimensions.  Returns the induction variables indexed by
+  // dimension, with nullptr for the excluded dimensions.
+  std::vector<llvm::Value*> AddLoopsForOutputDimensions(
+      const HloInstruction& op, int64_t num_excluded_minor_dimensions,
+      llvm_ir::ForLoopNest* loop_nest);
+
+  // Returns whether "op" is partitioned into parallel tasks along any of the
+  // "num_minor_dimensions" most minor dimensions of its shape.
+  bool PartitionsMinorDimensions(const HloInstruction& op,
+                                 int64_t num_minor_dimensions) const {
+    return ShouldEmitParallelLoopFor(op) &&
+           num_dynamic_loop_bounds_ >
+               op.shape().dimensions_size() - num_minor_dimensions;
+  }
+
   // Tries to emit a fast concatenate operation using memcpy.  Returns true if
   // successful, and false on failure.  On failure, sets "failure_reason" to a
   // string describing why it could not emit a fast concatenate.
@@ -642,7 +719,8 @@ class IrEmitter : public DfsHloVisitorWithDefault,
                            llvm::Value* program_buffer_address);
 
   // Returns a ConstExpr bitcast.
-  llvm::Constant* EmitGlobalForLiteral(const Literal& literal);
+  llvm::Constant* EmitGlobalForLiteral(const Literal& literal,
+                                       bool share_across_object_files);
 
   const HloModuleConfig& hlo_module_config_;
 
@@ -0,0 +1,157 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/measured_hlo_profile.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using HloInstructionInfo = HloProfilePrinterData::HloInstructionInfo;
+
+// Returns the instruction name of `info`. Profiles written before
+// HloInstructionInfo had a name field only have it in `long_name`, which
+// starts with "%<name> = ".
+std::string InstructionName(const HloInstructionInfo& info) {
+  if (!info.name().empty()) {
+    return info.name();
+  }
+  absl::string_view name = info.long_name();
+  absl::ConsumePrefix(&name, "%");
+  return std::string(name.substr(0, name.find(' ')));
+}
+
+}  // namespace
+
+/*static*/ StatusOr<std::unique_ptr<MeasuredHloProfile>>
+MeasuredHloProfile::Load(const std::string& path, double slow_fusion_factor) {
+  HloExecutionProfileData profile_data;
+  TF_RETURN_IF_ERROR(tensorflow::ReadBinaryProto(tensorflow::Env::Default(),
+                                                 path, &profile_data));
+  return Create(profile_data, slow_fusion_factor);
+}
+
+/*static*/ StatusOr<std::unique_ptr<MeasuredHloProfile>>
+MeasuredHloProfile::Create(const HloExecutionProfileData& profile_data,
+                           double slow_fusion_factor) {
+  const HloProfilePrinterData& printer_data = profile_data.printer_data();
+  const auto& counters = profile_data.profile_counters();
+  if (counters.size() < printer_data.profile_counters_size()) {
+    return InvalidArgument(
+        "HLO profile has %d counters, but its printer data describes %d",
+        counters.size(), printer_data.profile_counters_size());
+  }
+
+  auto profile = absl::WrapUnique(new MeasuredHloProfile());
+  // Measured cycles per estimated optimal second of every instruction that
+  // has both, used to find instructions that run far below the efficiency
+  // the cost model expects from them.
+  std::vector<std::pair<const HloInstructionInfo*, double>> efficiencies;
+  for (const auto& computation_info : printer_data.computation_infos()) {
+    for (const HloInstructionInfo& info :
+         computation_info.instruction_infos()) {
+      if (info.profile_index() < 0 || info.profile_index() >= counters.size()) {
+        return InvalidArgument("Invalid profile index %d for instruction %s",
+                               info.profile_index(), info.long_name());
+      }
+      const int64_t cycles = counters[info.profile_index()];
+      if (cycles <= 0) {
+        continue;
+      }
+      std::string name = InstructionName(info);
+      // ParallelTaskAssigner outlines instructions into "parallel_<name>"
+      // computations as clones; attribute their cycles to the original name.
+      constexpr absl::string_view kCloneSuffix = ".clone";
+      if (absl::StartsWith(computation_info.name(), "parallel_") &&
+          absl::EndsWith(name, kCloneSuffix)) {
+        name.resize(name.size() - kCloneSuffix.size());
+      }
+      profile->cycles_[name] += cycles;
+      if (info.optimal_seconds() > 0) {
+        efficiencies.emplace_back(&info, cycles / info.optimal_seconds());
+      }
+    }
+  }
+  if (efficiencies.empty()) {
+    return profile;
+  }
+
+  std::vector<double> sorted;
+  sorted.reserve(efficiencies.size());
+  for (const auto& [info, efficiency] : efficiencies) {
+    sorted.push_back(efficiency);
+  }
+  std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2,
+                   sorted.end());
+  const double median = sorted[sorted.size() / 2];
+
+  for (const auto& [info, efficiency] : efficiencies) {
+    if (info->fused_instruction_names().empty() ||
+        efficiency <= slow_fusion_factor * median) {
+      continue;
+    }
+    VLOG(1) << "Fusion " << InstructionName(*info) << " is "
+            << efficiency / median << "x slower than the median instruction.";
+    for (const std::string& name : info->fused_instruction_names()) {
+      profile->slow_fusion_of_[name] = profile->slow_fusion_count_;
+    }
+    ++profile->slow_fusion_count_;
+  }
+  return profile;
+}
+
+std::optional<int64_t> MeasuredHloProfile::CyclesFor(
+    absl::string_view name) const {
+  auto it = cycles_.find(name);
+  if (it == cycles_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+bool MeasuredHloProfile::IsSlowFusion(const HloInstruction& producer,
+                                      const HloInstruction& consumer) const {
+  auto producer_fusion = slow_fusion_of_.find(producer.name());
+  if (producer_fusion == slow_fusion_of_.end()) {
+    return false;
+  }
+  auto in_same_fusion = [&](const HloInstruction& instruction) {
+    auto it = slow_fusion_of_.find(instruction.name());
+    return it != slow_fusion_of_.end() && it->second == producer_fusion->second;
+  };
+  if (consumer.opcode() != HloOpcode::kFusion) {
+    return in_same_fusion(consumer);
+  }
+  return absl::c_any_of(consumer.fused_instructions(),
+                        [&](const HloInstruction* fused) {
+                          return fused->opcode() != HloOpcode::kParameter &&
+                                 in_same_fusion(*fused);
+                        });
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,84 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MEASURED_HLO_PROFILE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MEASURED_HLO_PROFILE_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_execution_profile_data.pb.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// Per-instruction costs measured by a previous profiled execution of the same
+// HLO module, used to replace static heuristics in the CPU pipeline
+// (profile-guided optimization).
+//
+// Profiles are HloExecutionProfileData protos, which XLA dumps as
+// *.hlo_execution_profile_data files when run with --xla_hlo_profile and
+// --xla_dump_to. Instructions are matched by name (fused instructions by the
+// pre-fusion name CpuInstructionFusion records in their metadata), so the
+// profile has to come from the same HLO module compiled by the same version of
+// XLA.
+class MeasuredHloProfile {
+ public:
+  // A fusion is considered slow if its measured cycles per estimated optimal
+  // second exceed this factor times the median over all profiled
+  // instructions.
+  static constexpr double kDefaultSlowFusionFactor = 2.0;
+
+  // Reads a binary HloExecutionProfileData from `path`.
+  static StatusOr<std::unique_ptr<MeasuredHloProfile>> Load(
+      const std::string& path,
+      double slow_fusion_factor = kDefaultSlowFusionFactor);
+
+  static StatusOr<std::unique_ptr<MeasuredHloProfile>> Create(
+      const HloExecutionProfileData& profile_data,
+      double slow_fusion_factor = kDefaultSlowFusionFactor);
+
+  // Returns the measured cycles of the instruction called `name`, if it was
+  // profiled.
+  std::optional<int64_t> CyclesFor(absl::string_view name) const;
+
+  // Returns true if `producer` and `consumer` (or an instruction already fused
+  // into `consumer`) were fused together in the profiled execution and that
+  // fusion was measured to be slow. Fusing them again is likely a regression.
+  bool IsSlowFusion(const HloInstruction& producer,
+                    const HloInstruction& consumer) const;
+
+  int64_t slow_fusion_count() const { return slow_fusion_count_; }
+
+ private:
+  MeasuredHloProfile() = default;
+
+  // Instruction name -> measured cycles.
+  absl::flat_hash_map<std::string, int64_t> cycles_;
+  // Name of an instruction that was part of a slow fusion -> index of that
+  // fusion.
+  absl::flat_hash_map<std::string, int64_t> slow_fusion_of_;
+  int64_t slow_fusion_count_ = 0;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MEASURED_HLO_PROFILE_H_
@@ -0,0 +1,240 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/measured_hlo_profile.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features_fake.h"
+#include "tensorflow/compiler/xla/service/hlo_execution_profile_data.pb.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+struct ProfiledInstruction {
+  std::string name;
+  float optimal_seconds;
+  int64_t cycles;
+  std::vector<std::string> fused_instruction_names;
+};
+
+HloExecutionProfileData MakeProfile(
+    const std::vector<ProfiledInstruction>& instructions) {
+  HloExecutionProfileData profile;
+  HloProfilePrinterData* printer_data = profile.mutable_printer_data();
+  auto* computation_info = printer_data->add_computation_infos();
+  computation_info->set_name("entry");
+  for (const ProfiledInstruction& instruction : instructions) {
+    auto* info = computation_info->add_instruction_infos();
+    info->set_name(instruction.name);
+    info->set_long_name(absl::StrCat("%", instruction.name, " = f32[] ..."));
+    info->set_optimal_seconds(instruction.optimal_seconds);
+    info->set_profile_index(profile.profile_counters_size());
+    for (const std::string& fused : instruction.fused_instruction_names) {
+      info->add_fused_instruction_names(fused);
+    }
+    profile.add_profile_counters(instruction.cycles);
+  }
+  printer_data->set_profile_counters_size(profile.profile_counters_size());
+  return profile;
+}
+
+class MeasuredHloProfileTest : public HloTestBase {};
+
+TEST_F(MeasuredHloProfileTest, RecordsCycles) {
+  HloExecutionProfileData data = MakeProfile({{"add", 1e-6, 1000, {}}});
+  // Older profiles only name the instruction in long_name.
+  data.mutable_printer_data()
+      ->mutable_computation_infos(0)
+      ->mutable_instruction_infos(0)
+      ->clear_name();
+  TF_ASSERT_OK_AND_ASSIGN(auto profile, MeasuredHloProfile::Create(data));
+  EXPECT_EQ(profile->CyclesFor("add"), 1000);
+  EXPECT_EQ(profile->CyclesFor("multiply"), std::nullopt);
+  EXPECT_EQ(profile->slow_fusion_count(), 0);
+}
+
+TEST_F(MeasuredHloProfileTest, RejectsInvalidProfileIndex) {
+  HloExecutionProfileData data = MakeProfile({{"add", 1e-6, 1000, {}}});
+  data.mutable_printer_data()
+      ->mutable_computation_infos(0)
+      ->mutable_instruction_infos(0)
+      ->set_profile_index(5);
+  EXPECT_FALSE(MeasuredHloProfile::Create(data).ok());
+}
+
+TEST_F(MeasuredHloProfileTest, DoesNotRepeatSlowFusion) {
+  const char* const kModule = R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[1024]{0} parameter(0)
+      p1 = f32[1024]{0} parameter(1)
+      add = f32[1024]{0} add(p0, p1)
+      ROOT multiply = f32[1024]{0} multiply(add, p1)
+    })";
+
+  // Without a profile, add is fused into multiply.
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kModule));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuInstructionFusion().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  // The profile of that fusion shows it running 100x slower per estimated
+  // optimal second than the other instructions.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto profile,
+      MeasuredHloProfile::Create(
+          MakeProfile({{"fusion", 1e-6, 100000, {"add", "multiply"}},
+                       {"negate", 1e-6, 1000, {}},
+                       {"exponential", 1e-6, 1200, {}}})));
+  EXPECT_EQ(profile->slow_fusion_count(), 1);
+  TF_ASSERT_OK_AND_ASSIGN(module, ParseAndReturnVerifiedModule(kModule));
+  CpuInstructionFusion profile_guided_fusion(profile.get());
+  TF_ASSERT_OK_AND_ASSIGN(changed, profile_guided_fusion.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(MeasuredHloProfileTest, DoesNotRepeatSlowFusionOfCompiledModule) {
+  const char* const kModule = R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[1024]{0} parameter(0)
+      p1 = f32[1024]{0} parameter(1)
+      m0 = f32[32,32]{1,0} parameter(2)
+      add = f32[1024]{0} add(p0, p1)
+      multiply = f32[1024]{0} multiply(add, p1)
+      dot0 = f32[32,32]{1,0} dot(m0, m0), lhs_contracting_dims={1},
+        rhs_contracting_dims={0}
+      dot1 = f32[32,32]{1,0} dot(dot0, m0), lhs_contracting_dims={1},
+        rhs_contracting_dims={0}
+      ROOT tuple = (f32[1024]{0}, f32[32,32]{1,0}) tuple(multiply, dot1)
+    })";
+  HloModuleConfig config = GetModuleConfigForTest();
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_hlo_profile(true);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kModule, config));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  ASSERT_TRUE(executable->hlo_profiling_enabled());
+
+  // Profile the compiled module with counters that show the fusion of add and
+  // multiply running 100x slower per estimated optimal second than the rest.
+  HloExecutionProfileData data;
+  *data.mutable_printer_data() = executable->hlo_profile_printer_data();
+  data.mutable_profile_counters()->Resize(
+      data.printer_data().profile_counters_size(), 0);
+  int fusion_count = 0;
+  for (const auto& computation_info : data.printer_data().computation_infos()) {
+    for (const auto& info : computation_info.instruction_infos()) {
+      int64_t cycles = static_cast<int64_t>(info.optimal_seconds() * 1e12) + 1;
+      if (info.fused_instruction_names_size() > 0) {
+        // The fused clones were renamed, but the profile names the
+        // instructions of the unfused module.
+        EXPECT_THAT(info.fused_instruction_names(),
+                    UnorderedElementsAre("add", "multiply"));
+        ++fusion_count;
+        cycles *= 100;
+      }
+      data.set_profile_counters(info.profile_index(), cycles);
+    }
+  }
+  ASSERT_EQ(fusion_count, 1);
+
+  std::string profile_path;
+  ASSERT_TRUE(tensorflow::Env::Default()->LocalTempFilename(&profile_path));
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(
+      tensorflow::Env::Default(), profile_path, data.SerializeAsString()));
+  TF_ASSERT_OK_AND_ASSIGN(auto profile, MeasuredHloProfile::Load(profile_path));
+  EXPECT_EQ(profile->slow_fusion_count(), 1);
+
+  // Compiling the module again with the profile leaves add and multiply
+  // unfused.
+  debug_options.set_xla_hlo_profile(false);
+  debug_options.set_xla_cpu_profile_guided_optimization_profile(profile_path);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(module,
+                          ParseAndReturnVerifiedModule(kModule, config));
+  TF_ASSERT_OK_AND_ASSIGN(auto optimized,
+                          backend().compiler()->RunHloPasses(
+                              std::move(module),
+                              backend().default_stream_executor(),
+                              /*device_allocator=*/nullptr));
+  for (const HloComputation* computation :
+       optimized->MakeNonfusionComputations()) {
+    for (const HloInstruction* instruction : computation->instructions()) {
+      EXPECT_NE(instruction->opcode(), HloOpcode::kFusion)
+          << instruction->ToString();
+    }
+  }
+}
+
+TEST_F(MeasuredHloProfileTest, SizesParallelTasksFromMeasuredCycles) {
+  const char* const kModule = R"(
+    HloModule m
+
+    ENTRY e {
+      p0 = f32[1024]{0} parameter(0)
+      p1 = f32[1024]{0} parameter(1)
+      ROOT add = f32[1024]{0} add(p0, p1)
+    })";
+  TargetMachineFeaturesWithFakeAlignmentLogic target_machine_features(
+      [](int64_t shape_size) {
+        return TargetMachineFeatures::kEigenExpectedTensorAlignment;
+      });
+  auto shape_size = [](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+  };
+
+  // The cost model considers the add too small to parallelize.
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kModule));
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      ParallelTaskAssigner(/*max_parallelism=*/8, shape_size,
+                           &target_machine_features)
+          .Run(module.get()));
+  EXPECT_FALSE(changed);
+
+  // But it was measured to take 1ms.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto profile,
+      MeasuredHloProfile::Create(MakeProfile({{"add", 1e-6, 2000000, {}}})));
+  TF_ASSERT_OK_AND_ASSIGN(module, ParseAndReturnVerifiedModule(kModule));
+  TF_ASSERT_OK_AND_ASSIGN(
+      changed, ParallelTaskAssigner(/*max_parallelism=*/8, shape_size,
+                                    &target_machine_features, profile.get())
+                   .Run(module.get()));
+  EXPECT_TRUE(changed);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
 #include <memory>
+#include <optional>
+#include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -109,10 +111,41 @@ class DefaultCostModel : public ParallelCostModel {
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
 };
 
+// Derives parallel task counts from measured cycles for instructions that
+// appear in a profile, and defers to 'fallback' for the others.
+class MeasuredCostModel : public ParallelCostModel {
+ public:
+  MeasuredCostModel(const int64_t max_parallelism,
+                    const MeasuredHloProfile* profile,
+                    std::unique_ptr<ParallelCostModel> fallback)
+      : max_parallelism_(max_parallelism),
+        profile_(profile),
+        fallback_(std::move(fallback)) {}
+  ~MeasuredCostModel() override {}
+
+  int64_t GetParallelTaskCount(HloInstruction* instruction) override {
+    std::optional<int64_t> cycles = profile_->CyclesFor(instruction->name());
+    if (!cycles.has_value()) {
+      return fallback_->GetParallelTaskCount(instruction);
+    }
+    // Minimum per-thread cost is 100us of work on a 2GHz core, as in
+    // DefaultCostModel.
+    const int64_t min_cycles_per_thread = 200000;
+    return std::min(max_parallelism_,
+                    std::max(int64_t{1}, *cycles / min_cycles_per_thread));
+  }
+
+ private:
+  const int64_t max_parallelism_;
+  const MeasuredHloProfile* profile_;
+  const std::unique_ptr<ParallelCostModel> fallback_;
+};
+
 ParallelTaskAssignment::ParallelTaskAssignment(
     const int64_t max_parallelism,
     const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
-    const TargetMachineFeatures* target_machine_features)
+    const TargetMachineFeatures* target_machine_features,
+    const MeasuredHloProfile* profile)
     : target_machine_features_(*target_machine_features) {
   VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
   // Run cost analysis on 'module'.
@@ -129,6 +162,10 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     // HLOs like CustomCall are not yet implemented in the HloCostAnalysis).
     cost_model_.reset(new SimpleCostModel(max_parallelism, shape_size));
   }
+  if (profile != nullptr) {
+    cost_model_ = std::make_unique<MeasuredCostModel>(
+        max_parallelism, profile, std::move(cost_model_));
+  }
 }
 
 int64_t ParallelTaskAssignment::GetTargetParallelTaskCount(
@@ -250,9 +287,9 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
 
 void ParallelTaskAssigner::ComputeTargetParallelTasks(
     HloModule* module, HloToParallelTasks* hlo_to_parallel_tasks) {
-  ParallelTaskAssignment parallel_task_assignment(max_parallelism_,
-                                                  shape_size_function_, module,
-                                                  &target_machine_features_);
+  ParallelTaskAssignment parallel_task_assignment(
+      max_parallelism_, shape_size_function_, module,
+      &target_machine_features_, profile_);
 
   // Compute parallel task counts for all instructions in 'module'.
   for (auto* computation : module->MakeNonfusionComputations()) {
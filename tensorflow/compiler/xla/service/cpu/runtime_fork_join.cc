@@ -17,6 +17,11 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,9 +34,74 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// State of one ParallelForkJoin call, shared between the calling thread and
+// the helper tasks it enqueues. A helper may only get to run after all
+// partitions have been claimed (and even after the call returned), so the
+// state is reference counted.
+struct ForkJoinState {
+  ForkJoinState(ComputeFunctionType function, void* result_ptr,
+                const void* run_options_ptr, const void** params,
+                void** buffer_table, uint64_t* prof_counters,
+                int32_t num_partitions, int64_t* partitions, int64_t stride)
+      : function(function),
+        result_ptr(result_ptr),
+        run_options_ptr(run_options_ptr),
+        params(params),
+        buffer_table(buffer_table),
+        prof_counters(prof_counters),
+        num_partitions(num_partitions),
+        partitions(partitions),
+        stride(stride),
+        statuses(num_partitions),
+        pending(num_partitions) {}
+
+  const ComputeFunctionType function;
+  void* const result_ptr;
+  const void* const run_options_ptr;
+  // Only passed to the first partition, as before partitions were scheduled
+  // dynamically.
+  const void** const params;
+  void** const buffer_table;
+  uint64_t* const prof_counters;
+  const int32_t num_partitions;
+  int64_t* const partitions;
+  const int64_t stride;
+
+  // Index of the next partition to claim.
+  std::atomic<int32_t> next_partition{0};
+  std::vector<XlaCustomCallStatus> statuses;
+  // Counts down the partitions that have not finished yet.
+  tensorflow::BlockingCounter pending;
+};
+
+// Claims and runs partitions of 'state' until there are none left.
+void RunPartitions(ForkJoinState* state) {
+  for (int32_t i = state->next_partition.fetch_add(1);
+       i < state->num_partitions; i = state->next_partition.fetch_add(1)) {
+    state->function(state->result_ptr, state->run_options_ptr,
+                    i == 0 ? state->params : nullptr, state->buffer_table,
+                    &state->statuses[i],
+                    &state->partitions[i * state->stride],
+                    state->prof_counters);
+    VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+    state->pending.DecrementCount();
+  }
+}
+
+}  // namespace
+
+// Runs 'num_partitions' calls to 'function_ptr' in parallel and returns once
+// all of them are done.
+//
+// Partitions are not bound to threads: the calling thread and up to
+// 'num_partitions - 1' helper tasks on the intra-op thread pool repeatedly
+// claim the next unprocessed partition. Threads that finish their partitions
+// early take over the remaining ones, which balances partitions of uneven
+// cost, and the calling thread keeps making progress (instead of blocking)
+// when the pool is busy with other work. The caller only waits for partitions
+// that are already running elsewhere.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -74,33 +144,25 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
   CHECK_NE(run_options, nullptr);
   CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
+  const Eigen::ThreadPoolDevice* pool = run_options->intra_op_thread_pool();
 
-  ComputeFunctionType function =
-      reinterpret_cast<ComputeFunctionType>(function_ptr);
   // Compute partition stride in 'partitions' array.
   const int64_t stride = 2 * num_partitioned_dims;
+  auto state = std::make_shared<ForkJoinState>(
+      reinterpret_cast<ComputeFunctionType>(function_ptr), result_ptr,
+      run_options_ptr, params, buffer_table, prof_counters, num_partitions,
+      partitions, stride);
 
-  std::vector<XlaCustomCallStatus> statuses(num_partitions);
-
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+  // More helpers than pool threads could not run concurrently anyway.
+  const int32_t num_helpers =
+      std::min<int32_t>(num_partitions - 1, pool->numThreads());
+  for (int32_t i = 0; i < num_helpers; ++i) {
+    pool->enqueueNoNotification([state]() { RunPartitions(state.get()); });
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  RunPartitions(state.get());
+  state->pending.Wait();
+  const std::vector<XlaCustomCallStatus>& statuses = state->statuses;
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
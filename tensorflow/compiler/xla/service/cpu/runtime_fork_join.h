@@ -20,8 +20,8 @@ limitations under the License.
 
 extern "C" {
 
-// Dispatches 'num_partitions' parallel calls to 'function_ptr' and joins
-// threads before returning. See comments in runtime_fork_join.cc for details.
+// Runs 'num_partitions' calls to 'function_ptr' in parallel and returns
+// once all of them are done. See comments in runtime_fork_join.cc for details.
 extern void __xla_cpu_runtime_ParallelForkJoin(
     void* result_ptr, const void* run_options_ptr, const void** params,
     void** buffer_table, void* status, uint64_t* prof_counters,
@@ -0,0 +1,93 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/compiler.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+constexpr char kHloText[] = R"(
+HloModule Export
+
+ENTRY main {
+  p0 = f32[4] parameter(0)
+  p1 = f32[4] parameter(1)
+  ROOT add = f32[4] add(p0, p1)
+}
+)";
+
+class CpuExportTest : public CpuCodegenTest {
+ protected:
+  StatusOr<std::unique_ptr<Executable>> Compile(bool keep_object_code) {
+    HloModuleConfig config = GetModuleConfigForTest();
+    DebugOptions debug_options = config.debug_options();
+    debug_options.set_xla_cpu_keep_object_code(keep_object_code);
+    config.set_debug_options(debug_options);
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                        ParseAndReturnVerifiedModule(kHloText, config));
+    return test_runner_.CreateExecutable(std::move(module),
+                                         /*run_hlo_passes=*/true);
+  }
+};
+
+TEST_F(CpuExportTest, DoesNotKeepObjectCodeByDefault) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> executable,
+                          Compile(/*keep_object_code=*/false));
+  EXPECT_TRUE(
+      static_cast<CpuExecutable*>(executable.get())->obj_files().empty());
+  EXPECT_EQ(backend().compiler()->Export(executable.get()).status().code(),
+            tensorflow::error::FAILED_PRECONDITION);
+}
+
+TEST_F(CpuExportTest, ExportsAndLoadsKeptObjectCode) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> executable,
+                          Compile(/*keep_object_code=*/true));
+  EXPECT_FALSE(
+      static_cast<CpuExecutable*>(executable.get())->obj_files().empty());
+
+  Compiler* compiler = backend().compiler();
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotCompilationResult> exported,
+                          compiler->Export(executable.get()));
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized,
+                          exported->SerializeAsString());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotCompilationResult> aot_result,
+                          compiler->LoadAotCompilationResult(serialized));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> loaded,
+      aot_result->LoadExecutable(compiler,
+                                 backend().default_stream_executor()));
+
+  Literal lhs = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  Literal rhs = LiteralUtil::CreateR1<float>({10, 20, 30, 40});
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal result, test_runner_.ExecuteWithExecutable(
+                          loaded.get(), {&lhs, &rhs}, /*profile=*/nullptr));
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateR1<float>({11, 22, 33, 44}), result));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
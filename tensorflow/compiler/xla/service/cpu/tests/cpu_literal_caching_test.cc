@@ -13,6 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
 #include "tensorflow/compiler/xla/service/cpu/test_target_triple_helper.h"
 #include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
@@ -123,6 +130,128 @@ CHECK-NOT: private unnamed_addr constant [8 x i8]
                                 /*match_optimized_ir=*/false);
 }
 
+TEST_F(CpuDuplicateConstantsTest, SharedArrayConstants) {
+  // Same module as in RepeatedArrayConstants, but with constants shared
+  // across object files: the single remaining global is named after its
+  // contents and can be merged by the linker.
+  const std::string hlo_text = R"(
+HloModule RepeatedConstants
+
+while_body {
+  arg_body = f32[2,3,2] parameter(0)
+  ROOT const = f32[2,3,2] constant(
+    {{{1, 2}, {1001, 1002}, {2001, 2002}},
+     {{2, 1}, {2001, 3002}, {2001, 2002}}})
+}
+
+while_cond {
+  arg_cond = f32[2,3,2] parameter(0)
+  token0 = token[] after-all()
+  infeed = (pred[], token[]) infeed(token0)
+  ROOT unknown = pred[] get-tuple-element((pred[], token[]) infeed), index=0
+}
+
+ENTRY main {
+  param = f32[2,3,2] parameter(0)
+  const_a = f32[2,3,2] constant(
+    {{{1, 2}, {1001, 1002}, {2001, 2002}},
+     {{2, 1}, {2001, 3002}, {2001, 2002}}})
+  const_b = f32[2,3,2] while(f32[2,3,2] const_a), condition=while_cond, body=while_body
+
+  token0 = token[] after-all()
+  out0 = token[] outfeed(f32[2,3,2] const_a, token[] token0)
+  ROOT out1 = token[] outfeed(f32[2,3,2] const_b, token[] token0)
+}
+)";
+
+  std::string filecheck_pattern = R"(
+CHECK: @__xla_constant_{{[0-9a-f]+}} = linkonce_odr hidden constant [48 x i8]
+CHECK-NOT: constant [48 x i8]
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_text));
+
+  CpuAotCompilationOptions options{
+      /*triple=*/kTargetTripleForHost, /*cpu_name=*/kTargetCpuForHost,
+      /*features=*/"",
+      /*entry_point_name=*/"entry",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+  options.set_share_constants(true);
+
+  CompileAheadOfTimeAndVerifyIr(std::move(module), options, filecheck_pattern,
+                                /*match_optimized_ir=*/false);
+}
+
+// Returns the names of the shared constants defined or referenced in
+// `object_file`.
+std::set<std::string> SharedConstantNames(const ObjectFileData& object_file) {
+  constexpr absl::string_view kPrefix = "__xla_constant_";
+  constexpr size_t kHexDigits = 32;
+  absl::string_view data(object_file.data(), object_file.size());
+  std::set<std::string> names;
+  for (size_t pos = data.find(kPrefix); pos != absl::string_view::npos;
+       pos = data.find(kPrefix, pos + 1)) {
+    absl::string_view name = data.substr(pos, kPrefix.size() + kHexDigits);
+    if (name.size() == kPrefix.size() + kHexDigits &&
+        std::all_of(name.begin() + kPrefix.size(), name.end(),
+                    absl::ascii_isxdigit)) {
+      names.insert(std::string(name));
+    }
+  }
+  return names;
+}
+
+TEST_F(CpuDuplicateConstantsTest, SharedConstantsHaveSameNameAcrossModules) {
+  // Two different computations, e.g. two signatures of one model, that use
+  // the same weight. Each object file must name the weight identically so
+  // that linking them together keeps a single copy.
+  const std::string add_text = R"(
+HloModule AddConstant
+
+ENTRY main {
+  param = f32[2,3,2] parameter(0)
+  const = f32[2,3,2] constant(
+    {{{1, 2}, {1001, 1002}, {2001, 2002}},
+     {{2, 1}, {2001, 3002}, {2001, 2002}}})
+  ROOT add = f32[2,3,2] add(param, const)
+}
+)";
+  const std::string multiply_text = R"(
+HloModule MultiplyConstant
+
+ENTRY main {
+  param = f32[2,3,2] parameter(0)
+  const = f32[2,3,2] constant(
+    {{{1, 2}, {1001, 1002}, {2001, 2002}},
+     {{2, 1}, {2001, 3002}, {2001, 2002}}})
+  ROOT multiply = f32[2,3,2] multiply(param, const)
+}
+)";
+
+  CpuAotCompilationOptions options{
+      /*triple=*/kTargetTripleForHost, /*cpu_name=*/kTargetCpuForHost,
+      /*features=*/"",
+      /*entry_point_name=*/"entry",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+  options.set_share_constants(true);
+
+  std::vector<std::set<std::string>> names;
+  for (const std::string& hlo_text : {add_text, multiply_text}) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                            ParseAndReturnVerifiedModule(hlo_text));
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<AotCompilationResult> result,
+        CompileToAotCompilationResult(std::move(module), options));
+    names.push_back(SharedConstantNames(
+        static_cast<CpuAotCompilationResult*>(result.get())
+            ->object_file_data()));
+  }
+
+  ASSERT_EQ(names[0].size(), 1);
+  EXPECT_EQ(names[0], names[1]);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
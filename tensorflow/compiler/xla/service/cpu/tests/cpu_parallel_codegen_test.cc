@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/compiler/xla/tests/test_utils.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Several embedded computations, so that the LLVM module has enough functions
+// to be split.
+constexpr char kHloText[] = R"(
+HloModule ParallelCodegen
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+less_than {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT lt = pred[] compare(lhs, rhs), direction=LT
+}
+
+ENTRY main {
+  p0 = f32[64,128] parameter(0)
+  p1 = f32[64,128] parameter(1)
+  zero = f32[] constant(0)
+  min = f32[] constant(-inf)
+  mul = f32[64,128] multiply(p0, p1)
+  sum = f32[64] reduce(mul, zero), dimensions={1}, to_apply=add
+  maxes = f32[64] reduce(p1, min), dimensions={1}, to_apply=max
+  sorted = f32[64] sort(maxes), dimensions={0}, to_comparator=less_than
+  ROOT result = (f32[64], f32[64]) tuple(sum, sorted)
+}
+)";
+
+class CpuParallelCodegenTest : public CpuCodegenTest {
+ protected:
+  StatusOr<std::unique_ptr<HloModule>> ParseModule(int split_count) {
+    HloModuleConfig config = GetModuleConfigForTest();
+    DebugOptions debug_options = config.debug_options();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(split_count);
+    debug_options.set_xla_cpu_keep_object_code(true);
+    config.set_debug_options(debug_options);
+    return ParseAndReturnVerifiedModule(kHloText, config);
+  }
+};
+
+TEST_F(CpuParallelCodegenTest, SplitsModuleIntoObjectFiles) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseModule(/*split_count=*/4));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  EXPECT_GT(
+      static_cast<CpuExecutable*>(executable.get())->obj_files().size(), 1);
+}
+
+TEST_F(CpuParallelCodegenTest, MatchesSingleThreadedCodegen) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseModule(/*split_count=*/1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Literal> arguments,
+                          MakeFakeArguments(module.get()));
+  std::vector<Literal*> argument_ptrs;
+  for (Literal& argument : arguments) {
+    argument_ptrs.push_back(&argument);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(Literal expected,
+                          Execute(std::move(module), argument_ptrs));
+
+  TF_ASSERT_OK_AND_ASSIGN(module, ParseModule(/*split_count=*/4));
+  TF_ASSERT_OK_AND_ASSIGN(Literal actual,
+                          Execute(std::move(module), argument_ptrs));
+  EXPECT_TRUE(LiteralTestUtil::Near(expected, actual, ErrorSpec{1e-5}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,77 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/match.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// `big` is live across the chain of dots unless it is recomputed for the root.
+const char* const kHloText = R"(
+HloModule Rematerialization
+
+ENTRY main {
+  a = f32[128,128] parameter(0)
+  big = f32[128,128] dot(a, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d1 = f32[128,128] dot(big, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d2 = f32[128,128] dot(d1, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d3 = f32[128,128] dot(d2, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT r = f32[128,128] add(d3, big)
+}
+)";
+
+class CpuRematerializationTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    // Below the size of any live set, so that everything that can be
+    // rematerialized is.
+    debug_options.set_xla_cpu_memory_limit_bytes(1);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuRematerializationTest, RecomputesLongLivedValues) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<HloModule> optimized,
+      backend().compiler()->RunHloPasses(
+          std::move(module), backend().default_stream_executor(),
+          /*device_allocator=*/nullptr));
+
+  ASSERT_TRUE(optimized->has_schedule());
+  EXPECT_TRUE(absl::c_any_of(
+      optimized->entry_computation()->instructions(),
+      [](const HloInstruction* instruction) {
+        return absl::StrContains(instruction->name(), "remat");
+      }))
+      << optimized->ToString();
+}
+
+TEST_F(CpuRematerializationTest, RematerializedModuleComputesSameResult) {
+  EXPECT_TRUE(RunAndCompare(kHloText, ErrorSpec{1e-2, 1e-3}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,300 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_replace.h"
+#include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable_call_frame.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Checks the vectorized reduce and reduce-window emitters against the
+// reference backend.
+class CpuVectorizedReduceTest : public HloTestBase {};
+
+TEST_F(CpuVectorizedReduceTest, RowReduction) {
+  const char* hlo_text = R"(
+HloModule RowReduction
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[37,259] parameter(0)
+  zero = f32[] constant(0)
+  ROOT reduce = f32[37] reduce(input, zero), dimensions={1}, to_apply=add
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
+TEST_F(CpuVectorizedReduceTest, ShortRowReduction) {
+  const char* hlo_text = R"(
+HloModule ShortRowReduction
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[100,7] parameter(0)
+  init = f32[] constant(-inf)
+  ROOT reduce = f32[100] reduce(input, init), dimensions={1}, to_apply=max
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{0, 0}));
+}
+
+TEST_F(CpuVectorizedReduceTest, MultiDimensionalRowReduction) {
+  const char* hlo_text = R"(
+HloModule MultiDimensionalRowReduction
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[4,9,67] parameter(0)
+  init = f32[] constant(-inf)
+  ROOT reduce = f32[9] reduce(input, init), dimensions={0,2}, to_apply=max
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{0, 0}));
+}
+
+TEST_F(CpuVectorizedReduceTest, IntegerReductionToScalar) {
+  const char* hlo_text = R"(
+HloModule IntegerReductionToScalar
+
+add {
+  lhs = s32[] parameter(0)
+  rhs = s32[] parameter(1)
+  ROOT add = s32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  input = s32[1001] parameter(0)
+  zero = s32[] constant(0)
+  ROOT reduce = s32[] reduce(input, zero), dimensions={0}, to_apply=add
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, std::nullopt));
+}
+
+TEST_F(CpuVectorizedReduceTest, ColumnReduction) {
+  const char* hlo_text = R"(
+HloModule ColumnReduction
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[67,35] parameter(0)
+  zero = f32[] constant(0)
+  ROOT reduce = f32[35] reduce(input, zero), dimensions={0}, to_apply=add
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
+TEST_F(CpuVectorizedReduceTest, PaddedMaxPool) {
+  const char* hlo_text = R"(
+HloModule PaddedMaxPool
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[2,17,17,35] parameter(0)
+  init = f32[] constant(-inf)
+  ROOT pool = f32[2,9,9,35] reduce-window(input, init),
+      window={size=1x3x3x1 stride=1x2x2x1 pad=0_0x1_1x1_1x0_0}, to_apply=max
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{0, 0}));
+}
+
+TEST_F(CpuVectorizedReduceTest, WindowAlongMinorDimension) {
+  const char* hlo_text = R"(
+HloModule WindowAlongMinorDimension
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[8,70] parameter(0)
+  zero = f32[] constant(0)
+  ROOT sum = f32[4,68] reduce-window(input, zero),
+      window={size=2x3 stride=2x1}, to_apply=add
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
+TEST_F(CpuVectorizedReduceTest, StridedMinorWindowFallsBack) {
+  const char* hlo_text = R"(
+HloModule StridedMinorWindowFallsBack
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[8,70] parameter(0)
+  zero = f32[] constant(0)
+  ROOT sum = f32[8,35] reduce-window(input, zero),
+      window={size=1x2 stride=1x2}, to_apply=add
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
+// Benchmarks the vectorized emitters against the scalar loops emitted with
+// --xla_backend_extra_options=xla_cpu_disable_vectorized_reduce.
+
+void BM_Reduction(::testing::benchmark::State& state,
+                  const std::string& hlo_text, bool vectorize) {
+  se::Platform* platform = PlatformUtil::GetPlatform("Host").ValueOrDie();
+  LocalClient* client =
+      ClientLibrary::GetOrCreateLocalClient(platform).ValueOrDie();
+  std::unique_ptr<HloModule> module =
+      ParseAndReturnUnverifiedModule(hlo_text).ValueOrDie();
+  std::vector<Shape> argument_shapes;
+  std::vector<const Shape*> argument_layouts;
+  for (const HloInstruction* parameter :
+       module->entry_computation()->parameter_instructions()) {
+    argument_shapes.push_back(parameter->shape());
+  }
+  for (const Shape& shape : argument_shapes) {
+    argument_layouts.push_back(&shape);
+  }
+
+  ExecutableBuildOptions build_options;
+  if (!vectorize) {
+    (*build_options.mutable_debug_options()
+          ->mutable_xla_backend_extra_options())
+        ["xla_cpu_disable_vectorized_reduce"] = "";
+  }
+  auto executables = client
+                         ->Compile(XlaComputation(module->ToProto()),
+                                   argument_layouts, build_options)
+                         .ConsumeValueOrDie();
+  std::unique_ptr<CpuExecutableCallFrame> frame =
+      CpuExecutableCallFrame::Create(
+          *static_cast<const CpuExecutable*>(executables[0]->executable()))
+          .ConsumeValueOrDie();
+
+  std::vector<std::vector<char>> arguments;
+  for (int i = 0; i < argument_shapes.size(); ++i) {
+    arguments.emplace_back(ShapeUtil::ByteSizeOf(argument_shapes[i]));
+    frame->set_arg_data(i, arguments.back().data());
+  }
+
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(
+      client->backend().eigen_intra_op_thread_pool_device());
+  for (auto s : state) {
+    TF_CHECK_OK(frame->Run(run_options));
+  }
+}
+
+std::string RowReductionHlo(const std::string& rows,
+                            const std::string& columns) {
+  return absl::StrReplaceAll(R"(
+HloModule RowReduction
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[$rows,$columns] parameter(0)
+  zero = f32[] constant(0)
+  ROOT reduce = f32[$rows] reduce(input, zero), dimensions={1}, to_apply=add
+}
+)",
+                             {{"$rows", rows}, {"$columns", columns}});
+}
+
+const char* const kMaxPoolHlo = R"(
+HloModule MaxPool
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+ENTRY main {
+  input = f32[1,56,56,64] parameter(0)
+  init = f32[] constant(-inf)
+  ROOT pool = f32[1,28,28,64] reduce-window(input, init),
+      window={size=1x3x3x1 stride=1x2x2x1 pad=0_0x0_1x0_1x0_0}, to_apply=max
+}
+)";
+
+void BM_RowReduction(::testing::benchmark::State& state) {
+  BM_Reduction(state, RowReductionHlo("256", "1024"), state.range(0));
+}
+
+void BM_LayerNormStyleReduction(::testing::benchmark::State& state) {
+  BM_Reduction(state, RowReductionHlo("128", "768"), state.range(0));
+}
+
+void BM_MaxPool(::testing::benchmark::State& state) {
+  BM_Reduction(state, kMaxPoolHlo, state.range(0));
+}
+
+BENCHMARK(BM_RowReduction)->Arg(0)->Arg(1);
+BENCHMARK(BM_LayerNormStyleReduction)->Arg(0)->Arg(1);
+BENCHMARK(BM_MaxPool)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
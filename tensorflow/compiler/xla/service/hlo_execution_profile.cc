@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_execution_profile_data.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/human_readable_profile_builder.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
@@ -108,6 +109,17 @@ std::unique_ptr<HloProfilePrinterData> CreateHloProfilePrinterData(
           cost_analysis.optimal_seconds(*hlo));
       instruction_info->set_profile_index(
           hlo_profile_index_map.GetProfileIndexFor(*hlo));
+      instruction_info->set_name(hlo->name());
+      if (hlo->opcode() == HloOpcode::kFusion) {
+        for (const HloInstruction* fused : hlo->fused_instructions()) {
+          if (fused->opcode() != HloOpcode::kParameter) {
+            const std::string& pre_fusion_name =
+                fused->metadata().pre_fusion_name();
+            instruction_info->add_fused_instruction_names(
+                pre_fusion_name.empty() ? fused->name() : pre_fusion_name);
+          }
+        }
+      }
     }
   }
 
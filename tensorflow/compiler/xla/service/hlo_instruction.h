@@ -1810,6 +1810,9 @@ class HloInstruction {
   void set_metadata_replaced_op(absl::string_view replaced_op) {
     metadata_.set_replaced_op(std::string(replaced_op));
   }
+  void set_metadata_pre_fusion_name(absl::string_view name) {
+    metadata_.set_pre_fusion_name(std::string(name));
+  }
   const OpMetadata& metadata() const { return metadata_; }
 
   // Set/get the computation containing this instruction. set_parent should only
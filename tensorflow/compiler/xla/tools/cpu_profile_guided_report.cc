@@ -0,0 +1,239 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compiles an HLO module for XLA:CPU with and without a measured HLO profile
+// (--xla_cpu_profile_guided_optimization_profile), reports which fusion and
+// parallel task assignment decisions the profile changed, and measures the
+// resulting speedup.
+//
+// Usage:
+//
+//   # Record a profile.
+//   bazel run run_hlo_module -- --platform=cpu --xla_hlo_profile \
+//     --xla_dump_to=/tmp/dump path/to/hlo_module
+//
+//   # Compare.
+//   bazel run cpu_profile_guided_report -- \
+//     --profile=/tmp/dump/<module>.hlo_execution_profile_data \
+//     [--input_format=hlo|pb|pbtxt] [--iterations=10] path/to/hlo_module
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_runner.h"
+#include "tensorflow/compiler/xla/service/platform_util.h"
+#include "tensorflow/compiler/xla/tests/test_utils.h"
+#include "tensorflow/compiler/xla/tools/hlo_module_loader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace xla {
+namespace {
+
+// The decisions of interest in an optimized module.
+struct CompilationDecisions {
+  // Every fusion, as the sorted pre-fusion names of the instructions fused
+  // into it.
+  std::set<std::string> fusions;
+  // Total parallel task count of every parallelized instruction.
+  std::map<std::string, int64_t> parallel_tasks;
+};
+
+CompilationDecisions GetDecisions(const HloModule& module) {
+  CompilationDecisions decisions;
+  for (const HloComputation* computation :
+       module.MakeNonfusionComputations()) {
+    for (const HloInstruction* instruction : computation->instructions()) {
+      if (instruction->opcode() == HloOpcode::kFusion) {
+        std::vector<std::string> names;
+        for (const HloInstruction* fused : instruction->fused_instructions()) {
+          if (fused->opcode() != HloOpcode::kParameter) {
+            const std::string& pre_fusion_name =
+                fused->metadata().pre_fusion_name();
+            names.push_back(pre_fusion_name.empty() ? fused->name()
+                                                    : pre_fusion_name);
+          }
+        }
+        std::sort(names.begin(), names.end());
+        decisions.fusions.insert(absl::StrJoin(names, " + "));
+      }
+      if (!instruction->outer_dimension_partitions().empty()) {
+        int64_t tasks = 1;
+        for (int64_t partitions : instruction->outer_dimension_partitions()) {
+          tasks *= partitions;
+        }
+        decisions.parallel_tasks[instruction->name()] = tasks;
+      }
+    }
+  }
+  return decisions;
+}
+
+struct Variant {
+  std::unique_ptr<Executable> executable;
+  CompilationDecisions decisions;
+  // Wall time of every timed execution, in microseconds.
+  std::vector<uint64_t> times_us;
+};
+
+StatusOr<Variant> CompileAndRun(HloRunner* runner, const std::string& path,
+                                const std::string& input_format,
+                                const std::string& profile, int iterations) {
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<HloModule> module,
+      LoadModuleFromFile(path, hlo_module_loader_details::Config(),
+                         input_format, [&](HloModuleConfig* config) {
+                           DebugOptions options = config->debug_options();
+                           options
+                               .set_xla_cpu_profile_guided_optimization_profile(
+                                   profile);
+                           config->set_debug_options(options);
+                         }));
+  TF_ASSIGN_OR_RETURN(std::vector<Literal> arguments,
+                      MakeFakeArguments(module.get()));
+  std::vector<const Literal*> argument_ptrs;
+  for (const Literal& argument : arguments) {
+    argument_ptrs.push_back(&argument);
+  }
+
+  Variant variant;
+  TF_ASSIGN_OR_RETURN(variant.executable,
+                      runner->CreateExecutable(std::move(module),
+                                               /*run_hlo_passes=*/true));
+  variant.decisions = GetDecisions(variant.executable->module());
+
+  // The first execution is a warmup.
+  for (int i = 0; i <= iterations; ++i) {
+    const uint64_t start_us = tensorflow::Env::Default()->NowMicros();
+    TF_RETURN_IF_ERROR(
+        runner
+            ->ExecuteWithExecutable(variant.executable.get(), argument_ptrs,
+                                    /*profile=*/nullptr)
+            .status());
+    if (i > 0) {
+      variant.times_us.push_back(tensorflow::Env::Default()->NowMicros() -
+                                 start_us);
+    }
+  }
+  std::sort(variant.times_us.begin(), variant.times_us.end());
+  return variant;
+}
+
+template <typename T>
+void PrintDifference(const std::string& title, const std::set<T>& a,
+                     const std::set<T>& b) {
+  std::vector<T> difference;
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::back_inserter(difference));
+  std::cout << title << " (" << difference.size() << "):\n";
+  for (const T& element : difference) {
+    std::cout << "  " << element << "\n";
+  }
+}
+
+Status Report(const std::string& path, const std::string& input_format,
+              const std::string& profile, int iterations) {
+  if (iterations < 1) {
+    return InvalidArgument("--iterations must be positive");
+  }
+  TF_ASSIGN_OR_RETURN(se::Platform * platform,
+                      PlatformUtil::GetPlatform("cpu"));
+  HloRunner runner(platform);
+  TF_ASSIGN_OR_RETURN(Variant baseline,
+                      CompileAndRun(&runner, path, input_format,
+                                    /*profile=*/"", iterations));
+  TF_ASSIGN_OR_RETURN(
+      Variant guided,
+      CompileAndRun(&runner, path, input_format, profile, iterations));
+
+  PrintDifference("Fusions only without profile", baseline.decisions.fusions,
+                  guided.decisions.fusions);
+  PrintDifference("Fusions only with profile", guided.decisions.fusions,
+                  baseline.decisions.fusions);
+
+  std::set<std::string> instructions;
+  for (const auto* tasks :
+       {&baseline.decisions.parallel_tasks, &guided.decisions.parallel_tasks}) {
+    for (const auto& [name, count] : *tasks) {
+      instructions.insert(name);
+    }
+  }
+  std::cout << "Parallel task count changes:\n";
+  for (const std::string& name : instructions) {
+    auto count = [&](const std::map<std::string, int64_t>& tasks) {
+      auto it = tasks.find(name);
+      return it == tasks.end() ? int64_t{1} : it->second;
+    };
+    const int64_t before = count(baseline.decisions.parallel_tasks);
+    const int64_t after = count(guided.decisions.parallel_tasks);
+    if (before != after) {
+      std::cout << "  " << name << ": " << before << " -> " << after << "\n";
+    }
+  }
+
+  const uint64_t baseline_us = baseline.times_us[iterations / 2];
+  const uint64_t guided_us =
+      std::max<uint64_t>(guided.times_us[iterations / 2], 1);
+  std::cout << "Median execution time over " << iterations
+            << " iterations: " << baseline_us << "us without profile, "
+            << guided_us << "us with profile (speedup "
+            << static_cast<double>(baseline_us) / guided_us << "x)\n";
+  return OkStatus();
+}
+
+}  // namespace
+}  // namespace xla
+
+int main(int argc, char** argv) {
+  std::string profile;
+  std::string input_format;
+  int iterations = 10;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("profile", &profile,
+                       "Path of the *.hlo_execution_profile_data file to "
+                       "compile the module with."),
+      tensorflow::Flag("input_format", &input_format,
+                       "The format of the input file: hlo, pb or pbtxt. "
+                       "Inferred from the file extension by default."),
+      tensorflow::Flag("iterations", &iterations,
+                       "Number of timed executions of each variant.")};
+  xla::AppendDebugOptionsFlags(&flag_list);
+  const std::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  bool parse_ok = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(usage.c_str(), &argc, &argv);
+  if (!parse_ok || argc != 2 || profile.empty()) {
+    LOG(QFATAL) << usage;
+  }
+
+  xla::Status status = xla::Report(argv[1], input_format, profile, iterations);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 1;
+  }
+  return 0;
+}
@@ -233,6 +233,13 @@ void AttrBuilder::FillAttrValueMapWithoutDefaults(AttrValueMap* m) const {
   }
 }
 
+void AttrBuilder::FillSetAttrValueMap(AttrValueMap* m) const {
+  for (auto& entry : encoded_attrs_) {
+    attr_tmp_.ParseFromString(entry.second);
+    m->insert(AttrValueMap::value_type(entry.first, attr_tmp_));
+  }
+}
+
 void AttrBuilder::AddAttrIfNotPresent(StringPiece attr_name,
                                       const AttrValue& value) {
   encoded_attrs_.emplace(string(attr_name), value.SerializeAsString());
@@ -273,12 +280,6 @@ Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
 }
 
 namespace {
-inline tensorflow::Fprint128 FingerprintCat128(const tensorflow::Fprint128& a,
-                                               const tensorflow::Fprint128& b) {
-  return {tensorflow::FingerprintCat64(a.low64, b.low64),
-          tensorflow::FingerprintCat64(a.high64, b.high64)};
-}
-
 void CombineUnordered(const tensorflow::Fprint128& a,
                       tensorflow::Fprint128* b) {
   b->low64 += a.low64;
@@ -36,6 +36,17 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Combine fingerprints into eager cache keys.
+inline Fprint128 FingerprintCat128(const Fprint128& a, const Fprint128& b) {
+  return {FingerprintCat64(a.low64, b.low64),
+          FingerprintCat64(a.high64, b.high64)};
+}
+
+inline Fprint128 FingerprintCat128(const Fprint128& a, const int64_t b) {
+  auto x = FingerprintCat64(a.low64, b);
+  return {x, FingerprintCat64(a.high64, x)};
+}
+
 // Maps attribute name to an encoding of the type of the attribute value.
 // If the type is not a list type, the value is the same as the TF_AttrType type
 // of the value. Else, the highest order bit is on, and the rest of the bits
@@ -160,6 +171,11 @@ class AttrBuilder : public AbstractOpAttrs {
   // and if an attribute value is the same as the default (according to the
   // OpDef), this attr-value pair is not added to `m`.
   void FillAttrValueMapWithoutDefaults(AttrValueMap* m) const;
+
+  // Fill `m` with the attr-value pairs set via AttrBuilder::Set() so far,
+  // without adding the default attr-value pairs from the op_def. These are
+  // exactly the attributes covered by CacheKey.
+  void FillSetAttrValueMap(AttrValueMap* m) const;
   const NodeDef& BuildNodeDef();
 
   // Transfers the attributes from `other` to this AttrBuilder. Does not
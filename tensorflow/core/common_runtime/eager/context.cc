@@ -24,6 +24,7 @@ limitations under the License.
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
 #include "tensorflow/c/eager/immediate_execution_context.h"
+#include "tensorflow/core/common_runtime/eager/attr_builder.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -486,6 +487,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
   mutex_lock ml(cache_mu_);
   default_executor_.WaitForAllPendingNodes().IgnoreError();
   kernel_cache_.clear();
+  kernel_cache_entries_.clear();
   for (auto& entry : registered_functions_) {
     entry.second->cached_kernel_keys->clear();
   }
@@ -1090,6 +1092,122 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   }
 }
 
+Fprint128 EagerContext::AddPoliciesToKernelCacheKey(
+    const Fprint128& op_cache_key, bool is_function) const {
+  Fprint128 cache_key = op_cache_key;
+  /// Include soft placement policy in cache key since the placement strategy
+  // can change and thus affect which kernel is picked.
+  cache_key = FingerprintCat128(cache_key, AllowSoftPlacement());
+
+  // Include run_eager_op_as_function policy in cache key since the execution
+  // strategy can change and affect which kernel is picked.
+  VLOG(3) << "RunEagerOpAsFunction(): " << RunEagerOpAsFunction();
+  cache_key = FingerprintCat128(cache_key, RunEagerOpAsFunction());
+
+  // When running in eager_op_as_function mode Send/Recv ops need to be
+  // placed on the same rendezvous to match the behaviour of eager mode.
+  bool reuse_rendezvous_for_functions =
+      (RunEagerOpAsFunction() && !is_function) ||
+      GetReuseRendezvousForFunctions();
+  // The launch-time rendezvous reuse setting is bundled with the kernel, so we
+  // need to include it in the cache key.
+  return FingerprintCat128(cache_key, reuse_rendezvous_for_functions);
+}
+
+void EagerContext::AddKernelCacheEntry(Fprint128 cache_key,
+                                       eager::KernelCacheEntry entry) {
+  mutex_lock ml(cache_mu_);
+  kernel_cache_entries_[cache_key] = std::move(entry);
+}
+
+void EagerContext::ExportKernelCache(eager::KernelCacheManifest* manifest) {
+  tf_shared_lock l(cache_mu_);
+  for (const auto& it : kernel_cache_) {
+    const KernelAndDevice* kernel = it.second.get();
+    // Only primitive op kernels can be rebuilt from their NodeDef alone.
+    if (kernel->kernel() == nullptr || kernel->device() == nullptr) continue;
+    auto recorded = kernel_cache_entries_.find(it.first);
+    if (recorded == kernel_cache_entries_.end()) continue;
+    eager::KernelCacheEntry* entry = manifest->add_entries();
+    *entry = recorded->second;
+    entry->set_cache_key_low64(it.first.low64);
+    entry->set_cache_key_high64(it.first.high64);
+    *entry->mutable_node_def() = kernel->kernel()->def();
+    entry->set_device(kernel->device()->name());
+  }
+}
+
+Status EagerContext::WarmupKernelCache(
+    const eager::KernelCacheManifest& manifest, int* num_added) {
+  int added = 0;
+  for (const eager::KernelCacheEntry& entry : manifest.entries()) {
+    Fprint128 cache_key = {entry.cache_key_low64(), entry.cache_key_high64()};
+    if (GetCachedKernel(cache_key) != nullptr) continue;
+
+    Device* device = nullptr;
+    if (!FindDeviceFromName(entry.device().c_str(), &device).ok()) {
+      VLOG(1) << "Skipping kernel cache entry for " << entry.node_def().op()
+              << ": device " << entry.device() << " not found.";
+      continue;
+    }
+
+    // Don't trust the recorded key: recompute it the way GetKernelCacheKey
+    // does for an op without resource variable inputs, so that an entry
+    // recorded for other attributes, devices or context policies never
+    // shadows the kernel an op would get.
+    AttrBuilder attrs(entry.node_def().op().c_str());
+    for (const auto& attr : entry.attrs()) {
+      attrs.Set(attr.first, attr.second);
+    }
+    Fprint128 expected_cache_key = AddPoliciesToKernelCacheKey(
+        attrs.CacheKey(entry.requested_device()), /*is_function=*/false);
+    for (const string& input_device : entry.input_devices()) {
+      expected_cache_key =
+          FingerprintCat128(expected_cache_key, Fingerprint128(input_device));
+    }
+    if (!(expected_cache_key == cache_key)) {
+      VLOG(1) << "Skipping kernel cache entry for " << entry.node_def().op()
+              << ": cache key mismatch.";
+      continue;
+    }
+    FunctionLibraryRuntime* flr = func_lib(device);
+    if (flr == nullptr) {
+      return errors::NotFound(
+          "Unable to find a FunctionLibraryRuntime corresponding to device ",
+          device->name());
+    }
+    auto* runner = flr->runner() != nullptr ? flr->runner() : this->runner();
+    core::RefCountPtr<KernelAndDevice> kernel(new KernelAndDeviceOp(
+        GetRendezvous(), LogMemory(), flr, runner,
+        GetCollectiveExecutorHandle(), HostCPU()));
+    Status s = kernel->Init(LogDevicePlacement(), entry.node_def(),
+                            /*graph_collector=*/nullptr);
+    if (!s.ok()) {
+      VLOG(1) << "Skipping kernel cache entry for " << entry.node_def().op()
+              << ": " << s;
+      continue;
+    }
+    AddKernelToCache(cache_key, kernel.get());
+    ++added;
+  }
+  VLOG(1) << "Warmed up " << added << " of " << manifest.entries_size()
+          << " eager kernels.";
+  if (num_added != nullptr) *num_added = added;
+  return OkStatus();
+}
+
+Status EagerContext::SaveKernelCache(const string& path) {
+  eager::KernelCacheManifest manifest;
+  ExportKernelCache(&manifest);
+  return WriteBinaryProto(Env::Default(), path, manifest);
+}
+
+Status EagerContext::LoadKernelCache(const string& path, int* num_added) {
+  eager::KernelCacheManifest manifest;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), path, &manifest));
+  return WarmupKernelCache(manifest, num_added);
+}
+
 void EagerContext::AddDeviceToCache(Fprint128 device_cache_key,
                                     Device* device) {
   mutex_lock l(device_cache_mu_);
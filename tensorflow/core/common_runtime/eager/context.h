@@ -58,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/eager_kernel_cache.pb.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -265,6 +266,39 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
+  // Returns the kernel cache key of an op from `op_cache_key`, the key of its
+  // name, attributes and requested device (see AttrBuilder::CacheKey), by
+  // adding the policies of this context that affect which kernel is created.
+  Fprint128 AddPoliciesToKernelCacheKey(const Fprint128& op_cache_key,
+                                        bool is_function) const;
+
+  // Records how the primitive op kernel cached under `cache_key` was looked
+  // up, i.e. the `requested_device`, `attrs` and `input_devices` fields of
+  // `entry`, so that ExportKernelCache can export it.
+  void AddKernelCacheEntry(Fprint128 cache_key, eager::KernelCacheEntry entry);
+
+  // Appends the NodeDef, device, cache key and cache key inputs of every
+  // cached primitive op kernel recorded with AddKernelCacheEntry to
+  // `manifest`. Kernels for functions are not exported since they depend on
+  // the function library of the exporting context.
+  void ExportKernelCache(eager::KernelCacheManifest* manifest);
+
+  // Instantiates the kernels described by `manifest` and inserts them in the
+  // kernel cache, so that the first execution of a matching op skips kernel
+  // creation. The cache key of each entry is recomputed from its op,
+  // attributes and devices under the policies of this context. Entries whose
+  // recomputed key doesn't match the recorded one, whose devices do not exist
+  // in this context or whose kernel cannot be created are skipped. If
+  // `num_added` is not null it is set to the number of kernels added to the
+  // cache.
+  Status WarmupKernelCache(const eager::KernelCacheManifest& manifest,
+                           int* num_added = nullptr);
+
+  // Convenience wrappers which write/read a binary KernelCacheManifest to/from
+  // `path`, e.g. to persist the kernel cache across process restarts.
+  Status SaveKernelCache(const string& path);
+  Status LoadKernelCache(const string& path, int* num_added = nullptr);
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -717,6 +751,10 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // How the primitive op kernels of `kernel_cache_` were looked up, for
+  // ExportKernelCache.
+  std::unordered_map<Fprint128, eager::KernelCacheEntry, Fprint128Hasher>
+      kernel_cache_entries_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
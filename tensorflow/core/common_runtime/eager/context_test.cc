@@ -338,6 +338,64 @@ TEST_F(EagerContextTest, XlaCompileDeviceType) {
   retvals[0] = nullptr;
 }
 
+TEST_F(EagerContextTest, KernelCacheExportAndWarmup) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  auto op = ImmediateOpPtr(context()->CreateOperation());
+  TF_ASSERT_OK(
+      op->Reset("Identity", "/job:localhost/replica:0/task:0/device:CPU:0"));
+  Tensor float_tensor = test::AsScalar<float>(3.0);
+  auto input_float = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      context()->CreateLocalHandleFromTFTensor(
+          float_tensor, context()->HostCPUName().c_str()));
+  TF_ASSERT_OK(op->AddInput(input_float.get()));
+  std::vector<AbstractTensorHandle*> retvals(1);
+  int num_retvals = retvals.size();
+  TF_ASSERT_OK(op->Execute(absl::MakeSpan(retvals), &num_retvals));
+  retvals[0]->Unref();
+  retvals[0] = nullptr;
+
+  eager::KernelCacheManifest manifest;
+  context()->ExportKernelCache(&manifest);
+  ASSERT_EQ(manifest.entries_size(), 1);
+  const eager::KernelCacheEntry& entry = manifest.entries(0);
+  EXPECT_EQ(entry.node_def().op(), "Identity");
+  EXPECT_EQ(entry.device(), "/job:localhost/replica:0/task:0/device:CPU:0");
+  EXPECT_EQ(entry.requested_device(),
+            "/job:localhost/replica:0/task:0/device:CPU:0");
+  EXPECT_EQ(entry.attrs().at("T").type(), DT_FLOAT);
+  ASSERT_EQ(entry.input_devices_size(), 1);
+  const Fprint128 cache_key = {entry.cache_key_low64(),
+                               entry.cache_key_high64()};
+
+  context()->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+
+  // Entries referring to devices unknown to this context are skipped.
+  eager::KernelCacheEntry* unknown_device = manifest.add_entries();
+  *unknown_device = entry;
+  unknown_device->set_cache_key_low64(entry.cache_key_low64() + 1);
+  unknown_device->set_device("/job:localhost/replica:0/task:0/device:CPU:7");
+
+  // So are entries whose recorded key doesn't match their op, attrs and
+  // devices.
+  eager::KernelCacheEntry* wrong_key = manifest.add_entries();
+  *wrong_key = entry;
+  wrong_key->set_cache_key_low64(entry.cache_key_low64() + 2);
+
+  int num_added = 0;
+  TF_ASSERT_OK(context()->WarmupKernelCache(manifest, &num_added));
+  EXPECT_EQ(num_added, 1);
+  core::RefCountPtr<KernelAndDevice> kernel =
+      context()->GetCachedKernel(cache_key);
+  ASSERT_NE(kernel, nullptr);
+  EXPECT_EQ(kernel->name(), entry.node_def().name());
+  EXPECT_EQ(kernel->device()->name(), entry.device());
+
+  // Warming up again is a no-op since the kernel is already cached.
+  TF_ASSERT_OK(context()->WarmupKernelCache(manifest, &num_added));
+  EXPECT_EQ(num_added, 0);
+}
+
 TEST_F(EagerContextTest, LocalRendezvousCreation) {
   InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
   std::function<Rendezvous*(const int64_t)> rendezvous_creator =
@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/colocation_graph.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/eager/attr_builder.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/common_runtime/eager/copy_to_device_node.h"
 #include "tensorflow/core/common_runtime/eager/execute_node.h"
@@ -56,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/logging.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -280,18 +282,6 @@ Status GetOutputDTypes(EagerOperation* op, DataTypeVector* output_dtypes) {
   return OkStatus();
 }
 
-inline tensorflow::Fprint128 FingerprintCat128(const tensorflow::Fprint128& a,
-                                               const tensorflow::Fprint128& b) {
-  return {tensorflow::FingerprintCat64(a.low64, b.low64),
-          tensorflow::FingerprintCat64(a.high64, b.high64)};
-}
-
-inline tensorflow::Fprint128 FingerprintCat128(const tensorflow::Fprint128& a,
-                                               const int64_t b) {
-  auto x = tensorflow::FingerprintCat64(a.low64, b);
-  return {x, tensorflow::FingerprintCat64(a.high64, x)};
-}
-
 const KernelDef* GetKernelDef(const EagerOperation& op, const NodeDef* node_def,
                               const Device* op_device) {
   if (node_def == nullptr || op_device == nullptr) return nullptr;
@@ -908,24 +898,9 @@ StatusOr<Fprint128> GetKernelCacheKey(
         input_resource_variable_dtypes_and_shapes) {
   EagerContext& ctx = op.EagerContext();
 
-  Fprint128 cache_key = op_cache_key;
-  /// Include soft placement policy in cache key since the placement strategy
-  // can change and thus affect which kernel is picked.
-  cache_key = FingerprintCat128(cache_key, ctx.AllowSoftPlacement());
-
-  // Include run_eager_op_as_function policy in cache key since the execution
-  // strategy can change and affect which kernel is picked.
-  VLOG(3) << "ctx.RunEagerOpAsFunction(): " << ctx.RunEagerOpAsFunction();
-  cache_key = FingerprintCat128(cache_key, ctx.RunEagerOpAsFunction());
-
-  // When running in eager_op_as_function mode Send/Recv ops need to be
-  // placed on the same rendezvous to match the behaviour of eager mode.
-  bool reuse_rendezvous_for_functions =
-      (ctx.RunEagerOpAsFunction() && !op.is_function()) ||
-      ctx.GetReuseRendezvousForFunctions();
-  // The launch-time rendezvous reuse setting is bundled with the kernel, so we
-  // need to include it in the cache key.
-  cache_key = FingerprintCat128(cache_key, reuse_rendezvous_for_functions);
+  // Note that EagerContext::WarmupKernelCache recomputes keys the same way.
+  Fprint128 cache_key =
+      ctx.AddPoliciesToKernelCacheKey(op_cache_key, op.is_function());
 
   for (int i = 0, end = input_dev_ptrs.size(); i < end; ++i) {
     cache_key =
@@ -1071,6 +1046,7 @@ Status GetOrCreateKernelAndDevice(
                         input_dev_ptrs,
                         input_resource_variable_dtypes_and_shapes));
   core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  metrics::RecordEagerKernelCacheQuery(kernel != nullptr);
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
@@ -1090,6 +1066,17 @@ Status GetOrCreateKernelAndDevice(
   if (kernel == nullptr) {
     VLOG(2) << "Creating new kernel for " << op->Name() << " on device "
             << DeviceNameOrUnspecified(absl::get<Device*>(op->Device()));
+    // What the cache key was computed from, for exporting the kernel cache.
+    // Taken before the device and attributes of the op get updated below.
+    eager::KernelCacheEntry cache_entry;
+    if (!op->is_function() &&
+        input_resource_variable_dtypes_and_shapes.empty()) {
+      cache_entry.set_requested_device(string(op->DeviceName()));
+      op->Attrs().FillSetAttrValueMap(cache_entry.mutable_attrs());
+      for (const Device* input_device : input_dev_ptrs) {
+        cache_entry.add_input_devices(input_device->name());
+      }
+    }
     bool run_function_with_flr = false;
     bool function_outputs_on_op_device = false;
     absl::optional<string> xla_compile_device_type;
@@ -1230,6 +1217,10 @@ Status GetOrCreateKernelAndDevice(
       TF_RETURN_IF_ERROR(OpDefForOp(op->Name().data(), &op_def));
       if (KernelCacheEnabled(*op_def)) {
         ctx.AddKernelToCache(cache_key, kernel.get());
+        if (kernel->kernel() != nullptr &&
+            input_resource_variable_dtypes_and_shapes.empty()) {
+          ctx.AddKernelCacheEntry(cache_key, std::move(cache_entry));
+        }
       }
     }
   }
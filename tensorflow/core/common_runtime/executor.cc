@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <vector>
@@ -171,6 +172,20 @@ class ExecutorImpl : public Executor {
           cost_estimates_[i] = kInitialCostEstimateCycles;
         }
       }
+      InitializeSchedulingPriorities(gview);
+    }
+
+    // Returns true iff the graph was annotated with scheduling priorities
+    // (e.g. by the CriticalPathAnnotator grappler pass).
+    bool HasSchedulingPriorities() const {
+      return !scheduling_priorities_.empty();
+    }
+
+    // Returns the static scheduling priority of the given node. Nodes with a
+    // larger priority are dispatched first when several nodes become ready
+    // at once. REQUIRES: HasSchedulingPriorities().
+    int64_t SchedulingPriority(const NodeItem& node) const {
+      return scheduling_priorities_[node.node_id];
     }
 
     // Returns true iff the given node is considered "expensive". The
@@ -205,6 +220,22 @@ class ExecutorImpl : public Executor {
     }
 
    private:
+    void InitializeSchedulingPriorities(const GraphView& gview) {
+      std::vector<int64_t> priorities(gview.num_nodes(), 0);
+      bool found = false;
+      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+        const NodeItem* item = gview.node(i);
+        if (item == nullptr || item->kernel == nullptr) continue;
+        const auto& attrs = item->kernel->def().attr();
+        auto it = attrs.find(kSchedulingPriorityAttrName);
+        if (it != attrs.end()) {
+          priorities[i] = it->second.i();
+          found = true;
+        }
+      }
+      if (found) scheduling_priorities_ = std::move(priorities);
+    }
+
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
     // Operations start out "expensive".
@@ -215,6 +246,8 @@ class ExecutorImpl : public Executor {
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    // Empty unless at least one node carries kSchedulingPriorityAttrName.
+    std::vector<int64_t> scheduling_priorities_;
   };
 
   ImmutableExecutorState immutable_state_;
@@ -1173,6 +1206,18 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  // When the graph carries scheduling priorities, dispatch the ready nodes in
+  // decreasing priority order so that the critical path is not starved by
+  // cheap off-critical branches.
+  const bool prioritized = kernel_stats_->HasSchedulingPriorities();
+  if (prioritized && ready->size() > 1) {
+    std::stable_sort(ready->begin(), ready->end(),
+                     [this](const TaggedNode& a, const TaggedNode& b) {
+                       return kernel_stats_->SchedulingPriority(*a.node_item) >
+                              kernel_stats_->SchedulingPriority(*b.node_item);
+                     });
+  }
+
   if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
@@ -1202,6 +1247,11 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+        } else if (prioritized && curr_expensive_node) {
+          // `ready` is sorted by decreasing priority: keep the most critical
+          // expensive node for this thread and dispatch the others.
+          RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
+                            scheduled_nsec));
         } else {
           if (curr_expensive_node) {
             // Dispatch to another thread since there is plenty of work to
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
@@ -255,6 +256,65 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWithSchedulingPriorities) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  // Give the nodes a mix of priorities; the result must not depend on the
+  // dispatch order, which is checked by DispatchesReadyNodesInPriorityOrder.
+  int64_t priority = 0;
+  for (Node* n : g->op_nodes()) {
+    n->AddAttr(kSchedulingPriorityAttrName, priority++ % 7);
+  }
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, DispatchesReadyNodesInPriorityOrder) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  // These nodes become ready together once "a" is received. Without
+  // priorities they are dispatched in the order in which they were added.
+  constexpr int kNumNodes = 8;
+  std::vector<string> expected_order(kNumNodes);
+  for (int i = 0; i < kNumNodes; ++i) {
+    Node* n = test::graph::Identity(g.get(), in);
+    n->AddAttr(kSchedulingPriorityAttrName, i);
+    expected_order[kNumNodes - 1 - i] = n->name();
+  }
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+
+  // Running all kernels inline runs the ready nodes one after another, in
+  // the order in which they are dispatched.
+  Executor::Args run_args;
+  run_args.rendezvous = rendez_;
+  run_args.stats_collector = &step_stats_collector_;
+  run_args.runner = runner_;
+  run_args.run_all_kernels_inline = true;
+  TF_ASSERT_OK(exec_->Run(run_args));
+
+  step_stats_collector_.Finalize();
+  ASSERT_EQ(step_stats_.dev_stats_size(), 1);
+  std::vector<string> order;
+  for (const NodeExecStats& stats : step_stats_.dev_stats(0).node_stats()) {
+    if (std::find(expected_order.begin(), expected_order.end(),
+                  stats.node_name()) != expected_order.end()) {
+      order.push_back(stats.node_name());
+    }
+  }
+  EXPECT_EQ(order, expected_order);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -263,6 +263,10 @@ auto* eager_client_error_counter = monitoring::Counter<2>::New(
     "Count the errors in eager client as a central place.", "error_source",
     "error_type");
 
+auto* eager_kernel_cache_queries_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/eager_kernel_cache_queries",
+    "Eager kernel cache lookups. The result can be hit or miss.", "cache_hit");
+
 monitoring::Counter<2>* GetGraphOptimizationCounter() {
   static auto* graph_optimization_counter =
       monitoring::Counter<2>::New("/tensorflow/core/graph_optimization_usecs",
@@ -562,5 +566,14 @@ void UpdateEagerClientErrorCounter(const string& error_source,
   eager_client_error_counter->GetCell(error_source, error_type)->IncrementBy(1);
 }
 
+void RecordEagerKernelCacheQuery(bool cache_hit) {
+  // This is called for every eager op dispatch, so avoid the label lookup.
+  static monitoring::CounterCell* hit_cell =
+      eager_kernel_cache_queries_counter->GetCell("true");
+  static monitoring::CounterCell* miss_cell =
+      eager_kernel_cache_queries_counter->GetCell("false");
+  (cache_hit ? hit_cell : miss_cell)->IncrementBy(1);
+}
+
 }  // namespace metrics
 }  // namespace tensorflow
@@ -327,6 +327,9 @@ void UpdateTpuErrorCounter(const string& op, const string& error_type);
 void UpdateEagerClientErrorCounter(const string& error_source,
                                    const string& error_type);
 
+// Records a lookup in the EagerContext kernel cache.
+void RecordEagerKernelCacheQuery(bool cache_hit);
+
 }  // namespace metrics
 }  // namespace tensorflow
 
@@ -44,6 +44,7 @@ namespace tensorflow {
 
 const char* const kColocationAttrName = "_class";
 const char* const kColocationGroupPrefix = "loc:@";
+const char* const kSchedulingPriorityAttrName = "_scheduling_priority";
 // For TPU distributed rewrite, TPU args are collected and "staged" on the local
 // host using an IdentityN TF op. Some args may result from a remote source.
 // When all arg tensors are available, the TPUExecute op can be inovoked. See
@@ -58,6 +58,12 @@ extern const char* const kColocationAttrName;
 // String prefix applied to the operation name for colocation constraints.
 extern const char* const kColocationGroupPrefix;
 
+// Name of the int attribute holding the scheduling priority of a node. Nodes
+// with a larger priority are dispatched first by the executor when several
+// nodes become ready at the same time. See CriticalPathAnnotator in
+// tensorflow/core/grappler/optimizers.
+extern const char* const kSchedulingPriorityAttrName;
+
 // Constants for host CPU staging op for TPUExecute.
 extern const char* const kTpuExecuteStagingOp;
 extern const char* const kTpuExecuteStagingNodeName;
@@ -0,0 +1,82 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares the per-node execution times recorded in two profiles, e.g. one
+// collected before and one after enabling a graph optimization. Each profile is
+// a RunMetadata or StepStats proto in binary or text format, such as the
+// run_metadata returned by a Session::Run call with FULL_TRACE enabled. To use
+// it, run something like this:
+//
+// bazel build tensorflow/core/grappler/costs:compare_profiles
+// bazel-bin/tensorflow/core/grappler/costs/compare_profiles before.pb after.pb
+//
+// The return value is 0 on success and -1 if a profile could not be loaded.
+
+#include <iostream>
+
+#include "tensorflow/core/grappler/costs/measured_cost_profile.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+int ParseFlagsAndCompareProfiles(int argc, char* argv[]) {
+  int32_t max_nodes = 50;
+  std::vector<Flag> flag_list = {
+      Flag("max_nodes", &max_nodes, "maximum number of nodes to print"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  // We need to call this to set up global state for TensorFlow.
+  port::InitMain(argv[0], &argc, &argv);
+
+  if (!parse_result || argc != 3) {
+    LOG(ERROR) << "compare_profiles expects two file names as arguments\n"
+               << usage;
+    return -1;
+  }
+
+  MeasuredCostProfile before;
+  Status before_status =
+      MeasuredCostProfile::FromFile(argv[1], /*graph_id=*/"", &before);
+  if (!before_status.ok()) {
+    LOG(ERROR) << "Loading profile '" << argv[1] << "' failed with "
+               << before_status.error_message();
+    return -1;
+  }
+
+  MeasuredCostProfile after;
+  Status after_status =
+      MeasuredCostProfile::FromFile(argv[2], /*graph_id=*/"", &after);
+  if (!after_status.ok()) {
+    LOG(ERROR) << "Loading profile '" << argv[2] << "' failed with "
+               << after_status.error_message();
+    return -1;
+  }
+
+  std::cout << CompareMeasuredCostProfiles(before, after, max_nodes);
+  return 0;
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
+
+int main(int argc, char* argv[]) {
+  return tensorflow::grappler::ParseFlagsAndCompareProfiles(argc, argv);
+}
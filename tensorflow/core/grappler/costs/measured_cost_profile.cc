@@ -0,0 +1,170 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_cost_profile.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Devices recorded by GPU tracing that duplicate the per-op stats of the
+// compute device.
+bool IsPseudoDevice(const string& device) {
+  return absl::StrContains(device, "/stream:") ||
+         absl::StrContains(device, "/memcpy");
+}
+
+int64_t GetDurationNanos(const NodeExecStats& stats) {
+  if (stats.all_end_rel_nanos() > 0) return stats.all_end_rel_nanos();
+  return stats.all_end_rel_micros() * 1000;
+}
+
+// Timelines sometimes record "node_name:OpType"; node names never contain ':'.
+string StripOpType(const string& node_name) {
+  return node_name.substr(0, node_name.find(':'));
+}
+
+string NodeKey(const string& graph_id, const string& node_name) {
+  if (graph_id.empty()) return node_name;
+  return absl::StrCat(graph_id, ":", node_name);
+}
+
+}  // namespace
+
+void MeasuredCostProfile::AddStepStats(const string& graph_id,
+                                       const StepStats& step_stats) {
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    if (IsPseudoDevice(dev_stats.device())) continue;
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      NodeStats& stats =
+          nodes_[NodeKey(graph_id, StripOpType(node_stats.node_name()))];
+      stats.count++;
+      stats.total_nanos += GetDurationNanos(node_stats);
+    }
+  }
+}
+
+Status MeasuredCostProfile::FromFile(const string& filename,
+                                     const string& graph_id,
+                                     MeasuredCostProfile* profile) {
+  RunMetadata run_metadata;
+  if (ReadTextOrBinaryProto(Env::Default(), filename, &run_metadata).ok() &&
+      run_metadata.step_stats().dev_stats_size() > 0) {
+    profile->AddStepStats(graph_id, run_metadata.step_stats());
+    return OkStatus();
+  }
+  StepStats step_stats;
+  TF_RETURN_IF_ERROR(
+      ReadTextOrBinaryProto(Env::Default(), filename, &step_stats));
+  if (step_stats.dev_stats_size() == 0) {
+    return errors::InvalidArgument("No step stats found in ", filename);
+  }
+  profile->AddStepStats(graph_id, step_stats);
+  return OkStatus();
+}
+
+absl::optional<Costs::NanoSeconds> MeasuredCostProfile::GetNodeTime(
+    const string& graph_id, const string& node_name) const {
+  return GetTime(NodeKey(graph_id, node_name));
+}
+
+absl::optional<Costs::NanoSeconds> MeasuredCostProfile::GetTime(
+    const string& key) const {
+  auto it = nodes_.find(key);
+  if (it == nodes_.end() || it->second.count == 0) return absl::nullopt;
+  return Costs::NanoSeconds(it->second.total_nanos / it->second.count);
+}
+
+Costs::NanoSeconds MeasuredCostProfile::GetNodeTimeOr(
+    const string& graph_id, const NodeDef& node,
+    Costs::NanoSeconds fallback) const {
+  absl::optional<Costs::NanoSeconds> time = GetNodeTime(graph_id, node.name());
+  return time.has_value() ? *time : fallback;
+}
+
+Costs::NanoSeconds MeasuredCostProfile::TotalTime() const {
+  int64_t total_nanos = 0;
+  for (const auto& node : nodes_) {
+    total_nanos += node.second.total_nanos / std::max<int64_t>(
+                                                 node.second.count, 1);
+  }
+  return Costs::NanoSeconds(total_nanos);
+}
+
+string CompareMeasuredCostProfiles(const MeasuredCostProfile& before,
+                                   const MeasuredCostProfile& after,
+                                   int max_nodes) {
+  struct Row {
+    string name;
+    absl::optional<Costs::NanoSeconds> before;
+    absl::optional<Costs::NanoSeconds> after;
+  };
+  std::vector<Row> rows;
+  for (const auto& node : before.nodes_) {
+    rows.push_back(
+        {node.first, before.GetTime(node.first), after.GetTime(node.first)});
+  }
+  for (const auto& node : after.nodes_) {
+    if (before.nodes_.count(node.first)) continue;
+    rows.push_back({node.first, absl::nullopt, after.GetTime(node.first)});
+  }
+  auto sort_key = [](const Row& row) {
+    return row.before.has_value() ? row.before->count()
+                                  : row.after.value_or(0).count();
+  };
+  std::sort(rows.begin(), rows.end(), [&](const Row& a, const Row& b) {
+    if (sort_key(a) != sort_key(b)) return sort_key(a) > sort_key(b);
+    return a.name < b.name;
+  });
+
+  auto format_us = [](const absl::optional<Costs::NanoSeconds>& time) {
+    return time.has_value() ? absl::StrFormat("%.1f", time->count() / 1e3)
+                            : string("-");
+  };
+  string report = absl::StrFormat("%-60s %12s %12s\n", "Node", "Before (us)",
+                                  "After (us)");
+  const int num_rows = rows.size();
+  for (int i = 0; i < num_rows && i < max_nodes; ++i) {
+    absl::StrAppendFormat(&report, "%-60s %12s %12s\n", rows[i].name,
+                          format_us(rows[i].before), format_us(rows[i].after));
+  }
+  if (num_rows > max_nodes) {
+    absl::StrAppendFormat(&report, "... %d more nodes\n",
+                          num_rows - max_nodes);
+  }
+  const Costs::NanoSeconds total_before = before.TotalTime();
+  const Costs::NanoSeconds total_after = after.TotalTime();
+  absl::StrAppendFormat(&report, "%-60s %12s %12s\n", "Total",
+                        format_us(total_before), format_us(total_after));
+  if (total_after.count() > 0) {
+    absl::StrAppendFormat(
+        &report, "Speedup: %.3fx\n",
+        static_cast<double>(total_before.count()) / total_after.count());
+  }
+  return report;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
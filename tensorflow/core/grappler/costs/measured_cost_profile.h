@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_PROFILE_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_PROFILE_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Per-node execution times measured on a real run of a graph (e.g. collected
+// in production with RunOptions::FULL_TRACE), which optimizers can use instead
+// of static cost estimates when choosing between transformations.
+//
+// Times are averaged over all the recorded executions of each node. Only the
+// compute devices are taken into account: the per-stream and memcpy pseudo
+// devices recorded by GPU tracing are skipped to avoid double counting.
+//
+// Nodes are identified by the id of the graph they belong to (see
+// GrapplerItem::id, i.e. the function name for function bodies) and their
+// name, so that nodes with the same name in different graphs are kept apart.
+class MeasuredCostProfile {
+ public:
+  MeasuredCostProfile() = default;
+
+  // Adds the node execution stats of `step_stats`, measured on a run of the
+  // graph `graph_id`, to the profile.
+  void AddStepStats(const string& graph_id, const StepStats& step_stats);
+
+  // Loads the profile of the graph `graph_id` from a RunMetadata or StepStats
+  // proto stored (in binary or text format) in `filename`.
+  static Status FromFile(const string& filename, const string& graph_id,
+                         MeasuredCostProfile* profile);
+
+  bool empty() const { return nodes_.empty(); }
+  int num_nodes() const { return nodes_.size(); }
+
+  // Returns the average measured execution time of node `node_name` of graph
+  // `graph_id`, or nullopt if the node was not recorded.
+  absl::optional<Costs::NanoSeconds> GetNodeTime(
+      const string& graph_id, const string& node_name) const;
+
+  // Returns the average measured execution time of `node` of graph
+  // `graph_id`, or `fallback` if the node was not recorded.
+  Costs::NanoSeconds GetNodeTimeOr(const string& graph_id, const NodeDef& node,
+                                   Costs::NanoSeconds fallback) const;
+
+  // Returns the sum over all nodes of their average execution time.
+  Costs::NanoSeconds TotalTime() const;
+
+ private:
+  friend string CompareMeasuredCostProfiles(const MeasuredCostProfile& before,
+                                            const MeasuredCostProfile& after,
+                                            int max_nodes);
+
+  // Returns the average execution time of the node keyed by `key` in
+  // `nodes_`, or nullopt if there is none.
+  absl::optional<Costs::NanoSeconds> GetTime(const string& key) const;
+
+  struct NodeStats {
+    int64_t count = 0;
+    int64_t total_nanos = 0;
+  };
+  // Keyed by "<graph id>:<node name>", or just the node name if the graph id
+  // is empty. Node names never contain ':'.
+  std::unordered_map<string, NodeStats> nodes_;
+};
+
+// Returns a human readable table comparing the average per-node execution
+// times of `before` and `after`, sorted by decreasing time in `before`, with
+// the total times and speedup at the bottom. Nodes present in only one of the
+// profiles (e.g. nodes added or removed by an optimization) are listed with a
+// "-" in place of the missing time. At most `max_nodes` rows are printed.
+string CompareMeasuredCostProfiles(const MeasuredCostProfile& before,
+                                   const MeasuredCostProfile& after,
+                                   int max_nodes = 50);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_PROFILE_H_
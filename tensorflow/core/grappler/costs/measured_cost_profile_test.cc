@@ -0,0 +1,125 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_cost_profile.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void AddNode(const string& name, int64_t duration_micros,
+             DeviceStepStats* dev_stats) {
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_end_rel_micros(duration_micros);
+}
+
+StepStats MakeStepStats() {
+  StepStats step_stats;
+  DeviceStepStats* cpu = step_stats.add_dev_stats();
+  cpu->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNode("conv", 100, cpu);
+  AddNode("conv", 300, cpu);
+  AddNode("relu:Relu", 10, cpu);
+  // Stream devices duplicate the stats of the compute device.
+  DeviceStepStats* stream = step_stats.add_dev_stats();
+  stream->set_device("/device:GPU:0/stream:all");
+  AddNode("conv", 1000, stream);
+  return step_stats;
+}
+
+TEST(MeasuredCostProfileTest, AveragesNodeTimes) {
+  MeasuredCostProfile profile;
+  EXPECT_TRUE(profile.empty());
+  profile.AddStepStats("graph", MakeStepStats());
+  EXPECT_EQ(profile.num_nodes(), 2);
+  EXPECT_EQ(*profile.GetNodeTime("graph", "conv"), Costs::NanoSeconds(200000));
+  EXPECT_EQ(*profile.GetNodeTime("graph", "relu"), Costs::NanoSeconds(10000));
+  EXPECT_FALSE(profile.GetNodeTime("graph", "unknown").has_value());
+  EXPECT_EQ(profile.TotalTime(), Costs::NanoSeconds(210000));
+
+  NodeDef node;
+  node.set_name("unknown");
+  EXPECT_EQ(profile.GetNodeTimeOr("graph", node, Costs::NanoSeconds(7)),
+            Costs::NanoSeconds(7));
+}
+
+TEST(MeasuredCostProfileTest, KeepsGraphsApart) {
+  StepStats function_stats;
+  DeviceStepStats* cpu = function_stats.add_dev_stats();
+  cpu->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNode("conv", 50, cpu);
+
+  MeasuredCostProfile profile;
+  profile.AddStepStats("graph", MakeStepStats());
+  profile.AddStepStats("my_function", function_stats);
+  EXPECT_EQ(profile.num_nodes(), 3);
+  EXPECT_EQ(*profile.GetNodeTime("graph", "conv"), Costs::NanoSeconds(200000));
+  EXPECT_EQ(*profile.GetNodeTime("my_function", "conv"),
+            Costs::NanoSeconds(50000));
+  EXPECT_FALSE(profile.GetNodeTime("my_function", "relu").has_value());
+  EXPECT_FALSE(profile.GetNodeTime("other_function", "conv").has_value());
+}
+
+TEST(MeasuredCostProfileTest, LoadsRunMetadataAndStepStats) {
+  const string run_metadata_path =
+      io::JoinPath(testing::TmpDir(), "run_metadata.pb");
+  RunMetadata run_metadata;
+  *run_metadata.mutable_step_stats() = MakeStepStats();
+  TF_ASSERT_OK(
+      WriteBinaryProto(Env::Default(), run_metadata_path, run_metadata));
+  MeasuredCostProfile from_run_metadata;
+  TF_ASSERT_OK(MeasuredCostProfile::FromFile(run_metadata_path, "graph",
+                                             &from_run_metadata));
+  EXPECT_EQ(from_run_metadata.num_nodes(), 2);
+  EXPECT_TRUE(from_run_metadata.GetNodeTime("graph", "conv").has_value());
+
+  const string step_stats_path =
+      io::JoinPath(testing::TmpDir(), "step_stats.pbtxt");
+  TF_ASSERT_OK(
+      WriteTextProto(Env::Default(), step_stats_path, MakeStepStats()));
+  MeasuredCostProfile from_step_stats;
+  TF_ASSERT_OK(MeasuredCostProfile::FromFile(step_stats_path, "graph",
+                                             &from_step_stats));
+  EXPECT_EQ(from_step_stats.num_nodes(), 2);
+}
+
+TEST(MeasuredCostProfileTest, CompareProfiles) {
+  MeasuredCostProfile before;
+  before.AddStepStats("", MakeStepStats());
+
+  StepStats after_stats;
+  DeviceStepStats* cpu = after_stats.add_dev_stats();
+  cpu->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNode("fused_conv_relu", 105, cpu);
+  MeasuredCostProfile after;
+  after.AddStepStats("", after_stats);
+
+  const string report = CompareMeasuredCostProfiles(before, after);
+  EXPECT_NE(report.find("conv"), string::npos);
+  EXPECT_NE(report.find("fused_conv_relu"), string::npos);
+  EXPECT_NE(report.find("Speedup: 2.000x"), string::npos);
+  // Nodes are sorted by decreasing time in the first profile.
+  EXPECT_LT(report.find("conv "), report.find("relu "));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
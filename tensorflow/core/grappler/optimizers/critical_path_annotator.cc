@@ -0,0 +1,62 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/critical_path_annotator.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/static_schedule.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status CriticalPathAnnotator::Optimize(Cluster* cluster,
+                                       const GrapplerItem& item,
+                                       GraphDef* optimized_graph) {
+  if (cluster == nullptr) {
+    return errors::Aborted(
+        "CriticalPathAnnotator requires a cluster to estimate op costs.");
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> lengths;
+  TF_RETURN_IF_ERROR(EstimateCriticalPathLengths(item, cluster, &lengths));
+
+  *optimized_graph = item.graph;
+  int num_annotated = 0;
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    auto it = lengths.find(&item.graph.node(i));
+    if (it == lengths.end()) continue;
+    (*optimized_graph->mutable_node(i)
+          ->mutable_attr())[kSchedulingPriorityAttrName]
+        .set_i(it->second.count());
+    ++num_annotated;
+  }
+  VLOG(1) << "Annotated " << num_annotated << " of "
+          << item.graph.node_size() << " nodes with scheduling priorities.";
+
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER(CriticalPathAnnotator);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_ANNOTATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_ANNOTATOR_H_
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Annotates every node of the graph with a scheduling priority equal to the
+// predicted length (in nanoseconds) of the most expensive chain of nodes that
+// starts at the node, as estimated by the OpLevelCostEstimator. The priority
+// is stored in the kSchedulingPriorityAttrName attribute, which the executor
+// uses to dispatch nodes on the critical path before cheaper off-critical
+// branches when several nodes become ready at once.
+//
+// The graph topology is left untouched. This optimizer is disabled by default
+// and can be enabled by adding "CriticalPathAnnotator" to the custom
+// optimizers of the RewriterConfig.
+class CriticalPathAnnotator : public CustomGraphOptimizer {
+ public:
+  CriticalPathAnnotator() = default;
+  ~CriticalPathAnnotator() override = default;
+
+  string name() const override { return "critical_path_annotator"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_ANNOTATOR_H_
@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/critical_path_annotator.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+std::unique_ptr<VirtualCluster> CreateVirtualCluster() {
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  std::unordered_map<string, DeviceProperties> devices;
+  devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+  return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+}
+
+int64_t GetPriority(const GraphDef& graph, const string& node_name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == node_name) {
+      int64_t priority = -1;
+      TF_CHECK_OK(GetNodeAttr(node, kSchedulingPriorityAttrName, &priority));
+      return priority;
+    }
+  }
+  return -1;
+}
+
+TEST(CriticalPathAnnotatorTest, IsRegistered) {
+  EXPECT_NE(
+      CustomGraphOptimizerRegistry::CreateByNameOrNull("CriticalPathAnnotator"),
+      nullptr);
+}
+
+TEST(CriticalPathAnnotatorTest, CriticalBranchHasHigherPriority) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {128, 128});
+  Output m1 = ops::MatMul(s.WithOpName("m1"), a, a);
+  Output m2 = ops::MatMul(s.WithOpName("m2"), m1, m1);
+  Output c = ops::Identity(s.WithOpName("c"), a);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"m2", "c"};
+
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster();
+  CriticalPathAnnotator optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  ASSERT_EQ(output.node_size(), item.graph.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    EXPECT_EQ(output.node(i).name(), item.graph.node(i).name());
+    EXPECT_EQ(output.node(i).op(), item.graph.node(i).op());
+  }
+  EXPECT_GT(GetPriority(output, "a"), GetPriority(output, "m1"));
+  EXPECT_GT(GetPriority(output, "m1"), GetPriority(output, "c"));
+  EXPECT_GT(GetPriority(output, "c"), 0);
+}
+
+TEST(CriticalPathAnnotatorTest, RequiresCluster) {
+  GrapplerItem item;
+  CriticalPathAnnotator optimizer;
+  GraphDef output;
+  EXPECT_TRUE(
+      errors::IsAborted(optimizer.Optimize(/*cluster=*/nullptr, item, &output)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -16,9 +16,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -69,11 +71,18 @@ inline std::pair<int, int> GetNumGPUs(const Cluster& cluster) {
   return {num_gpus, num_volta};
 }
 
+// Returns true if the convolutions of type `data_type` account for at least
+// kConvGPUFP16Threshold of the convolutions placed on `device`. Convolutions
+// are weighted by their measured execution time when `profile` records any of
+// them in graph `graph_id` (unrecorded ones count as the average recorded
+// convolution), and are simply counted otherwise.
 inline bool NumConvOnDeviceWithDataTypeOverThreshold(
     const TransposeContext& context, absl::string_view device,
-    const DataType& data_type) {
-  int num_conv_gpu = 0;
-  int num_conv_gpu_fp16 = 0;
+    const DataType& data_type, const MeasuredCostProfile* profile,
+    const string& graph_id) {
+  std::vector<std::pair<bool, absl::optional<Costs::NanoSeconds>>> convs;
+  int64_t total_measured_nanos = 0;
+  int num_measured = 0;
 
   for (const auto& node : context.graph_view->GetNodes()) {
     const auto* node_def = node.node();
@@ -88,24 +97,43 @@ inline bool NumConvOnDeviceWithDataTypeOverThreshold(
                            absl::AsciiStrToLower(device))) {
       continue;
     }
-    num_conv_gpu++;
     const auto* t_attr = node.GetAttr("T");
-    if (t_attr == nullptr) {
-      continue;
+    const bool has_data_type =
+        t_attr != nullptr && t_attr->type() == data_type;
+    absl::optional<Costs::NanoSeconds> time;
+    if (profile != nullptr) {
+      time = profile->GetNodeTime(graph_id, node_def->name());
     }
-    if (t_attr->type() == data_type) {
-      num_conv_gpu_fp16++;
+    if (time.has_value()) {
+      total_measured_nanos += time->count();
+      num_measured++;
     }
+    convs.emplace_back(has_data_type, time);
   }
 
-  if (num_conv_gpu == 0) return false;
+  if (convs.empty()) return false;
+
+  const double default_weight =
+      num_measured > 0 ? static_cast<double>(total_measured_nanos) /
+                             static_cast<double>(num_measured)
+                       : 1.0;
+  double total_weight = 0.0;
+  double data_type_weight = 0.0;
+  for (const auto& conv : convs) {
+    const double weight = num_measured > 0 && conv.second.has_value()
+                              ? static_cast<double>(conv.second->count())
+                              : default_weight;
+    total_weight += weight;
+    if (conv.first) data_type_weight += weight;
+  }
+  if (total_weight <= 0.0) return false;
 
-  return (static_cast<float>(num_conv_gpu_fp16) /
-          static_cast<float>(num_conv_gpu)) >= kConvGPUFP16Threshold;
+  return (data_type_weight / total_weight) >= kConvGPUFP16Threshold;
 }
 
 inline std::pair<string, string> GetSrcAndDstDataFormats(
-    const TransposeContext& context, int num_gpus, int num_voltas) {
+    const TransposeContext& context, int num_gpus, int num_voltas,
+    const MeasuredCostProfile* profile, const string& graph_id) {
   string src_format = kNHWC;
   string dst_format = kNCHW;
 
@@ -114,7 +142,8 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
   const bool should_swap =
       ((static_cast<float>(num_voltas) / static_cast<float>(num_gpus)) >=
        kVoltaGPURatioThreshold) &&
-      NumConvOnDeviceWithDataTypeOverThreshold(context, kGPU, DT_HALF);
+      NumConvOnDeviceWithDataTypeOverThreshold(context, kGPU, DT_HALF,
+                                               profile, graph_id);
   // We swap only if NHWC is enforced or no layout is enforced and the devices
   // config meet the thresholds
   if (is_NHWC_enforced || (context.enforced_layout.empty() && should_swap)) {
@@ -435,7 +464,8 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
         /*assume_valid_feeds=*/is_aggressive, item, cluster, &context));
 
     const auto src_dst_formats = GetSrcAndDstDataFormats(
-        context, num_gpus, num_gpus_and_num_volta.second);
+        context, num_gpus, num_gpus_and_num_volta.second,
+        measured_cost_profile_.get(), item.id);
     context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
                                        src_dst_formats.second);
   } else {
@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 
+#include <memory>
 #include <string>
 
+#include "tensorflow/core/grappler/costs/measured_cost_profile.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -50,10 +52,22 @@ class GenericLayoutOptimizer : public GraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* output) override;
 
+  // Uses the execution times measured in `profile` instead of op counts when
+  // deciding which data format to convert the graph to. Nodes are looked up
+  // by the id of the optimized item and their name. This only affects GPU
+  // graphs, where DT_HALF convolutions on Volta or newer GPUs are weighted by
+  // their measured time to decide whether to keep NHWC; the CPU conversion is
+  // fixed by cpu_layout_conversion.
+  void set_measured_cost_profile(
+      std::shared_ptr<const MeasuredCostProfile> profile) {
+    measured_cost_profile_ = std::move(profile);
+  }
+
  private:
   RewriterConfig::Toggle opt_level_;
   RewriterConfig::CpuLayout cpu_layout_conversion_;
   const string enforced_layout_;
+  std::shared_ptr<const MeasuredCostProfile> measured_cost_profile_;
 };
 
 }  // namespace grappler
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -23,10 +27,12 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/clusters/single_machine.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/measured_cost_profile.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
@@ -674,6 +680,85 @@ TEST_F(GenericLayoutOptimizerTest, PreserveInputShapes) {
             output_shapes.DebugString());
 }
 
+TEST_F(GenericLayoutOptimizerTest, MeasuredProfileChangesGPULayout) {
+  // The measured profile only feeds the GPU decision of keeping a graph whose
+  // convolutions are mostly DT_HALF in NHWC on Volta, so the cluster has a
+  // Volta GPU regardless of the build.
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.mutable_environment()->insert({"architecture", "7"});
+  VirtualCluster cluster({{"/CPU:0", cpu_device}, {"/GPU:0", gpu_device}});
+  TF_ASSERT_OK(cluster.Provision());
+
+  // Two DT_HALF convolutions and a DT_FLOAT one, all in NHWC.
+  Scope scope = Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:GPU:0");
+  GrapplerItem item;
+  item.id = "main";
+  auto add_conv = [&](const string& name, DataType data_type) {
+    Output input = ops::Placeholder(
+        scope.WithOpName(name + "_input"), data_type,
+        ops::Placeholder::Shape({8, kHeight, kWidth, kDepthIn}));
+    Output filter = ops::Placeholder(
+        scope.WithOpName(name + "_filter"), data_type,
+        ops::Placeholder::Shape({kKernel, kKernel, kDepthIn, kDepthOut}));
+    Output conv = ops::Conv2D(scope.WithOpName(name), input, filter,
+                              {1, 1, 1, 1}, "SAME",
+                              ops::Conv2D::Attrs().DataFormat("NHWC"));
+    ops::Identity(scope.WithOpName(name + "_output"), conv);
+    item.fetch.push_back(name + "_output");
+  };
+  add_conv("conv_half_0", DT_HALF);
+  add_conv("conv_half_1", DT_HALF);
+  add_conv("conv_float", DT_FLOAT);
+  TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
+
+  auto conv_data_format = [](const GraphDef& graph) {
+    Status status;
+    utils::GraphView graph_view(&graph, &status);
+    TF_CHECK_OK(status);
+    const auto* conv = graph_view.GetNode("conv_float");
+    CHECK(conv != nullptr);
+    return conv->GetAttr("data_format")->s();
+  };
+
+  // Counted, most convolutions are DT_HALF: the graph stays in NHWC.
+  GenericLayoutOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+  EXPECT_EQ(conv_data_format(output), "NHWC");
+
+  // Measured, the DT_FLOAT convolution dominates: the graph is converted to
+  // NCHW.
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:GPU:0");
+  for (const auto& conv_time : std::vector<std::pair<string, int64_t>>{
+           {"conv_half_0", 10}, {"conv_half_1", 10}, {"conv_float", 100}}) {
+    NodeExecStats* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name(conv_time.first);
+    node_stats->set_all_end_rel_micros(conv_time.second);
+  }
+  auto profile = std::make_shared<MeasuredCostProfile>();
+  profile->AddStepStats(item.id, step_stats);
+  optimizer.set_measured_cost_profile(profile);
+  output.Clear();
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+  EXPECT_EQ(conv_data_format(output), "NCHW");
+
+  // The profile of another graph is ignored.
+  auto other_profile = std::make_shared<MeasuredCostProfile>();
+  other_profile->AddStepStats("other", step_stats);
+  optimizer.set_measured_cost_profile(other_profile);
+  output.Clear();
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+  EXPECT_EQ(conv_data_format(output), "NHWC");
+
+  TF_ASSERT_OK(cluster.Shutdown());
+}
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
@@ -0,0 +1,113 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/graph_optimization_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+constexpr char kEntrySuffix[] = ".graph.pb";
+}  // namespace
+
+void GraphOptimizationCache::KeyBuilder::AddString(StringPiece s) {
+  // Mix in the length first, so that ("ab", "c") and ("a", "bc") differ.
+  AddInt(s.size());
+  const Fprint128 fp = Fingerprint128(s);
+  fingerprint_.low64 = FingerprintCat64(fingerprint_.low64, fp.low64);
+  fingerprint_.high64 = FingerprintCat64(fingerprint_.high64, fp.high64);
+}
+
+void GraphOptimizationCache::KeyBuilder::AddInt(int64_t value) {
+  fingerprint_.low64 =
+      FingerprintCat64(fingerprint_.low64, static_cast<uint64>(value));
+  fingerprint_.high64 =
+      FingerprintCat64(fingerprint_.high64, ~static_cast<uint64>(value));
+}
+
+void GraphOptimizationCache::KeyBuilder::AddProto(
+    const protobuf::MessageLite& proto) {
+  string serialized;
+  if (!SerializeToStringDeterministic(proto, &serialized)) {
+    // Fall back to a (possibly non-deterministic) serialization; at worst this
+    // causes a cache miss.
+    serialized = proto.SerializeAsString();
+  }
+  AddString(serialized);
+}
+
+void GraphOptimizationCache::KeyBuilder::AddFunctionLibrary(
+    const FunctionLibraryDefinition& flib) {
+  std::vector<string> names = flib.ListFunctionNames();
+  std::sort(names.begin(), names.end());
+  AddInt(names.size());
+  for (const string& name : names) {
+    AddProto(*flib.Find(name));
+    const string grad = flib.FindGradient(name);
+    if (!grad.empty()) AddString(grad);
+  }
+}
+
+string GraphOptimizationCache::KeyBuilder::Key() const {
+  return absl::StrCat(absl::Hex(fingerprint_.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint_.low64, absl::kZeroPad16));
+}
+
+GraphOptimizationCache::GraphOptimizationCache(const string& cache_dir,
+                                               Env* env)
+    : cache_dir_(cache_dir), env_(env) {}
+
+string GraphOptimizationCache::EntryPath(const string& key) const {
+  return io::JoinPath(cache_dir_, absl::StrCat(key, kEntrySuffix));
+}
+
+bool GraphOptimizationCache::Lookup(const string& key, GraphDef* graph) const {
+  const string path = EntryPath(key);
+  if (!env_->FileExists(path).ok()) return false;
+  Status status = ReadBinaryProto(env_, path, graph);
+  if (!status.ok()) {
+    VLOG(1) << "Ignoring unreadable graph optimization cache entry " << path
+            << ": " << status;
+    graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+Status GraphOptimizationCache::Insert(const string& key,
+                                      const GraphDef& graph) const {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(cache_dir_));
+  string tmp_path = io::JoinPath(cache_dir_, absl::StrCat(key, "_"));
+  if (!env_->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name in ",
+                            cache_dir_);
+  }
+  Status status = WriteBinaryProto(env_, tmp_path, graph);
+  if (status.ok()) status = env_->RenameFile(tmp_path, EntryPath(key));
+  if (!status.ok()) env_->DeleteFile(tmp_path).IgnoreError();
+  return status;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
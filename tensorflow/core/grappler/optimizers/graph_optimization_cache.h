@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GRAPH_OPTIMIZATION_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GRAPH_OPTIMIZATION_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A content-addressed cache of optimized graphs stored in a local directory.
+// Every entry is a binary GraphDef stored in a file named after its key, so
+// several processes (e.g. replicas of a model server starting up on the same
+// host) can share a cache directory. Entries are written to a temporary file
+// and atomically renamed into place; a concurrent reader either sees a
+// complete entry or no entry at all.
+//
+// The cache does not know what the key was computed from: callers are
+// responsible for mixing everything that may affect the optimized graph (the
+// input graph, the functions it calls, the devices and the optimizer config)
+// into the key with a KeyBuilder.
+class GraphOptimizationCache {
+ public:
+  // Accumulates a 128-bit fingerprint of a sequence of strings and protos.
+  // The result depends on the order of the Add* calls.
+  class KeyBuilder {
+   public:
+    KeyBuilder() : fingerprint_{0, 0} {}
+
+    void AddString(StringPiece s);
+    void AddInt(int64_t value);
+    // Protos are serialized deterministically, so that maps with the same
+    // contents produce the same key.
+    void AddProto(const protobuf::MessageLite& proto);
+    // Adds all the functions of `flib` in the order of their names.
+    void AddFunctionLibrary(const FunctionLibraryDefinition& flib);
+
+    // Returns the key as a 32 character hex string.
+    string Key() const;
+
+   private:
+    Fprint128 fingerprint_;
+  };
+
+  explicit GraphOptimizationCache(const string& cache_dir,
+                                  Env* env = Env::Default());
+
+  // Returns true and fills `graph` if an entry for `key` exists and can be
+  // parsed. Unreadable entries are treated as misses.
+  bool Lookup(const string& key, GraphDef* graph) const;
+
+  // Stores `graph` under `key`, replacing an existing entry if any.
+  Status Insert(const string& key, const GraphDef& graph) const;
+
+  const string& cache_dir() const { return cache_dir_; }
+
+ private:
+  string EntryPath(const string& key) const;
+
+  const string cache_dir_;
+  Env* const env_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GRAPH_OPTIMIZATION_CACHE_H_
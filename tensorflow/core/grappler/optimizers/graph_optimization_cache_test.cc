@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/graph_optimization_cache.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+TEST(GraphOptimizationCacheTest, KeyDependsOnContentsAndOrder) {
+  GraphOptimizationCache::KeyBuilder a;
+  a.AddString("ab");
+  a.AddString("c");
+
+  GraphOptimizationCache::KeyBuilder b;
+  b.AddString("a");
+  b.AddString("bc");
+
+  GraphOptimizationCache::KeyBuilder c;
+  c.AddString("ab");
+  c.AddString("c");
+
+  EXPECT_EQ(a.Key().size(), 32);
+  EXPECT_NE(a.Key(), b.Key());
+  EXPECT_EQ(a.Key(), c.Key());
+}
+
+TEST(GraphOptimizationCacheTest, FunctionLibraryKeyIgnoresInsertionOrder) {
+  FunctionDefLibrary library;
+  *library.add_function() = test::function::XTimesTwo();
+  *library.add_function() = test::function::XTimesFour();
+  FunctionLibraryDefinition flib(OpRegistry::Global(), library);
+
+  FunctionDefLibrary reversed_library;
+  *reversed_library.add_function() = test::function::XTimesFour();
+  *reversed_library.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition reversed_flib(OpRegistry::Global(),
+                                          reversed_library);
+
+  GraphOptimizationCache::KeyBuilder key;
+  key.AddFunctionLibrary(flib);
+  GraphOptimizationCache::KeyBuilder reversed_key;
+  reversed_key.AddFunctionLibrary(reversed_flib);
+  EXPECT_EQ(key.Key(), reversed_key.Key());
+
+  FunctionLibraryDefinition other_flib(OpRegistry::Global(),
+                                       FunctionDefLibrary());
+  TF_ASSERT_OK(other_flib.AddFunctionDef(test::function::XTimesTwo()));
+  GraphOptimizationCache::KeyBuilder other_key;
+  other_key.AddFunctionLibrary(other_flib);
+  EXPECT_NE(key.Key(), other_key.Key());
+}
+
+TEST(GraphOptimizationCacheTest, InsertAndLookup) {
+  GraphOptimizationCache cache(
+      io::JoinPath(testing::TmpDir(), "graph_optimization_cache_test"));
+
+  GraphDef graph;
+  TF_ASSERT_OK(NodeDefBuilder("x", "Placeholder")
+                   .Attr("dtype", DT_FLOAT)
+                   .Finalize(graph.add_node()));
+
+  GraphOptimizationCache::KeyBuilder key;
+  key.AddProto(graph);
+
+  GraphDef cached;
+  EXPECT_FALSE(cache.Lookup(key.Key(), &cached));
+  TF_ASSERT_OK(cache.Insert(key.Key(), graph));
+  ASSERT_TRUE(cache.Lookup(key.Key(), &cached));
+  EXPECT_EQ(cached.DebugString(), graph.DebugString());
+
+  // Entries are overwritten by later inserts.
+  graph.mutable_node(0)->set_name("y");
+  TF_ASSERT_OK(cache.Insert(key.Key(), graph));
+  ASSERT_TRUE(cache.Lookup(key.Key(), &cached));
+  EXPECT_EQ(cached.node(0).name(), "y");
+
+  // Unreadable entries are cache misses.
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(),
+      io::JoinPath(cache.cache_dir(), absl::StrCat(key.Key(), ".graph.pb")),
+      "not a graph"));
+  EXPECT_FALSE(cache.Lookup(key.Key(), &cached));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
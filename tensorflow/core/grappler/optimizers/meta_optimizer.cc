@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
@@ -59,6 +60,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
@@ -220,10 +224,15 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("remap", "remapping",
          new Remapper(cfg_.remapping(), cfg_.cpu_layout_conversion(),
                       xla_auto_clustering_on_));
-  MK_OPT("layout", "layout_optimizer",
-         new GenericLayoutOptimizer(
-             /*optimization level*/ cfg_.layout_optimizer(),
-             /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
+  if (optimizer == "layout" &&
+      (plugin_configs.toggle_config["layout_optimizer"] !=
+       RewriterConfig::OFF)) {
+    auto layout_optimizer = std::make_unique<GenericLayoutOptimizer>(
+        /*optimization level*/ cfg_.layout_optimizer(),
+        /*CPU layout conversion*/ cfg_.cpu_layout_conversion());
+    layout_optimizer->set_measured_cost_profile(measured_cost_profile_);
+    return layout_optimizer;
+  }
   MK_OPT("auto_mixed_precision", "auto_mixed_precision",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CUDA));
 #ifdef INTEL_MKL
@@ -267,6 +276,15 @@ MetaOptimizer::MetaOptimizer(DeviceBase* cpu_device, const ConfigProto& cfg)
   auto global_jit_level =
       cfg.graph_options().optimizer_options().global_jit_level();
   xla_auto_clustering_on_ = IsXlaGlobalJitOn(global_jit_level);
+  if (!cfg_.experimental_optimization_cache_dir().empty()) {
+    optimization_cache_ = std::make_unique<GraphOptimizationCache>(
+        cfg_.experimental_optimization_cache_dir());
+  }
+  if (cfg_.experimental_function_optimization_threads() > 1) {
+    function_optimization_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_optimizer",
+        cfg_.experimental_function_optimization_threads());
+  }
 }
 
 Status MetaOptimizer::InitializeOptimizers(
@@ -402,9 +420,11 @@ Status MetaOptimizer::InitializeOptimizers(
         USER_IS_EXPERIMENTAL_BOTH(layout_optimizer)) {
       VLOG(2) << "layout_optimizer is not implemented in TFG yet";
     } else {
-      optimizers->push_back(MakeUnique<GenericLayoutOptimizer>(
+      auto layout_optimizer = MakeUnique<GenericLayoutOptimizer>(
           /*optimization level*/ cfg_.layout_optimizer(),
-          /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
+          /*CPU layout conversion*/ cfg_.cpu_layout_conversion());
+      layout_optimizer->set_measured_cost_profile(measured_cost_profile_);
+      optimizers->push_back(std::move(layout_optimizer));
     }
   }
   if (BOTH_NOT_OFF(remapping)) {
@@ -851,7 +871,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1010,6 +1033,70 @@ void PropagateTFDataAttrs(const FunctionLibraryDefinition& flib,
   }
 }
 
+void MetaOptimizer::AddConfigToCacheKey(
+    const Cluster* cluster, GraphOptimizationCache::KeyBuilder* key) const {
+  key->AddString(TF_VERSION_STRING);
+  key->AddInt(TF_GRAPH_DEF_VERSION);
+
+  // The cache location itself doesn't affect the optimized graph.
+  ConfigProto config = config_proto_;
+  config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_experimental_optimization_cache_dir();
+  key->AddProto(config);
+  key->AddInt(cpu_device_ != nullptr);
+
+  // The profile is referenced by path in the config; also mix in a summary of
+  // its contents in case the file was overwritten with a new measurement.
+  if (measured_cost_profile_ != nullptr) {
+    key->AddInt(measured_cost_profile_->num_nodes());
+    key->AddInt(measured_cost_profile_->TotalTime().count());
+  }
+
+  if (cluster != nullptr) {
+    std::vector<string> device_names = cluster->GetDeviceNames();
+    std::sort(device_names.begin(), device_names.end());
+    key->AddInt(device_names.size());
+    for (const string& device_name : device_names) {
+      key->AddString(device_name);
+      const DeviceProperties* properties =
+          gtl::FindOrNull(cluster->GetDevices(), device_name);
+      if (properties != nullptr) key->AddProto(*properties);
+    }
+  }
+}
+
+bool MetaOptimizer::OptimizersSucceeded(absl::string_view item_id) const {
+  mutex_lock l(optimization_results_mu_);
+  for (const GraphOptimizationResult& graph_result : optimization_results_) {
+    if (!item_id.empty() && graph_result.id != item_id) continue;
+    for (const OptimizerResult& result : graph_result.results) {
+      if (!result.status.ok()) return false;
+    }
+  }
+  return true;
+}
+
+void MetaOptimizer::LoadMeasuredCostProfile(const string& graph_id) {
+  const string& path = cfg_.experimental_measured_profile_path();
+  if (path.empty() || (measured_cost_profile_ != nullptr &&
+                        measured_cost_profile_graph_id_ == graph_id)) {
+    return;
+  }
+  measured_cost_profile_graph_id_ = graph_id;
+  measured_cost_profile_ = nullptr;
+
+  auto profile = std::make_shared<MeasuredCostProfile>();
+  Status status = MeasuredCostProfile::FromFile(path, graph_id, profile.get());
+  if (status.ok()) {
+    VLOG(1) << "Loaded measured cost profile with " << profile->num_nodes()
+            << " nodes from " << path;
+    measured_cost_profile_ = std::move(profile);
+  } else {
+    LOG(WARNING) << "Failed to load measured cost profile: " << status;
+  }
+}
+
 Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                                           GraphDef* optimized_graph) {
   tensorflow::metrics::ScopedCounter<2> timings(
@@ -1019,6 +1106,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
   optimization_results_.clear();
 
+  // The measured profile holds the times of the nodes of the main graph, and
+  // none of the functions it calls.
+  LoadMeasuredCostProfile(item.id);
+
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
   const auto minimized_flib =
@@ -1046,6 +1137,61 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       item.optimization_options().optimize_function_library;
   const auto producer = item.graph.versions().producer();
 
+  // Look up the whole optimized graph in the cache. The key covers the graph
+  // and every field of the item that optimizers look at.
+  GraphOptimizationCache::KeyBuilder config_key;
+  string graph_cache_key;
+  if (optimization_cache_ != nullptr) {
+    AddConfigToCacheKey(cluster, &config_key);
+
+    GraphOptimizationCache::KeyBuilder key = config_key;
+    key.AddString("graph");
+    // Functions are added in a canonical order below, rather than in the
+    // (unspecified) order of the minimized library.
+    FunctionDefLibrary library;
+    library.Swap(item.graph.mutable_library());
+    key.AddProto(item.graph);
+    library.Swap(item.graph.mutable_library());
+    key.AddFunctionLibrary(minimized_flib(item.graph));
+
+    const auto add_strings = [&key](const std::vector<string>& strings) {
+      key.AddInt(strings.size());
+      for (const string& s : strings) key.AddString(s);
+    };
+    add_strings(item.fetch);
+    add_strings(item.init_ops);
+    add_strings(item.keep_ops);
+    key.AddInt(item.feed.size());
+    for (const auto& feed : item.feed) {
+      key.AddString(feed.first);
+      key.AddInt(feed.second.dtype());
+      key.AddString(feed.second.shape().DebugString());
+    }
+    key.AddString(item.save_op);
+    key.AddString(item.restore_op);
+    key.AddString(item.save_restore_loc_tensor);
+    key.AddInt(item.queue_runners.size());
+    for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+      key.AddProto(queue_runner);
+    }
+    std::vector<string> devices(item.devices().begin(), item.devices().end());
+    std::sort(devices.begin(), devices.end());
+    add_strings(devices);
+    const GrapplerItem::OptimizationOptions& options =
+        item.optimization_options();
+    key.AddInt(options.allow_non_differentiable_rewrites);
+    key.AddInt(options.allow_pruning_stateful_and_dataset_ops);
+    key.AddInt(options.optimize_function_library);
+    key.AddInt(options.is_eager_mode);
+    graph_cache_key = key.Key();
+
+    if (optimization_cache_->Lookup(graph_cache_key, optimized_graph)) {
+      VLOG(1) << "Found optimized graph for grappler item " << item.id
+              << " in cache: " << graph_cache_key;
+      return OkStatus();
+    }
+  }
+
   // 1. Optimize main graph
   TF_RETURN_IF_ERROR(
       OptimizeGraph(cluster, GrapplerItem(item), optimized_graph));
@@ -1126,15 +1272,131 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of a single function. With a function optimization
+  // pool it is called concurrently for all the functions of one pass over the
+  // library, so it must not modify `flib` or any other shared state.
+  const auto optimize_function = [&](const FunctionDef& func,
+                                     GrapplerFunctionItem* func_item,
+                                     GraphDef* optimized_func_graph) -> Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+
+    // Function bodies are cached separately, so that unchanged functions are
+    // reused even if the main graph changed. The optimized body depends only
+    // on the function, the functions it calls and the restrictions set above.
+    string func_cache_key;
+    if (optimization_cache_ != nullptr) {
+      GraphOptimizationCache::KeyBuilder key = config_key;
+      key.AddString("function");
+      key.AddProto(func);
+      key.AddFunctionLibrary(flib.ReachableDefinitions(func));
+      key.AddInt(producer);
+      key.AddInt(
+          func_item->optimization_options().allow_non_differentiable_rewrites);
+      func_cache_key = key.Key();
+
+      if (optimization_cache_->Lookup(func_cache_key, optimized_func_graph)) {
+        VLOG(2) << "Found optimized function " << func_name
+                << " in cache: " << func_cache_key;
+        return OkStatus();
+      }
+    }
+
+    GrapplerFunctionItem func_item_copy = *func_item;
+    TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                     optimized_func_graph));
+    if (!func_cache_key.empty() && OptimizersSucceeded(func_item->id)) {
+      Status status =
+          optimization_cache_->Insert(func_cache_key, *optimized_func_graph);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to cache optimized function " << func_name
+                     << ": " << status;
+      }
+    }
+    return OkStatus();
+  };
+
+  // Adds the optimized body of a function to `flib`, together with the new
+  // specialized functions it calls.
+  const auto replace_function = [&](const string& func_name,
+                                    GrapplerFunctionItem* func_item,
+                                    GraphDef* optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph->library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item->SwapFunctionBody(std::move(*optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(*func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Collect the functions to optimize in this pass.
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1155,92 +1417,77 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       if (data::IsTFDataFunction(func)) continue;
 
       VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
+              << funcs.size() << " of "
               << optimized_graph->library().function_size() << "]";
 
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
-
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+      funcs.push_back(&func);
+    }
+    if (funcs.empty()) break;
+
+    if (function_optimization_pool_ == nullptr) {
+      // Each function is replaced right after it is optimized, so functions
+      // see the optimized bodies of the functions before them in the library.
+      for (const FunctionDef* func : funcs) {
+        GrapplerFunctionItem func_item;
+        GraphDef optimized_func_graph;
+        TF_RETURN_IF_ERROR(
+            optimize_function(*func, &func_item, &optimized_func_graph));
+        TF_RETURN_IF_ERROR(replace_function(func->signature().name(),
+                                            &func_item, &optimized_func_graph));
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+    } else {
+      // All functions of a pass are optimized against the same snapshot of
+      // the library, and the results are merged back in library order, so
+      // the optimized graph does not depend on the number of threads.
+      //
+      // Each task creates its own optimizers, but all of them share `cluster`
+      // and `cpu_device_`. This is safe for the built-in optimizers: they only
+      // read the devices of the cluster, which are fixed once it is
+      // provisioned, and constant folding runs kernels on the CPU device,
+      // which devices support concurrently. Custom optimizers must be
+      // thread-safe in the same way when this option is enabled.
+      const int num_funcs = funcs.size();
+      const size_t first_result = optimization_results_.size();
+      std::vector<GrapplerFunctionItem> func_items(num_funcs);
+      std::vector<GraphDef> optimized_func_graphs(num_funcs);
+      std::vector<Status> statuses(num_funcs);
+      BlockingCounter counter(num_funcs);
+      for (int i = 0; i < num_funcs; ++i) {
+        function_optimization_pool_->Schedule([&, i]() {
+          statuses[i] = optimize_function(*funcs[i], &func_items[i],
+                                          &optimized_func_graphs[i]);
+          counter.DecrementCount();
+        });
       }
+      counter.Wait();
+      for (const Status& status : statuses) TF_RETURN_IF_ERROR(status);
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
-        }
+      // Keep the per-function optimization results in library order.
+      absl::flat_hash_map<string, int> func_index;
+      for (int i = 0; i < num_funcs; ++i) {
+        func_index[funcs[i]->signature().name()] = i;
+      }
+      std::stable_sort(optimization_results_.begin() + first_result,
+                       optimization_results_.end(),
+                       [&](const GraphOptimizationResult& a,
+                           const GraphOptimizationResult& b) {
+                         return gtl::FindWithDefault(func_index, a.id, -1) <
+                                gtl::FindWithDefault(func_index, b.id, -1);
+                       });
+
+      for (int i = 0; i < num_funcs; ++i) {
+        TF_RETURN_IF_ERROR(replace_function(funcs[i]->signature().name(),
+                                            &func_items[i],
+                                            &optimized_func_graphs[i]));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
-    // If optimized at least one function, update the graph library.
-    if (optimize_function_library) {
-      *optimized_graph->mutable_library() = flib.ToProto();
-    }
+    // Update the graph library with the optimized functions.
+    *optimized_graph->mutable_library() = flib.ToProto();
   }
 
   // Run module-level TFG optimizations at the end of the meta-optimizer.
@@ -1268,6 +1515,15 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   }
 #endif
 
+  if (!graph_cache_key.empty() && OptimizersSucceeded(/*item_id=*/"")) {
+    Status status =
+        optimization_cache_->Insert(graph_cache_key, *optimized_graph);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to cache optimized graph for grappler item "
+                   << item.id << ": " << status;
+    }
+  }
+
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
@@ -16,14 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/costs/measured_cost_profile.h"
+#include "tensorflow/core/grappler/optimizers/graph_optimization_cache.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -97,10 +102,32 @@ class MetaOptimizer : public GraphOptimizer {
   Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                        GraphDef* optimized_graph);
 
+  // Adds everything besides the input graph that affects the result of the
+  // optimization (config, devices, TF version) to a cache key.
+  void AddConfigToCacheKey(const Cluster* cluster,
+                           GraphOptimizationCache::KeyBuilder* key) const;
+  // Returns true if no optimizer failed or ran out of time while optimizing
+  // the GrapplerItem with the given id, or any item if `item_id` is empty.
+  // Results of failed optimizations are not cached.
+  bool OptimizersSucceeded(absl::string_view item_id) const;
+  // Loads cfg_.experimental_measured_profile_path as the profile of the graph
+  // `graph_id`, unless it was already loaded for that graph.
+  void LoadMeasuredCostProfile(const string& graph_id);
+
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
   bool xla_auto_clustering_on_;
+  // Loaded from cfg_.experimental_measured_profile_path for the main graph
+  // `measured_cost_profile_graph_id_`; null if not set.
+  std::shared_ptr<const MeasuredCostProfile> measured_cost_profile_;
+  string measured_cost_profile_graph_id_;
+  // Created from cfg_.experimental_optimization_cache_dir; null if not set.
+  std::unique_ptr<GraphOptimizationCache> optimization_cache_;
+  // Optimizes the function library in parallel if
+  // cfg_.experimental_function_optimization_threads is greater than 1; null
+  // otherwise.
+  std::unique_ptr<thread::ThreadPool> function_optimization_pool_;
 
   struct OptimizerResult {
     string optimizer_name;
@@ -118,6 +145,8 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Functions might be optimized concurrently, and record their results here.
+  mutable mutex optimization_results_mu_;
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
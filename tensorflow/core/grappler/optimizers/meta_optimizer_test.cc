@@ -18,12 +18,15 @@ limitations under the License.
 #include <atomic>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
@@ -32,8 +35,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
@@ -218,6 +223,43 @@ TEST_F(MetaOptimizerTest, RunsPluginOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  // A fresh directory, so that no cache from another run is picked up.
+  string cache_dir;
+  ASSERT_TRUE(Env::Default()->LocalTempFilename(&cache_dir));
+  rewriter_config.set_experimental_optimization_cache_dir(cache_dir);
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  MetaOptimizer optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  // The same graph and config are served from the cache.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  MetaOptimizer cached_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(cached_optimizer.Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different config is a cache miss.
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer other_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(other_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+}
+
 TEST_F(MetaOptimizerTest, RunOptimizersTwice) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -703,6 +745,196 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
       optimization_options_my_mul_2->allow_non_differentiable_rewrites);
 }
 
+// Returns a graph calling `num_functions` distinct non-inlinable functions,
+// each of them calling a shared inlinable function.
+GrapplerItem MakeGraphWithManyFunctions(int num_functions) {
+  using test::function::NDef;
+
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  std::vector<FunctionDef> funcs = {mul_func};
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < num_functions; ++i) {
+    const string name = absl::StrCat("MySquare_", i);
+    FunctionDef square_func = FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {},
+        {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", DT_FLOAT}}},
+         {{"neg"}, "Neg", {"my_mul:z:0"}, {{"T", DT_FLOAT}}},
+         {{"neg_neg"}, "Neg", {"neg:y:0"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "neg_neg:y:0"}});
+    (*square_func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(square_func);
+    nodes.push_back(
+        NDef(absl::StrCat("square_", i), name, {"a"}, {}, kDevice));
+  }
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+  for (int i = 0; i < num_functions; ++i) {
+    item.fetch.push_back(absl::StrCat("square_", i));
+  }
+  return item;
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryIsDeterministic) {
+  GrapplerItem item = MakeGraphWithManyFunctions(32);
+
+  const auto optimize = [&item](int num_threads) -> GraphDef {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_experimental_function_optimization_threads(
+        num_threads);
+
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    return output;
+  };
+
+  GraphDef sequential = optimize(1);
+  GraphDef parallel = optimize(8);
+
+  // The functions don't call each other, so the result must not depend on
+  // the number of threads.
+  CompareGraphs(sequential, parallel);
+  FunctionLibraryDefinition sequential_flib(OpRegistry::Global(),
+                                            sequential.library());
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel.library());
+  for (int i = 0; i < 32; ++i) {
+    const string name = absl::StrCat("MySquare_", i);
+    const FunctionDef* sequential_func = sequential_flib.Find(name);
+    const FunctionDef* parallel_func = parallel_flib.Find(name);
+    ASSERT_NE(sequential_func, nullptr);
+    ASSERT_NE(parallel_func, nullptr);
+
+    // MyMul should be inlined into every function.
+    for (const NodeDef& node : parallel_func->node_def()) {
+      EXPECT_NE(node.op(), "MyMul");
+    }
+    CompareFunctions(*sequential_func, *parallel_func);
+  }
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithSharedClusterAndDevice) {
+  using test::function::NDef;
+  constexpr int kNumFunctions = 16;
+
+  // Every function has a constant subexpression, which constant folding
+  // evaluates on the CPU device.
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string name = absl::StrCat("MyScale_", i);
+    FunctionDef scale_func = FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {},
+        {FunctionDefHelper::Const("two", 2.0f),
+         FunctionDefHelper::Const("factor", static_cast<float>(i)),
+         {{"scale"},
+          "Mul",
+          {"two:output:0", "factor:output:0"},
+          {{"T", DT_FLOAT}}},
+         {{"scaled"}, "Mul", {"x", "scale:z:0"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "scaled:z:0"}});
+    (*scale_func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(scale_func);
+    nodes.push_back(NDef(absl::StrCat("scale_", i), name, {"a"}, {}, kDevice));
+  }
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+  for (int i = 0; i < kNumFunctions; ++i) {
+    item.fetch.push_back(absl::StrCat("scale_", i));
+  }
+
+  std::unique_ptr<Device> cpu_device = DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0");
+  ASSERT_NE(cpu_device, nullptr);
+  DeviceProperties cpu_properties;
+  cpu_properties.set_type("CPU");
+  VirtualCluster cluster({{"/job:localhost/replica:0/task:0/device:CPU:0",
+                           cpu_properties}});
+  TF_ASSERT_OK(cluster.Provision());
+
+  const auto optimize = [&](int num_threads) -> GraphDef {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_experimental_function_optimization_threads(
+        num_threads);
+
+    MetaOptimizer optimizer(cpu_device.get(), config_proto);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+    return output;
+  };
+
+  GraphDef sequential = optimize(1);
+  GraphDef parallel = optimize(8);
+
+  CompareGraphs(sequential, parallel);
+  FunctionLibraryDefinition sequential_flib(OpRegistry::Global(),
+                                            sequential.library());
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel.library());
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string name = absl::StrCat("MyScale_", i);
+    const FunctionDef* sequential_func = sequential_flib.Find(name);
+    const FunctionDef* parallel_func = parallel_flib.Find(name);
+    ASSERT_NE(sequential_func, nullptr);
+    ASSERT_NE(parallel_func, nullptr);
+
+    // Only the multiplication by the input is left.
+    int num_muls = 0;
+    for (const NodeDef& node : parallel_func->node_def()) {
+      if (node.op() == "Mul") ++num_muls;
+    }
+    EXPECT_EQ(num_muls, 1);
+    CompareFunctions(*sequential_func, *parallel_func);
+  }
+  TF_EXPECT_OK(cluster.Shutdown());
+}
+
+static void BM_OptimizeFunctionLibrary(::testing::benchmark::State& state) {
+  const int num_functions = state.range(0);
+  const int num_threads = state.range(1);
+  GrapplerItem item = MakeGraphWithManyFunctions(num_functions);
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_experimental_function_optimization_threads(num_threads);
+
+  for (auto s : state) {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+  state.SetItemsProcessed(state.iterations() * num_functions);
+}
+
+BENCHMARK(BM_OptimizeFunctionLibrary)
+    ->UseRealTime()
+    ->ArgPair(100, 1)
+    ->ArgPair(100, 4)
+    ->ArgPair(100, 16)
+    ->ArgPair(500, 1)
+    ->ArgPair(500, 4)
+    ->ArgPair(500, 16);
+
 class SleepingOptimizer : public CustomGraphOptimizer {
  public:
   SleepingOptimizer() {}
@@ -199,5 +199,66 @@ Status EstimateRequiredTimes(
   return OkStatus();
 }
 
+Status EstimateCriticalPathLengths(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>*
+        critical_path_lengths) {
+  std::unordered_map<string, const NodeDef*> name_map;
+  for (const NodeDef& node : item.graph.node()) {
+    name_map[node.name()] = &node;
+  }
+
+  std::unordered_map<const NodeDef*, int> pending_fanouts;
+  for (const NodeDef& node : item.graph.node()) {
+    for (const string& input : node.input()) {
+      string node_name = NodeName(input);
+      auto it = name_map.find(node_name);
+      if (it == name_map.end()) {
+        return errors::InvalidArgument(
+            strings::StrCat("Unknown input node ", input));
+      }
+      const NodeDef* fanin = it->second;
+      pending_fanouts[fanin] += 1;
+    }
+  }
+  // Nodes are visited in reverse topological order, starting from the sinks.
+  // Nodes in a cycle never run out of pending fanouts and are never visited.
+  std::deque<const NodeDef*> ready_nodes;
+  for (const NodeDef& node : item.graph.node()) {
+    if (pending_fanouts[&node] == 0) {
+      ready_nodes.push_back(&node);
+    }
+  }
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+  OpLevelCostEstimator estimator;
+  VirtualPlacer placer(cluster->GetDevices());
+
+  // Length of the longest path among the fanouts of each node visited so far.
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> fanout_lengths;
+  while (!ready_nodes.empty()) {
+    const NodeDef* node = ready_nodes.front();
+    ready_nodes.pop_front();
+
+    Costs::NanoSeconds execution_time =
+        PredictExecutionTime(properties, estimator, placer, *node);
+    Costs::NanoSeconds length = execution_time + fanout_lengths[node];
+    (*critical_path_lengths)[node] = length;
+
+    for (const string& fanin_name : node->input()) {
+      const NodeDef* fanin = name_map[NodeName(fanin_name)];
+      fanout_lengths[fanin] = std::max(fanout_lengths[fanin], length);
+      if (--pending_fanouts[fanin] == 0) {
+        ready_nodes.push_back(fanin);
+      }
+    }
+  }
+
+  return OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
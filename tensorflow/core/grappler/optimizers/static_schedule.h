@@ -44,6 +44,17 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Compute, for each node in the graph, the length of the longest path from the
+// start of the execution of the node to the end of the execution of the graph,
+// i.e. the sum of the predicted execution times of the nodes along the most
+// expensive chain of fanouts starting at the node. Nodes on the critical path of
+// the graph have the largest values among their siblings. Nodes that belong to
+// a cycle (e.g. while loops) are not assigned any value.
+Status EstimateCriticalPathLengths(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>*
+        critical_path_lengths);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
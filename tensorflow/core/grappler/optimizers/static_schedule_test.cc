@@ -196,6 +196,34 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
                                       "Sign_2", "Sign_3", "y"}));
 }
 
+TEST_F(StaticScheduleTest, CriticalPathLengths) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // A cheap branch (c) and an expensive branch (m1 -> m2) fanning out of a.
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {128, 128});
+  Output m1 = ops::MatMul(s.WithOpName("m1"), a, a);
+  Output m2 = ops::MatMul(s.WithOpName("m2"), m1, m1);
+  Output c = ops::Identity(s.WithOpName("c"), a);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> lengths;
+  TF_EXPECT_OK(EstimateCriticalPathLengths(item, cluster.get(), &lengths));
+  EXPECT_EQ(item.graph.node_size(), lengths.size());
+
+  std::unordered_map<string, Costs::NanoSeconds> lengths_by_name;
+  for (const auto& node_length : lengths) {
+    lengths_by_name[node_length.first->name()] = node_length.second;
+  }
+  EXPECT_GT(lengths_by_name["a"], lengths_by_name["m1"]);
+  EXPECT_GT(lengths_by_name["m1"], lengths_by_name["m2"]);
+  EXPECT_GT(lengths_by_name["m1"], lengths_by_name["c"]);
+  EXPECT_GE(lengths_by_name["c"], Costs::NanoSeconds(1));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/simple_memory_arena.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace {
@@ -36,13 +37,15 @@ constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
-                           bool preserve_all_tensors, int tensor_alignment)
+                           bool preserve_all_tensors, int tensor_alignment,
+                           int plan_cache_capacity)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_all_tensors_(preserve_all_tensors),
-      tensor_alignment_(tensor_alignment) {}
+      tensor_alignment_(tensor_alignment),
+      plan_cache_capacity_(std::max(plan_cache_capacity, 0)) {}
 
 ArenaPlanner::~ArenaPlanner() {}
 
@@ -82,6 +85,8 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  // Cached plans were computed for the previous graph structure.
+  plan_cache_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
   dealloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
@@ -178,6 +183,31 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
     }
   }
 
+  // When nodes run in steps, a tensor must stay alive from the step of its
+  // producer until the last step in which any of its consumers runs, which is
+  // not necessarily the step of the last consumer in execution plan order.
+  if (UsesExecutionSteps()) {
+    std::vector<int32_t> last_use_step(graph_info_->num_tensors(), 0);
+    for (size_t i = 0; i < graph_info_->num_execution_nodes(); ++i) {
+      TfLiteIntArray* node_inputs = graph_info_->node(i).inputs;
+      for (int j = 0; j < node_inputs->size; ++j) {
+        int tensor_index = node_inputs->data[j];
+        if (tensor_index != kTfLiteOptionalTensor) {
+          last_use_step[tensor_index] =
+              std::max(last_use_step[tensor_index], node_steps_[i]);
+        }
+      }
+    }
+    for (size_t i = 0; i < graph_info_->num_tensors(); ++i) {
+      if (alloc_node_[i] != kNodeNotAssigned) {
+        alloc_node_[i] = node_steps_[alloc_node_[i]];
+      }
+      if (dealloc_node_[i] != kNodeNotAssigned) {
+        dealloc_node_[i] = last_use_step[i];
+      }
+    }
+  }
+
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
   return kTfLiteOk;
@@ -196,16 +226,53 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
        ++i) {
     const TfLiteNode& node = graph_info_->node(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
+    const int32_t step = UsesExecutionSteps() ? node_steps_[i] : i;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = step;
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = step;
+      }
+    }
+  }
+
+  // Look the plan up in the cache before running the allocation algorithm.
+  std::vector<size_t> signature;
+  const bool cacheable =
+      ComputePlanSignature(first_node, last_node, &signature);
+  size_t signature_hash = 0;
+  bool cache_hit = false;
+  if (cacheable) {
+    for (size_t value : signature) {
+      signature_hash = CombineHashes({signature_hash, value});
+    }
+    for (auto it = plan_cache_.begin(); it != plan_cache_.end(); ++it) {
+      if (it->signature_hash != signature_hash ||
+          it->signature != signature) {
+        continue;
       }
+      allocs_ = it->allocs;
+      TF_LITE_ENSURE_STATUS(arena_.RestorePlan(it->arena_plan));
+      TF_LITE_ENSURE_STATUS(
+          persistent_arena_.RestorePlan(it->persistent_arena_plan));
+      plan_cache_.splice(plan_cache_.begin(), plan_cache_, it);
+      ++plan_cache_hits_;
+      cache_hit = true;
+      break;
     }
   }
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  if (!cache_hit) {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+    if (cacheable) {
+      plan_cache_.push_front(CachedPlan{signature_hash, std::move(signature),
+                                        allocs_, arena_.SavePlan(),
+                                        persistent_arena_.SavePlan()});
+      if (plan_cache_.size() > plan_cache_capacity_) {
+        plan_cache_.pop_back();
+      }
+    }
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
@@ -241,6 +308,17 @@ TfLiteStatus ArenaPlanner::AcquireNonPersistentMemory() {
   return kTfLiteOk;
 }
 
+void ArenaPlanner::SetNodeExecutionSteps(const std::vector<int>& steps) {
+  node_steps_ = steps;
+}
+
+bool ArenaPlanner::UsesExecutionSteps() const {
+  // Steps computed for a different execution plan are ignored; the caller
+  // is expected to update them before running nodes concurrently.
+  return !node_steps_.empty() &&
+         node_steps_.size() == graph_info_->num_execution_nodes();
+}
+
 bool ArenaPlanner::HasNonPersistentMemory() {
   return arena_.GetBufferSize() != 0;
 }
@@ -334,6 +412,31 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::ComputePlanSignature(int first_node, int last_node,
+                                        std::vector<size_t>* signature) const {
+  // Only plans covering the whole graph, starting from a clean state, are
+  // cached. Incremental planning for dynamic tensors depends on the
+  // allocations made so far.
+  if (plan_cache_capacity_ == 0 || first_node != 0 || last_node < 0 ||
+      static_cast<size_t>(last_node) + 1 < graph_info_->num_execution_nodes()) {
+    return false;
+  }
+  const size_t num_tensors = graph_info_->num_tensors();
+  signature->clear();
+  signature->reserve(4 * num_tensors);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    if (allocs_[i].size != 0) {
+      return false;
+    }
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    signature->push_back(tensor.allocation_type);
+    signature->push_back(tensor.bytes);
+    signature->push_back(alloc_node_[i]);
+    signature->push_back(dealloc_node_[i]);
+  }
+  return true;
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <vector>
 
@@ -43,14 +44,22 @@ struct AllocationInfo;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// Optionally, the planner keeps a bounded LRU cache of whole-graph plans keyed
+// by the sizes and usage intervals of all tensors. When an interpreter keeps
+// switching between a few recurring input shapes, re-planning for a shape that
+// was seen before restores the cached offsets instead of re-running the
+// allocation algorithm.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. The inputs to the graph will not share
   // memory with any other tensor, effectively preserving them until the end
-  // of inference.
+  // of inference. At most `plan_cache_capacity` whole-graph plans are cached;
+  // zero disables the cache.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
-               bool preserve_all_tensors, int tensor_alignment);
+               bool preserve_all_tensors, int tensor_alignment,
+               int plan_cache_capacity = 0);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -62,12 +71,36 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
+  void SetNodeExecutionSteps(const std::vector<int>& steps) override;
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Returns the number of ExecuteAllocations() calls served from the plan
+  // cache. For testing.
+  int plan_cache_hits() const { return plan_cache_hits_; }
+
  private:
+  // A whole-graph allocation plan, along with the signature of the tensor
+  // sizes and usage intervals it was computed for.
+  struct CachedPlan {
+    size_t signature_hash;
+    std::vector<size_t> signature;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    SimpleMemoryArena::Plan arena_plan;
+    SimpleMemoryArena::Plan persistent_arena_plan;
+  };
+
+  // True if `node_steps_` applies to the current execution plan.
+  bool UsesExecutionSteps() const;
+
+  // Fills `signature` with everything CalculateAllocations() depends on for
+  // the whole graph. Returns false if the current state can't be served from
+  // the plan cache, e.g. because some tensors are already allocated.
+  bool ComputePlanSignature(int first_node, int last_node,
+                            std::vector<size_t>* signature) const;
+
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
   TfLiteStatus Commit();
@@ -127,6 +160,16 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Execution step of each node, see SetNodeExecutionSteps(). When set,
+  // `alloc_node_` and `dealloc_node_` hold steps instead of node indices.
+  std::vector<int> node_steps_;
+
+  // Most recently used plans first; holds at most `plan_cache_capacity_`
+  // entries.
+  std::list<CachedPlan> plan_cache_;
+  size_t plan_cache_capacity_;
+  int plan_cache_hits_ = 0;
 };
 
 }  // namespace tflite
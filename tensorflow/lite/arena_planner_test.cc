@@ -174,12 +174,13 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false) {
+  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false,
+                int plan_cache_capacity = 0) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_all_tensors, kTensorAlignment));
+        preserve_all_tensors, kTensorAlignment, plan_cache_capacity));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -201,6 +202,10 @@ class ArenaPlannerTest : public ::testing::Test {
     CHECK(planner_->AcquireNonPersistentMemory() == kTfLiteOk);
   }
 
+  void ResetAllocations() {
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  }
+
   void ResetAllocationsAfter(int node) {
     CHECK(planner_->ResetAllocationsAfter(node) == kTfLiteOk);
   }
@@ -759,5 +764,119 @@ TEST_F(ArenaPlannerTest, DebugTensors) {
   EXPECT_EQ(tensorOffsets.size(), 8);
 }
 
+TEST_F(ArenaPlannerTest, PlanCacheRestoresRecurringShapes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {5}},  // First op, with temporary
+                      {{2, 0}, {4}, {6}},  // Second op, with temporary
+                      {{4}, {3}, {7}}      // Third op, with temporary
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_all_tensors=*/false, /*plan_cache_capacity=*/2);
+  auto offsets = [this]() {
+    std::vector<std::ptrdiff_t> result;
+    for (int i = 0; i < 8; ++i) result.push_back(GetOffset(i));
+    return result;
+  };
+
+  Execute(0, 10);
+  const std::vector<std::ptrdiff_t> small_offsets = offsets();
+  EXPECT_EQ(planner_->plan_cache_hits(), 0);
+
+  // Grow the input and an intermediate; this shape hasn't been planned yet.
+  (*graph.tensors())[0].bytes = 96;
+  (*graph.tensors())[2].bytes = 128;
+  ResetAllocations();
+  Execute(0, 10);
+  const std::vector<std::ptrdiff_t> large_offsets = offsets();
+  EXPECT_EQ(planner_->plan_cache_hits(), 0);
+  EXPECT_NE(small_offsets, large_offsets);
+
+  // Switching back and forth is served from the cache.
+  (*graph.tensors())[0].bytes = 3;
+  (*graph.tensors())[2].bytes = 9;
+  ResetAllocations();
+  Execute(0, 10);
+  EXPECT_EQ(planner_->plan_cache_hits(), 1);
+  EXPECT_EQ(offsets(), small_offsets);
+
+  (*graph.tensors())[0].bytes = 96;
+  (*graph.tensors())[2].bytes = 128;
+  ResetAllocations();
+  Execute(0, 10);
+  EXPECT_EQ(planner_->plan_cache_hits(), 2);
+  EXPECT_EQ(offsets(), large_offsets);
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheEvictsLeastRecentlyUsed) {
+  TestGraph graph({0}, {{{0}, {1}, {}}, {{1}, {2}, {}}}, {2});
+  SetGraph(&graph, /*preserve_all_tensors=*/false, /*plan_cache_capacity=*/1);
+
+  Execute(0, 10);
+  (*graph.tensors())[1].bytes = 64;
+  ResetAllocations();
+  Execute(0, 10);
+
+  // The first shape was evicted by the second one.
+  (*graph.tensors())[1].bytes = 6;
+  ResetAllocations();
+  Execute(0, 10);
+  EXPECT_EQ(planner_->plan_cache_hits(), 0);
+  const std::ptrdiff_t offset1 = GetOffset(1);
+  const std::ptrdiff_t offset2 = GetOffset(2);
+
+  // Incremental planning is never served from the cache.
+  ResetAllocations();
+  Execute(0, 0);
+  Execute(1, 1);
+  EXPECT_EQ(planner_->plan_cache_hits(), 0);
+
+  ResetAllocations();
+  Execute(0, 10);
+  EXPECT_EQ(planner_->plan_cache_hits(), 1);
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), offset1);
+  EXPECT_EQ(GetOffset(2), offset2);
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentStepsDontShareMemory) {
+  // Two towers joined by the last op.
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {6}},   // Tower A
+                      {{1}, {2}, {}},    // Tower A
+                      {{0}, {3}, {7}},   // Tower B
+                      {{3}, {4}, {}},    // Tower B
+                      {{2, 4}, {5}, {}}  // Join
+                  },
+                  {5});
+  SetGraph(&graph);
+  auto overlap = [this](int t1, int t2) {
+    return GetOffset(t1) < GetOffsetAfter(t2) &&
+           GetOffset(t2) < GetOffsetAfter(t1);
+  };
+
+  // Run sequentially, tower B reuses memory of tower A.
+  Execute(0, 10);
+  EXPECT_TRUE(overlap(1, 3) || overlap(1, 4) || overlap(6, 7));
+
+  // With the towers running concurrently, nothing live in the same step may
+  // share memory.
+  planner_->SetNodeExecutionSteps({0, 1, 0, 1, 2});
+  CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  const std::vector<std::pair<int, int>> concurrent = {
+      {1, 3}, {1, 4}, {1, 7}, {2, 3}, {2, 4}, {6, 3}, {6, 7}};
+  for (const auto& tensors : concurrent) {
+    EXPECT_FALSE(overlap(tensors.first, tensors.second))
+        << tensors.first << " " << tensors.second;
+  }
+  // Tensors whose steps don't overlap can still share memory.
+  EXPECT_TRUE(overlap(5, 1) || overlap(5, 3) || overlap(5, 6) ||
+              overlap(5, 7));
+}
+
 }  // namespace
 }  // namespace tflite
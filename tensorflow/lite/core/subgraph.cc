@@ -474,8 +474,19 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
   return kTfLiteOk;
 }
 
+namespace {
+// The CPU backend context of the worker thread running an op in
+// `Subgraph::InvokeInSteps`, if any. Kernels running concurrently must not
+// share a CPU backend context.
+thread_local TfLiteExternalContext* worker_cpu_backend_context = nullptr;
+}  // namespace
+
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      worker_cpu_backend_context != nullptr) {
+    return worker_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1049,9 +1060,9 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_.reset(new ArenaPlanner(&context_, CreateGraphInfo(),
-                                           ShouldPreserveAllTensors(),
-                                           kDefaultTensorAlignment));
+    memory_planner_.reset(new ArenaPlanner(
+        &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
+        kDefaultTensorAlignment, MemoryPlanCacheSize()));
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1085,6 +1096,11 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
                            execution_plan_, &last_exec_plan_index_prepared));
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
+  // Nodes can only run in steps if they are all planned at once.
+  if (next_execution_plan_index_to_plan_allocation_ == 0) {
+    TF_LITE_ENSURE_STATUS(UpdateExecutionSteps());
+  }
+
   // Execute arena allocations.
   TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
       next_execution_plan_index_to_plan_allocation_,
@@ -1155,6 +1171,174 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::UpdateExecutionSteps() {
+  std::vector<int> steps;
+  const int num_threads = NumParallelOpThreads();
+  // Nodes with dynamic outputs are prepared and planned incrementally during
+  // Invoke().
+  if (num_threads > 1 &&
+      (has_dynamic_tensors_ || ShouldReleaseDynamicTensors())) {
+    TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_WARNING,
+                         "Running ops sequentially despite "
+                         "SetNumParallelOpThreads(%d), since the subgraph has "
+                         "dynamic tensors.",
+                         num_threads);
+  } else if (num_threads > 1) {
+    // Ops that may have side effects (e.g. on resources or through control
+    // flow subgraphs), custom ops and delegate kernels, which may not support
+    // concurrent invocations, run on their own.
+    auto is_exclusive = [this](int execution_plan_index) {
+      const auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[execution_plan_index]];
+      return node_and_registration.first.might_have_side_effect ||
+             node_and_registration.first.delegate != nullptr ||
+             node_and_registration.second.builtin_code == kTfLiteBuiltinCustom;
+    };
+    std::unique_ptr<GraphInfo> graph_info = CreateGraphInfo();
+    const int num_steps =
+        ComputeExecutionSteps(graph_info.get(), is_exclusive, &steps);
+    if (num_steps == execution_plan_.size()) {
+      // No two nodes are independent.
+      steps.clear();
+    }
+  }
+
+  if (steps != execution_steps_) {
+    execution_steps_ = std::move(steps);
+    execution_plan_indices_by_step_.clear();
+    for (int i = 0; i < execution_steps_.size(); ++i) {
+      if (execution_steps_[i] >= execution_plan_indices_by_step_.size()) {
+        execution_plan_indices_by_step_.resize(execution_steps_[i] + 1);
+      }
+      execution_plan_indices_by_step_[execution_steps_[i]].push_back(i);
+    }
+    memory_planner_->SetNodeExecutionSteps(execution_steps_);
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+
+  if (execution_steps_.empty()) {
+    worker_pool_.reset();
+    worker_cpu_backend_contexts_.clear();
+    return kTfLiteOk;
+  }
+  if (!worker_pool_ || worker_pool_->num_threads() != num_threads) {
+    worker_pool_ = std::make_unique<WorkerPool>(num_threads);
+    worker_cpu_backend_contexts_.clear();
+    for (int i = 1; i < num_threads; ++i) {
+      worker_cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+  }
+  // Keep the worker contexts in sync with SetNumThreads().
+  for (auto& worker_context : worker_cpu_backend_contexts_) {
+    if (worker_context->internal_backend_context() &&
+        context_.recommended_num_threads != -1) {
+      worker_context->internal_backend_context()->SetMaxNumThreads(
+          context_.recommended_num_threads);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::InvokeInSteps() {
+  std::vector<TfLiteStatus> statuses;
+  for (const std::vector<int>& step : execution_plan_indices_by_step_) {
+    for (int execution_plan_index : step) {
+      int node_index = execution_plan_[execution_plan_index];
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(
+          nodes_and_registration_[node_index].first,
+          nodes_and_registration_[node_index].second));
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    // Profilers aren't expected to be thread-safe, so ops of a step run one by
+    // one while profiling.
+    if (step.size() == 1 || profiler_) {
+      for (int execution_plan_index : step) {
+        int node_index = execution_plan_[execution_plan_index];
+        TfLiteNode& node = nodes_and_registration_[node_index].first;
+        const TfLiteRegistration& registration =
+            nodes_and_registration_[node_index].second;
+        const char* op_name = nullptr;
+        if (profiler_) op_name = GetTFLiteOpName(registration);
+        TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name,
+                                              node_index);
+        if (OpInvoke(registration, &node) != kTfLiteOk) {
+          return ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+        }
+      }
+      continue;
+    }
+
+    statuses.assign(step.size(), kTfLiteOk);
+    auto invoke_node = [this, &step, &statuses](int thread_id, int i) {
+      // Worker threads use their own CPU backend context, the calling thread
+      // keeps the subgraph's one.
+      if (thread_id > 0 && external_contexts_[kTfLiteCpuBackendContext]) {
+        worker_cpu_backend_context =
+            worker_cpu_backend_contexts_[thread_id - 1].get();
+      }
+      int node_index = execution_plan_[step[i]];
+      statuses[i] = OpInvoke(nodes_and_registration_[node_index].second,
+                             &nodes_and_registration_[node_index].first);
+      if (thread_id > 0) worker_cpu_backend_context = nullptr;
+    };
+    worker_pool_->Run(step.size(), invoke_node);
+    for (int i = 0; i < step.size(); ++i) {
+      if (statuses[i] != kTfLiteOk) {
+        int node_index = execution_plan_[step[i]];
+        return ReportOpError(&context_,
+                             nodes_and_registration_[node_index].first,
+                             nodes_and_registration_[node_index].second,
+                             node_index, "failed to invoke");
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   if (!consistent_) {
     ReportError("Invoke called on model that is not consistent.");
@@ -1171,7 +1355,14 @@ TfLiteStatus Subgraph::Invoke() {
   }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 
-  // Invocations are always done in node order.
+  // All nodes have been prepared and planned at once if they run in steps.
+  if (!execution_steps_.empty() &&
+      execution_steps_.size() == execution_plan_.size() &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    return InvokeInSteps();
+  }
+
+  // Otherwise, invocations are done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
@@ -1191,37 +1382,7 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
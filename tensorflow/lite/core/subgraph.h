@@ -33,10 +33,12 @@ limitations under the License.
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
+#include "tensorflow/lite/worker_pool.h"
 
 namespace tflite {
 
@@ -402,6 +404,20 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of memory plans the arena planner caches for recurring tensor
+  // shapes. Zero if caching is disabled.
+  int MemoryPlanCacheSize() const {
+    return options_ ? options_->GetMemoryPlanCacheSize() : 0;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads running independent ops concurrently. Values below two
+  // mean that ops run one by one.
+  int NumParallelOpThreads() const {
+    return options_ ? options_->GetNumParallelOpThreads() : 0;
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -517,6 +533,19 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Groups the execution plan into steps of independent nodes if nodes may run
+  // concurrently, and updates the memory planner accordingly. Called once all
+  // nodes have been prepared.
+  TfLiteStatus UpdateExecutionSteps();
+
+  // Invokes the nodes step by step, running the nodes of a step concurrently.
+  TfLiteStatus InvokeInSteps();
+
+  // Checks that all input tensors of 'node' can be read by it, copying data
+  // from delegate buffers if necessary.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -840,6 +869,20 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Execution step of each node in `execution_plan_` when independent nodes
+  // run concurrently, see `UpdateExecutionSteps`. Empty if nodes run one by
+  // one in execution plan order.
+  std::vector<int> execution_steps_;
+
+  // Execution plan indices of the nodes of each step.
+  std::vector<std::vector<int>> execution_plan_indices_by_step_;
+
+  // Threads running the nodes of a step, and a CPU backend context for each of
+  // them but the calling thread, so that concurrent kernels don't share one.
+  std::unique_ptr<WorkerPool> worker_pool_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
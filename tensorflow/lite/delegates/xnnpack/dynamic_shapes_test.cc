@@ -0,0 +1,170 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/xnnpack/conv_2d_tester.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace xnnpack {
+
+namespace {
+
+std::vector<char> CreateConv2DModel() {
+  return Conv2DTester()
+      .InputHeight(8)
+      .InputWidth(8)
+      .InputChannels(4)
+      .OutputChannels(8)
+      .KernelHeight(3)
+      .KernelWidth(3)
+      .SamePadding()
+      .ReluActivation()
+      .CreateTfLiteModel();
+}
+
+// Resizes the input of both interpreters, runs them on the same random data
+// and compares their outputs.
+void RunWithInputShape(Interpreter* delegate_interpreter,
+                       Interpreter* default_interpreter,
+                       const std::vector<int>& input_shape) {
+  for (Interpreter* interpreter : {delegate_interpreter, default_interpreter}) {
+    ASSERT_EQ(kTfLiteOk, interpreter->ResizeInputTensor(
+                             interpreter->inputs()[0], input_shape));
+    ASSERT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+  }
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto input_rng =
+      std::bind(std::uniform_real_distribution<float>(-1.0f, 1.0f), rng);
+  const TfLiteTensor* input =
+      default_interpreter->tensor(default_interpreter->inputs()[0]);
+  const size_t input_size = input->bytes / sizeof(float);
+  float* default_input_data = default_interpreter->typed_input_tensor<float>(0);
+  std::generate(default_input_data, default_input_data + input_size,
+                std::ref(input_rng));
+  std::copy(default_input_data, default_input_data + input_size,
+            delegate_interpreter->typed_input_tensor<float>(0));
+
+  ASSERT_EQ(kTfLiteOk, default_interpreter->Invoke());
+  ASSERT_EQ(kTfLiteOk, delegate_interpreter->Invoke());
+
+  const TfLiteTensor* default_output =
+      default_interpreter->tensor(default_interpreter->outputs()[0]);
+  const TfLiteTensor* delegate_output =
+      delegate_interpreter->tensor(delegate_interpreter->outputs()[0]);
+  ASSERT_TRUE(TfLiteIntArrayEqual(default_output->dims, delegate_output->dims));
+  const size_t output_size = default_output->bytes / sizeof(float);
+  const float* default_output_data =
+      default_interpreter->typed_output_tensor<float>(0);
+  const float* delegate_output_data =
+      delegate_interpreter->typed_output_tensor<float>(0);
+  for (size_t i = 0; i < output_size; i++) {
+    ASSERT_NEAR(default_output_data[i], delegate_output_data[i],
+                std::abs(default_output_data[i]) * 3.0e-6f)
+        << "element " << i << " / " << output_size;
+  }
+}
+
+}  // namespace
+
+TEST(DynamicShapes, ResizeWithoutRedelegation) {
+  std::vector<char> buffer = CreateConv2DModel();
+  const Model* model = GetModel(buffer.data());
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(kTfLiteOk,
+            InterpreterBuilder(model, resolver)(&delegate_interpreter));
+  std::unique_ptr<Interpreter> default_interpreter;
+  ASSERT_EQ(kTfLiteOk,
+            InterpreterBuilder(model, resolver)(&default_interpreter));
+
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_DYNAMIC_SHAPES;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+               TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk,
+            delegate_interpreter->ModifyGraphWithDelegate(delegate.get()));
+  ASSERT_EQ(1, delegate_interpreter->execution_plan().size());
+  const int delegate_node = delegate_interpreter->execution_plan()[0];
+
+  // Shapes are revisited to go through the cached runtimes too.
+  for (const std::vector<int>& input_shape :
+       std::vector<std::vector<int>>{{1, 8, 8, 4},
+                                     {2, 5, 7, 4},
+                                     {1, 13, 3, 4},
+                                     {1, 8, 8, 4},
+                                     {2, 5, 7, 4}}) {
+    RunWithInputShape(delegate_interpreter.get(), default_interpreter.get(),
+                      input_shape);
+    // Undoing and redoing the delegation would have added a new node.
+    ASSERT_EQ(1, delegate_interpreter->execution_plan().size());
+    ASSERT_EQ(delegate_node, delegate_interpreter->execution_plan()[0]);
+  }
+}
+
+TEST(DynamicShapes, ResizeWithWeightsCache) {
+  std::vector<char> buffer = CreateConv2DModel();
+  const Model* model = GetModel(buffer.data());
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+
+  std::unique_ptr<Interpreter> delegate_interpreter;
+  ASSERT_EQ(kTfLiteOk,
+            InterpreterBuilder(model, resolver)(&delegate_interpreter));
+  std::unique_ptr<Interpreter> default_interpreter;
+  ASSERT_EQ(kTfLiteOk,
+            InterpreterBuilder(model, resolver)(&default_interpreter));
+
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheDelete)>
+      weights_cache(TfLiteXNNPackDelegateWeightsCacheCreate(),
+                    TfLiteXNNPackDelegateWeightsCacheDelete);
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_DYNAMIC_SHAPES;
+  delegate_options.weights_cache = weights_cache.get();
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+               TfLiteXNNPackDelegateDelete);
+  ASSERT_EQ(kTfLiteOk,
+            delegate_interpreter->ModifyGraphWithDelegate(delegate.get()));
+  // Runtimes built for new shapes find the weights packed for the first one.
+  ASSERT_TRUE(
+      TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache.get()));
+
+  for (const std::vector<int>& input_shape :
+       std::vector<std::vector<int>>{{1, 8, 8, 4}, {3, 6, 4, 4}}) {
+    RunWithInputShape(delegate_interpreter.get(), default_interpreter.get(),
+                      input_shape);
+  }
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
@@ -73,6 +73,13 @@ class Delegate {
 
     options_ =
         options != nullptr ? *options : TfLiteXNNPackDelegateOptionsDefault();
+    if (support_dynamic_shapes()) {
+      // Delegate kernels are kept when inputs are resized. The runtime fills
+      // in the shapes of their tensors from the original ops before they are
+      // prepared again, see Subgraph::Prepare.
+      delegate_.flags = kTfLiteDelegateFlagsAllowDynamicTensors |
+                        kTfLiteDelegateFlagsRequirePropagatedShapes;
+    }
   }
 
   TfLiteIntArray* PrepareOpsToDelegate(TfLiteContext* context);
@@ -91,6 +98,10 @@ class Delegate {
                               TFLITE_XNNPACK_DELEGATE_FLAG_QS8)) != 0;
   }
 
+  bool support_dynamic_shapes() const {
+    return (options_.flags & TFLITE_XNNPACK_DELEGATE_FLAG_DYNAMIC_SHAPES) != 0;
+  }
+
   bool force_fp16() const {
 #ifdef XNNPACK_DELEGATE_FORCE_PRECISION_FP16
     return true;
@@ -152,6 +163,20 @@ class Subgraph {
   static Subgraph* Create(TfLiteContext* context,
                           const TfLiteDelegateParams* params,
                           const Delegate& delegate) {
+    std::unordered_set<int> externals;
+    xnn_runtime_t runtime =
+        CreateRuntime(context, params, delegate, &externals);
+    if (runtime == nullptr) {
+      return nullptr;
+    }
+    return new Subgraph(context, params, delegate, runtime, externals);
+  }
+
+  // Builds an XNNPACK runtime for the delegated nodes, for the current shapes
+  // of their tensors. Returns nullptr on failure.
+  static xnn_runtime_t CreateRuntime(
+      TfLiteContext* context, const TfLiteDelegateParams* params,
+      const Delegate& delegate, std::unordered_set<int>* external_tensors) {
     // Convert subgraph inputs and outputs to hash sets for faster lookup.
     const std::unordered_set<int> inputs(
         &params->input_tensors->data[0],
@@ -616,10 +641,65 @@ class Subgraph {
       return nullptr;
     }
 
-    return new Subgraph(delegate, runtime_ptr, externals);
+    *external_tensors = std::move(externals);
+    return runtime_ptr;
   }
 
-  TfLiteStatus Prepare(TfLiteContext* context) { return kTfLiteOk; }
+  TfLiteStatus Prepare(TfLiteContext* context) {
+    if (!delegate_.support_dynamic_shapes()) {
+      return kTfLiteOk;
+    }
+
+    // The shapes of the delegated tensors were propagated by the original ops.
+    std::vector<int> shape_key;
+    for (int t : shape_tensors_) {
+      const TfLiteTensor& tensor = context->tensors[t];
+      if (tensor.allocation_type == kTfLiteDynamic) {
+        TF_LITE_KERNEL_LOG(context,
+                           "unsupported dynamic tensor %d in XNNPACK delegate",
+                           t);
+        return kTfLiteError;
+      }
+      shape_key.push_back(NumDimensions(&tensor));
+      shape_key.insert(shape_key.end(), &tensor.dims->data[0],
+                       &tensor.dims->data[NumDimensions(&tensor)]);
+    }
+    if (shape_key == shape_key_) {
+      return kTfLiteOk;
+    }
+
+    // Switch to the runtime for the new shapes, the least recently used
+    // runtime being dropped when the cache is full.
+    auto cached = std::find_if(
+        cached_runtimes_.begin(), cached_runtimes_.end(),
+        [&shape_key](const CachedRuntime& entry) {
+          return entry.first == shape_key;
+        });
+    RuntimePtr runtime(nullptr, &xnn_delete_runtime);
+    if (cached != cached_runtimes_.end()) {
+      runtime = std::move(cached->second);
+      cached_runtimes_.erase(cached);
+    } else {
+      runtime.reset(RecreateRuntime(context));
+      if (runtime == nullptr) {
+        TF_LITE_KERNEL_LOG(context,
+                           "failed to reshape XNNPACK runtime for new input "
+                           "shapes");
+        return kTfLiteError;
+      }
+    }
+    cached_runtimes_.emplace_back(std::move(shape_key_), std::move(runtime_));
+    if (cached_runtimes_.size() > kMaxCachedRuntimes) {
+      cached_runtimes_.erase(cached_runtimes_.begin());
+    }
+    runtime_ = std::move(runtime);
+    shape_key_ = std::move(shape_key);
+    // Data pointers must be set up for the new runtime before it runs.
+    for (auto& io_info : externals_) {
+      io_info.second = nullptr;
+    }
+    return kTfLiteOk;
+  }
 
   TfLiteStatus Invoke(TfLiteContext* context) {
     bool any_pointers_changed = false;
@@ -4498,18 +4578,79 @@ class Subgraph {
   }
 
  private:
-  Subgraph(const Delegate& delegate, xnn_runtime_t runtime,
+  using RuntimePtr =
+      std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)>;
+  using CachedRuntime = std::pair<std::vector<int>, RuntimePtr>;
+
+  // Number of runtimes for previously seen input shapes that are kept besides
+  // the current one, when the delegate supports dynamic shapes.
+  static constexpr size_t kMaxCachedRuntimes = 4;
+
+  Subgraph(TfLiteContext* context, const TfLiteDelegateParams* params,
+           const Delegate& delegate, xnn_runtime_t runtime,
            const std::unordered_set<int>& externals)
-      : runtime_(runtime, &xnn_delete_runtime) {
+      : delegate_(delegate), runtime_(runtime, &xnn_delete_runtime) {
     for (int t : externals) {
       externals_[t] = nullptr;
     }
+    if (delegate.support_dynamic_shapes()) {
+      nodes_to_replace_.assign(
+          &params->nodes_to_replace->data[0],
+          &params->nodes_to_replace->data[params->nodes_to_replace->size]);
+      input_tensors_.assign(
+          &params->input_tensors->data[0],
+          &params->input_tensors->data[params->input_tensors->size]);
+      output_tensors_.assign(
+          &params->output_tensors->data[0],
+          &params->output_tensors->data[params->output_tensors->size]);
+      shape_tensors_.assign(externals.begin(), externals.end());
+      std::sort(shape_tensors_.begin(), shape_tensors_.end());
+      for (int t : shape_tensors_) {
+        const TfLiteTensor& tensor = context->tensors[t];
+        shape_key_.push_back(NumDimensions(&tensor));
+        shape_key_.insert(shape_key_.end(), &tensor.dims->data[0],
+                          &tensor.dims->data[NumDimensions(&tensor)]);
+      }
+    }
+  }
+
+  // Builds a runtime for the current tensor shapes from the same delegated
+  // nodes. Packed weights are shared with the other runtimes through the
+  // weights cache of the delegate, if any.
+  xnn_runtime_t RecreateRuntime(TfLiteContext* context) const {
+    auto to_int_array = [](const std::vector<int>& values) {
+      std::unique_ptr<TfLiteIntArray, decltype(&TfLiteIntArrayFree)> array(
+          TfLiteIntArrayCreate(values.size()), &TfLiteIntArrayFree);
+      std::copy(values.begin(), values.end(), &array->data[0]);
+      return array;
+    };
+    auto nodes_to_replace = to_int_array(nodes_to_replace_);
+    auto input_tensors = to_int_array(input_tensors_);
+    auto output_tensors = to_int_array(output_tensors_);
+    TfLiteDelegateParams params = {};
+    params.nodes_to_replace = nodes_to_replace.get();
+    params.input_tensors = input_tensors.get();
+    params.output_tensors = output_tensors.get();
+
+    std::unordered_set<int> externals;
+    return CreateRuntime(context, &params, delegate_, &externals);
   }
 
+  const Delegate& delegate_;
   // XNNPACK Runtime (subgraph + workspace) with smart-pointer for lifetime
   // management.
-  std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime_{
-      nullptr, &xnn_delete_runtime};
+  RuntimePtr runtime_{nullptr, &xnn_delete_runtime};
+  // Delegated nodes and their inputs and outputs, kept to build runtimes for
+  // new input shapes.
+  std::vector<int> nodes_to_replace_;
+  std::vector<int> input_tensors_;
+  std::vector<int> output_tensors_;
+  // Sorted external tensors, whose dimensions identify the shapes `runtime_`
+  // was built for, and the dimensions themselves.
+  std::vector<int> shape_tensors_;
+  std::vector<int> shape_key_;
+  // Runtimes built for other shapes, least recently used first.
+  std::vector<CachedRuntime> cached_runtimes_;
   // Mapping from TFLite Tensor IDs (same as XNNPACK Value IDs) for
   // input/output tensors in the delegated subgraph to their data locations.
   std::unordered_map<int, void*> externals_;
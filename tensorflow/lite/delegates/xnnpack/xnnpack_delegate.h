@@ -29,6 +29,13 @@ extern "C" {
 #define TFLITE_XNNPACK_DELEGATE_FLAG_QU8 0x00000002
 // Force FP16 inference for FP32 operators.
 #define TFLITE_XNNPACK_DELEGATE_FLAG_FORCE_FP16 0x00000004
+// Keep the delegation when input tensors are resized. Instead of undoing and
+// redoing the delegation, each delegated partition builds a runtime for the
+// new shapes and keeps the runtimes of a few previously seen shapes. Provide a
+// soft-finalized `weights_cache` so that these runtimes share one copy of the
+// packed weights. A delegate created with this flag must only be applied to a
+// single interpreter.
+#define TFLITE_XNNPACK_DELEGATE_FLAG_DYNAMIC_SHAPES 0x00000008
 
 struct TfLiteXNNPackDelegateWeightsCache;
 
@@ -40,6 +47,7 @@ typedef struct {
   // - TFLITE_XNNPACK_DELEGATE_FLAG_QS8
   // - TFLITE_XNNPACK_DELEGATE_FLAG_QU8
   // - TFLITE_XNNPACK_DELEGATE_FLAG_FORCE_FP16
+  // - TFLITE_XNNPACK_DELEGATE_FLAG_DYNAMIC_SHAPES
   uint32_t flags;
   // Cache for packed weights, can be shared between multiple instances of
   // delegates.
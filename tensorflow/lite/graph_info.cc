@@ -249,4 +249,53 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
   return kTfLiteOk;
 }
 
+int ComputeExecutionSteps(GraphInfo* info,
+                          const std::function<bool(int)>& is_exclusive,
+                          std::vector<int>* steps) {
+  const int num_nodes = info->num_execution_nodes();
+  const int num_tensors = info->num_tensors();
+  steps->assign(num_nodes, 0);
+  // Step of the node producing each tensor, or of the last node that used it
+  // for variable tensors. -1 if the tensor is not produced by any node.
+  std::vector<int> tensor_steps(num_tensors, -1);
+  auto is_variable = [info](int tensor_index) {
+    return info->tensor(tensor_index)->is_variable;
+  };
+  // Nodes following an exclusive node can't run before this step.
+  int min_step = 0;
+  int num_steps = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = info->node(i);
+    int step = min_step;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        step = std::max(step, tensor_steps[tensor_index] + 1);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index != kTfLiteOptionalTensor && is_variable(tensor_index)) {
+        step = std::max(step, tensor_steps[tensor_index] + 1);
+      }
+    }
+    if (is_exclusive(i)) {
+      step = std::max(step, num_steps);
+      min_step = step + 1;
+    }
+    (*steps)[i] = step;
+    num_steps = std::max(num_steps, step + 1);
+
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kTfLiteOptionalTensor && is_variable(tensor_index)) {
+        tensor_steps[tensor_index] = step;
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        tensor_steps[tensor_index] = step;
+      }
+    }
+  }
+  return num_steps;
+}
+
 }  // namespace tflite
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <functional>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
@@ -90,6 +91,18 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
     const GraphInfo* info, const TfLiteIntArray* nodes_to_partition,
     std::vector<NodeSubset>* node_subsets);
 
+// Assigns every node of the execution plan to an execution step, such that a
+// node runs in a later step than the nodes producing its inputs and than the
+// earlier nodes reading or writing the same variable tensors. Nodes sharing a
+// step are independent of each other and may run concurrently. A node for
+// which `is_exclusive(execution_plan_index)` returns true runs in a step of its
+// own, after all the nodes preceding it in the execution plan and before all
+// the nodes following it. `steps` is indexed by execution plan index and steps
+// are numbered from zero. Returns the number of steps.
+int ComputeExecutionSteps(GraphInfo* info,
+                          const std::function<bool(int)>& is_exclusive,
+                          std::vector<int>* steps);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_GRAPH_INFO_H_
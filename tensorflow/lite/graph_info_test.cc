@@ -387,5 +387,54 @@ TEST(PartitionTest, Nodes4PartitionNodes3_WithControlDependency) {
       {expected_subgraph0, expected_subgraph1, expected_subgraph2});
 }
 
+// Two independent towers joined by a final node.
+TEST(ExecutionStepsTest, IndependentBranchesShareSteps) {
+  SimpleTestGraph graph;
+  graph.AddTensors(6);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  graph.AddNode({0}, {3});
+  graph.AddNode({3}, {4});
+  graph.AddNode({2, 4}, {5});
+  graph.SetInputsAndOutputs({0}, {5});
+
+  std::vector<int> steps;
+  EXPECT_EQ(
+      ComputeExecutionSteps(&graph, [](int) { return false; }, &steps), 3);
+  EXPECT_EQ(steps, std::vector<int>({0, 1, 0, 1, 2}));
+}
+
+TEST(ExecutionStepsTest, ExclusiveNodesRunAlone) {
+  SimpleTestGraph graph;
+  graph.AddTensors(6);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  graph.AddNode({0}, {3});
+  graph.AddNode({3}, {4});
+  graph.AddNode({2, 4}, {5});
+  graph.SetInputsAndOutputs({0}, {5});
+
+  std::vector<int> steps;
+  EXPECT_EQ(ComputeExecutionSteps(
+                &graph, [](int node) { return node == 1; }, &steps),
+            5);
+  EXPECT_EQ(steps, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST(ExecutionStepsTest, VariableTensorsAreAccessedInOrder) {
+  SimpleTestGraph graph;
+  graph.AddTensors(4);
+  graph.tensor(2)->is_variable = true;
+  // Both nodes read & update the variable tensor 2.
+  graph.AddNode({0, 2}, {1});
+  graph.AddNode({0, 2}, {3});
+  graph.SetInputsAndOutputs({0}, {1, 3});
+
+  std::vector<int> steps;
+  EXPECT_EQ(
+      ComputeExecutionSteps(&graph, [](int) { return false; }, &steps), 2);
+  EXPECT_EQ(steps, std::vector<int>({0, 1}));
+}
+
 }  // namespace
 }  // namespace tflite
@@ -22,11 +22,13 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "ruy/denormal.h"  // from @ruy
 #include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
@@ -468,4 +470,32 @@ TfLiteStatus Interpreter::ApplyOptionsImpl(InterpreterOptions* options) {
   return kTfLiteOk;
 }
 
+void Interpreter::StartWeightLoad() {
+  if (!options_ ||
+      options_->GetWeightLoadPolicy() == WeightLoadPolicy::kOnDemand) {
+    return;
+  }
+  // Stops a previous load first; its pages are resident by now anyway.
+  weight_loader_ = std::make_unique<WeightLoader>();
+  std::unordered_set<const void*> added;
+  for (auto& subgraph : subgraphs_) {
+    for (int node_index : subgraph->execution_plan()) {
+      const TfLiteNode& node =
+          subgraph->node_and_registration(node_index)->first;
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        const TfLiteTensor* tensor = subgraph->tensor(tensor_index);
+        if (tensor->allocation_type != kTfLiteMmapRo) continue;
+        if (!added.insert(tensor->data.raw_const).second) continue;
+        weight_loader_->AddRange(tensor->data.raw_const, tensor->bytes);
+      }
+    }
+  }
+  if (options_->GetWeightLoadPolicy() == WeightLoadPolicy::kPrefault) {
+    weight_loader_->Load();
+  } else {
+    weight_loader_->StartAsync();
+  }
+}
+
 }  // namespace tflite
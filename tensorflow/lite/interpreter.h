@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/string_type.h"
 #include "tensorflow/lite/type_to_tflitetype.h"
+#include "tensorflow/lite/weight_loader.h"
 
 namespace tflite {
 
@@ -696,6 +697,12 @@ class Interpreter {
   /// WARNING: This is an experimental interface that is subject to change.
   TfLiteStatus ApplyOptions(InterpreterOptions* options);
 
+  /// Returns the loader of the weights requested by
+  /// `InterpreterOptions::SetWeightLoadPolicy`, e.g. to wait for a prefetch or
+  /// to report its progress, or nullptr if weights are loaded on demand.
+  /// WARNING: This is an experimental interface that is subject to change.
+  WeightLoader* weight_loader() { return weight_loader_.get(); }
+
 #ifndef DOXYGEN_SKIP
   /// Return the number of subgraphs in the model.
   /// WARNING: This is an experimental API and subject to change.
@@ -835,6 +842,10 @@ class Interpreter {
 
   TfLiteStatus ApplyOptionsImpl(InterpreterOptions* options);
 
+  // Starts loading the weights read by the nodes of all subgraphs if the
+  // options ask for it. Called once the nodes and tensors of the model exist.
+  void StartWeightLoad();
+
   // A pure C data structure used to communicate with the pure C plugin
   // interface. To avoid copying tensor metadata, this is also the definitive
   // structure to store tensors.
@@ -905,6 +916,9 @@ class Interpreter {
 
   // InterpreterOptions object which is being used.
   std::unique_ptr<InterpreterOptions> options_;
+
+  // Loads the weights ahead of their use, see StartWeightLoad().
+  std::unique_ptr<WeightLoader> weight_loader_;
 };
 
 }  // namespace tflite
@@ -35,8 +35,11 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/internal/signature_def.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/fused_elementwise.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/op_fusion.h"
 #include "tensorflow/lite/profiling/platform_profiler.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/schema/schema_utils.h"
@@ -810,6 +813,20 @@ TfLiteStatus InterpreterBuilder::operator()(
       }
     }
     modified_subgraph->SetVariables(std::move(variables));
+    if (options_.GetFuseElementwiseOps()) {
+      OpFusionStats stats;
+      if (FuseOps(modified_subgraph,
+                  op_resolver_.FindOp(
+                      ops::custom::fused_elementwise::kOpName, /*version=*/1),
+                  &stats) != kTfLiteOk) {
+        return cleanup_and_error();
+      }
+      TFLITE_LOG(TFLITE_LOG_INFO,
+                 "Fused %d activations and %d elementwise ops into %d nodes "
+                 "in subgraph %d.",
+                 stats.num_folded_activations, stats.num_fused_ops,
+                 stats.num_fused_chains, subgraph_index);
+    }
     if (subgraph->name()) {
       modified_subgraph->SetName(subgraph->name()->c_str());
     }
@@ -824,6 +841,9 @@ TfLiteStatus InterpreterBuilder::operator()(
     return cleanup_and_error();
   }
 
+  // Weights are loaded ahead while delegates are applied, which read them too.
+  (*interpreter)->StartWeightLoad();
+
   if (ShouldCreateLazyDelegateProviders(num_fp32_tensors_)) {
     (*interpreter)->lazy_delegate_providers_ =
         op_resolver_.GetDelegateCreators();
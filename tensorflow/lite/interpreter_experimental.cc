@@ -136,7 +136,9 @@ Profiler* Interpreter::GetProfiler() {
 }
 
 TfLiteStatus Interpreter::ApplyOptions(InterpreterOptions* options) {
-  return ApplyOptionsImpl(options);
+  TF_LITE_ENSURE_STATUS(ApplyOptionsImpl(options));
+  StartWeightLoad();
+  return kTfLiteOk;
 }
 
 SignatureRunner* Interpreter::GetSignatureRunner(const char* signature_key) {
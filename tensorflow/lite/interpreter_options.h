@@ -20,6 +20,21 @@ limitations under the License.
 
 namespace tflite {
 
+/// How the weights of a model, i.e. its constant tensors, are brought into
+/// memory when the model file is memory-mapped.
+/// WARNING: This is an experimental API and subject to change.
+enum class WeightLoadPolicy {
+  /// Pages of weights are faulted in by the first operation that reads them,
+  /// usually during the first `Invoke`.
+  kOnDemand,
+  /// All weights are read in before the interpreter is built, or before
+  /// `ApplyOptions` returns.
+  kPrefault,
+  /// Weights are read in by a background thread, in execution order, while
+  /// delegates are applied, tensors are allocated and the model first runs.
+  kPrefetch,
+};
+
 /// Options class for `Interpreter`.
 /// WARNING: This is an experimental API and subject to change.
 class InterpreterOptions {
@@ -27,7 +42,11 @@ class InterpreterOptions {
   InterpreterOptions()
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
-        experimental_optimize_memory_for_large_tensors_(0) {}
+        experimental_optimize_memory_for_large_tensors_(0),
+        experimental_memory_plan_cache_size_(0),
+        experimental_num_parallel_op_threads_(0),
+        experimental_weight_load_policy_(WeightLoadPolicy::kOnDemand),
+        experimental_fuse_elementwise_ops_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -76,10 +95,83 @@ class InterpreterOptions {
     return experimental_optimize_memory_for_large_tensors_;
   }
 
+  /// Caches up to `value` memory plans per subgraph, keyed by the sizes of all
+  /// tensors. When the inputs are resized back and forth between a few
+  /// recurring shapes, `AllocateTensors` then restores the arena plan of a
+  /// previously seen shape instead of recomputing it. Ops are still prepared
+  /// for every resize. Zero (the default) disables the cache. This must be set
+  /// before the first call to `AllocateTensors`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetMemoryPlanCacheSize(int value) {
+    experimental_memory_plan_cache_size_ = value > 0 ? value : 0;
+  }
+
+  /// Returns the number of memory plans cached per subgraph.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetMemoryPlanCacheSize() { return experimental_memory_plan_cache_size_; }
+
+  /// Runs independent ops of a subgraph concurrently on up to `num_threads`
+  /// threads, e.g. the towers of a multi-tower model. Ops are grouped into
+  /// steps of mutually independent ops, and the memory plan keeps the tensors
+  /// of ops in overlapping steps apart, which may increase the arena size.
+  /// Each running op still uses the interpreter's number of threads for its
+  /// own kernel, so consider lowering `SetNumThreads` accordingly. Custom ops
+  /// and delegate kernels, including the default XNNPACK delegate's, always
+  /// run alone while the other ops may still run concurrently. Subgraphs with
+  /// dynamic tensors always run sequentially, and a warning is logged. Values
+  /// below two (the default) disable this.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumParallelOpThreads(int num_threads) {
+    experimental_num_parallel_op_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads running independent ops concurrently.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumParallelOpThreads() {
+    return experimental_num_parallel_op_threads_;
+  }
+
+  /// Sets how the weights read by the ops of the model are loaded, see
+  /// `WeightLoadPolicy`. Weights are loaded in the order the ops of the primary
+  /// subgraph and then of the other subgraphs run; buffers no op reads are
+  /// left alone. Loading the weights ahead avoids the page faults, and for
+  /// large models the disk reads, that otherwise stall the first inference.
+  /// Progress is reported by `Interpreter::weight_loader()`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetWeightLoadPolicy(WeightLoadPolicy policy) {
+    experimental_weight_load_policy_ = policy;
+  }
+
+  /// Returns how the weights of the model are loaded.
+  /// WARNING: This is an experimental API and subject to change.
+  WeightLoadPolicy GetWeightLoadPolicy() {
+    return experimental_weight_load_policy_;
+  }
+
+  /// Rewrites the ops of each subgraph when the interpreter is built so that
+  /// fewer of them make a full pass over their tensors: activation ops are
+  /// folded into the fused activation of the op producing their input, and
+  /// chains of float elementwise ops with constant operands run as a single
+  /// fused node, see `op_fusion.h`. Fused nodes are custom ops that delegates
+  /// don't claim, so only enable this when the model runs on the builtin CPU
+  /// kernels and the op resolver provides "TFLite_FusedElementwise".
+  /// WARNING: This is an experimental API and subject to change.
+  void SetFuseElementwiseOps(bool value = true) {
+    experimental_fuse_elementwise_ops_ = value;
+  }
+
+  /// Returns if ops are fused when the interpreter is built.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetFuseElementwiseOps() { return experimental_fuse_elementwise_ops_; }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
+  int experimental_memory_plan_cache_size_;
+  int experimental_num_parallel_op_threads_;
+  WeightLoadPolicy experimental_weight_load_policy_;
+  bool experimental_fuse_elementwise_ops_;
 };
 
 }  // namespace tflite
@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+namespace tflite {
+
+InterpreterPool::Lease::Lease(Lease&& other)
+    : pool_(other.pool_),
+      index_(other.index_),
+      interpreter_(other.interpreter_) {
+  other.pool_ = nullptr;
+  other.interpreter_ = nullptr;
+}
+
+InterpreterPool::Lease& InterpreterPool::Lease::operator=(Lease&& other) {
+  if (this != &other) {
+    if (pool_ != nullptr) pool_->Release(index_);
+    pool_ = other.pool_;
+    index_ = other.index_;
+    interpreter_ = other.interpreter_;
+    other.pool_ = nullptr;
+    other.interpreter_ = nullptr;
+  }
+  return *this;
+}
+
+InterpreterPool::Lease::~Lease() {
+  if (pool_ != nullptr) pool_->Release(index_);
+}
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options) {
+  ErrorReporter* error_reporter = model.error_reporter();
+  if (options.num_instances < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "InterpreterPool needs at least one instance, got %d.",
+                         options.num_instances);
+    return nullptr;
+  }
+  std::unique_ptr<InterpreterPool> pool(new InterpreterPool(options));
+
+  TfLiteXNNPackDelegateWeightsCache* weights_cache = options.weights_cache;
+  if (options.use_xnnpack && weights_cache == nullptr) {
+    pool->weights_cache_.reset(TfLiteXNNPackDelegateWeightsCacheCreate());
+    weights_cache = pool->weights_cache_.get();
+    if (weights_cache == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to create the XNNPACK weights cache.");
+      return nullptr;
+    }
+  }
+
+  for (int i = 0; i < options.num_instances; ++i) {
+    InterpreterBuilder builder(model, op_resolver);
+    if (builder.SetNumThreads(options.num_threads_per_instance) != kTfLiteOk) {
+      return nullptr;
+    }
+    if (options.use_xnnpack) {
+      TfLiteXNNPackDelegateOptions xnnpack_options =
+          TfLiteXNNPackDelegateOptionsDefault();
+      xnnpack_options.num_threads = options.num_threads_per_instance;
+      // The first instance packs the weights into the cache, the others look
+      // them up, since all of them see the same model buffers.
+      xnnpack_options.weights_cache = weights_cache;
+      pool->delegates_.emplace_back(
+          TfLiteXNNPackDelegateCreate(&xnnpack_options),
+          TfLiteXNNPackDelegateDelete);
+      builder.AddDelegate(pool->delegates_.back().get());
+    }
+    std::unique_ptr<Interpreter> interpreter;
+    if (builder(&interpreter) != kTfLiteOk ||
+        interpreter->AllocateTensors() != kTfLiteOk) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Failed to build instance %d of InterpreterPool.",
+                           i);
+      return nullptr;
+    }
+    if (options.release_idle_arenas &&
+        interpreter->ReleaseNonPersistentMemory() != kTfLiteOk) {
+      return nullptr;
+    }
+    pool->interpreters_.push_back(std::move(interpreter));
+    pool->free_.push_back(i);
+  }
+
+  // No more weights are added once all instances are delegated. A finalized
+  // cache is read-only, so the instances can use it concurrently. A cache
+  // passed in the options is finalized by its owner.
+  if (pool->weights_cache_ != nullptr &&
+      !TfLiteXNNPackDelegateWeightsCacheFinalizeHard(
+          pool->weights_cache_.get())) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Failed to finalize the XNNPACK weights cache.");
+    return nullptr;
+  }
+  return pool;
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire() {
+  int index;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    interpreter_released_.wait(lock, [this] { return !free_.empty(); });
+    index = free_.back();
+    free_.pop_back();
+  }
+  return LeaseInterpreter(index);
+}
+
+InterpreterPool::Lease InterpreterPool::TryAcquire() {
+  int index;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) return Lease();
+    index = free_.back();
+    free_.pop_back();
+  }
+  return LeaseInterpreter(index);
+}
+
+InterpreterPool::Lease InterpreterPool::LeaseInterpreter(int index) {
+  Interpreter* interpreter = interpreters_[index].get();
+  if (options_.release_idle_arenas &&
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    Release(index);
+    return Lease();
+  }
+  return Lease(this, index, interpreter);
+}
+
+void InterpreterPool::Release(int index) {
+  if (options_.release_idle_arenas) {
+    interpreters_[index]->ReleaseNonPersistentMemory();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(index);
+  }
+  interpreter_released_.notify_one();
+}
+
+}  // namespace tflite
@@ -0,0 +1,153 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_INTERPRETER_POOL_H_
+
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+
+/// WARNING: Experimental interface, subject to change
+///
+/// A fixed set of interpreters for one model, to serve it from several threads
+/// at once without paying for N copies of the model.
+///
+/// All interpreters read their constant tensors from the same
+/// `FlatBufferModel`, and, when XNNPACK is used, share one XNNPACK weights
+/// cache, so weights that XNNPACK repacks are packed once and shared read-only.
+/// Each interpreter only owns its activation arena and its kernels' scratch
+/// state.
+///
+/// Usage:
+///
+/// <pre><code>
+/// auto model = tflite::FlatBufferModel::BuildFromFile(...);
+/// tflite::InterpreterPool::Options options;
+/// options.num_instances = 8;
+/// auto pool = tflite::InterpreterPool::Create(
+///     *model, ops::builtin::BuiltinOpResolverWithoutDefaultDelegates(),
+///     options);
+/// // On any thread:
+/// tflite::InterpreterPool::Lease lease = pool->Acquire();
+/// // Fill lease->typed_input_tensor<float>(0)...
+/// lease->Invoke();
+/// // Read lease->typed_output_tensor<float>(0)...
+/// </code></pre>
+///
+/// The model must outlive the pool. Pass a resolver without default delegates
+/// when `use_xnnpack` is set, so that the interpreters are not delegated twice.
+class InterpreterPool {
+ public:
+  struct Options {
+    /// Number of interpreters, i.e. of invocations that can run concurrently.
+    int num_instances = 1;
+    /// Number of threads each interpreter may use.
+    int num_threads_per_instance = 1;
+    /// If true, the interpreters are delegated to XNNPACK with a shared weights
+    /// cache.
+    bool use_xnnpack = true;
+    /// If set along with `use_xnnpack`, the weights cache to use instead of one
+    /// owned by the pool, e.g. to share packed weights between pools of the
+    /// same model. Not owned; it must outlive the pool, and the caller is
+    /// responsible for finalizing it.
+    TfLiteXNNPackDelegateWeightsCache* weights_cache = nullptr;
+    /// If true, an interpreter releases its activation arena while it is not
+    /// leased, trading the cost of re-allocating it in Acquire for memory.
+    /// Input tensors must be set after every Acquire in that case.
+    bool release_idle_arenas = false;
+  };
+
+  /// Exclusive use of one interpreter of the pool, which returns to the pool
+  /// when the lease is destroyed. Move-only.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other);
+    Lease& operator=(Lease&& other);
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    /// Returns the leased interpreter, or nullptr for an empty lease.
+    Interpreter* get() const { return interpreter_; }
+    Interpreter* operator->() const { return interpreter_; }
+    explicit operator bool() const { return interpreter_ != nullptr; }
+
+   private:
+    friend class InterpreterPool;
+    Lease(InterpreterPool* pool, int index, Interpreter* interpreter)
+        : pool_(pool), index_(index), interpreter_(interpreter) {}
+
+    InterpreterPool* pool_ = nullptr;
+    int index_ = -1;
+    Interpreter* interpreter_ = nullptr;
+  };
+
+  /// Builds `options.num_instances` interpreters for `model`, with their
+  /// tensors allocated. Returns nullptr on failure, after reporting the error
+  /// to the model's error reporter.
+  static std::unique_ptr<InterpreterPool> Create(const FlatBufferModel& model,
+                                                 const OpResolver& op_resolver,
+                                                 const Options& options);
+
+  /// All leases must have been destroyed.
+  ~InterpreterPool() = default;
+
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+  /// Blocks until an interpreter is free and leases it. Returns an empty lease
+  /// if the interpreter's tensors could not be re-allocated.
+  Lease Acquire();
+
+  /// Leases a free interpreter, or returns an empty lease if there is none.
+  Lease TryAcquire();
+
+  int num_instances() const { return interpreters_.size(); }
+
+ private:
+  explicit InterpreterPool(const Options& options) : options_(options) {}
+
+  // Leases interpreter `index`, which the caller removed from `free_`.
+  Lease LeaseInterpreter(int index);
+  void Release(int index);
+
+  const Options options_;
+
+  // Declared before the delegates and interpreters, which use it, so that it
+  // is destroyed last.
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  void (*)(TfLiteXNNPackDelegateWeightsCache*)>
+      weights_cache_{nullptr, TfLiteXNNPackDelegateWeightsCacheDelete};
+  std::vector<Interpreter::TfLiteDelegatePtr> delegates_;
+  std::vector<std::unique_ptr<Interpreter>> interpreters_;
+
+  std::mutex mutex_;
+  std::condition_variable interpreter_released_;
+  std::vector<int> free_;  // Guarded by mutex_.
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTERPRETER_POOL_H_
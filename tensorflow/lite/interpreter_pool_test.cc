@@ -0,0 +1,174 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/xnnpack/conv_2d_tester.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace {
+
+// add.bin computes `output = 3 * input`.
+constexpr char kModelPath[] = "tensorflow/lite/testdata/add.bin";
+
+// Runs the model on `lease` and checks the result.
+void InvokeAndCheck(const InterpreterPool::Lease& lease, float value) {
+  ASSERT_TRUE(lease);
+  TfLiteTensor* input = lease->input_tensor(0);
+  const int num_elements = input->bytes / sizeof(float);
+  for (int i = 0; i < num_elements; ++i) {
+    input->data.f[i] = value + i;
+  }
+  ASSERT_EQ(lease->Invoke(), kTfLiteOk);
+  const TfLiteTensor* output = lease->output_tensor(0);
+  for (int i = 0; i < num_elements; ++i) {
+    EXPECT_EQ(output->data.f[i], 3 * (value + i));
+  }
+}
+
+class InterpreterPoolTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(kModelPath);
+    ASSERT_TRUE(model_);
+    options_.use_xnnpack = GetParam();
+  }
+
+  std::unique_ptr<InterpreterPool> CreatePool() {
+    return InterpreterPool::Create(
+        *model_, ops::builtin::BuiltinOpResolverWithoutDefaultDelegates(),
+        options_);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  InterpreterPool::Options options_;
+};
+
+TEST_P(InterpreterPoolTest, ServesConcurrentRequests) {
+  options_.num_instances = 3;
+  auto pool = CreatePool();
+  ASSERT_TRUE(pool);
+  EXPECT_EQ(pool->num_instances(), 3);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&pool, t] {
+      for (int i = 0; i < 20; ++i) {
+        InvokeAndCheck(pool->Acquire(), t * 100 + i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_P(InterpreterPoolTest, TryAcquireFailsWhenAllInstancesAreLeased) {
+  options_.num_instances = 2;
+  auto pool = CreatePool();
+  ASSERT_TRUE(pool);
+
+  InterpreterPool::Lease first = pool->TryAcquire();
+  InterpreterPool::Lease second = pool->TryAcquire();
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_FALSE(pool->TryAcquire());
+
+  Interpreter* released = first.get();
+  first = InterpreterPool::Lease();
+  InterpreterPool::Lease third = pool->TryAcquire();
+  EXPECT_EQ(third.get(), released);
+  InvokeAndCheck(third, 1);
+}
+
+TEST_P(InterpreterPoolTest, ReleasesIdleArenas) {
+  options_.num_instances = 2;
+  options_.release_idle_arenas = true;
+  auto pool = CreatePool();
+  ASSERT_TRUE(pool);
+
+  for (int i = 0; i < 4; ++i) {
+    InvokeAndCheck(pool->Acquire(), i);
+  }
+}
+
+TEST_P(InterpreterPoolTest, RejectsEmptyPool) {
+  options_.num_instances = 0;
+  EXPECT_FALSE(CreatePool());
+}
+
+INSTANTIATE_TEST_SUITE_P(WithAndWithoutXnnpack, InterpreterPoolTest,
+                         ::testing::Bool());
+
+TEST(InterpreterPoolWeightsCacheTest, PacksWeightsOnce) {
+  std::vector<char> buffer = xnnpack::Conv2DTester()
+                                 .InputHeight(8)
+                                 .InputWidth(8)
+                                 .InputChannels(4)
+                                 .OutputChannels(8)
+                                 .KernelHeight(3)
+                                 .KernelWidth(3)
+                                 .SamePadding()
+                                 .CreateTfLiteModel();
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromBuffer(buffer.data(), buffer.size());
+  ASSERT_TRUE(model);
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  decltype(&TfLiteXNNPackDelegateWeightsCacheDelete)>
+      weights_cache(TfLiteXNNPackDelegateWeightsCacheCreate(),
+                    TfLiteXNNPackDelegateWeightsCacheDelete);
+  ASSERT_TRUE(weights_cache);
+  InterpreterPool::Options options;
+  options.num_instances = 2;
+  options.weights_cache = weights_cache.get();
+
+  auto first_pool = InterpreterPool::Create(
+      *model, ops::builtin::BuiltinOpResolverWithoutDefaultDelegates(),
+      options);
+  ASSERT_TRUE(first_pool);
+  // A soft-finalized cache only accepts weights it already holds, so it can
+  // not grow anymore: building interpreters fails if one of them needs weights
+  // that the first pool did not pack.
+  ASSERT_TRUE(
+      TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache.get()));
+
+  options.num_instances = 3;
+  auto pool = InterpreterPool::Create(
+      *model, ops::builtin::BuiltinOpResolverWithoutDefaultDelegates(),
+      options);
+  ASSERT_TRUE(pool);
+  // Leases are kept so that every instance is checked.
+  std::vector<InterpreterPool::Lease> leases;
+  for (int i = 0; i < pool->num_instances(); ++i) {
+    leases.push_back(pool->TryAcquire());
+    ASSERT_TRUE(leases.back());
+    // The convolution, whose filter is in the cache, is delegated.
+    EXPECT_EQ(leases.back()->execution_plan().size(), 1);
+    EXPECT_EQ(leases.back()->Invoke(), kTfLiteOk);
+  }
+}
+
+}  // namespace
+}  // namespace tflite
@@ -697,6 +697,143 @@ TEST(BasicInterpreter, OneOpInterpreter) {
   ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
 }
 
+TEST(BasicInterpreter, ParallelOpExecution) {
+  // Two towers of passthrough ops fed by the same input.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2, 4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = GetPassthroughOpRegistration();
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({3}, {4}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+
+  InterpreterOptions options;
+  options.SetNumParallelOpThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // Tensors of the two towers are live at the same time.
+  const float* tower_a = interpreter.typed_tensor<float>(1);
+  const float* tower_b = interpreter.typed_tensor<float>(3);
+  EXPECT_TRUE(tower_a + 3 <= tower_b || tower_b + 3 <= tower_a);
+
+  for (int run = 0; run < 10; ++run) {
+    float* input = interpreter.typed_tensor<float>(0);
+    for (int i = 0; i < 3; ++i) input[i] = run + i;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int output : {2, 4}) {
+      const float* data = interpreter.typed_tensor<float>(output);
+      for (int i = 0; i < 3; ++i) EXPECT_EQ(data[i], run + i);
+    }
+  }
+}
+
+// Delegates the passthrough node writing tensor 2, and copies its input to its
+// output.
+class PassthroughDelegateKernel : public SimpleDelegateKernelInterface {
+ public:
+  TfLiteStatus Init(TfLiteContext* context,
+                    const TfLiteDelegateParams* params) override {
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) override {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  }
+
+  TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) override {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+    return kTfLiteOk;
+  }
+};
+
+class PassthroughDelegate : public SimpleDelegateInterface {
+ public:
+  bool IsNodeSupportedByDelegate(const TfLiteRegistration* registration,
+                                 const TfLiteNode* node,
+                                 TfLiteContext* context) const override {
+    return node->outputs->data[0] == 2;
+  }
+  TfLiteStatus Initialize(TfLiteContext* context) override {
+    return kTfLiteOk;
+  }
+  const char* Name() const override { return "PassthroughDelegateForTest"; }
+  std::unique_ptr<SimpleDelegateKernelInterface>
+  CreateDelegateKernelInterface() override {
+    return std::make_unique<PassthroughDelegateKernel>();
+  }
+  SimpleDelegateInterface::Options DelegateOptions() const override {
+    return SimpleDelegateInterface::Options();
+  }
+};
+
+TEST(BasicInterpreter, ParallelOpExecutionWithDelegate) {
+  // Two towers of passthrough ops fed by the same input, one op of which is
+  // delegated.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2, 4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = GetPassthroughOpRegistration();
+  for (const std::pair<int, int>& input_and_output :
+       std::vector<std::pair<int, int>>{{0, 1}, {1, 2}, {0, 3}, {3, 4}}) {
+    ASSERT_EQ(interpreter.AddNodeWithParameters(
+                  {input_and_output.first}, {input_and_output.second}, nullptr,
+                  0, nullptr, &reg),
+              kTfLiteOk);
+  }
+
+  InterpreterOptions options;
+  options.SetNumParallelOpThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  Interpreter::TfLiteDelegatePtr delegate(
+      TfLiteDelegateFactory::CreateSimpleDelegate(
+          std::make_unique<PassthroughDelegate>()),
+      TfLiteDelegateFactory::DeleteSimpleDelegate);
+  ASSERT_EQ(interpreter.ModifyGraphWithDelegate(std::move(delegate)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.execution_plan().size(), 4);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The delegate kernel runs on its own, the other ops still in steps.
+  for (int run = 0; run < 10; ++run) {
+    float* input = interpreter.typed_tensor<float>(0);
+    for (int i = 0; i < 3; ++i) input[i] = run + i;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int output : {2, 4}) {
+      const float* data = interpreter.typed_tensor<float>(output);
+      for (int i = 0; i < 3; ++i) EXPECT_EQ(data[i], run + i);
+    }
+  }
+}
+
 TEST(BasicInterpreter, ReleaseNonPersistentMemory) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
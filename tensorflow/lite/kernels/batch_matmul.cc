@@ -20,6 +20,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <utility>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
@@ -45,6 +46,9 @@ static const int kOutputTensor = 0;
 
 static const int kNumTempTensorsForAdjoints = 2;
 static const int kNumTempTensorsForHybrid = 5;
+// A scale per row of each (transposed) RHS matrix, and the quantized RHS when
+// it is quantized on the fly.
+static const int kNumTempTensorsForDynamicRhs = 2;
 
 // This file has two implementations of Transpose.
 enum KernelType {
@@ -65,6 +69,14 @@ struct OpData {
   int scratch_tensor_index;
   bool rhs_transposed;
   bool compute_row_sums = false;
+  // Whether float32 LHS and RHS are both quantized to int8 on the fly, see
+  // Register_BATCH_MATMUL_DYNAMIC_INT8().
+  bool quantize_float_inputs = false;
+  bool is_dynamic_int8 = false;
+  // Whether the int8 RHS of a hybrid op has a scale per output channel, and
+  // whether these scales still have to be copied to their temporary.
+  bool is_rhs_per_channel = false;
+  bool compute_rhs_scales = false;
 };
 
 struct OpContext {
@@ -87,11 +99,19 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // Creates the temp tensors to store the transposed LHS and/or RHS, and
   // extra buffers for the quantized case.
   context->AddTensors(context,
-                      kNumTempTensorsForAdjoints + kNumTempTensorsForHybrid,
+                      kNumTempTensorsForAdjoints + kNumTempTensorsForHybrid +
+                          kNumTempTensorsForDynamicRhs,
                       &op_data->scratch_tensor_index);
   return op_data;
 }
 
+void* InitDynamicInt8(TfLiteContext* context, const char* buffer,
+                      size_t length) {
+  auto* op_data = static_cast<OpData*>(Init(context, buffer, length));
+  op_data->quantize_float_inputs = true;
+  return op_data;
+}
+
 void Free(TfLiteContext* context, void* buffer) {
   delete static_cast<OpData*>(buffer);
 }
@@ -130,18 +150,6 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
   const TfLiteTensor* lhs = op_context->lhs;
   const TfLiteTensor* rhs = op_context->rhs;
   TfLiteIntArrayFree(node->temporaries);
-  // For "hybrid" quantization, we impose the constraint that the LHS
-  // is float (typically an activation from a prior layer) and the RHS
-  // is quantized int8.
-  bool is_hybrid =
-      (op_context->lhs->type == kTfLiteFloat32 && rhs->type == kTfLiteInt8);
-  if (is_hybrid) {
-    node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints +
-                                             kNumTempTensorsForHybrid);
-  } else {
-    node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints);
-  }
-
   const int lhs_rank = NumDimensions(lhs);
   const int rhs_rank = NumDimensions(rhs);
   const int batch_size = op_context->params->adj_x
@@ -151,6 +159,47 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
                             ? rhs->dims->data[rhs_rank - 2]
                             : rhs->dims->data[rhs_rank - 1];
 
+  // For "hybrid" quantization, we impose the constraint that the LHS
+  // is float (typically an activation from a prior layer) and the RHS
+  // is quantized int8. With dynamic int8 quantization, a float RHS is
+  // quantized on the fly too, with a scale per output channel.
+  op_data->is_dynamic_int8 = op_data->quantize_float_inputs &&
+                             lhs->type == kTfLiteFloat32 &&
+                             rhs->type == kTfLiteFloat32;
+  op_data->is_rhs_per_channel = false;
+  if (lhs->type == kTfLiteFloat32 && rhs->type == kTfLiteInt8 &&
+      rhs->quantization.type == kTfLiteAffineQuantization) {
+    const auto* affine_quantization =
+        reinterpret_cast<const TfLiteAffineQuantization*>(
+            rhs->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    if (affine_quantization->scale->size > 1) {
+      const int channel_dim =
+          op_context->params->adj_y ? rhs_rank - 2 : rhs_rank - 1;
+      TF_LITE_ENSURE_EQ(context, affine_quantization->quantized_dimension,
+                        channel_dim);
+      TF_LITE_ENSURE_EQ(context, affine_quantization->scale->size, num_units);
+      op_data->is_rhs_per_channel = true;
+    }
+  }
+  bool is_hybrid =
+      (op_context->lhs->type == kTfLiteFloat32 && rhs->type == kTfLiteInt8) ||
+      op_data->is_dynamic_int8;
+  if (op_data->is_dynamic_int8) {
+    node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints +
+                                             kNumTempTensorsForHybrid +
+                                             kNumTempTensorsForDynamicRhs);
+  } else if (op_data->is_rhs_per_channel) {
+    node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints +
+                                             kNumTempTensorsForHybrid + 1);
+  } else if (is_hybrid) {
+    node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints +
+                                             kNumTempTensorsForHybrid);
+  } else {
+    node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints);
+  }
+
   // Temp tensor for Transposed LHS;
   {
     node->temporaries->data[0] = op_data->scratch_tensor_index;
@@ -221,7 +270,7 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
     TfLiteTensor* input_quantized;
     TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/2,
                                                 &input_quantized));
-    input_quantized->type = op_context->rhs->type;
+    input_quantized->type = kTfLiteInt8;
     input_quantized->allocation_type = kTfLiteArenaRw;
 
     TfLiteIntArray* input_quantized_size =
@@ -285,6 +334,42 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, row_sums, row_sums_size));
     }
+
+    if (op_data->is_rhs_per_channel || op_data->is_dynamic_int8) {
+      // The per-channel scales are laid out like the row sums, so that each
+      // RHS matrix has its own; they are copied from the quantization
+      // parameters once, or computed by every quantization of the RHS.
+      op_data->compute_rhs_scales = true;
+      node->temporaries->data[7] = op_data->scratch_tensor_index + 7;
+      TfLiteTensor* rhs_scales;
+      TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/7,
+                                                  &rhs_scales));
+      rhs_scales->type = kTfLiteFloat32;
+      rhs_scales->allocation_type = kTfLiteArenaRwPersistent;
+      if (!TfLiteIntArrayEqualsArray(rhs_scales->dims, 1, row_sums_dims)) {
+        TfLiteIntArray* rhs_scales_size = TfLiteIntArrayCreate(1);
+        rhs_scales_size->data[0] = row_sums_dims[0];
+        TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, rhs_scales,
+                                                         rhs_scales_size));
+      }
+    }
+
+    if (op_data->is_dynamic_int8) {
+      // Holds the RHS quantized in the layout of the transposed RHS.
+      node->temporaries->data[8] = op_data->scratch_tensor_index + 8;
+      TfLiteTensor* rhs_quantized;
+      TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/8,
+                                                  &rhs_quantized));
+      rhs_quantized->type = kTfLiteInt8;
+      rhs_quantized->allocation_type = kTfLiteArenaRw;
+      TfLiteIntArray* rhs_quantized_size = TfLiteIntArrayCopy(rhs->dims);
+      if (!op_context->params->adj_y) {
+        std::swap(rhs_quantized_size->data[rhs_rank - 2],
+                  rhs_quantized_size->data[rhs_rank - 1]);
+      }
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, rhs_quantized,
+                                                       rhs_quantized_size));
+    }
   }
 
   return kTfLiteOk;
@@ -446,6 +531,7 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                         const TfLiteTensor* input,
                         const RuntimeShape& filter_shape,
                         const TfLiteTensor* filter,
+                        const float* per_channel_scale,
                         TfLiteTensor* input_quantized,
                         TfLiteTensor* scaling_factors,
                         TfLiteTensor* accum_scratch, TfLiteTensor* row_sums,
@@ -482,9 +568,11 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                                     input_size, quant_data, scaling_factors_ptr,
                                     input_offset_ptr,
                                     params->asymmetric_quantize_inputs);
-  for (int b = 0; b < num_batches_to_quantize; ++b) {
-    // Incorporate scaling of the filter.
-    scaling_factors_ptr[b] *= filter->params.scale;
+  if (per_channel_scale == nullptr) {
+    for (int b = 0; b < num_batches_to_quantize; ++b) {
+      // Incorporate scaling of the filter.
+      scaling_factors_ptr[b] *= filter->params.scale;
+    }
   }
 
   RuntimeShape output_shape = GetTensorShape(output);
@@ -496,14 +584,16 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
   if (kernel_type == kGenericOptimized) {
     optimized_ops::BatchMatMul(
         filter_shape, filter_data, input_shape, quant_data, scaling_factors_ptr,
-        input_offset_ptr, row_sums_ptr, GetTensorShape(output),
-        GetTensorData<int32_t>(accum_scratch), GetTensorData<float>(output),
-        &(data->compute_row_sums), CpuBackendContext::GetFromContext(context));
+        per_channel_scale, input_offset_ptr, row_sums_ptr,
+        GetTensorShape(output), GetTensorData<int32_t>(accum_scratch),
+        GetTensorData<float>(output), &(data->compute_row_sums),
+        CpuBackendContext::GetFromContext(context));
   } else {
     reference_ops::BatchMatMul(
         filter_shape, filter_data, input_shape, quant_data, scaling_factors_ptr,
-        input_offset_ptr, row_sums_ptr, GetTensorShape(output),
-        GetTensorData<float>(output), &(data->compute_row_sums));
+        per_channel_scale, input_offset_ptr, row_sums_ptr,
+        GetTensorShape(output), GetTensorData<float>(output),
+        &(data->compute_row_sums));
   }
 
   return kTfLiteOk;
@@ -636,9 +726,39 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
     TfLiteTensor* row_sums;
     TF_LITE_ENSURE_OK(context,
                       GetTemporarySafe(context, node, /*index=*/6, &row_sums));
-    return EvalHybrid<kernel_type>(
-        context, node, data, lhs_shape, lhs, rhs_shape, rhs, input_quantized,
-        scaling_factors, accum_scratch, row_sums, input_offsets, output);
+    // The row sums of a RHS that isn't constant change with every run.
+    const TfLiteTensor* original_rhs;
+    TF_LITE_ENSURE_OK(
+        context, GetInputSafe(context, node, kInputRHSTensor, &original_rhs));
+    if (!IsConstantTensor(original_rhs)) {
+      data->compute_row_sums = true;
+    }
+    const float* per_channel_scale = nullptr;
+    if (data->is_rhs_per_channel) {
+      TfLiteTensor* rhs_scales;
+      TF_LITE_ENSURE_OK(
+          context, GetTemporarySafe(context, node, /*index=*/7, &rhs_scales));
+      if (data->compute_rhs_scales) {
+        const auto* affine_quantization =
+            reinterpret_cast<const TfLiteAffineQuantization*>(
+                original_rhs->quantization.params);
+        const int num_units = affine_quantization->scale->size;
+        const int num_weights_matrices =
+            NumElements(rhs_scales) / std::max(num_units, 1);
+        float* rhs_scales_data = GetTensorData<float>(rhs_scales);
+        for (int m = 0; m < num_weights_matrices; ++m) {
+          std::copy_n(affine_quantization->scale->data, num_units,
+                      rhs_scales_data + m * num_units);
+        }
+        data->compute_rhs_scales = false;
+      }
+      per_channel_scale = GetTensorData<float>(rhs_scales);
+    }
+    return EvalHybrid<kernel_type>(context, node, data, lhs_shape, lhs,
+                                   rhs_shape, rhs, per_channel_scale,
+                                   input_quantized, scaling_factors,
+                                   accum_scratch, row_sums, input_offsets,
+                                   output);
   } else if (lhs->type == kTfLiteInt8 && rhs->type == kTfLiteInt8) {
     if (output->type == kTfLiteInt8) {
       return EvalInt8Int8<kernel_type>(context, data, lhs_shape, lhs, rhs_shape,
@@ -660,6 +780,54 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Quantizes each row of the (transposed) float RHS to int8 with its own
+// scale, and then runs the hybrid kernel, which quantizes the LHS.
+template <KernelType kernel_type>
+TfLiteStatus EvalDynamicInt8(TfLiteContext* context, TfLiteNode* node,
+                             OpData* data, const RuntimeShape& lhs_shape,
+                             const TfLiteTensor* lhs,
+                             const RuntimeShape& rhs_shape,
+                             const TfLiteTensor* rhs, TfLiteTensor* output) {
+  TfLiteTensor* input_quantized;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/2,
+                                              &input_quantized));
+  TfLiteTensor* scaling_factors;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/3,
+                                              &scaling_factors));
+  TfLiteTensor* accum_scratch;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/4, &accum_scratch));
+  TfLiteTensor* input_offsets;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/5, &input_offsets));
+  TfLiteTensor* row_sums;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, /*index=*/6, &row_sums));
+  TfLiteTensor* rhs_scales;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, /*index=*/7, &rhs_scales));
+  TfLiteTensor* rhs_quantized;
+  TF_LITE_ENSURE_OK(
+      context, GetTemporarySafe(context, node, /*index=*/8, &rhs_quantized));
+
+  const int rank = rhs_shape.DimensionsCount();
+  const int accum_depth = rhs_shape.Dims(rank - 1);
+  int num_rows = 1;
+  for (int i = 0; i < rank - 1; ++i) {
+    num_rows *= rhs_shape.Dims(i);
+  }
+  TF_LITE_ENSURE(context, NumElements(rhs_scales) >= num_rows);
+  tensor_utils::BatchQuantizeFloats(
+      GetTensorData<float>(rhs), num_rows, accum_depth,
+      GetTensorData<int8_t>(rhs_quantized), GetTensorData<float>(rhs_scales),
+      /*zero_points=*/nullptr, /*do_asymmetric=*/false);
+  data->compute_row_sums = true;
+  return EvalHybrid<kernel_type>(
+      context, node, data, lhs_shape, lhs, rhs_shape, rhs_quantized,
+      GetTensorData<float>(rhs_scales), input_quantized, scaling_factors,
+      accum_scratch, row_sums, input_offsets, output);
+}
+
 TfLiteTensor* GetTempRhs(TfLiteContext* context, TfLiteNode* node,
                          const TfLiteTensor* rhs) {
   TfLiteTensor* transposed_rhs = GetTemporary(context, node, 1);
@@ -740,6 +908,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (rhs->type) {
     case kTfLiteFloat32:
+      if (op_data->is_dynamic_int8) {
+        return EvalDynamicInt8<kernel_type>(context, node, op_data, lhs_shape,
+                                            lhs_tensor, rhs_shape, rhs_tensor,
+                                            output);
+      }
       // Note we pass RHS args first, LHS args second. See note above.
       if (kernel_type == kGenericOptimized) {
         optimized_ops::BatchMatMul(rhs_shape, GetTensorData<float>(rhs_tensor),
@@ -784,6 +957,17 @@ TfLiteRegistration* Register_BATCH_MATMUL_GENERIC_OPTIMIZED() {
   return &r;
 }
 
+// Quantizes float32 operands, e.g. both activations of an attention matmul,
+// to int8 with a scale per row of the LHS and per column of the RHS at every
+// run, and multiplies them with an int8 GEMM. Other types are handled as by
+// Register_BATCH_MATMUL(). Trades accuracy for speed, so it is opt-in.
+TfLiteRegistration* Register_BATCH_MATMUL_DYNAMIC_INT8() {
+  static TfLiteRegistration r = {
+      batch_matmul::InitDynamicInt8, batch_matmul::Free, batch_matmul::Prepare,
+      batch_matmul::Eval<batch_matmul::kGenericOptimized>};
+  return &r;
+}
+
 TfLiteRegistration* Register_BATCH_MATMUL() {
   return Register_BATCH_MATMUL_GENERIC_OPTIMIZED();
 }
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/kernels/builtin_op_kernels.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -420,6 +421,10 @@ class HybridBatchMatMulOpModel : public SingleOpModel {
     SignedSymmetricQuantizeAndPopulate(rhs_id_, f);
   }
 
+  void SetPerChannelWeights(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(rhs_id_, data);
+  }
+
   void SetInput(const std::vector<float>& f) { PopulateTensor(lhs_id_, f); }
   std::vector<float> GetOutput() { return ExtractVector<float>(output_id_); }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_id_); }
@@ -478,6 +483,37 @@ TEST_P(HybridAsymmetricBatchMatMulOpTest, SimpleTestQuantizedInt8) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3}));
 }
 
+TEST_P(HybridAsymmetricBatchMatMulOpTest, NonConstantWeightsQuantizedInt8) {
+  HybridBatchMatMulOpModel m(
+      /*units=*/3, /*batches=*/2,
+      /*lhs=*/{TensorType_FLOAT32, {2, 10}},
+      /*rhs=*/{TensorType_INT8, {10, 3}, 0, 0, 10.0 / 127.0, 0});
+
+  m.SetInput({
+      11, 12, 13, 14, 15, 16, 17, 18,  -19, -20,  // batch 1, 0
+      11, 12, 13, 14, 15, 16, 17, -18, 19,  -20,  // batch 1, 1
+  });
+  m.SetSignedWeights({
+      1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5,  5,  5,
+      6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 10,
+  });
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({196, 196, 196, 246, 246, 246},
+                                              /*max_abs_error=*/0.64f)));
+
+  // The row sums of the weights, which the input offsets are applied to, have
+  // to follow the new weights.
+  m.SetSignedWeights({
+      -1, -1, -1, -2, -2, -2, -3, -3, -3, -4, -4,  -4,  -5,  -5,  -5,
+      -6, -6, -6, -7, -7, -7, -8, -8, -8, -9, -9, -9, -10, -10, -10,
+  });
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {-196, -196, -196, -246, -246, -246},
+                                 /*max_abs_error=*/0.64f)));
+}
+
 TEST_P(HybridAsymmetricBatchMatMulOpTest, MultipleNumBatchQuantizedInt8) {
   // need 4 scale factors
   HybridBatchMatMulOpModel m(
@@ -910,10 +946,156 @@ TEST_P(HybridSymmetricBatchMatMulOpTest, QuantizedInt8BroadcastInputs) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 3}));
 }
 
+TEST_P(HybridSymmetricBatchMatMulOpTest, PerChannelQuantizedInt8) {
+  HybridBatchMatMulOpModel m(
+      /*units=*/3, /*batches=*/2,
+      /*lhs=*/{TensorType_FLOAT32, {2, 10}},
+      /*rhs=*/
+      {TensorType_INT8, {10, 3}, 0, 0, 0, 0, /*per_channel_quantization=*/true,
+       /*per_channel_quantization_scales=*/{1.0, 2.0, 0.5},
+       /*per_channel_quantization_offsets=*/{0, 0, 0}, /*channel_index=*/1},
+      /*output=*/{TensorType_FLOAT32}, /*asymmetric_quantize_inputs=*/false);
+
+  m.SetPerChannelWeights({
+      1, 2,  -0.5, 2, 4,  -1,   3, 6,  -1.5, 4,  8,  -2,   5,  10, -2.5,
+      6, 12, -3,   7, 14, -3.5, 8, 16, -4,   9,  18, -4.5, 10, 20, -5,
+  });
+
+  m.SetInput({
+      11, 12, 13, 14, 15, 16, 17, 18,  -19, -20,  // batch 1, 0
+      11, 12, 13, 14, 15, 16, 17, -18, 19,  -20,  // batch 1, 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     192.598,
+                                     385.197,
+                                     -96.299,
+                                     248.346,
+                                     496.693,
+                                     -124.173,
+                                 },
+                                 /*max_abs_error=*/0.01f)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3}));
+}
+
+TEST_P(HybridSymmetricBatchMatMulOpTest, PerChannelQuantizedInt8BatchWeights) {
+  // Every one of the 2x2 weights matrices has its own row sums and scales.
+  HybridBatchMatMulOpModel m(
+      /*units=*/2, /*batches=*/4,
+      /*lhs=*/{TensorType_FLOAT32, {2, 2, 1, 2}},
+      /*rhs=*/
+      {TensorType_INT8, {2, 2, 2, 2}, 0, 0, 0, 0,
+       /*per_channel_quantization=*/true,
+       /*per_channel_quantization_scales=*/{1.0, 0.5},
+       /*per_channel_quantization_offsets=*/{0, 0}, /*channel_index=*/3},
+      /*output=*/{TensorType_FLOAT32}, /*asymmetric_quantize_inputs=*/false);
+
+  m.SetPerChannelWeights({
+      1, 0.5, -1, 1.5,  // batch 0, 0
+      2, 1,   -1, 1.5,  // batch 0, 1
+      3, 1.5, -1, 1.5,  // batch 1, 0
+      4, 2,   -1, 1.5,  // batch 1, 1
+  });
+
+  m.SetInput({1, 1, 2, -2, 0, 3, -4, 4});
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({0, 2, 6, -1, -3, 4.5, -20, -2},
+                                              /*max_abs_error=*/1e-4f)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 1, 2}));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     HybridSymmetricBatchMatMulOpTest, HybridSymmetricBatchMatMulOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
 
+const auto kDynamicInt8KernelMap = new std::map<string, TfLiteRegistration*>({
+    {"DynamicInt8", ops::builtin::Register_BATCH_MATMUL_DYNAMIC_INT8()},
+});
+
+// Both float operands are quantized to int8 at every run, the LHS per row and
+// the RHS per column, so the expected outputs carry their rounding errors.
+class DynamicInt8BatchMatMulOpTest : public SingleOpTest {
+ protected:
+  const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
+    return *kDynamicInt8KernelMap;
+  }
+};
+
+TEST_P(DynamicInt8BatchMatMulOpTest, Float32Test_Simple) {
+  BatchMatMulOpModel<float> model({TensorType_FLOAT32, {1, 2, 3}},
+                                  {TensorType_FLOAT32, {1, 3, 4}});
+  model.PopulateTensor<float>(model.lhs(), {1, 2, 3, 4, 5, 6});
+  model.PopulateTensor<float>(model.rhs(),
+                              {7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {73.9686, 80.0308, 85.9686, 92.1572, 172.9915, 188.3157,
+                   203.0388, 218.6784},
+                  /*max_abs_error=*/0.02f)));
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 2, 4}));
+
+  // Both operands are quantized again for new values.
+  model.PopulateTensor<float>(model.lhs(), {-1, -2, -3, -4, -5, -6});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-73.9686, -80.0308, -85.9686, -92.1572, -172.9915,
+                   -188.3157, -203.0388, -218.6784},
+                  /*max_abs_error=*/0.02f)));
+}
+
+TEST_P(DynamicInt8BatchMatMulOpTest, Float32Test_Broadcast2RHSAdjoint) {
+  BatchMatMulOpModel<float> model({TensorType_FLOAT32, {2, 1, 3, 2}},
+                                  {TensorType_FLOAT32, {3, 4, 2}}, false, true);
+  model.PopulateTensor<float>(model.lhs(),
+                              {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+  model.PopulateTensor<float>(model.rhs(),
+                              {7,  11, 8,  12, 9,  13, 10, 14, 15, 19, 16, 20,
+                               17, 21, 18, 22, 23, 27, 24, 28, 25, 29, 26, 30});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(
+      model.GetOutput(),
+      ElementsAreArray(ArrayFloatNear(
+          {29.071,   32.0947,  35.0788,  38.1105,  64.992,   72.0312,
+           78.9527,  86.0155,  101.134,  112.2207, 123.1103, 134.2365,
+           53.0784,  56.1895,  59.1656,  62.1576,  120.7641, 128.0625,
+           134.9604, 141.9054, 188.9209, 200.4414, 211.2916, 222.2206,
+           77.1414,  80.2207,  83.0857,  86.1889,  176.7011, 183.9053,
+           190.4733, 197.7482, 276.9839, 288.3467, 298.6448, 310.1259,
+           137.055,  152.1572, 166.9842, 182.1415, 172.976,  192.0937,
+           210.8581, 230.0465, 208.897,  232.0303, 254.732,  277.9515,
+           256.6066, 272.3145, 287.0864, 301.9684, 324.2923, 344.1875,
+           362.8811, 381.7162, 391.9779, 416.0605, 438.6759, 461.4639,
+           376.5436, 392.0312, 406.0324, 421.6852, 476.1033, 495.7158,
+           513.4199, 533.2445, 575.663,  599.4003, 620.8075, 644.8038},
+          /*max_abs_error=*/0.02f)));
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({2, 3, 3, 4}));
+}
+
+TEST_P(DynamicInt8BatchMatMulOpTest, Int8Test_Simple) {
+  // Operands that are already int8 are multiplied as by the default kernel.
+  BatchMatMulOpModel<int32_t> model({TensorType_INT8, {1, 2, 3}},
+                                    {TensorType_INT8, {1, 3, 4}});
+  model.PopulateTensor<int8_t>(model.lhs(), {1, 2, 3, 4, 5, 6});
+  model.PopulateTensor<int8_t>(model.rhs(),
+                               {7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray({74, 80, 86, 92, 173, 188, 203, 218}));
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 2, 4}));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DynamicInt8BatchMatMulOpTest, DynamicInt8BatchMatMulOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kDynamicInt8KernelMap)));
+
 class QuantizedBatchMatMulOpModel : public SingleOpModel {
  public:
   QuantizedBatchMatMulOpModel(int units, int batches, const TensorData& lhs,
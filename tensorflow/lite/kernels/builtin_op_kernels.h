@@ -41,6 +41,9 @@ TfLiteRegistration* Register_ASSIGN_VARIABLE();
 TfLiteRegistration* Register_AVERAGE_POOL_2D();
 TfLiteRegistration* Register_BATCH_TO_SPACE_ND();
 TfLiteRegistration* Register_BATCH_MATMUL();
+// Opt-in variant of BATCH_MATMUL that quantizes float32 operands to int8 at
+// run time. Not part of the standard `BuiltinOpResolver`.
+TfLiteRegistration* Register_BATCH_MATMUL_DYNAMIC_INT8();
 TfLiteRegistration* Register_BIDIRECTIONAL_SEQUENCE_LSTM();
 TfLiteRegistration* Register_BIDIRECTIONAL_SEQUENCE_RNN();
 TfLiteRegistration* Register_BROADCAST_ARGS();
@@ -37,6 +37,8 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse_matmul.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/conv.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -120,6 +122,12 @@ struct OpData {
 
   // Number of convolution groups.
   int32_t groups = 1;
+
+  // Sparse filters are re-encoded once into one of these, depending on their
+  // type, and run with the block-sparse kernel regardless of the kernel type.
+  bool is_sparse = false;
+  optimized_ops::BlockSparseMatrix<float> sparse_filter_float;
+  optimized_ops::BlockSparseMatrix<int8_t> sparse_filter_int8;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -177,6 +185,9 @@ bool IsIm2ColRequired(const TfLiteTensor* input, TfLiteConvParams* params,
   // If HWCN weights are required, Im2Col not required
   if (data->need_hwcn_weights) return false;
 
+  // The block-sparse kernel gathers its own input patches.
+  if (data->is_sparse) return false;
+
   // segregate based on dilated conv & non-dialated conv
   const bool need_dilated_im2col =
       params->dilation_width_factor != 1 || params->dilation_height_factor != 1;
@@ -424,10 +435,45 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     }
   }
 
+  // Sparse filters are only supported by the block-sparse kernel, for float
+  // and int8 convolutions.
+  data->is_sparse = filter->sparsity != nullptr;
+  if (data->is_sparse) {
+    TF_LITE_ENSURE(context, IsConstantTensor(filter));
+    TF_LITE_ENSURE_EQ(context, data->groups, 1);
+    if (!((input_type == kTfLiteFloat32 && filter->type == kTfLiteFloat32) ||
+          (input_type == kTfLiteInt8 && filter->type == kTfLiteInt8))) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Sparse filters are only supported for float32 and "
+                         "int8 convolutions, got %s input and %s filter.",
+                         TfLiteTypeGetName(input_type),
+                         TfLiteTypeGetName(filter->type));
+      return kTfLiteError;
+    }
+    // The kernel views the filter as a [output_depth, filter_height *
+    // filter_width * input_depth] matrix.
+    const int filter_cols = SizeOfDimension(filter, 1) *
+                            SizeOfDimension(filter, 2) *
+                            SizeOfDimension(filter, 3);
+    if (filter->type == kTfLiteFloat32) {
+      if (data->sparse_filter_float.rows == 0) {
+        TF_LITE_ENSURE_OK(context,
+                          optimized_ops::BuildBlockSparseMatrixFromTensor(
+                              context, filter, filter_cols,
+                              &data->sparse_filter_float));
+      }
+    } else if (data->sparse_filter_int8.rows == 0) {
+      TF_LITE_ENSURE_OK(context,
+                        optimized_ops::BuildBlockSparseMatrixFromTensor(
+                            context, filter, filter_cols,
+                            &data->sparse_filter_int8));
+    }
+  }
+
   // The multi-threaded kernel supports neither dilation nor hybrid kernels, and
   // is incompatible with mutable input filters that might change between evals.
   data->supports_multithreaded_kernel =
-      (kernel_type == kMultithreadOptimized) &&
+      (kernel_type == kMultithreadOptimized) && !data->is_sparse &&
       (context->recommended_num_threads != 1) && !is_hybrid &&
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
@@ -743,6 +789,18 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
 
+  if (data->is_sparse) {
+    optimized_ops::BlockSparseConv(
+        op_params, data->sparse_filter_int8,
+        data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), GetTensorShape(input),
+        GetTensorData<int8>(input), GetTensorShape(filter),
+        GetTensorData<int32>(bias), GetTensorShape(output),
+        GetTensorData<int8>(output),
+        CpuBackendContext::GetFromContext(context));
+    return;
+  }
+
   KernelType effective_kernel_type = kernel_type;
   // We have to fallback to reference execution path when im2col is needed but
   // disabled because to-be-allocated temporary im2col tensor is too large.
@@ -903,6 +961,16 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.dilation_height_factor = params->dilation_height_factor;
   op_params.float_activation_min = output_activation_min;
   op_params.float_activation_max = output_activation_max;
+  if (data->is_sparse) {
+    optimized_ops::BlockSparseConv(
+        op_params, data->sparse_filter_float,
+        /*per_channel_multiplier=*/nullptr, /*per_channel_shift=*/nullptr,
+        GetTensorShape(input), GetTensorData<float>(input),
+        GetTensorShape(filter), GetTensorData<float>(bias),
+        GetTensorShape(output), GetTensorData<float>(output),
+        CpuBackendContext::GetFromContext(context));
+    return;
+  }
   switch (effective_kernel_type) {
     case kReference: {
       reference_ops::Conv(op_params, GetTensorShape(input),
@@ -1966,6 +1966,131 @@ TEST_P(ConvolutionOpTest, SimpleTestHybridWithDilationPerChannel) {
                                  0.16)));
 }
 
+// Convolution with a constant sparse filter. Float filters are stored as is,
+// int8 filters are quantized with the filter scale.
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input, const TensorData& filter,
+                           const std::vector<float>& filter_data,
+                           const TensorData& output, int stride_width = 1,
+                           int stride_height = 1,
+                           enum Padding padding = Padding_VALID)
+      : is_float_(input.type == TensorType_FLOAT32) {
+    input_ = AddInput(input);
+    filter_ = AddConstSparseInput(filter, filter_data);
+    const int bias_size = filter.shape[0];
+    if (is_float_) {
+      bias_ = AddInput({TensorType_FLOAT32, {bias_size}});
+    } else {
+      bias_ = AddInput({TensorType_INT32, {bias_size}, 0, 0,
+                        GetScale(input_) * GetScale(filter_)});
+    }
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, padding, stride_width,
+                                     stride_height, ActivationFunctionType_NONE)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                    registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    if (is_float_) {
+      PopulateTensor(input_, data);
+    } else {
+      QuantizeAndPopulate<int8_t>(input_, data);
+    }
+  }
+  void SetBias(std::initializer_list<float> data) {
+    if (is_float_) {
+      PopulateTensor(bias_, data);
+    } else {
+      QuantizeAndPopulate<int32_t>(bias_, data);
+    }
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int8_t> GetQuantizedOutput() {
+    return ExtractVector<int8_t>(output_);
+  }
+
+ private:
+  bool is_float_;
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, Sparse1x4FilterFloat32) {
+  TensorData filter = {TensorType_FLOAT32, {4, 2, 2, 4}};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {3};
+  filter.block_size = {4};
+  SparseConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {1, 3, 3, 4}}, filter,
+      // [4 * 2 * 2 * 4] as [output_channel, y, x, input_channel]
+      {
+          1, 2, 3, 4, 0, 0, 0,  0,   // out channel = 0, y = 0
+          0, 0, 0, 0, 0, 0, 0,  0,   // out channel = 0, y = 1
+          0, 0, 0, 0, 1, 0, -1, 0,   // out channel = 1, y = 0
+          0, 1, 0, 1, 0, 0, 0,  0,   // out channel = 1, y = 1
+          0, 0, 0, 0, 0, 0, 0,  0,   // out channel = 2, y = 0
+          0, 0, 0, 0, 2, 2, 2,  2,   // out channel = 2, y = 1
+          1, 1, 0, 0, 0, 0, 0,  0,   // out channel = 3, y = 0
+          0, 0, 0, 0, 0, 0, -1, -1,  // out channel = 3, y = 1
+      },
+      {TensorType_FLOAT32, {}});
+  m.SetInput({
+      1, 2, 3, 4, 1, -1, 1, -1, 2,  0,  1, 0,  // y = 0
+      0, 1, 0, 1, 3, 2,  1, 0,  -1, -2, 0, 1,  // y = 1
+      1, 1, 1, 1, 0, 0,  2, 2,  4,  3,  2, 1,  // y = 2
+  });
+  m.SetBias({1, 2, 3, 4});
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 31, 4, 15, 6,   // y = 0, x = 0
+                                 -1, 5, -1, 3,   // y = 0, x = 1
+                                 7, 6, 11, 1,    // y = 1, x = 0
+                                 11, 3, 23, 6,   // y = 1, x = 1
+                             }));
+}
+
+TEST_P(ConvolutionOpTest, Sparse4x1FilterInt8) {
+  TensorData filter = {TensorType_INT8, {4, 3, 3, 2}, 0, 0, 1};
+  filter.traversal_order = {0, 1, 2, 3, 4};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {0};
+  filter.block_size = {4};
+  SparseConvolutionOpModel m(
+      GetRegistration(), {TensorType_INT8, {1, 2, 2, 2}, 0, 0, 1}, filter,
+      // [4 * 3 * 3 * 2] as [output_channel, y, x, input_channel]
+      {
+          1,  0, 0, 0, 0, 0, 0, 0, 1,  2,  0, 0, 0, 0, 0, 0, 0, 0,  // o = 0
+          0,  1, 0, 0, 0, 0, 0, 0, 3,  4,  0, 0, 0, 0, 0, 0, 0, 0,  // o = 1
+          1,  1, 0, 0, 0, 0, 0, 0, -1, 1,  0, 0, 0, 0, 0, 0, 0, 0,  // o = 2
+          -1, 0, 0, 0, 0, 0, 0, 0, 2,  -2, 0, 0, 0, 0, 0, 0, 0, 0,  // o = 3
+      },
+      {TensorType_INT8, {}, 0, 0, 1}, /*stride_width=*/1, /*stride_height=*/1,
+      Padding_SAME);
+  m.SetInput({1, 2, 3, 4, -1, 0, 2, 2});
+  m.SetBias({1, 0, -1, 2});
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetQuantizedOutput(), ElementsAreArray({
+                                          6, 11, 0, 0,    // y = 0, x = 0
+                                          12, 25, 0, 0,   // y = 0, x = 1
+                                          0, -3, 0, 0,    // y = 1, x = 0
+                                          8, 16, 2, 1,    // y = 1, x = 1
+                                      }));
+}
+
 const auto kQuantizedKernelMap = new std::map<string, TfLiteRegistration*>({
     {"GenericOptimized", ops::builtin::Register_CONV_2D_UINT8()},
 });
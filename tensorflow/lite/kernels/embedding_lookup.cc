@@ -54,6 +54,19 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* value;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 1, &value));
   TF_LITE_ENSURE(context, NumDimensions(value) >= 2);
+  if (value->quantization.type == kTfLiteAffineQuantization) {
+    const auto* affine_quantization =
+        reinterpret_cast<const TfLiteAffineQuantization*>(
+            value->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    // Per-channel quantized embeddings must have one scale per row.
+    if (affine_quantization->scale->size > 1) {
+      TF_LITE_ENSURE_EQ(context, affine_quantization->quantized_dimension, 0);
+      TF_LITE_ENSURE_EQ(context, affine_quantization->scale->size,
+                        SizeOfDimension(value, 0));
+    }
+  }
 
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
@@ -101,7 +114,16 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                         const TfLiteTensor* lookup, const TfLiteTensor* value,
                         TfLiteTensor* output) {
   const int row_size = SizeOfDimension(value, 0);
-  const double scaling_factor = value->params.scale;
+  // Per-channel quantized embeddings have a scale for each row.
+  const float* per_row_scale = nullptr;
+  if (value->quantization.type == kTfLiteAffineQuantization) {
+    const auto* affine_quantization =
+        reinterpret_cast<const TfLiteAffineQuantization*>(
+            value->quantization.params);
+    if (affine_quantization->scale->size > 1) {
+      per_row_scale = affine_quantization->scale->data;
+    }
+  }
 
   // col_size after we flatten tensor into 2D.
   int col_size = 1;
@@ -125,6 +147,8 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
       // Dequantize embedding values.
       // TODO(alanchiao): refactor scalar multiply into separate function
       // for ease of adding a neon equivalent if ever necessary.
+      const double scaling_factor =
+          per_row_scale != nullptr ? per_row_scale[idx] : value->params.scale;
       for (int j = 0; j < col_size; j++) {
         output_ptr[j + i * col_size] =
             value_ptr[j + idx * col_size] * scaling_factor;
@@ -49,6 +49,16 @@ class BaseEmbeddingLookupOpModel : public SingleOpModel {
     BuildInterpreter({index_shape, weight_shape});
   }
 
+  BaseEmbeddingLookupOpModel(std::initializer_list<int> index_shape,
+                             const TensorData& weight,
+                             TensorType output_type = TensorType_FLOAT32) {
+    input_ = AddInput(TensorType_INT32);
+    weight_ = AddInput(weight);
+    output_ = AddOutput(output_type);
+    SetBuiltinOp(BuiltinOperator_EMBEDDING_LOOKUP, BuiltinOptions_NONE, 0);
+    BuildInterpreter({index_shape, weight.shape});
+  }
+
   void SetInput(std::initializer_list<int> data) {
     PopulateTensor(input_, data);
   }
@@ -101,6 +111,25 @@ class HybridEmbeddingLookupOpModel : public BaseEmbeddingLookupOpModel {
   }
 };
 
+class PerChannelHybridEmbeddingLookupOpModel
+    : public BaseEmbeddingLookupOpModel {
+ public:
+  PerChannelHybridEmbeddingLookupOpModel(
+      std::initializer_list<int> index_shape,
+      std::initializer_list<int> weight_shape,
+      const std::vector<float>& row_scales)
+      : BaseEmbeddingLookupOpModel(
+            index_shape,
+            {TensorType_INT8, weight_shape, 0, 0, 0, 0,
+             /*per_channel_quantization=*/true, row_scales,
+             std::vector<int64_t>(row_scales.size(), 0),
+             /*channel_index=*/0}) {}
+
+  void SetSignedWeight(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(weight_, data);
+  }
+};
+
 // TODO(ahentz): write more tests that exercise the details of the op, such as
 // lookup errors and variable input shapes.
 TEST(EmbeddingLookupOpTest, SimpleTest) {
@@ -245,6 +274,30 @@ TEST(HybridEmbeddingLookupHybridOpTest, Simple4DTestInt8) {
                   kTestTolerance)));
 }
 
+TEST(HybridEmbeddingLookupHybridOpTest, Simple2DTestPerChannelInt8) {
+  // Rows of very different magnitudes would lose the small ones with a
+  // single scale.
+  PerChannelHybridEmbeddingLookupOpModel m({3}, {3, 8},
+                                           {0.00001, 0.01, 0.25});
+  m.SetInput({1, 0, 2});
+  m.SetSignedWeight({
+      0.0,  0.0001, 0.0002, 0.0003, 0.001, 0.0011, 0.0012, -0.0012,  // Row 0
+      1.00, -1.01,  1.02,   1.03,   1.10,  1.11,   1.12,   1.13,     // Row 1
+      20.0, 20.25,  20.5,   20.75,  21.0,  21.25,  21.5,   -21.75,   // Row 2
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput<float>(),
+              ElementsAreArray(ArrayFloatNear({
+                  1.00, -1.01, 1.02, 1.03, 1.10, 1.11, 1.12, 1.13,  // Row 1
+                  0.0, 0.0001, 0.0002, 0.0003, 0.001, 0.0011, 0.0012,
+                  -0.0012,  // Row 0
+                  20.0, 20.25, 20.5, 20.75, 21.0, 21.25, 21.5,
+                  -21.75,  // Row 2
+              })));
+}
+
 TEST(EmbeddingLookupHybridOpTest, Simple3DTestQuantized) {
   EmbeddingLookupOpModel m({3}, {3, 2, 4}, TensorType_UINT8, TensorType_INT8);
   m.SetInput({1, 0, 2});
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse_matmul.h"
 #include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
@@ -53,6 +54,16 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
 
+// Returns true if `sparsity` has 1 x `block_cols` blocks, the formats with
+// dedicated kernels.
+bool IsRowBlockSparse(const TfLiteSparsity& sparsity, int block_cols) {
+  return SupportedSparsityFormat(sparsity) &&
+         sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+         sparsity.block_map != nullptr && sparsity.block_map->size == 1 &&
+         sparsity.block_map->data[0] == 1 &&
+         sparsity.dim_metadata[2].dense_size == block_cols;
+}
+
 TfLiteStatus CreateLedgerTensor(const TfLiteSparsity* sparsity,
                                 TfLiteContext* context, TfLiteTensor* ledger) {
   TF_LITE_ENSURE(context, sparsity != nullptr);
@@ -120,6 +131,11 @@ struct OpData {
   bool compute_row_sums = false;
   // Only used for sparse hybrid fully connected kernels.
   bool ledger_initialized;
+  // Sparse weights in a format without a dedicated kernel are re-encoded once
+  // into one of these and run with the generic block-sparse kernel.
+  bool use_block_sparse_weights = false;
+  optimized_ops::BlockSparseMatrix<float> block_sparse_weights_float;
+  optimized_ops::BlockSparseMatrix<int8_t> block_sparse_weights_int8;
 };
 
 constexpr int kInputTensor = 0;
@@ -446,6 +462,65 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+// Returns true if the sparse `filter` is run with the generic block-sparse
+// kernel, i.e. if the kernel in use has no dedicated path for its format.
+bool UseBlockSparseWeights(KernelType kernel_type, const OpData* data,
+                           const TfLiteTensor* input,
+                           const TfLiteTensor* filter,
+                           const TfLiteTensor* output) {
+  const TfLiteSparsity& sparsity = *filter->sparsity;
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32) {
+    const bool is_random_sparse =
+        SupportedSparsityFormat(sparsity) &&
+        sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse;
+    return kernel_type == kGenericOptimized && !is_random_sparse &&
+           !IsRowBlockSparse(sparsity, 4);
+  }
+  if (input->type == kTfLiteInt8 && filter->type == kTfLiteInt8 &&
+      output->type == kTfLiteInt8) {
+    // The 1x16 kernel only supports per-tensor quantization.
+    const bool is_per_channel = data->per_channel_output_multiplier.size() > 1;
+    return is_per_channel || !IsRowBlockSparse(sparsity, 16);
+  }
+  return false;
+}
+
+// Re-encodes sparse weights that need the generic block-sparse kernel. This
+// happens once, the weights being constant.
+TfLiteStatus PrepareBlockSparseWeights(KernelType kernel_type,
+                                       TfLiteContext* context,
+                                       TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  const TfLiteTensor* filter;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kWeightsTensor, &filter));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  data->use_block_sparse_weights =
+      filter->sparsity != nullptr &&
+      UseBlockSparseWeights(kernel_type, data, input, filter, output);
+  if (!data->use_block_sparse_weights) return kTfLiteOk;
+  TF_LITE_ENSURE(context, IsConstantTensor(filter));
+  const int filter_cols = SizeOfDimension(filter, 1);
+  if (filter->type == kTfLiteFloat32) {
+    if (data->block_sparse_weights_float.rows == 0) {
+      TF_LITE_ENSURE_OK(context,
+                        optimized_ops::BuildBlockSparseMatrixFromTensor(
+                            context, filter, filter_cols,
+                            &data->block_sparse_weights_float));
+    }
+  } else if (data->block_sparse_weights_int8.rows == 0) {
+    TF_LITE_ENSURE_OK(context,
+                      optimized_ops::BuildBlockSparseMatrixFromTensor(
+                          context, filter, filter_cols,
+                          &data->block_sparse_weights_int8));
+  }
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Check for supported activation types.
@@ -469,7 +544,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                 params->activation == kTfLiteActReluN1To1 ||
                                 params->activation == kTfLiteActRelu6);
   }
-  return PrepareImpl(context, node);
+  TF_LITE_ENSURE_STATUS(PrepareImpl(context, node));
+  return PrepareBlockSparseWeights(kernel_type, context, node);
 }
 
 TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
@@ -1012,6 +1088,19 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                                "supports symmetric weight quantization only.");
             return kTfLiteError;
           }
+          if (data->use_block_sparse_weights) {
+            optimized_ops::FullyConnectedBlockSparseWeight(
+                data->block_sparse_weights_int8, op_params,
+                is_per_channel ? data->per_channel_output_multiplier.data()
+                               : nullptr,
+                is_per_channel ? data->per_channel_output_shift.data()
+                               : nullptr,
+                input_shape, GetTensorData<int8_t>(input),
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
+            break;
+          }
           if (!SupportedSparsityFormat(sparsity) ||
               !VerifySparsity(filter_shape, input_shape, output_shape,
                               &sparsity)) {
@@ -1020,8 +1109,7 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 "Invalid quantized and sparse fully-connected format.");
             return kTfLiteError;
           }
-          if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+          if (IsRowBlockSparse(sparsity, 16)) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1186,7 +1274,15 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
     FullyConnectedParams op_params;
     op_params.float_activation_min = output_activation_min;
     op_params.float_activation_max = output_activation_max;
-    if (filter->sparsity != nullptr) {
+    if (data->use_block_sparse_weights) {
+      optimized_ops::FullyConnectedBlockSparseWeight(
+          data->block_sparse_weights_float, op_params,
+          /*per_channel_multiplier=*/nullptr, /*per_channel_shift=*/nullptr,
+          GetTensorShape(input), GetTensorData<float>(input),
+          GetTensorData<float>(bias), GetTensorShape(output),
+          GetTensorData<float>(output),
+          CpuBackendContext::GetFromContext(context));
+    } else if (filter->sparsity != nullptr) {
       const auto& sparsity = *filter->sparsity;
       if (!SupportedSparsityFormat(sparsity)) {
         TF_LITE_KERNEL_LOG(context,
@@ -1210,8 +1306,7 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             filter_shape, GetTensorData<float>(filter),  // Disable formatting
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output));
-      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-                 sparsity.dim_metadata[2].dense_size == 4) {
+      } else if (IsRowBlockSparse(sparsity, 4)) {
         // Block sparse with block size of 1x4.
         optimized_ops::FullyConnectedSparseWeight1x4(
             sparsity, op_params,                         // Disable formatting
@@ -1860,6 +1860,88 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple4x4Test) {
+  std::initializer_list<float> weight_data = {
+      1,  2,  3,  4,  0, 0, 0, 0,  // u = 0
+      -1, -2, -3, -4, 0, 0, 0, 0,  // u = 1
+      1,  0,  1,  0,  0, 0, 0, 0,  // u = 2
+      0,  1,  0,  1,  0, 0, 0, 0,  // u = 3
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {4, 8};
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    SparseFullyConnectedOpModel<float> m(
+        GetRegistration(),
+        /*units=*/4, /*batches=*/2,
+        /*input=*/{TensorType_FLOAT32, {2, 8}}, weight, weight_data,
+        /*output=*/{TensorType_FLOAT32},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+    m.SetBias({1, 2, 3, 4});
+
+    m.SetInput({
+        1,  2,  3,  4,  5, 6, 7, 8,  // b = 0
+        -1, -2, -3, -4, 1, 1, 1, 1,  // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 4));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(31, 0, 7, 10, 0, 32, 0, 0));
+  }
+}
+
+TEST_P(SparseFullyConnectedOpTest, Simple16x1TestNoBias) {
+  std::initializer_list<float> weight_data = {
+      1, 0, 0, 1,   // u = 0
+      2, 0, 0, 1,   // u = 1
+      3, 0, 0, 1,   // u = 2
+      4, 0, 0, 1,   // u = 3
+      5, 0, 0, 1,   // u = 4
+      6, 0, 0, 1,   // u = 5
+      7, 0, 0, 1,   // u = 6
+      8, 0, 0, 1,   // u = 7
+      9, 0, 0, 1,   // u = 8
+      10, 0, 0, 1,  // u = 9
+      11, 0, 0, 1,  // u = 10
+      12, 0, 0, 1,  // u = 11
+      13, 0, 0, 1,  // u = 12
+      14, 0, 0, 1,  // u = 13
+      15, 0, 0, 1,  // u = 14
+      16, 0, 0, 1,  // u = 15
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {16, 4};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0};
+  weight.block_size = {16};
+  SparseFullyConnectedOpModel<float> m(
+      GetRegistration(), /*units=*/16, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 4}}, weight, weight_data,
+      /*output=*/{TensorType_FLOAT32},
+      /*bias_tensor_optional=*/true);
+
+  m.SetInput({
+      1, 5, 5, 2,   // b = 0
+      -1, 5, 5, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 16));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray({3, 4,  5,  6,  7,  8,  9,  10,  // b = 0
+                                11, 12, 13, 14, 15, 16, 17, 18,
+                                0, 0,  0,  0,  0,  0,  0,  0,   // b = 1
+                                0, 0,  0,  0,  0,  0,  0,  0}));
+}
+
 TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16Test) {
   std::initializer_list<float> weight_data = {
       /* 1st row */
@@ -2145,6 +2227,36 @@ TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestScaledInputOutput) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(-52, -50, -52));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple4x4Test) {
+  std::vector<float> weight_data = {
+      1,  2,  3,  4,  0, 0, 0,  0,  // u = 0
+      -1, -2, -3, -4, 0, 0, 0,  0,  // u = 1
+      0,  0,  0,  0,  1, 1, 1,  1,  // u = 2
+      0,  0,  0,  0,  2, 0, -2, 1,  // u = 3
+  };
+  TensorData weight = {TensorType_INT8, {4, 8}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/4, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 8}, 0, 0, 1}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3, 4});
+  m.SetInput({
+      1, 2, 3, 4, 1,  2,  3,  4,   // b = 0
+      4, 3, 2, 1, -1, -2, -3, -4,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 4));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(31, 0, 13, 4, 21, 0, 0, 4));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     SparseQuantizedFullyConnectedOpTest, SparseQuantizedFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
@@ -0,0 +1,210 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/fused_elementwise.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace fused_elementwise {
+namespace {
+
+constexpr int kInputTensor = 0;
+constexpr int kOutputTensor = 0;
+
+// Number of elements that go through all the steps before moving on, small
+// enough for the running values to stay in the L1 cache between steps.
+constexpr int kTileSize = 1024;
+
+bool IsBinary(StepType type) {
+  switch (type) {
+    case StepType::kAdd:
+    case StepType::kSub:
+    case StepType::kReverseSub:
+    case StepType::kMul:
+    case StepType::kDiv:
+    case StepType::kReverseDiv:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Size of the innermost dimension, which per-channel operands broadcast along.
+int NumChannels(const TfLiteTensor* input) {
+  const int num_dims = NumDimensions(input);
+  return num_dims == 0 ? 1 : SizeOfDimension(input, num_dims - 1);
+}
+
+template <typename Op>
+void ApplyBinary(const float* operand, bool is_scalar, int channels,
+                 float* values, int size, Op op) {
+  if (is_scalar) {
+    const float c = operand[0];
+    for (int i = 0; i < size; ++i) values[i] = op(values[i], c);
+    return;
+  }
+  for (int i = 0; i < size; i += channels) {
+    float* row = values + i;
+    for (int j = 0; j < channels; ++j) row[j] = op(row[j], operand[j]);
+  }
+}
+
+template <typename Op>
+void ApplyUnary(float* values, int size, Op op) {
+  for (int i = 0; i < size; ++i) values[i] = op(values[i]);
+}
+
+void ApplyStep(const Step& step, const TfLiteTensor* operand, int channels,
+               float* values, int size) {
+  const float* c = operand ? GetTensorData<float>(operand) : nullptr;
+  const bool is_scalar = operand && NumElements(operand) == 1;
+  switch (step.type) {
+    case StepType::kAdd:
+      ApplyBinary(c, is_scalar, channels, values, size,
+                  [](float x, float y) { return x + y; });
+      break;
+    case StepType::kSub:
+      ApplyBinary(c, is_scalar, channels, values, size,
+                  [](float x, float y) { return x - y; });
+      break;
+    case StepType::kReverseSub:
+      ApplyBinary(c, is_scalar, channels, values, size,
+                  [](float x, float y) { return y - x; });
+      break;
+    case StepType::kMul:
+      ApplyBinary(c, is_scalar, channels, values, size,
+                  [](float x, float y) { return x * y; });
+      break;
+    case StepType::kDiv:
+      ApplyBinary(c, is_scalar, channels, values, size,
+                  [](float x, float y) { return x / y; });
+      break;
+    case StepType::kReverseDiv:
+      ApplyBinary(c, is_scalar, channels, values, size,
+                  [](float x, float y) { return y / x; });
+      break;
+    case StepType::kRelu:
+      ApplyUnary(values, size, [](float x) { return std::max(x, 0.0f); });
+      break;
+    case StepType::kRelu6:
+      ApplyUnary(values, size,
+                 [](float x) { return std::min(std::max(x, 0.0f), 6.0f); });
+      break;
+    case StepType::kReluN1To1:
+      ApplyUnary(values, size,
+                 [](float x) { return std::min(std::max(x, -1.0f), 1.0f); });
+      break;
+    case StepType::kTanh:
+      ApplyUnary(values, size, [](float x) { return std::tanh(x); });
+      break;
+    case StepType::kLogistic:
+      ApplyUnary(values, size,
+                 [](float x) { return 1.0f / (1.0f + std::exp(-x)); });
+      break;
+  }
+}
+
+}  // namespace
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  const auto* params = reinterpret_cast<const Params*>(node->builtin_data);
+  TF_LITE_ENSURE(context, params != nullptr);
+  TF_LITE_ENSURE(context,
+                 params->num_steps > 0 && params->num_steps <= kMaxSteps);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+
+  const int channels = NumChannels(input);
+  for (int i = 0; i < params->num_steps; ++i) {
+    const Step& step = params->steps[i];
+    if (!IsBinary(step.type)) continue;
+    TF_LITE_ENSURE(context, step.input_index > kInputTensor &&
+                                step.input_index < NumInputs(node));
+    const TfLiteTensor* operand;
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, step.input_index, &operand));
+    TF_LITE_ENSURE_TYPES_EQ(context, operand->type, kTfLiteFloat32);
+    const int64_t num_elements = NumElements(operand);
+    TF_LITE_ENSURE(context, num_elements == 1 || num_elements == channels);
+  }
+
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(input->dims));
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const auto* params = reinterpret_cast<const Params*>(node->builtin_data);
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  const TfLiteTensor* operands[kMaxSteps];
+  for (int i = 0; i < params->num_steps; ++i) {
+    const Step& step = params->steps[i];
+    operands[i] = IsBinary(step.type)
+                      ? GetInput(context, node, step.input_index)
+                      : nullptr;
+  }
+
+  const int64_t size = NumElements(input);
+  const int channels = NumChannels(input);
+  if (size == 0 || channels == 0) return kTfLiteOk;
+  // Tiles hold whole rows so that per-channel operands line up.
+  const int tile_size = std::max(1, kTileSize / channels) * channels;
+  const float* input_data = GetTensorData<float>(input);
+  float* output_data = GetTensorData<float>(output);
+  for (int64_t start = 0; start < size; start += tile_size) {
+    const int tile =
+        static_cast<int>(std::min<int64_t>(tile_size, size - start));
+    float* values = output_data + start;
+    if (values != input_data + start) {
+      std::copy_n(input_data + start, tile, values);
+    }
+    for (int i = 0; i < params->num_steps; ++i) {
+      ApplyStep(params->steps[i], operands[i], channels, values, tile);
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace fused_elementwise
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE() {
+  static TfLiteRegistration r = {nullptr, nullptr, fused_elementwise::Prepare,
+                                 fused_elementwise::Eval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
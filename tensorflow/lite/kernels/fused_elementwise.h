@@ -0,0 +1,74 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_FUSED_ELEMENTWISE_H_
+#define TENSORFLOW_LITE_KERNELS_FUSED_ELEMENTWISE_H_
+
+#include <stdint.h>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace fused_elementwise {
+
+// The fused elementwise op runs a chain of float elementwise steps over its
+// first input in a single pass. It isn't part of the schema: nodes are only
+// created by the load-time op fusion pass, which finds the kernel in the op
+// resolver under this name.
+constexpr char kOpName[] = "TFLite_FusedElementwise";
+
+constexpr int kMaxSteps = 16;
+
+enum class StepType : int32_t {
+  // Binary steps, `x` is the running value and `c` the constant operand.
+  kAdd,         // x + c
+  kSub,         // x - c
+  kReverseSub,  // c - x
+  kMul,         // x * c
+  kDiv,         // x / c
+  kReverseDiv,  // c / x
+  // Unary steps.
+  kRelu,
+  kRelu6,
+  kReluN1To1,
+  kTanh,
+  kLogistic,
+};
+
+struct Step {
+  StepType type;
+  // For binary steps, the index of the node input holding the constant
+  // operand. It has either a single element or one element per entry of the
+  // innermost dimension of the first input.
+  int32_t input_index;
+};
+
+// Builtin data of fused elementwise nodes. It is allocated with malloc() and
+// owned by the node, like the builtin data of builtin ops.
+struct Params {
+  int32_t num_steps;
+  Step steps[kMaxSteps];
+};
+
+}  // namespace fused_elementwise
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE();
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_FUSED_ELEMENTWISE_H_
@@ -0,0 +1,161 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/block_sparse_matmul_test_util.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse_matmul.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+// Each sparse benchmark is comparable to the dense benchmark of the same
+// matrix size.
+namespace tflite {
+namespace optimized_ops {
+namespace {
+
+// Arguments: rows, cols, batches.
+void BM_DenseFullyConnected(benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int batches = state.range(2);
+  std::mt19937 random(2022);
+  const std::vector<float> weights =
+      RandomBlockSparseMatrix<float>(rows, cols, 1, 1, 0.f, &random);
+  const std::vector<float> input =
+      RandomVector<float>(batches * cols, -64, 64, &random);
+  const std::vector<float> bias(rows, 0.f);
+  std::vector<float> output(batches * rows);
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetMaxNumThreads(1);
+  FullyConnectedParams params;
+  params.float_activation_min = std::numeric_limits<float>::lowest();
+  params.float_activation_max = std::numeric_limits<float>::max();
+  params.lhs_cacheable = true;
+  params.rhs_cacheable = false;
+  for (auto _ : state) {
+    FullyConnected(params, RuntimeShape({batches, cols}), input.data(),
+                   RuntimeShape({rows, cols}), weights.data(),
+                   RuntimeShape({rows}), bias.data(),
+                   RuntimeShape({batches, rows}), output.data(),
+                   &cpu_backend_context);
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+BENCHMARK(BM_DenseFullyConnected)
+    ->Args({1024, 1024, 1})
+    ->Args({1024, 1024, 8})
+    ->Args({2048, 512, 1});
+
+// Arguments: rows, cols, batches, block rows, block cols, sparsity in percent.
+template <typename T>
+void BM_BlockSparseFullyConnected(benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int batches = state.range(2);
+  const int block_rows = state.range(3);
+  const int block_cols = state.range(4);
+  const float sparsity = state.range(5) / 100.f;
+  std::mt19937 random(2022);
+  const std::vector<T> dense = RandomBlockSparseMatrix<T>(
+      rows, cols, block_rows, block_cols, sparsity, &random);
+  const std::vector<T> input =
+      RandomVector<T>(batches * cols, -64, 64, &random);
+  const std::vector<BlockSparseAccum<T>> bias(rows, 0);
+  std::vector<T> output(batches * rows);
+  BlockSparseMatrix<T> weights;
+  BuildBlockSparseMatrix(dense.data(), rows, cols, block_rows, block_cols,
+                         &weights);
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetMaxNumThreads(1);
+  FullyConnectedParams params;
+  params.float_activation_min = std::numeric_limits<float>::lowest();
+  params.float_activation_max = std::numeric_limits<float>::max();
+  params.input_offset = 0;
+  params.output_offset = 0;
+  params.output_multiplier = 1 << 30;
+  params.output_shift = -8;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  for (auto _ : state) {
+    FullyConnectedBlockSparseWeight(
+        weights, params, nullptr, nullptr, RuntimeShape({batches, cols}),
+        input.data(), bias.data(), RuntimeShape({batches, rows}),
+        output.data(), &cpu_backend_context);
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+
+void BlockSparseFullyConnectedArgs(benchmark::internal::Benchmark* b) {
+  for (const auto& block : std::vector<std::pair<int, int>>{
+           {1, 1}, {1, 4}, {1, 16}, {4, 4}, {16, 1}}) {
+    for (int sparsity : {50, 70, 80, 90}) {
+      for (int batches : {1, 8}) {
+        b->Args({1024, 1024, batches, block.first, block.second, sparsity});
+      }
+    }
+  }
+}
+BENCHMARK_TEMPLATE(BM_BlockSparseFullyConnected, float)
+    ->Apply(BlockSparseFullyConnectedArgs);
+BENCHMARK_TEMPLATE(BM_BlockSparseFullyConnected, int8_t)
+    ->Apply(BlockSparseFullyConnectedArgs);
+
+// Arguments: block rows, block cols, sparsity in percent. A 3x3 convolution
+// of a 28x28x64 input to 64 channels.
+void BM_BlockSparseConv(benchmark::State& state) {
+  const int block_rows = state.range(0);
+  const int block_cols = state.range(1);
+  const float sparsity = state.range(2) / 100.f;
+  const RuntimeShape input_shape({1, 28, 28, 64});
+  const RuntimeShape filter_shape({64, 3, 3, 64});
+  const RuntimeShape output_shape({1, 28, 28, 64});
+  std::mt19937 random(2022);
+  const std::vector<float> dense = RandomBlockSparseMatrix<float>(
+      64, 3 * 3 * 64, block_rows, block_cols, sparsity, &random);
+  const std::vector<float> input =
+      RandomVector<float>(input_shape.FlatSize(), -64, 64, &random);
+  const std::vector<float> bias(64, 0.f);
+  std::vector<float> output(output_shape.FlatSize());
+  BlockSparseMatrix<float> filter;
+  BuildBlockSparseMatrix(dense.data(), 64, 3 * 3 * 64, block_rows, block_cols,
+                         &filter);
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetMaxNumThreads(1);
+  ConvParams params;
+  params.stride_height = params.stride_width = 1;
+  params.dilation_height_factor = params.dilation_width_factor = 1;
+  params.padding_values.height = params.padding_values.width = 1;
+  params.float_activation_min = std::numeric_limits<float>::lowest();
+  params.float_activation_max = std::numeric_limits<float>::max();
+  for (auto _ : state) {
+    BlockSparseConv(params, filter, nullptr, nullptr, input_shape,
+                    input.data(), filter_shape, bias.data(), output_shape,
+                    output.data(), &cpu_backend_context);
+    benchmark::DoNotOptimize(output.data());
+  }
+}
+BENCHMARK(BM_BlockSparseConv)
+    ->ArgsProduct({{1, 4, 16}, {4, 1}, {50, 70, 80, 90}});
+
+}  // namespace
+}  // namespace optimized_ops
+}  // namespace tflite
@@ -0,0 +1,395 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/block_sparse_matmul_test_util.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse_matmul.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+TEST(BlockSparseMatrixTest, BuildsBlocks) {
+  // clang-format off
+  const std::vector<int8_t> dense = {
+      0, 0, 0, 0, 1, 2, 0, 4,
+      0, 0, 0, 0, 0, 0, 0, 0,
+      5, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, -8,
+  };
+  // clang-format on
+  BlockSparseMatrix<int8_t> matrix;
+  BuildBlockSparseMatrix(dense.data(), 4, 8, 2, 4, &matrix);
+  EXPECT_EQ(matrix.block_rows, 2);
+  EXPECT_EQ(matrix.block_cols, 4);
+  EXPECT_EQ(matrix.num_block_rows(), 2);
+  EXPECT_THAT(matrix.block_row_ptr, ElementsAre(0, 1, 3));
+  EXPECT_THAT(matrix.block_col, ElementsAre(4, 0, 4));
+  EXPECT_THAT(matrix.values,
+              ElementsAreArray({1, 2, 0, 4, 0, 0, 0, 0,    // block (0, 1)
+                                5, 0, 0, 0, 0, 0, 0, 0,    // block (1, 0)
+                                0, 0, 0, 0, 0, 0, 0, -8}));  // block (1, 1)
+  EXPECT_THAT(matrix.row_sums, ElementsAre(7, 0, 5, -8));
+}
+
+TEST(BlockSparseMatrixTest, FallsBackToUnitBlocks) {
+  const std::vector<float> dense = {0, 1, 0, 2, 3, 0};
+  BlockSparseMatrix<float> matrix;
+  // 4-wide blocks don't tile 3 columns.
+  BuildBlockSparseMatrix(dense.data(), 2, 3, 1, 4, &matrix);
+  EXPECT_EQ(matrix.block_rows, 1);
+  EXPECT_EQ(matrix.block_cols, 1);
+  EXPECT_THAT(matrix.block_row_ptr, ElementsAre(0, 1, 3));
+  EXPECT_THAT(matrix.block_col, ElementsAre(1, 0, 1));
+  EXPECT_THAT(matrix.values, ElementsAre(1, 2, 3));
+  EXPECT_TRUE(matrix.row_sums.empty());
+}
+
+TEST(BlockSparseMatrixTest, GetsBlockShapeFromSparsity) {
+  // A [16, 32] tensor with 16x1 blocks, as written by the sparsifier.
+  TfLiteDimensionMetadata dim_metadata[3] = {};
+  dim_metadata[2].format = kTfLiteDimDense;
+  dim_metadata[2].dense_size = 16;
+  TfLiteIntArray* block_map = TfLiteIntArrayCreate(1);
+  block_map->data[0] = 0;
+  TfLiteSparsity sparsity = {};
+  sparsity.block_map = block_map;
+  sparsity.dim_metadata = dim_metadata;
+  sparsity.dim_metadata_size = 3;
+
+  int block_rows, block_cols;
+  GetBlockSparseShape(sparsity, /*dims_count=*/2, &block_rows, &block_cols);
+  EXPECT_EQ(block_rows, 16);
+  EXPECT_EQ(block_cols, 1);
+
+  block_map->data[0] = 1;
+  GetBlockSparseShape(sparsity, /*dims_count=*/2, &block_rows, &block_cols);
+  EXPECT_EQ(block_rows, 1);
+  EXPECT_EQ(block_cols, 16);
+  TfLiteIntArrayFree(block_map);
+}
+
+struct BlockShape {
+  int block_rows;
+  int block_cols;
+};
+
+class BlockSparseFullyConnectedTest
+    : public ::testing::TestWithParam<std::tuple<BlockShape, float>> {
+ protected:
+  BlockSparseFullyConnectedTest() {
+    cpu_backend_context_.SetMaxNumThreads(4);
+  }
+
+  CpuBackendContext cpu_backend_context_;
+  std::mt19937 random_{2022};
+};
+
+TEST_P(BlockSparseFullyConnectedTest, FloatMatchesDense) {
+  const BlockShape shape = std::get<0>(GetParam());
+  const float sparsity = std::get<1>(GetParam());
+  const int rows = 96, cols = 160, batches = 3;
+  const std::vector<float> dense = RandomBlockSparseMatrix<float>(
+      rows, cols, shape.block_rows, shape.block_cols, sparsity, &random_);
+  const std::vector<float> input =
+      RandomVector<float>(batches * cols, -64, 64, &random_);
+  const std::vector<float> bias = RandomVector<float>(rows, -64, 64, &random_);
+
+  BlockSparseMatrix<float> weights;
+  BuildBlockSparseMatrix(dense.data(), rows, cols, shape.block_rows,
+                         shape.block_cols, &weights);
+  EXPECT_EQ(weights.block_rows, shape.block_rows);
+  EXPECT_EQ(weights.block_cols, shape.block_cols);
+
+  FullyConnectedParams params;
+  params.float_activation_min = -50.f;
+  params.float_activation_max = 50.f;
+  std::vector<float> output(batches * rows);
+  FullyConnectedBlockSparseWeight(
+      weights, params, nullptr, nullptr, RuntimeShape({batches, cols}),
+      input.data(), bias.data(), RuntimeShape({batches, rows}), output.data(),
+      &cpu_backend_context_);
+
+  std::vector<float> expected(batches * rows);
+  for (int b = 0; b < batches; ++b) {
+    for (int r = 0; r < rows; ++r) {
+      float acc = bias[r];
+      for (int c = 0; c < cols; ++c) {
+        acc += dense[r * cols + c] * input[b * cols + c];
+      }
+      expected[b * rows + r] = std::min(50.f, std::max(-50.f, acc));
+    }
+  }
+  EXPECT_THAT(output, Pointwise(FloatNear(1e-3), expected));
+}
+
+TEST_P(BlockSparseFullyConnectedTest, Int8MatchesDense) {
+  const BlockShape shape = std::get<0>(GetParam());
+  const float sparsity = std::get<1>(GetParam());
+  const int rows = 96, cols = 160, batches = 3;
+  const std::vector<int8_t> dense = RandomBlockSparseMatrix<int8_t>(
+      rows, cols, shape.block_rows, shape.block_cols, sparsity, &random_);
+  const std::vector<int8_t> input =
+      RandomVector<int8_t>(batches * cols, -128, 127, &random_);
+  const std::vector<int32_t> bias =
+      RandomVector<int32_t>(rows, -10000, 10000, &random_);
+  std::vector<int32_t> multiplier(rows);
+  std::vector<int> shift(rows);
+  for (int r = 0; r < rows; ++r) {
+    QuantizeMultiplier(1.0 / (300 + 10 * r), &multiplier[r], &shift[r]);
+  }
+
+  BlockSparseMatrix<int8_t> weights;
+  BuildBlockSparseMatrix(dense.data(), rows, cols, shape.block_rows,
+                         shape.block_cols, &weights);
+
+  FullyConnectedParams params;
+  params.input_offset = 3;
+  params.output_offset = -5;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  std::vector<int8_t> output(batches * rows);
+  FullyConnectedBlockSparseWeight(
+      weights, params, multiplier.data(), shift.data(),
+      RuntimeShape({batches, cols}), input.data(), bias.data(),
+      RuntimeShape({batches, rows}), output.data(), &cpu_backend_context_);
+
+  std::vector<int8_t> expected(batches * rows);
+  for (int b = 0; b < batches; ++b) {
+    for (int r = 0; r < rows; ++r) {
+      int32_t acc = bias[r];
+      for (int c = 0; c < cols; ++c) {
+        acc += dense[r * cols + c] *
+               (input[b * cols + c] + params.input_offset);
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, multiplier[r], shift[r]) +
+            params.output_offset;
+      expected[b * rows + r] = std::min(127, std::max(-128, acc));
+    }
+  }
+  EXPECT_THAT(output, ElementsAreArray(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BlockSparseFullyConnectedTest, BlockSparseFullyConnectedTest,
+    ::testing::Combine(
+        // Specialized shapes and shapes only known at runtime.
+        ::testing::Values(BlockShape{1, 1}, BlockShape{1, 4},
+                          BlockShape{1, 16}, BlockShape{4, 4},
+                          BlockShape{16, 1}, BlockShape{2, 8},
+                          BlockShape{3, 2}),
+        ::testing::Values(0.5f, 0.7f, 0.9f)));
+
+// Naive NHWC convolution of `input` with the OHWI `filter`, padding with
+// `pad_value`.
+template <typename T, typename AccumT>
+std::vector<AccumT> NaiveConv(const ConvParams& params,
+                              const RuntimeShape& input_shape,
+                              const std::vector<T>& input,
+                              const RuntimeShape& filter_shape,
+                              const std::vector<T>& filter,
+                              const RuntimeShape& output_shape, T pad_value,
+                              AccumT input_offset) {
+  std::vector<AccumT> output(output_shape.FlatSize(), 0);
+  for (int b = 0; b < output_shape.Dims(0); ++b) {
+    for (int y = 0; y < output_shape.Dims(1); ++y) {
+      for (int x = 0; x < output_shape.Dims(2); ++x) {
+        for (int o = 0; o < output_shape.Dims(3); ++o) {
+          AccumT acc = 0;
+          for (int fy = 0; fy < filter_shape.Dims(1); ++fy) {
+            for (int fx = 0; fx < filter_shape.Dims(2); ++fx) {
+              const int in_y = y * params.stride_height -
+                               params.padding_values.height +
+                               fy * params.dilation_height_factor;
+              const int in_x = x * params.stride_width -
+                               params.padding_values.width +
+                               fx * params.dilation_width_factor;
+              const bool inside = in_y >= 0 && in_y < input_shape.Dims(1) &&
+                                  in_x >= 0 && in_x < input_shape.Dims(2);
+              for (int i = 0; i < filter_shape.Dims(3); ++i) {
+                const T value =
+                    inside ? input[Offset(input_shape, b, in_y, in_x, i)]
+                           : pad_value;
+                acc += filter[Offset(filter_shape, o, fy, fx, i)] *
+                       (value + input_offset);
+              }
+            }
+          }
+          output[Offset(output_shape, b, y, x, o)] = acc;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+struct ConvGeometry {
+  int filter_size;
+  int stride;
+  int padding;
+  int dilation;
+};
+
+class BlockSparseConvTest
+    : public ::testing::TestWithParam<std::tuple<ConvGeometry, BlockShape>> {
+ protected:
+  BlockSparseConvTest() {
+    const ConvGeometry geometry = std::get<0>(GetParam());
+    params_.stride_height = params_.stride_width = geometry.stride;
+    params_.padding_values.height = params_.padding_values.width =
+        geometry.padding;
+    params_.dilation_height_factor = params_.dilation_width_factor =
+        geometry.dilation;
+    cpu_backend_context_.SetMaxNumThreads(3);
+  }
+
+  RuntimeShape input_shape() const {
+    return RuntimeShape({2, kInputSize, kInputSize, kInputDepth});
+  }
+  RuntimeShape filter_shape() const {
+    const int filter_size = std::get<0>(GetParam()).filter_size;
+    return RuntimeShape({kOutputDepth, filter_size, filter_size, kInputDepth});
+  }
+  RuntimeShape output_shape() const {
+    const ConvGeometry geometry = std::get<0>(GetParam());
+    const int effective_filter_size =
+        (geometry.filter_size - 1) * geometry.dilation + 1;
+    const int output_size =
+        (kInputSize + 2 * geometry.padding - effective_filter_size) /
+            geometry.stride +
+        1;
+    return RuntimeShape({2, output_size, output_size, kOutputDepth});
+  }
+
+  static constexpr int kInputSize = 9;
+  static constexpr int kInputDepth = 16;
+  static constexpr int kOutputDepth = 32;
+
+  ConvParams params_;
+  CpuBackendContext cpu_backend_context_;
+  std::mt19937 random_{2022};
+};
+
+TEST_P(BlockSparseConvTest, FloatMatchesDense) {
+  const BlockShape shape = std::get<1>(GetParam());
+  const int patch_size = filter_shape().FlatSize() / kOutputDepth;
+  const std::vector<float> filter = RandomBlockSparseMatrix<float>(
+      kOutputDepth, patch_size, shape.block_rows, shape.block_cols, 0.7f,
+      &random_);
+  const std::vector<float> input =
+      RandomVector<float>(input_shape().FlatSize(), -64, 64, &random_);
+  const std::vector<float> bias =
+      RandomVector<float>(kOutputDepth, -64, 64, &random_);
+  BlockSparseMatrix<float> matrix;
+  BuildBlockSparseMatrix(filter.data(), kOutputDepth, patch_size,
+                         shape.block_rows, shape.block_cols, &matrix);
+
+  params_.float_activation_min = std::numeric_limits<float>::lowest();
+  params_.float_activation_max = std::numeric_limits<float>::max();
+  std::vector<float> output(output_shape().FlatSize());
+  BlockSparseConv(params_, matrix, nullptr, nullptr, input_shape(),
+                  input.data(), filter_shape(), bias.data(), output_shape(),
+                  output.data(), &cpu_backend_context_);
+
+  std::vector<float> expected =
+      NaiveConv<float, float>(params_, input_shape(), input, filter_shape(),
+                              filter, output_shape(), 0.f, 0.f);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    expected[i] += bias[i % kOutputDepth];
+  }
+  EXPECT_THAT(output, Pointwise(FloatNear(1e-3), expected));
+}
+
+TEST_P(BlockSparseConvTest, Int8MatchesDense) {
+  const BlockShape shape = std::get<1>(GetParam());
+  const int patch_size = filter_shape().FlatSize() / kOutputDepth;
+  const std::vector<int8_t> filter = RandomBlockSparseMatrix<int8_t>(
+      kOutputDepth, patch_size, shape.block_rows, shape.block_cols, 0.7f,
+      &random_);
+  const std::vector<int8_t> input =
+      RandomVector<int8_t>(input_shape().FlatSize(), -128, 127, &random_);
+  const std::vector<int32_t> bias =
+      RandomVector<int32_t>(kOutputDepth, -10000, 10000, &random_);
+  std::vector<int32_t> multiplier(kOutputDepth);
+  std::vector<int> shift(kOutputDepth);
+  for (int o = 0; o < kOutputDepth; ++o) {
+    QuantizeMultiplier(1.0 / (500 + 20 * o), &multiplier[o], &shift[o]);
+  }
+  BlockSparseMatrix<int8_t> matrix;
+  BuildBlockSparseMatrix(filter.data(), kOutputDepth, patch_size,
+                         shape.block_rows, shape.block_cols, &matrix);
+
+  // An input zero point of -7: padding has to use it.
+  params_.input_offset = 7;
+  params_.output_offset = 2;
+  params_.quantized_activation_min = -100;
+  params_.quantized_activation_max = 100;
+  std::vector<int8_t> output(output_shape().FlatSize());
+  BlockSparseConv(params_, matrix, multiplier.data(), shift.data(),
+                  input_shape(), input.data(), filter_shape(), bias.data(),
+                  output_shape(), output.data(), &cpu_backend_context_);
+
+  const std::vector<int32_t> acc = NaiveConv<int8_t, int32_t>(
+      params_, input_shape(), input, filter_shape(), filter, output_shape(),
+      /*pad_value=*/-7, /*input_offset=*/7);
+  std::vector<int8_t> expected(acc.size());
+  for (size_t i = 0; i < acc.size(); ++i) {
+    const int o = i % kOutputDepth;
+    const int32_t value =
+        MultiplyByQuantizedMultiplier(acc[i] + bias[o], multiplier[o],
+                                      shift[o]) +
+        2;
+    expected[i] = std::min(100, std::max(-100, value));
+  }
+  EXPECT_THAT(output, ElementsAreArray(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BlockSparseConvTest, BlockSparseConvTest,
+    ::testing::Combine(
+        ::testing::Values(
+            // Pointwise, which reads the input in place.
+            ConvGeometry{/*filter_size=*/1, /*stride=*/1, /*padding=*/0,
+                         /*dilation=*/1},
+            ConvGeometry{/*filter_size=*/3, /*stride=*/1, /*padding=*/1,
+                         /*dilation=*/1},
+            ConvGeometry{/*filter_size=*/3, /*stride=*/2, /*padding=*/0,
+                         /*dilation=*/1},
+            ConvGeometry{/*filter_size=*/3, /*stride=*/1, /*padding=*/2,
+                         /*dilation=*/2}),
+        ::testing::Values(BlockShape{1, 4}, BlockShape{4, 4},
+                          BlockShape{16, 1})));
+
+}  // namespace
+}  // namespace optimized_ops
+}  // namespace tflite
@@ -0,0 +1,65 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_BLOCK_SPARSE_MATMUL_TEST_UTIL_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_BLOCK_SPARSE_MATMUL_TEST_UTIL_H_
+
+#include <algorithm>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace tflite {
+namespace optimized_ops {
+
+// Returns a row-major [rows, cols] matrix where a `sparsity` fraction of the
+// block_rows x block_cols blocks are zero.
+template <typename T>
+std::vector<T> RandomBlockSparseMatrix(int rows, int cols, int block_rows,
+                                       int block_cols, float sparsity,
+                                       std::mt19937* random) {
+  std::uniform_real_distribution<float> keep(0.f, 1.f);
+  std::uniform_int_distribution<int> value(-127, 127);
+  std::vector<T> matrix(rows * cols, T(0));
+  for (int row = 0; row < rows; row += block_rows) {
+    for (int col = 0; col < cols; col += block_cols) {
+      if (keep(*random) < sparsity) continue;
+      for (int r = row; r < std::min(rows, row + block_rows); ++r) {
+        for (int c = col; c < std::min(cols, col + block_cols); ++c) {
+          matrix[r * cols + c] = std::is_integral<T>::value
+                                     ? static_cast<T>(value(*random))
+                                     : static_cast<T>(value(*random) / 64.f);
+        }
+      }
+    }
+  }
+  return matrix;
+}
+
+// Returns `size` random values in [min, max], divided by 64 for floats.
+template <typename T>
+std::vector<T> RandomVector(int size, int min, int max, std::mt19937* random) {
+  std::uniform_int_distribution<int> value(min, max);
+  std::vector<T> vector(size);
+  for (T& v : vector) {
+    v = std::is_integral<T>::value ? static_cast<T>(value(*random))
+                                   : static_cast<T>(value(*random) / 64.f);
+  }
+  return vector;
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_BLOCK_SPARSE_MATMUL_TEST_UTIL_H_
@@ -0,0 +1,416 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_BLOCK_SPARSE_MATMUL_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_BLOCK_SPARSE_MATMUL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/internal/utils/sparsity_format_converter.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Largest number of elements in a block handled by the block-sparse kernels.
+// Matrices with larger blocks are stored with 1x1 blocks instead.
+constexpr int kBlockSparseMaxBlockSize = 64;
+
+// Minimum number of multiply-accumulates worth running on another thread.
+constexpr int kBlockSparseMinWorkPerThread = 16 * 1024;
+
+// The accumulator type of the block-sparse kernels: float for float matrices
+// and int32 for int8 matrices. This is also the type of the bias.
+template <typename T>
+using BlockSparseAccum =
+    typename std::conditional<std::is_integral<T>::value, int32_t, T>::type;
+
+// A [rows, cols] matrix in block compressed sparse row (BSR) format. The
+// matrix is tiled into blocks of block_rows x block_cols and only blocks with
+// at least one non-zero value are stored.
+//
+// Unlike TfLiteSparsity, which can describe any traversal order and blocking,
+// this layout is fixed so that the kernels below can stream the weights. It is
+// built once from the dense weights, see BuildBlockSparseMatrix().
+template <typename T>
+struct BlockSparseMatrix {
+  int rows = 0;
+  int cols = 0;
+  int block_rows = 1;
+  int block_cols = 1;
+  // The blocks of block row `r` are [block_row_ptr[r], block_row_ptr[r + 1]).
+  std::vector<int32_t> block_row_ptr;
+  // The first column of each block.
+  std::vector<int32_t> block_col;
+  // The values of each block, block_rows x block_cols in row-major order.
+  std::vector<T> values;
+  // The sum of the values of each row. Only populated for integer matrices,
+  // whose kernels use it to apply the input offset.
+  std::vector<int32_t> row_sums;
+
+  int num_block_rows() const { return rows / block_rows; }
+  int num_blocks() const { return block_col.size(); }
+};
+
+// Returns the block shape of the rows (outermost dimension) and columns
+// (innermost dimension) of a `dims_count`-D tensor with `sparsity`. Blocks
+// along any other dimension are ignored, as they are not contiguous once the
+// tensor is viewed as a [dim 0, product of the other dims] matrix.
+inline void GetBlockSparseShape(const TfLiteSparsity& sparsity, int dims_count,
+                                int* block_rows, int* block_cols) {
+  *block_rows = 1;
+  *block_cols = 1;
+  if (sparsity.block_map == nullptr) return;
+  for (int i = 0; i < sparsity.block_map->size; ++i) {
+    const int metadata_index = dims_count + i;
+    if (metadata_index >= sparsity.dim_metadata_size) return;
+    const int block_size = sparsity.dim_metadata[metadata_index].dense_size;
+    if (sparsity.block_map->data[i] == 0) {
+      *block_rows = block_size;
+    } else if (sparsity.block_map->data[i] == dims_count - 1) {
+      *block_cols = block_size;
+    }
+  }
+}
+
+// Encodes the row-major [rows, cols] `dense_data` into `matrix`, dropping all
+// blocks of zeros. Falls back to 1x1 blocks if the block shape doesn't tile
+// the matrix or exceeds kBlockSparseMaxBlockSize.
+template <typename T>
+inline void BuildBlockSparseMatrix(const T* dense_data, int rows, int cols,
+                                   int block_rows, int block_cols,
+                                   BlockSparseMatrix<T>* matrix) {
+  if (block_rows < 1 || block_cols < 1 || rows % block_rows != 0 ||
+      cols % block_cols != 0 ||
+      block_rows * block_cols > kBlockSparseMaxBlockSize) {
+    block_rows = 1;
+    block_cols = 1;
+  }
+  matrix->rows = rows;
+  matrix->cols = cols;
+  matrix->block_rows = block_rows;
+  matrix->block_cols = block_cols;
+  matrix->block_row_ptr.assign(1, 0);
+  matrix->block_col.clear();
+  matrix->values.clear();
+  matrix->row_sums.assign(std::is_integral<T>::value ? rows : 0, 0);
+
+  for (int row = 0; row < rows; row += block_rows) {
+    for (int col = 0; col < cols; col += block_cols) {
+      bool is_zero = true;
+      for (int r = 0; r < block_rows && is_zero; ++r) {
+        const T* block_row = dense_data + (row + r) * cols + col;
+        for (int c = 0; c < block_cols; ++c) {
+          if (block_row[c] != T(0)) {
+            is_zero = false;
+            break;
+          }
+        }
+      }
+      if (is_zero) continue;
+      matrix->block_col.push_back(col);
+      for (int r = 0; r < block_rows; ++r) {
+        const T* block_row = dense_data + (row + r) * cols + col;
+        matrix->values.insert(matrix->values.end(), block_row,
+                              block_row + block_cols);
+        if (std::is_integral<T>::value) {
+          for (int c = 0; c < block_cols; ++c) {
+            matrix->row_sums[row + r] += block_row[c];
+          }
+        }
+      }
+    }
+    matrix->block_row_ptr.push_back(matrix->block_col.size());
+  }
+}
+
+// Densifies the constant sparse `tensor` and encodes it into `matrix`. The
+// rows of the matrix are the outermost dimension of `tensor` and `cols` is
+// the product of the other dimensions, e.g. the input depth of fully-connected
+// weights or filter_height * filter_width * input_depth of a conv filter.
+template <typename T>
+inline TfLiteStatus BuildBlockSparseMatrixFromTensor(
+    TfLiteContext* context, const TfLiteTensor* tensor, int cols,
+    BlockSparseMatrix<T>* matrix) {
+  TF_LITE_ENSURE(context, tensor->sparsity != nullptr);
+  const std::vector<int> shape(tensor->dims->data,
+                               tensor->dims->data + tensor->dims->size);
+  TF_LITE_ENSURE(context, !shape.empty());
+  int64_t num_elements = 1;
+  for (int dim : shape) num_elements *= dim;
+  TF_LITE_ENSURE_EQ(context, static_cast<int64_t>(shape[0]) * cols,
+                    num_elements);
+  tflite::internal::sparsity::FormatConverter<T> converter(shape,
+                                                           *tensor->sparsity);
+  TF_LITE_ENSURE_OK(context,
+                    converter.SparseToDense(GetTensorData<T>(tensor)));
+  int block_rows, block_cols;
+  GetBlockSparseShape(*tensor->sparsity, shape.size(), &block_rows,
+                      &block_cols);
+  BuildBlockSparseMatrix(converter.GetData().data(), shape[0], cols,
+                         block_rows, block_cols, matrix);
+  return kTfLiteOk;
+}
+
+// Returns output row `row` from its accumulated dot product `acc`.
+inline float BlockSparseOutput(const BlockSparseMatrix<float>& matrix,
+                               float acc, int row,
+                               const FullyConnectedParams& params,
+                               const float* bias_data,
+                               const int32_t* per_channel_multiplier,
+                               const int* per_channel_shift) {
+  if (bias_data) acc += bias_data[row];
+  return ActivationFunctionWithMinMax(acc, params.float_activation_min,
+                                      params.float_activation_max);
+}
+
+inline int8_t BlockSparseOutput(const BlockSparseMatrix<int8_t>& matrix,
+                                int32_t acc, int row,
+                                const FullyConnectedParams& params,
+                                const int32_t* bias_data,
+                                const int32_t* per_channel_multiplier,
+                                const int* per_channel_shift) {
+  // The weights are symmetric, so sum(w * (x + offset)) is
+  // sum(w * x) + offset * sum(w).
+  acc += params.input_offset * matrix.row_sums[row];
+  if (bias_data) acc += bias_data[row];
+  const int32_t multiplier = per_channel_multiplier
+                                 ? per_channel_multiplier[row]
+                                 : params.output_multiplier;
+  const int shift =
+      per_channel_shift ? per_channel_shift[row] : params.output_shift;
+  acc = MultiplyByQuantizedMultiplier(acc, multiplier, shift);
+  acc += params.output_offset;
+  acc = std::max(acc, params.quantized_activation_min);
+  acc = std::min(acc, params.quantized_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+// Computes block rows [block_row_start, block_row_end) of
+// output = matrix * input for `batches` rows of `input`, each of
+// matrix.cols values. The output of each batch is matrix.rows values.
+//
+// kBlockRows and kBlockCols are the block shape of `matrix`, or 0 for a shape
+// only known at runtime.
+template <typename T, int kBlockRows, int kBlockCols>
+inline void BlockSparseMatMulImpl(
+    const BlockSparseMatrix<T>& matrix, const FullyConnectedParams& params,
+    const int32_t* per_channel_multiplier, const int* per_channel_shift,
+    const T* input_data, int batches, const BlockSparseAccum<T>* bias_data,
+    T* output_data, int block_row_start, int block_row_end) {
+  using AccumT = BlockSparseAccum<T>;
+  const int block_rows = kBlockRows ? kBlockRows : matrix.block_rows;
+  const int block_cols = kBlockCols ? kBlockCols : matrix.block_cols;
+  const int block_size = block_rows * block_cols;
+  const int rows = matrix.rows;
+  const int cols = matrix.cols;
+  const int32_t* block_row_ptr = matrix.block_row_ptr.data();
+  const int32_t* block_col = matrix.block_col.data();
+  const T* values = matrix.values.data();
+
+  // One accumulator per block element so that the inner loop vectorizes; the
+  // columns of each row are reduced once all blocks are accumulated. Two sets
+  // of accumulators, for even and odd blocks, hide the latency of the adds.
+  // Sizing them to a compile-time block keeps them in registers.
+  constexpr int kAccumSize = kBlockRows && kBlockCols
+                                 ? kBlockRows * kBlockCols
+                                 : kBlockSparseMaxBlockSize;
+  AccumT acc[kAccumSize];
+  AccumT acc_odd[kAccumSize];
+  for (int block_row = block_row_start; block_row < block_row_end;
+       ++block_row) {
+    const int row = block_row * block_rows;
+    const int block_start = block_row_ptr[block_row];
+    const int block_end = block_row_ptr[block_row + 1];
+    for (int b = 0; b < batches; ++b) {
+      const T* input = input_data + b * cols;
+      for (int i = 0; i < block_size; ++i) {
+        acc[i] = 0;
+        acc_odd[i] = 0;
+      }
+      int k = block_start;
+      for (; k + 1 < block_end; k += 2) {
+        const T* block = values + k * block_size;
+        const T* block_odd = block + block_size;
+        const T* x = input + block_col[k];
+        const T* x_odd = input + block_col[k + 1];
+        for (int r = 0; r < block_rows; ++r) {
+          for (int c = 0; c < block_cols; ++c) {
+            acc[r * block_cols + c] +=
+                static_cast<AccumT>(block[r * block_cols + c]) *
+                static_cast<AccumT>(x[c]);
+            acc_odd[r * block_cols + c] +=
+                static_cast<AccumT>(block_odd[r * block_cols + c]) *
+                static_cast<AccumT>(x_odd[c]);
+          }
+        }
+      }
+      if (k < block_end) {
+        const T* block = values + k * block_size;
+        const T* x = input + block_col[k];
+        for (int r = 0; r < block_rows; ++r) {
+          for (int c = 0; c < block_cols; ++c) {
+            acc[r * block_cols + c] +=
+                static_cast<AccumT>(block[r * block_cols + c]) *
+                static_cast<AccumT>(x[c]);
+          }
+        }
+      }
+      for (int i = 0; i < block_size; ++i) acc[i] += acc_odd[i];
+      T* output = output_data + b * rows + row;
+      for (int r = 0; r < block_rows; ++r) {
+        AccumT total = 0;
+        for (int c = 0; c < block_cols; ++c) total += acc[r * block_cols + c];
+        output[r] =
+            BlockSparseOutput(matrix, total, row + r, params, bias_data,
+                              per_channel_multiplier, per_channel_shift);
+      }
+    }
+  }
+}
+
+// Single-threaded block-sparse matrix multiplication, see
+// BlockSparseMatMulImpl(). Common block shapes use kernels specialized for
+// their shape.
+template <typename T>
+inline void BlockSparseMatMul(const BlockSparseMatrix<T>& matrix,
+                              const FullyConnectedParams& params,
+                              const int32_t* per_channel_multiplier,
+                              const int* per_channel_shift,
+                              const T* input_data, int batches,
+                              const BlockSparseAccum<T>* bias_data,
+                              T* output_data, int block_row_start,
+                              int block_row_end) {
+#define TF_LITE_BLOCK_SPARSE_MATMUL(kRows, kCols)                      \
+  if (matrix.block_rows == kRows && matrix.block_cols == kCols) {       \
+    return BlockSparseMatMulImpl<T, kRows, kCols>(                      \
+        matrix, params, per_channel_multiplier, per_channel_shift,      \
+        input_data, batches, bias_data, output_data, block_row_start,   \
+        block_row_end);                                                 \
+  }
+  TF_LITE_BLOCK_SPARSE_MATMUL(1, 1);
+  TF_LITE_BLOCK_SPARSE_MATMUL(1, 4);
+  TF_LITE_BLOCK_SPARSE_MATMUL(1, 8);
+  TF_LITE_BLOCK_SPARSE_MATMUL(1, 16);
+  TF_LITE_BLOCK_SPARSE_MATMUL(2, 2);
+  TF_LITE_BLOCK_SPARSE_MATMUL(4, 1);
+  TF_LITE_BLOCK_SPARSE_MATMUL(4, 4);
+  TF_LITE_BLOCK_SPARSE_MATMUL(8, 1);
+  TF_LITE_BLOCK_SPARSE_MATMUL(16, 1);
+#undef TF_LITE_BLOCK_SPARSE_MATMUL
+  BlockSparseMatMulImpl<T, 0, 0>(matrix, params, per_channel_multiplier,
+                                 per_channel_shift, input_data, batches,
+                                 bias_data, output_data, block_row_start,
+                                 block_row_end);
+}
+
+template <typename T>
+struct BlockSparseMatMulTask : cpu_backend_threadpool::Task {
+  BlockSparseMatMulTask(const BlockSparseMatrix<T>& matrix,
+                        const FullyConnectedParams& params,
+                        const int32_t* per_channel_multiplier,
+                        const int* per_channel_shift, const T* input_data,
+                        int batches, const BlockSparseAccum<T>* bias_data,
+                        T* output_data, int block_row_start, int block_row_end)
+      : matrix(matrix),
+        params(params),
+        per_channel_multiplier(per_channel_multiplier),
+        per_channel_shift(per_channel_shift),
+        input_data(input_data),
+        batches(batches),
+        bias_data(bias_data),
+        output_data(output_data),
+        block_row_start(block_row_start),
+        block_row_end(block_row_end) {}
+
+  void Run() override {
+    BlockSparseMatMul(matrix, params, per_channel_multiplier,
+                      per_channel_shift, input_data, batches, bias_data,
+                      output_data, block_row_start, block_row_end);
+  }
+
+ private:
+  const BlockSparseMatrix<T>& matrix;
+  const FullyConnectedParams& params;
+  const int32_t* per_channel_multiplier;
+  const int* per_channel_shift;
+  const T* input_data;
+  int batches;
+  const BlockSparseAccum<T>* bias_data;
+  T* output_data;
+  int block_row_start;
+  int block_row_end;
+};
+
+// Fully-connected layer with block-sparse weights. Float and int8 (symmetric
+// weights) are supported; `per_channel_multiplier` and `per_channel_shift` are
+// either null or hold one value per output channel.
+//
+// The workload is sliced along the block rows of the weights so that a single
+// batch, the common case for sparse models, still uses all threads.
+template <typename T>
+inline void FullyConnectedBlockSparseWeight(
+    const BlockSparseMatrix<T>& weights, const FullyConnectedParams& params,
+    const int32_t* per_channel_multiplier, const int* per_channel_shift,
+    const RuntimeShape& input_shape, const T* input_data,
+    const BlockSparseAccum<T>* bias_data, const RuntimeShape& output_shape,
+    T* output_data, CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  TFLITE_DCHECK_EQ(output_shape.Dims(output_dims_count - 1), weights.rows);
+  TFLITE_DCHECK_EQ(input_shape.FlatSize(), batches * weights.cols);
+
+  const int num_block_rows = weights.num_block_rows();
+  const int64_t work =
+      static_cast<int64_t>(weights.values.size()) * std::max(batches, 1);
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int thread_count = static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>({static_cast<int64_t>(max_threads),
+                            static_cast<int64_t>(num_block_rows),
+                            work / kBlockSparseMinWorkPerThread})));
+  if (thread_count == 1) {
+    BlockSparseMatMul(weights, params, per_channel_multiplier,
+                      per_channel_shift, input_data, batches, bias_data,
+                      output_data, 0, num_block_rows);
+    return;
+  }
+  std::vector<BlockSparseMatMulTask<T>> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end = thread_start + num_block_rows / thread_count;
+    if (i < num_block_rows % thread_count) thread_end++;
+    tasks.emplace_back(weights, params, per_channel_multiplier,
+                       per_channel_shift, input_data, batches, bias_data,
+                       output_data, thread_start, thread_end);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_BLOCK_SPARSE_MATMUL_H_
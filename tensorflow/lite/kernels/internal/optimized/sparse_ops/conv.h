@@ -0,0 +1,234 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_CONV_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse_matmul.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Number of output pixels whose input patches are gathered at a time. The
+// patches of a tile stay in cache while all blocks of the filter are applied.
+constexpr int kBlockSparseConvTilePixels = 16;
+
+// Computes output pixels [pixel_start, pixel_end), counted over the batch,
+// height and width of the output, of a convolution with a block-sparse
+// filter. The filter is the [output_depth, filter_height * filter_width *
+// input_depth] matrix of the OHWI filter.
+//
+// `patches` holds kBlockSparseConvTilePixels patches and is only used if the
+// input has to be gathered, i.e. unless the convolution is pointwise.
+template <typename T>
+inline void BlockSparseConvImpl(
+    const ConvParams& params, const FullyConnectedParams& matmul_params,
+    const BlockSparseMatrix<T>& filter, const int32_t* per_channel_multiplier,
+    const int* per_channel_shift, const RuntimeShape& input_shape,
+    const T* input_data, const RuntimeShape& filter_shape,
+    const BlockSparseAccum<T>* bias_data, const RuntimeShape& output_shape,
+    T* output_data, int pixel_start, int pixel_end, T* patches) {
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int patch_size = filter.cols;
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+  const int dilation_height = params.dilation_height_factor;
+  const int dilation_width = params.dilation_width_factor;
+  const int pad_height = params.padding_values.height;
+  const int pad_width = params.padding_values.width;
+  // Padding has to contribute nothing to the accumulators: zero for float, and
+  // the input zero point for int8, as the kernel adds the input offset.
+  const T pad_value = std::is_integral<T>::value
+                          ? static_cast<T>(-matmul_params.input_offset)
+                          : T(0);
+  const bool is_pointwise = filter_height == 1 && filter_width == 1 &&
+                            stride_height == 1 && stride_width == 1 &&
+                            pad_height == 0 && pad_width == 0;
+
+  for (int pixel = pixel_start; pixel < pixel_end;
+       pixel += kBlockSparseConvTilePixels) {
+    const int tile_pixels =
+        std::min(kBlockSparseConvTilePixels, pixel_end - pixel);
+    const T* tile_input = input_data + pixel * input_depth;
+    if (!is_pointwise) {
+      for (int p = 0; p < tile_pixels; ++p) {
+        const int out_x = (pixel + p) % output_width;
+        const int out_y = ((pixel + p) / output_width) % output_height;
+        const int batch = (pixel + p) / (output_width * output_height);
+        T* patch = patches + p * patch_size;
+        for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+          const int in_y =
+              out_y * stride_height - pad_height + filter_y * dilation_height;
+          for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+            const int in_x =
+                out_x * stride_width - pad_width + filter_x * dilation_width;
+            T* patch_pixel =
+                patch + (filter_y * filter_width + filter_x) * input_depth;
+            if (in_y < 0 || in_y >= input_height || in_x < 0 ||
+                in_x >= input_width) {
+              std::fill(patch_pixel, patch_pixel + input_depth, pad_value);
+            } else {
+              memcpy(patch_pixel,
+                     input_data + Offset(input_shape, batch, in_y, in_x, 0),
+                     input_depth * sizeof(T));
+            }
+          }
+        }
+      }
+      tile_input = patches;
+    }
+    BlockSparseMatMul(filter, matmul_params, per_channel_multiplier,
+                      per_channel_shift, tile_input, tile_pixels, bias_data,
+                      output_data + pixel * output_depth, 0,
+                      filter.num_block_rows());
+  }
+}
+
+template <typename T>
+struct BlockSparseConvTask : cpu_backend_threadpool::Task {
+  BlockSparseConvTask(const ConvParams& params,
+                      const FullyConnectedParams& matmul_params,
+                      const BlockSparseMatrix<T>& filter,
+                      const int32_t* per_channel_multiplier,
+                      const int* per_channel_shift,
+                      const RuntimeShape& input_shape, const T* input_data,
+                      const RuntimeShape& filter_shape,
+                      const BlockSparseAccum<T>* bias_data,
+                      const RuntimeShape& output_shape, T* output_data,
+                      int pixel_start, int pixel_end)
+      : params(params),
+        matmul_params(matmul_params),
+        filter(filter),
+        per_channel_multiplier(per_channel_multiplier),
+        per_channel_shift(per_channel_shift),
+        input_shape(input_shape),
+        input_data(input_data),
+        filter_shape(filter_shape),
+        bias_data(bias_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        pixel_start(pixel_start),
+        pixel_end(pixel_end) {}
+
+  void Run() override {
+    std::vector<T> patches(kBlockSparseConvTilePixels * filter.cols);
+    BlockSparseConvImpl(params, matmul_params, filter, per_channel_multiplier,
+                        per_channel_shift, input_shape, input_data,
+                        filter_shape, bias_data, output_shape, output_data,
+                        pixel_start, pixel_end, patches.data());
+  }
+
+ private:
+  const ConvParams& params;
+  const FullyConnectedParams& matmul_params;
+  const BlockSparseMatrix<T>& filter;
+  const int32_t* per_channel_multiplier;
+  const int* per_channel_shift;
+  const RuntimeShape& input_shape;
+  const T* input_data;
+  const RuntimeShape& filter_shape;
+  const BlockSparseAccum<T>* bias_data;
+  const RuntimeShape& output_shape;
+  T* output_data;
+  int pixel_start;
+  int pixel_end;
+};
+
+// Convolution with a block-sparse filter, see BlockSparseMatrix. Input
+// patches are gathered a tile of output pixels at a time, so unlike the dense
+// kernels no im2col buffer of the whole output is needed. Float and int8
+// (symmetric filter, per-channel `per_channel_multiplier` and
+// `per_channel_shift`) are supported; grouped convolution is not.
+//
+// The workload is sliced along the output pixels.
+template <typename T>
+inline void BlockSparseConv(
+    const ConvParams& params, const BlockSparseMatrix<T>& filter,
+    const int32_t* per_channel_multiplier, const int* per_channel_shift,
+    const RuntimeShape& input_shape, const T* input_data,
+    const RuntimeShape& filter_shape, const BlockSparseAccum<T>* bias_data,
+    const RuntimeShape& output_shape, T* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Conv");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter.rows, output_shape.Dims(3));
+  TFLITE_DCHECK_EQ(filter.cols, filter_shape.Dims(1) * filter_shape.Dims(2) *
+                                    input_shape.Dims(3));
+
+  FullyConnectedParams matmul_params;
+  if (std::is_integral<T>::value) {
+    matmul_params.input_offset = params.input_offset;
+    matmul_params.output_offset = params.output_offset;
+    matmul_params.quantized_activation_min = params.quantized_activation_min;
+    matmul_params.quantized_activation_max = params.quantized_activation_max;
+  } else {
+    matmul_params.float_activation_min = params.float_activation_min;
+    matmul_params.float_activation_max = params.float_activation_max;
+  }
+
+  const int pixels = output_shape.Dims(0) * output_shape.Dims(1) *
+                     output_shape.Dims(2);
+  const int tiles = (pixels + kBlockSparseConvTilePixels - 1) /
+                    kBlockSparseConvTilePixels;
+  const int64_t work = static_cast<int64_t>(filter.values.size()) * pixels;
+  const int thread_count = static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>(
+             {static_cast<int64_t>(cpu_backend_context->max_num_threads()),
+              static_cast<int64_t>(tiles),
+              work / kBlockSparseMinWorkPerThread})));
+  std::vector<BlockSparseConvTask<T>> tasks;
+  tasks.reserve(thread_count);
+  int tile_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int tile_end = tile_start + tiles / thread_count;
+    if (i < tiles % thread_count) tile_end++;
+    tasks.emplace_back(
+        params, matmul_params, filter, per_channel_multiplier,
+        per_channel_shift, input_shape, input_data, filter_shape, bias_data,
+        output_shape, output_data, tile_start * kBlockSparseConvTilePixels,
+        std::min(pixels, tile_end * kBlockSparseConvTilePixels));
+    tile_start = tile_end;
+  }
+  if (thread_count == 1) {
+    tasks[0].Run();
+    return;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_CONV_H_
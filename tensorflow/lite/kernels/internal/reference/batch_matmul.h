@@ -106,9 +106,11 @@ inline void BatchMatMul(const RuntimeShape& lhs_shape, const Ta* lhs_data,
   }
 }
 
+// Hybrid batch matmul, see optimized_ops::BatchMatMul for `per_channel_scale`.
 inline void BatchMatMul(const RuntimeShape& lhs_shape, const int8_t* lhs_data,
                         const RuntimeShape& rhs_shape, const int8_t* rhs_data,
                         const float* scaling_factors,
+                        const float* per_channel_scale,
                         const int32_t* input_offset, int32_t* row_sums,
                         const RuntimeShape& output_shape, float* output_data,
                         bool* compute_row_sums) {
@@ -136,16 +138,24 @@ inline void BatchMatMul(const RuntimeShape& lhs_shape, const int8_t* lhs_data,
   const int rhs_cols = extended_rhs_shape.Dims(4);
   const int accum_depth = extended_lhs_shape.Dims(4);
 
-  const int ioff_ext0 = rhs_ext0 == 0 ? 0 : rhs_cols;
-  const int ioff_ext1 = rhs_ext1 == 0 ? 0 : rhs_cols;
+  // Input scaling factors and offsets are stored per column, and row sums per
+  // row, of each matrix.
   const int ioff_ext2 = rhs_ext2 == 0 ? 0 : rhs_cols;
-  const int woff_ext0 = lhs_ext0 == 0 ? 0 : lhs_rows;
-  const int woff_ext1 = lhs_ext1 == 0 ? 0 : lhs_rows;
+  const int ioff_ext1 =
+      rhs_ext1 == 0 ? 0 : rhs_cols * extended_rhs_shape.Dims(2);
+  const int ioff_ext0 = rhs_ext0 == 0 ? 0
+                                      : rhs_cols * extended_rhs_shape.Dims(1) *
+                                            extended_rhs_shape.Dims(2);
   const int woff_ext2 = lhs_ext2 == 0 ? 0 : lhs_rows;
+  const int woff_ext1 =
+      lhs_ext1 == 0 ? 0 : lhs_rows * extended_lhs_shape.Dims(2);
+  const int woff_ext0 = lhs_ext0 == 0 ? 0
+                                      : lhs_rows * extended_lhs_shape.Dims(1) *
+                                            extended_lhs_shape.Dims(2);
 
   if (!compute_row_sums || *compute_row_sums) {
     int num_weights_matrices = 1;
-    for (int i = 1; i < extended_lhs_shape.DimensionsCount() - 2; ++i) {
+    for (int i = 0; i < extended_lhs_shape.DimensionsCount() - 2; ++i) {
       num_weights_matrices *= extended_lhs_shape.Dims(i);
     }
     tensor_utils::ReductionSumVector(
@@ -161,18 +171,23 @@ inline void BatchMatMul(const RuntimeShape& lhs_shape, const int8_t* lhs_data,
     const int32_t* ioff_ptr0 = input_offset + (b0 * ioff_ext0);
     const float* scale_ptr0 = scaling_factors + (b0 * ioff_ext0);
     const int32_t* woff_ptr0 = row_sums + (b0 * woff_ext0);
+    const float* pcs_ptr0 =
+        per_channel_scale ? per_channel_scale + (b0 * woff_ext0) : nullptr;
     for (int b1 = 0; b1 < batch_dim1; ++b1) {
       const int8_t* lhs_ptr1 = lhs_ptr0 + b1 * lhs_ext1;
       const int8_t* rhs_ptr1 = rhs_ptr0 + b1 * rhs_ext1;
       const int32_t* ioff_ptr1 = ioff_ptr0 + (b1 * ioff_ext1);
       const float* scale_ptr1 = scale_ptr0 + (b1 * ioff_ext1);
       const int32_t* woff_ptr1 = woff_ptr0 + (b1 * woff_ext1);
+      const float* pcs_ptr1 = pcs_ptr0 ? pcs_ptr0 + (b1 * woff_ext1) : nullptr;
       for (int b2 = 0; b2 < batch_dim2; ++b2) {
         const int8_t* lhs_ptr2 = lhs_ptr1 + b2 * lhs_ext2;
         const int8_t* rhs_ptr2 = rhs_ptr1 + b2 * rhs_ext2;
         const int32_t* ioff_ptr2 = ioff_ptr1 + (b2 * ioff_ext2);
         const float* scale_ptr2 = scale_ptr1 + (b2 * ioff_ext2);
         const int32_t* woff_ptr2 = woff_ptr1 + (b2 * woff_ext2);
+        const float* pcs_ptr2 =
+            pcs_ptr1 ? pcs_ptr1 + (b2 * woff_ext2) : nullptr;
         float* out_ptr = output_data + ((b0 * batch_dim1 * batch_dim2) +
                                         b1 * batch_dim2 + b2) *
                                            lhs_rows * rhs_cols;
@@ -188,7 +203,9 @@ inline void BatchMatMul(const RuntimeShape& lhs_shape, const int8_t* lhs_data,
             int32_t row_sum = woff_ptr2[i];
             total -= row_sum * batch_offset;
             int idx = lhs_rows * j + i;
-            out_ptr[idx] += batch_scaling_factor * total;
+            const float scale = pcs_ptr2 ? batch_scaling_factor * pcs_ptr2[i]
+                                         : batch_scaling_factor;
+            out_ptr[idx] += scale * total;
           }
         }
       }
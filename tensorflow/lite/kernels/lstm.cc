@@ -105,6 +105,32 @@ TfLiteStatus make_ledger(const TfLiteSparsity* sparsity, TfLiteContext* context,
   return context->ResizeTensor(context, ledger, ledger_size);
 }
 
+// The sparse kernels behind the ledgers apply a single scale to the whole
+// matrix, so sparse weights must be quantized per tensor.
+TfLiteStatus CheckSparseWeightsArePerTensor(TfLiteContext* context,
+                                            TfLiteNode* node) {
+  for (const int index :
+       {kInputToInputWeightsTensor, kInputToForgetWeightsTensor,
+        kInputToCellWeightsTensor, kInputToOutputWeightsTensor,
+        kRecurrentToInputWeightsTensor, kRecurrentToForgetWeightsTensor,
+        kRecurrentToCellWeightsTensor, kRecurrentToOutputWeightsTensor,
+        kProjectionWeightsTensor}) {
+    const TfLiteTensor* weights = GetOptionalInputTensor(context, node, index);
+    if (weights == nullptr || weights->sparsity == nullptr ||
+        weights->quantization.type != kTfLiteAffineQuantization) {
+      continue;
+    }
+    const auto* params = static_cast<const TfLiteAffineQuantization*>(
+        weights->quantization.params);
+    TF_LITE_ENSURE_MSG(
+        context,
+        params == nullptr || params->scale == nullptr ||
+            params->scale->size <= 1,
+        "Sparse hybrid LSTM weights must not be quantized per channel.");
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus copy_ledger(const TfLiteSparsity* sparsity, TfLiteTensor* ledger) {
   if (sparsity == nullptr) {
     return kTfLiteOk;
@@ -1371,6 +1397,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const bool is_hybrid_op = IsHybridOp(input, input_to_output_weights);
 
   const bool is_sparse_op = (input_to_output_weights->sparsity != nullptr);
+  if (is_hybrid_op && is_sparse_op) {
+    TF_LITE_ENSURE_OK(context, CheckSparseWeightsArePerTensor(context, node));
+  }
 
   // The type of Integer LSTM.
   const int num_intermediate_tensors = node->intermediates->size;
@@ -141,8 +141,28 @@ void ComputeRowSums(
   }
 }
 
+// Returns the per-channel scales of hybrid weights quantized along their
+// rows, or nullptr if the weights are quantized per-tensor.
+inline const float* GetTensorPerChannelScale(const TfLiteTensor* tensor) {
+  if (tensor == nullptr ||
+      tensor->quantization.type != kTfLiteAffineQuantization) {
+    return nullptr;
+  }
+  const auto* affine_quantization =
+      static_cast<const TfLiteAffineQuantization*>(tensor->quantization.params);
+  if (affine_quantization == nullptr || affine_quantization->scale == nullptr ||
+      affine_quantization->scale->size <= 1) {
+    return nullptr;
+  }
+  return affine_quantization->scale->data;
+}
+
+// Per-channel weights are fully described by their per-channel scales.
 inline float GetTensorScale(const TfLiteTensor* tensor) {
-  return tensor == nullptr ? 1.0f : tensor->params.scale;
+  if (tensor == nullptr || GetTensorPerChannelScale(tensor) != nullptr) {
+    return 1.0f;
+  }
+  return tensor->params.scale;
 }
 
 // LINT.IfChange
@@ -342,17 +362,21 @@ void CalculateLstmGateHybrid(
     const int8_t* input, const float* input_sf, const int32_t* input_zp,
     const int8_t* input_to_gate_weights,
     const uint8_t* input_to_gate_weights_ledger,
-    const float input_to_gate_weights_scale, int32_t* input_to_gate_row_sums,
+    const float input_to_gate_weights_scale,
+    const float* input_to_gate_weights_per_channel_scale,
+    int32_t* input_to_gate_row_sums,
     // Aux input and weights
     const int8_t* aux_input, const float* aux_input_sf,
     const int32_t* aux_input_zp, const int8_t* aux_input_to_gate_weights,
     const float aux_input_to_gate_weights_scale,
+    const float* aux_input_to_gate_weights_per_channel_scale,
     int32_t* aux_input_to_gate_row_sums,
     // Output state and weights
     const int8_t* output_state, const float* output_state_sf,
     const int32_t* output_state_zp, const int8_t* recurrent_to_gate_weights,
     const uint8_t* recurrent_to_gate_weights_ledger,
     const float recurrent_to_gate_weights_scale,
+    const float* recurrent_to_gate_weights_per_channel_scale,
     int32_t* recurrent_to_gate_row_sums,
     // Cell state and weights (peephole LSTM)
     const float* cell_state, const int8_t* cell_to_gate_weights,
@@ -400,7 +424,7 @@ void CalculateLstmGateHybrid(
       tensor_utils::MatrixBatchVectorMultiplyAccumulate(
           input_to_gate_weights, n_cell, n_input, input,
           input_to_gate_weights_scale, input_sf, n_batch, gate,
-          /*per_channel_scale=*/nullptr, input_zp, accum_scratch,
+          input_to_gate_weights_per_channel_scale, input_zp, accum_scratch,
           input_to_gate_row_sums, compute_row_sums, scratch0, context);
     }
   }
@@ -410,7 +434,8 @@ void CalculateLstmGateHybrid(
     tensor_utils::MatrixBatchVectorMultiplyAccumulate(
         aux_input_to_gate_weights, n_cell, n_aux_input, aux_input,
         aux_input_to_gate_weights_scale, aux_input_sf, n_batch, gate,
-        /*per_channel_scale=*/nullptr, aux_input_zp, accum_scratch,
+        aux_input_to_gate_weights_per_channel_scale, aux_input_zp,
+        accum_scratch,
         aux_input_to_gate_row_sums, compute_row_sums, scratch0, context);
   }
   // For each batch and cell: compute recurrent_weight * output_state.
@@ -428,7 +453,8 @@ void CalculateLstmGateHybrid(
       tensor_utils::MatrixBatchVectorMultiplyAccumulate(
           recurrent_to_gate_weights, n_cell, n_output, output_state,
           recurrent_to_gate_weights_scale, output_state_sf, n_batch, gate,
-          /*per_channel_scale=*/nullptr, output_state_zp, accum_scratch,
+          recurrent_to_gate_weights_per_channel_scale, output_state_zp,
+          accum_scratch,
           recurrent_to_gate_row_sums, compute_row_sums, scratch0, context);
     }
   }
@@ -475,8 +501,10 @@ void CalculateLstmOutputHybrid(
     int n_batch, int n_cell, int n_output, const float* cell_state,
     const float* output_gate, TfLiteFusedActivation activation,
     const int8_t* projection_weights, const uint8_t* projection_weights_ledger,
-    float projection_weights_scale, const float* projection_bias,
-    const float proj_clip, float* output_state, bool asymmetric_quantize_inputs,
+    float projection_weights_scale,
+    const float* projection_weights_per_channel_scale,
+    const float* projection_bias, const float proj_clip, float* output_state,
+    bool asymmetric_quantize_inputs,
     int32_t* projection_weights_row_sums, bool* compute_row_sums,
     CpuBackendContext* context, float* scratch0, int8_t* scratch1,
     float* scratch2, int32_t* scratch3, int32_t* scratch4) {
@@ -512,7 +540,7 @@ void CalculateLstmOutputHybrid(
         tensor_utils::MatrixBatchVectorMultiplyAccumulate(
             projection_weights, n_output, n_cell, scratch1,
             projection_weights_scale, scratch2, n_batch, output_state,
-            /*per_channel_scale=*/nullptr, scratch3, scratch4,
+            projection_weights_per_channel_scale, scratch3, scratch4,
             projection_weights_row_sums, compute_row_sums, scratch2, context);
       }
     }
@@ -1034,35 +1062,48 @@ inline void LstmStepHybrid(
     const float* input_ptr, const int8_t* input_to_input_weights_ptr,
     const uint8_t* input_to_input_weights_ledger_ptr,
     float input_to_input_weights_scale,
+    const float* input_to_input_weights_per_channel_scale,
     const int8_t* input_to_forget_weights_ptr,
     const uint8_t* input_to_forget_weights_ledger_ptr,
     float input_to_forget_weights_scale,
+    const float* input_to_forget_weights_per_channel_scale,
     const int8_t* input_to_cell_weights_ptr,
     const uint8_t* input_to_cell_weights_ledger_ptr,
     float input_to_cell_weights_scale,
+    const float* input_to_cell_weights_per_channel_scale,
     const int8_t* input_to_output_weights_ptr,
     const uint8_t* input_to_output_weights_ledger_ptr,
-    float input_to_output_weights_scale, const float* aux_input_ptr,
+    float input_to_output_weights_scale,
+    const float* input_to_output_weights_per_channel_scale,
+    const float* aux_input_ptr,
     const int8_t* aux_input_to_input_weights_ptr,
     float aux_input_to_input_weights_scale,
+    const float* aux_input_to_input_weights_per_channel_scale,
     const int8_t* aux_input_to_forget_weights_ptr,
     float aux_input_to_forget_weights_scale,
+    const float* aux_input_to_forget_weights_per_channel_scale,
     const int8_t* aux_input_to_cell_weights_ptr,
     float aux_input_to_cell_weights_scale,
+    const float* aux_input_to_cell_weights_per_channel_scale,
     const int8_t* aux_input_to_output_weights_ptr,
     float aux_input_to_output_weights_scale,
+    const float* aux_input_to_output_weights_per_channel_scale,
     const int8_t* recurrent_to_input_weights_ptr,
     const uint8_t* recurrent_to_input_weights_ledger_ptr,
     float recurrent_to_input_weights_scale,
+    const float* recurrent_to_input_weights_per_channel_scale,
     const int8_t* recurrent_to_forget_weights_ptr,
     const uint8_t* recurrent_to_forget_weights_ledger_ptr,
     float recurrent_to_forget_weights_scale,
+    const float* recurrent_to_forget_weights_per_channel_scale,
     const int8_t* recurrent_to_cell_weights_ptr,
     const uint8_t* recurrent_to_cell_weights_ledger_ptr,
     float recurrent_to_cell_weights_scale,
+    const float* recurrent_to_cell_weights_per_channel_scale,
     const int8_t* recurrent_to_output_weights_ptr,
     const uint8_t* recurrent_to_output_weights_ledger_ptr,
     float recurrent_to_output_weights_scale,
+    const float* recurrent_to_output_weights_per_channel_scale,
     const int8_t* cell_to_input_weights_ptr, float cell_to_input_weights_scale,
     const int8_t* cell_to_forget_weights_ptr,
     float cell_to_forget_weights_scale,
@@ -1076,7 +1117,9 @@ inline void LstmStepHybrid(
     const float* cell_gate_bias_ptr, const float* output_gate_bias_ptr,
     const int8_t* projection_weights_ptr,
     const uint8_t* projection_weights_ledger_ptr,
-    float projection_weights_scale, const float* projection_bias_ptr,
+    float projection_weights_scale,
+    const float* projection_weights_per_channel_scale,
+    const float* projection_bias_ptr,
     const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* scratch0, float* scratch1, float* scratch2, float* scratch3,
@@ -1195,12 +1238,15 @@ inline void LstmStepHybrid(
     CalculateLstmGateHybrid(
         quantized_input_ptr, input_sf, input_zp, input_to_input_weights_ptr,
         input_to_input_weights_ledger_ptr, input_to_input_weights_scale,
-        input_to_input_row_sums, quantized_aux_input_ptr, aux_input_sf,
-        aux_input_zp, aux_input_to_input_weights_ptr,
-        aux_input_to_input_weights_scale, aux_input_to_input_row_sums,
-        quantized_output_state_ptr, output_state_sf, output_state_zp,
-        recurrent_to_input_weights_ptr, recurrent_to_input_weights_ledger_ptr,
-        recurrent_to_input_weights_scale, recurrent_to_input_row_sums,
+        input_to_input_weights_per_channel_scale, input_to_input_row_sums,
+        quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+        aux_input_to_input_weights_ptr, aux_input_to_input_weights_scale,
+        aux_input_to_input_weights_per_channel_scale,
+        aux_input_to_input_row_sums, quantized_output_state_ptr,
+        output_state_sf, output_state_zp, recurrent_to_input_weights_ptr,
+        recurrent_to_input_weights_ledger_ptr, recurrent_to_input_weights_scale,
+        recurrent_to_input_weights_per_channel_scale,
+        recurrent_to_input_row_sums,
         cell_state_ptr, cell_to_input_weights_ptr, cell_to_input_weights_scale,
         input_layer_norm_coefficients_ptr, input_gate_bias_ptr, n_batch,
         n_input, n_aux_input, n_output, n_cell, kTfLiteActSigmoid,
@@ -1212,12 +1258,16 @@ inline void LstmStepHybrid(
   CalculateLstmGateHybrid(
       quantized_input_ptr, input_sf, input_zp, input_to_forget_weights_ptr,
       input_to_forget_weights_ledger_ptr, input_to_forget_weights_scale,
-      input_to_forget_row_sums, quantized_aux_input_ptr, aux_input_sf,
-      aux_input_zp, aux_input_to_forget_weights_ptr,
-      aux_input_to_forget_weights_scale, aux_input_to_forget_row_sums,
+      input_to_forget_weights_per_channel_scale, input_to_forget_row_sums,
+      quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+      aux_input_to_forget_weights_ptr, aux_input_to_forget_weights_scale,
+      aux_input_to_forget_weights_per_channel_scale,
+      aux_input_to_forget_row_sums,
       quantized_output_state_ptr, output_state_sf, output_state_zp,
       recurrent_to_forget_weights_ptr, recurrent_to_forget_weights_ledger_ptr,
-      recurrent_to_forget_weights_scale, recurrent_to_forget_row_sums,
+      recurrent_to_forget_weights_scale,
+      recurrent_to_forget_weights_per_channel_scale,
+      recurrent_to_forget_row_sums,
       cell_state_ptr, cell_to_forget_weights_ptr, cell_to_forget_weights_scale,
       forget_layer_norm_coefficients_ptr, forget_gate_bias_ptr, n_batch,
       n_input, n_aux_input, n_output, n_cell, kTfLiteActSigmoid,
@@ -1228,12 +1278,14 @@ inline void LstmStepHybrid(
   CalculateLstmGateHybrid(
       quantized_input_ptr, input_sf, input_zp, input_to_cell_weights_ptr,
       input_to_cell_weights_ledger_ptr, input_to_cell_weights_scale,
-      input_to_cell_row_sums, quantized_aux_input_ptr, aux_input_sf,
-      aux_input_zp, aux_input_to_cell_weights_ptr,
-      aux_input_to_cell_weights_scale, aux_input_to_cell_row_sums,
+      input_to_cell_weights_per_channel_scale, input_to_cell_row_sums,
+      quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+      aux_input_to_cell_weights_ptr, aux_input_to_cell_weights_scale,
+      aux_input_to_cell_weights_per_channel_scale, aux_input_to_cell_row_sums,
       quantized_output_state_ptr, output_state_sf, output_state_zp,
       recurrent_to_cell_weights_ptr, recurrent_to_cell_weights_ledger_ptr,
-      recurrent_to_cell_weights_scale, recurrent_to_cell_row_sums,
+      recurrent_to_cell_weights_scale,
+      recurrent_to_cell_weights_per_channel_scale, recurrent_to_cell_row_sums,
       /*cell_state=*/nullptr, /*cell_to_gate_weights=*/nullptr,
       /*cell_to_gate_weights_scale=*/0.0f, cell_layer_norm_coefficients_ptr,
       cell_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
@@ -1249,12 +1301,16 @@ inline void LstmStepHybrid(
   CalculateLstmGateHybrid(
       quantized_input_ptr, input_sf, input_zp, input_to_output_weights_ptr,
       input_to_output_weights_ledger_ptr, input_to_output_weights_scale,
-      input_to_output_row_sums, quantized_aux_input_ptr, aux_input_sf,
-      aux_input_zp, aux_input_to_output_weights_ptr,
-      aux_input_to_output_weights_scale, aux_input_to_output_row_sums,
+      input_to_output_weights_per_channel_scale, input_to_output_row_sums,
+      quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+      aux_input_to_output_weights_ptr, aux_input_to_output_weights_scale,
+      aux_input_to_output_weights_per_channel_scale,
+      aux_input_to_output_row_sums,
       quantized_output_state_ptr, output_state_sf, output_state_zp,
       recurrent_to_output_weights_ptr, recurrent_to_output_weights_ledger_ptr,
-      recurrent_to_output_weights_scale, recurrent_to_output_row_sums,
+      recurrent_to_output_weights_scale,
+      recurrent_to_output_weights_per_channel_scale,
+      recurrent_to_output_row_sums,
       cell_state_ptr, cell_to_output_weights_ptr, cell_to_output_weights_scale,
       output_layer_norm_coefficients_ptr, output_gate_bias_ptr, n_batch,
       n_input, n_aux_input, n_output, n_cell, kTfLiteActSigmoid,
@@ -1265,7 +1321,8 @@ inline void LstmStepHybrid(
   CalculateLstmOutputHybrid(
       n_batch, n_cell, n_output, cell_state_ptr, output_gate_scratch,
       params->activation, projection_weights_ptr, projection_weights_ledger_ptr,
-      projection_weights_scale, projection_bias_ptr, params->proj_clip,
+      projection_weights_scale, projection_weights_per_channel_scale,
+      projection_bias_ptr, params->proj_clip,
       output_state_ptr, asymmetric_quantize_inputs, projection_weights_row_sums,
       compute_row_sums, context, scratch2, quantized_output_scratch, input_sf,
       input_zp, accum_scratch_ptr);
@@ -2013,6 +2070,23 @@ TfLiteStatus EvalHybrid(
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
 
+  // MatrixBatchVectorMultiplyAccumulate only applies per-channel scales
+  // together with input offsets, so per-channel weights always use the
+  // asymmetric input quantization, which is at least as accurate.
+  TfLiteLSTMParams step_params = *params;
+  for (const TfLiteTensor* weights :
+       {input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+        input_to_output_weights, recurrent_to_input_weights,
+        recurrent_to_forget_weights, recurrent_to_cell_weights,
+        recurrent_to_output_weights, aux_input_to_input_weights,
+        aux_input_to_forget_weights, aux_input_to_cell_weights,
+        aux_input_to_output_weights, projection_weights}) {
+    if (GetTensorPerChannelScale(weights) != nullptr) {
+      step_params.asymmetric_quantize_inputs = true;
+    }
+  }
+  params = &step_params;
+
   int32_t* input_zp_ptr = nullptr;
   int32_t* aux_input_zp_ptr = nullptr;
   int32_t* output_state_zp_ptr = nullptr;
@@ -2043,35 +2117,47 @@ TfLiteStatus EvalHybrid(
           input_ptr, GetTensorData<int8_t>(input_to_input_weights),
           GetTensorData<uint8_t>(input_to_input_weights_ledger),
           GetTensorScale(input_to_input_weights),
+          GetTensorPerChannelScale(input_to_input_weights),
           GetTensorData<int8_t>(input_to_forget_weights),
           GetTensorData<uint8_t>(input_to_forget_weights_ledger),
           GetTensorScale(input_to_forget_weights),
+          GetTensorPerChannelScale(input_to_forget_weights),
           GetTensorData<int8_t>(input_to_cell_weights),
           GetTensorData<uint8_t>(input_to_cell_weights_ledger),
           GetTensorScale(input_to_cell_weights),
+          GetTensorPerChannelScale(input_to_cell_weights),
           GetTensorData<int8_t>(input_to_output_weights),
           GetTensorData<uint8_t>(input_to_output_weights_ledger),
-          GetTensorScale(input_to_output_weights), aux_input_ptr,
+          GetTensorScale(input_to_output_weights),
+          GetTensorPerChannelScale(input_to_output_weights), aux_input_ptr,
           GetTensorData<int8_t>(aux_input_to_input_weights),
           GetTensorScale(aux_input_to_input_weights),
+          GetTensorPerChannelScale(aux_input_to_input_weights),
           GetTensorData<int8_t>(aux_input_to_forget_weights),
           GetTensorScale(aux_input_to_forget_weights),
+          GetTensorPerChannelScale(aux_input_to_forget_weights),
           GetTensorData<int8_t>(aux_input_to_cell_weights),
           GetTensorScale(aux_input_to_cell_weights),
+          GetTensorPerChannelScale(aux_input_to_cell_weights),
           GetTensorData<int8_t>(aux_input_to_output_weights),
           GetTensorScale(aux_input_to_output_weights),
+          GetTensorPerChannelScale(aux_input_to_output_weights),
           GetTensorData<int8_t>(recurrent_to_input_weights),
           GetTensorData<uint8_t>(recurrent_to_input_weights_ledger),
           GetTensorScale(recurrent_to_input_weights),
+          GetTensorPerChannelScale(recurrent_to_input_weights),
           GetTensorData<int8_t>(recurrent_to_forget_weights),
           GetTensorData<uint8_t>(recurrent_to_forget_weights_ledger),
           GetTensorScale(recurrent_to_forget_weights),
+          GetTensorPerChannelScale(recurrent_to_forget_weights),
           GetTensorData<int8_t>(recurrent_to_cell_weights),
           GetTensorData<uint8_t>(recurrent_to_cell_weights_ledger),
           GetTensorScale(recurrent_to_cell_weights),
+          GetTensorPerChannelScale(recurrent_to_cell_weights),
           GetTensorData<int8_t>(recurrent_to_output_weights),
           GetTensorData<uint8_t>(recurrent_to_output_weights_ledger),
           GetTensorScale(recurrent_to_output_weights),
+          GetTensorPerChannelScale(recurrent_to_output_weights),
           GetTensorData<int8_t>(cell_to_input_weights),
           GetTensorScale(cell_to_input_weights),
           GetTensorData<int8_t>(cell_to_forget_weights),
@@ -2089,6 +2175,7 @@ TfLiteStatus EvalHybrid(
           GetTensorData<int8_t>(projection_weights),
           GetTensorData<uint8_t>(projection_weights_ledger),
           GetTensorScale(projection_weights),
+          GetTensorPerChannelScale(projection_weights),
           GetTensorData<float>(projection_bias), params, n_batch, n_cell,
           n_input, aux_input_size, n_output, output_batch_leading_dim,
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
@@ -2141,35 +2228,47 @@ TfLiteStatus EvalHybrid(
             input_ptr, GetTensorData<int8_t>(input_to_input_weights),
             GetTensorData<uint8_t>(input_to_input_weights_ledger),
             GetTensorScale(input_to_input_weights),
+            GetTensorPerChannelScale(input_to_input_weights),
             GetTensorData<int8_t>(input_to_forget_weights),
             GetTensorData<uint8_t>(input_to_forget_weights_ledger),
             GetTensorScale(input_to_forget_weights),
+            GetTensorPerChannelScale(input_to_forget_weights),
             GetTensorData<int8_t>(input_to_cell_weights),
             GetTensorData<uint8_t>(input_to_cell_weights_ledger),
             GetTensorScale(input_to_cell_weights),
+            GetTensorPerChannelScale(input_to_cell_weights),
             GetTensorData<int8_t>(input_to_output_weights),
             GetTensorData<uint8_t>(input_to_output_weights_ledger),
-            GetTensorScale(input_to_output_weights), aux_input_ptr,
+            GetTensorScale(input_to_output_weights),
+            GetTensorPerChannelScale(input_to_output_weights), aux_input_ptr,
             GetTensorData<int8_t>(aux_input_to_input_weights),
             GetTensorScale(aux_input_to_input_weights),
+            GetTensorPerChannelScale(aux_input_to_input_weights),
             GetTensorData<int8_t>(aux_input_to_forget_weights),
             GetTensorScale(aux_input_to_forget_weights),
+            GetTensorPerChannelScale(aux_input_to_forget_weights),
             GetTensorData<int8_t>(aux_input_to_cell_weights),
             GetTensorScale(aux_input_to_cell_weights),
+            GetTensorPerChannelScale(aux_input_to_cell_weights),
             GetTensorData<int8_t>(aux_input_to_output_weights),
             GetTensorScale(aux_input_to_output_weights),
+            GetTensorPerChannelScale(aux_input_to_output_weights),
             GetTensorData<int8_t>(recurrent_to_input_weights),
             GetTensorData<uint8_t>(recurrent_to_input_weights_ledger),
             GetTensorScale(recurrent_to_input_weights),
+            GetTensorPerChannelScale(recurrent_to_input_weights),
             GetTensorData<int8_t>(recurrent_to_forget_weights),
             GetTensorData<uint8_t>(recurrent_to_forget_weights_ledger),
             GetTensorScale(recurrent_to_forget_weights),
+            GetTensorPerChannelScale(recurrent_to_forget_weights),
             GetTensorData<int8_t>(recurrent_to_cell_weights),
             GetTensorData<uint8_t>(recurrent_to_cell_weights_ledger),
             GetTensorScale(recurrent_to_cell_weights),
+            GetTensorPerChannelScale(recurrent_to_cell_weights),
             GetTensorData<int8_t>(recurrent_to_output_weights),
             GetTensorData<uint8_t>(recurrent_to_output_weights_ledger),
             GetTensorScale(recurrent_to_output_weights),
+            GetTensorPerChannelScale(recurrent_to_output_weights),
             GetTensorData<int8_t>(cell_to_input_weights),
             GetTensorScale(cell_to_input_weights),
             GetTensorData<int8_t>(cell_to_forget_weights),
@@ -2187,6 +2286,7 @@ TfLiteStatus EvalHybrid(
             GetTensorData<int8_t>(projection_weights),
             GetTensorData<uint8_t>(projection_weights_ledger),
             GetTensorScale(projection_weights),
+            GetTensorPerChannelScale(projection_weights),
             GetTensorData<float>(projection_bias), params,
             /*n_batch=*/1, n_cell, n_input, aux_input_size, n_output,
             output_batch_leading_dim, input_gate_scratch_ptr,
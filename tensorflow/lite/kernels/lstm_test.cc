@@ -2141,7 +2141,8 @@ class HybridSparseLSTMOpModel : public ::tflite::SingleOpModel {
       const std::vector<float>& recurrent_to_forget_weights,
       const std::vector<float>& recurrent_to_cell_weights,
       const std::vector<float>& recurrent_to_output_weights,
-      const ::tflite::TensorType& weight_type = ::tflite::TensorType_INT8)
+      const ::tflite::TensorType& weight_type = ::tflite::TensorType_INT8,
+      bool allocate_and_delegate = true)
       : n_batch_(n_batch),
         n_input_(n_input),
         n_cell_(n_cell),
@@ -2235,9 +2236,32 @@ class HybridSparseLSTMOpModel : public ::tflite::SingleOpModel {
         CreateLSTMOptions(builder_, ActivationFunctionType_TANH, cell_clip,
                           proj_clip, LSTMKernelType_FULL, false)
             .Union());
-    BuildInterpreter(input_shapes);
+    BuildInterpreter(input_shapes, /*num_threads=*/-1,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true, allocate_and_delegate);
+  }
+
+  // Gives the recurrent-to-forget weights one (unchanged) scale per row.
+  void UsePerChannelRecurrentToForgetWeights() {
+    TfLiteTensor* t = interpreter_->tensor(recurrent_to_forget_weights_);
+    const int num_rows = t->dims->data[0];
+    const float scale = t->params.scale;
+    auto* affine_quantization = reinterpret_cast<TfLiteAffineQuantization*>(
+        malloc(sizeof(TfLiteAffineQuantization)));
+    affine_quantization->quantized_dimension = 0;
+    affine_quantization->scale = TfLiteFloatArrayCreate(num_rows);
+    affine_quantization->zero_point = TfLiteIntArrayCreate(num_rows);
+    for (int row = 0; row < num_rows; ++row) {
+      affine_quantization->scale->data[row] = scale;
+      affine_quantization->zero_point->data[row] = 0;
+    }
+    TfLiteQuantizationFree(&t->quantization);
+    t->quantization.type = kTfLiteAffineQuantization;
+    t->quantization.params = affine_quantization;
   }
 
+  TfLiteStatus AllocateTensors() { return interpreter_->AllocateTensors(); }
+
   void SetCellToInputWeights(std::vector<float> f) {
     SignedSymmetricQuantizeAndPopulate(cell_to_input_weights_, f);
   }
@@ -2734,6 +2758,71 @@ TEST_F(NoCifgPeepholeProjectionNoClippingSparseLstmTest,
                 sparse_layer_norm_lstm_golden_output, &sparse_layer_norm_lstm);
 }
 
+TEST_F(NoCifgPeepholeProjectionNoClippingSparseLstmTest,
+       HybridSparseLstmRejectsPerChannelWeights) {
+  TensorData input_weight = {};
+  input_weight.type = TensorType_FLOAT32;
+  input_weight.shape = {4, 48};
+  input_weight.traversal_order = {0, 1, 2};
+  input_weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  input_weight.block_map = {1};
+  input_weight.block_size = {16};
+  TensorData recurrent_weight = {};
+  recurrent_weight.type = TensorType_FLOAT32;
+  recurrent_weight.shape = {4, 16};
+  recurrent_weight.traversal_order = {0, 1, 2};
+  recurrent_weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  recurrent_weight.block_map = {1};
+  recurrent_weight.block_size = {16};
+  HybridSparseLSTMOpModel sparse_layer_norm_lstm(
+      n_batch_, n_input_, n_cell_, n_output_,
+      /*use_cifg=*/false, /*use_peephole=*/true,
+      /*use_projection_weights=*/true,
+      /*use_projection_bias=*/false, cell_clip_, proj_clip_,
+      {
+          {n_batch_, n_input_},  // input tensor
+
+          {input_to_input_weights_size_},
+          {input_to_forget_weights_size_},
+          {input_to_cell_weights_size_},
+          {input_to_output_weights_size_},
+
+          {recurrent_to_input_weights_size_},
+          {recurrent_to_forget_weights_size_},
+          {recurrent_to_cell_weights_size_},
+          {recurrent_to_output_weights_size_},
+
+          {n_cell_},  // cell_to_input_weight tensor
+          {n_cell_},  // cell_to_forget_weight tensor
+          {n_cell_},  // cell_to_output_weight tensor
+
+          {n_cell_},  // input_gate_bias tensor
+          {n_cell_},  // forget_gate_bias tensor
+          {n_cell_},  // cell_bias tensor
+          {n_cell_},  // output_gate_bias tensor
+
+          {n_output_, n_cell_},  // projection_weight tensor
+          {0},                   // projection_bias tensor
+
+          {n_output_ * n_batch_},  // output_state tensor
+          {n_cell_ * n_batch_},    // cell_state tensor
+
+          {n_cell_},  // input_layer_norm_weight tensor
+          {n_cell_},  // forget_layer_norm_weight tensor
+          {n_cell_},  // cell_layer_norm_weight tensor
+          {n_cell_},  // output_layer_norm_weight tensor
+      },
+      input_weight, input_to_input_weights_, input_to_forget_weights_,
+      input_to_cell_weights_, input_to_output_weights_, recurrent_weight,
+      recurrent_to_input_weights_, recurrent_to_forget_weights_,
+      recurrent_to_cell_weights_, recurrent_to_output_weights_,
+      TensorType_INT8, /*allocate_and_delegate=*/false);
+
+  // The ledger path would silently apply a single scale to every row.
+  sparse_layer_norm_lstm.UsePerChannelRecurrentToForgetWeights();
+  EXPECT_EQ(sparse_layer_norm_lstm.AllocateTensors(), kTfLiteError);
+}
+
 // Test parameter controls asymmetric_quantize_inputs in LSTMOpModel.
 INSTANTIATE_TEST_SUITE_P(
     Parameterized, LstmOpTest,
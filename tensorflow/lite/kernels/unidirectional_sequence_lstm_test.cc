@@ -49,11 +49,42 @@ class HybridUnidirectionalLSTMOpModel : public UnidirectionalLSTMOpModel {
   void SetWeights(int weights_idx, const std::vector<float>& f) {
     if (tensor_type_ == TensorType_UINT8) {
       SymmetricQuantizeAndPopulate(weights_idx, f);
+    } else if (per_channel_weights_ &&
+               interpreter_->tensor(weights_idx)->dims->size == 2) {
+      PerRowQuantizeAndPopulate(weights_idx, f);
     } else {
       SignedSymmetricQuantizeAndPopulate(weights_idx, f);
     }
   }
 
+  // Quantizes the int8 weight matrices set afterwards with one scale per row.
+  void UsePerChannelWeights() { per_channel_weights_ = true; }
+
+  void PerRowQuantizeAndPopulate(int weights_idx, const std::vector<float>& f) {
+    TfLiteTensor* t = interpreter_->tensor(weights_idx);
+    const int num_rows = t->dims->data[0];
+    const int num_cols = t->dims->data[1];
+    std::vector<int8_t> q(f.size());
+    auto* affine_quantization = reinterpret_cast<TfLiteAffineQuantization*>(
+        malloc(sizeof(TfLiteAffineQuantization)));
+    affine_quantization->quantized_dimension = 0;
+    affine_quantization->scale = TfLiteFloatArrayCreate(num_rows);
+    affine_quantization->zero_point = TfLiteIntArrayCreate(num_rows);
+    for (int row = 0; row < num_rows; ++row) {
+      float min, max;
+      tensor_utils::SymmetricQuantizeFloats(
+          f.data() + row * num_cols, num_cols, q.data() + row * num_cols, &min,
+          &max, &affine_quantization->scale->data[row]);
+      affine_quantization->zero_point->data[row] = 0;
+    }
+    t->params.scale = 0.0f;
+    t->params.zero_point = 0;
+    TfLiteQuantizationFree(&t->quantization);
+    t->quantization.type = kTfLiteAffineQuantization;
+    t->quantization.params = affine_quantization;
+    PopulateTensor(weights_idx, /*offset=*/0, q.data(), q.data() + q.size());
+  }
+
   void SetInputToInputWeights(const std::vector<float>& f) {
     SetWeights(input_to_input_weights_, f);
   }
@@ -104,6 +135,7 @@ class HybridUnidirectionalLSTMOpModel : public UnidirectionalLSTMOpModel {
 
  protected:
   TensorType tensor_type_;
+  bool per_channel_weights_ = false;
 };
 
 class BaseUnidirectionalLstmTest : public ::testing::TestWithParam<bool> {
@@ -498,6 +530,70 @@ TEST_P(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
                 /*tolerance=*/0.0157651);
 }
 
+TEST_P(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
+       HybridLstmBlackBoxTestPerChannelInt8) {
+  const int n_batch = 1;
+  const int n_input = 2;
+  // n_cell and n_output have the same size when there is no projection.
+  const int n_cell = 4;
+  const int n_output = 4;
+  const int sequence_length = 3;
+
+  HybridUnidirectionalLSTMOpModel lstm(
+      n_batch, n_input, n_cell, n_output, sequence_length,
+      /*time_major=*/true, /*use_cifg=*/false, /*use_peephole=*/false,
+      /*use_projection_weights=*/false,
+      /*use_projection_bias=*/false, /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+      {
+          {sequence_length, n_batch, n_input},  // input tensor
+
+          {n_cell, n_input},  // input_to_input_weight tensor
+          {n_cell, n_input},  // input_to_forget_weight tensor
+          {n_cell, n_input},  // input_to_cell_weight tensor
+          {n_cell, n_input},  // input_to_output_weight tensor
+
+          {n_cell, n_output},  // recurrent_to_input_weight tensor
+          {n_cell, n_output},  // recurrent_to_forget_weight tensor
+          {n_cell, n_output},  // recurrent_to_cell_weight tensor
+          {n_cell, n_output},  // recurrent_to_output_weight tensor
+
+          {0},  // cell_to_input_weight tensor
+          {0},  // cell_to_forget_weight tensor
+          {0},  // cell_to_output_weight tensor
+
+          {n_cell},  // input_gate_bias tensor
+          {n_cell},  // forget_gate_bias tensor
+          {n_cell},  // cell_gate_bias tensor
+          {n_cell},  // output_gate_bias tensor
+
+          {0, 0},  // projection_weight tensor
+          {0},     // projection_bias tensor
+
+          {n_batch, n_output},  // output_state tensor
+          {n_batch, n_cell},    // cell_state tensor
+      },
+      TensorType_INT8, GetParam());
+  lstm.UsePerChannelWeights();
+
+  lstm.SetInputToInputWeights(input_to_input_weights_);
+  lstm.SetInputToCellWeights(input_to_cell_weights_);
+  lstm.SetInputToForgetWeights(input_to_forget_weights_);
+  lstm.SetInputToOutputWeights(input_to_output_weights_);
+
+  lstm.SetInputGateBias(input_gate_bias_);
+  lstm.SetCellBias(cell_gate_bias_);
+  lstm.SetForgetGateBias(forget_gate_bias_);
+  lstm.SetOutputGateBias(output_gate_bias_);
+
+  lstm.SetRecurrentToInputWeights(recurrent_to_input_weights_);
+  lstm.SetRecurrentToCellWeights(recurrent_to_cell_weights_);
+  lstm.SetRecurrentToForgetWeights(recurrent_to_forget_weights_);
+  lstm.SetRecurrentToOutputWeights(recurrent_to_output_weights_);
+
+  VerifyGoldens(lstm_input_, lstm_golden_output_, &lstm,
+                /*tolerance=*/0.0157651);
+}
+
 class CifgPeepholeNoProjectionNoClippingUnidirectionalLstmTest
     : public BaseUnidirectionalLstmTest {
   void SetUp() override {
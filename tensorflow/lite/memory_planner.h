@@ -62,6 +62,15 @@ class MemoryPlanner {
   // Returns true if the non-persistent memory is available.
   virtual bool HasNonPersistentMemory() = 0;
 
+  // Declares that nodes are executed in steps rather than one by one in
+  // execution plan order: `steps[i]` is the step of the i-th node of the
+  // execution plan, and nodes sharing a step may run concurrently. Tensors
+  // used in overlapping ranges of steps must not share memory. An empty
+  // vector restores sequential execution. Takes effect on the next call to
+  // PlanAllocations(). Planners that never share memory between tensors can
+  // ignore this.
+  virtual void SetNodeExecutionSteps(const std::vector<int>& steps) {}
+
   // Dumps the memory planning information against the specified op node
   // execution plan (i.e. `execution_plan`) for the purpose of debugging.
   virtual void DumpDebugInfo(const std::vector<int>& execution_plan) const = 0;
@@ -267,6 +267,34 @@ TEST(BasicFlatBufferModel, TestModelInInterpreter) {
   }
 }
 
+TEST(BasicFlatBufferModel, TestWeightLoadPolicy) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin");
+  ASSERT_TRUE(model);
+  TrivialResolver resolver(&dummy_reg);
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver)(&interpreter), kTfLiteOk);
+  EXPECT_EQ(interpreter->weight_loader(), nullptr);
+
+  for (WeightLoadPolicy policy :
+       {WeightLoadPolicy::kPrefault, WeightLoadPolicy::kPrefetch}) {
+    InterpreterOptions options;
+    options.SetWeightLoadPolicy(policy);
+    ASSERT_EQ(InterpreterBuilder(*model, resolver, &options)(&interpreter),
+              kTfLiteOk);
+    WeightLoader* loader = interpreter->weight_loader();
+    ASSERT_NE(loader, nullptr);
+    loader->Wait();
+    // Only tensor 0, read by the first op, is memory-mapped.
+    const WeightLoader::Stats stats = loader->GetStats();
+    EXPECT_EQ(stats.num_ranges, 1);
+    EXPECT_EQ(stats.bytes, interpreter->tensor(0)->bytes);
+    EXPECT_EQ(stats.loaded_bytes, stats.bytes);
+    EXPECT_TRUE(stats.done);
+  }
+}
+
 TEST(BasicFlatBufferModel, TestWithNumThreads) {
   TestErrorReporter reporter;
   auto model = FlatBufferModel::BuildFromFile(
@@ -0,0 +1,428 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/op_fusion.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/fused_elementwise.h"
+
+namespace tflite {
+namespace {
+
+namespace fused_elementwise = ops::custom::fused_elementwise;
+
+constexpr int kNoReader = -1;
+
+// Readers of the tensors of a subgraph, according to an execution plan.
+class TensorReaders {
+ public:
+  TensorReaders(const Subgraph& subgraph, const std::vector<int>& plan)
+      : num_reads_(subgraph.tensors_size(), 0),
+        reader_(subgraph.tensors_size(), kNoReader) {
+    for (int position = 0; position < plan.size(); ++position) {
+      const TfLiteNode& node =
+          subgraph.node_and_registration(plan[position])->first;
+      for (int i = 0; i < node.inputs->size; ++i) {
+        AddRead(node.inputs->data[i], position);
+      }
+    }
+    // Outputs and variables are read from outside of the plan.
+    for (int tensor : subgraph.outputs()) AddRead(tensor, kNoReader);
+    for (int tensor : subgraph.variables()) AddRead(tensor, kNoReader);
+  }
+
+  // Returns the position in the plan of the only reader of `tensor`, or
+  // kNoReader if the tensor has no or several readers.
+  int SingleReader(int tensor) const {
+    if (tensor < 0 || tensor >= num_reads_.size()) return kNoReader;
+    return num_reads_[tensor] == 1 ? reader_[tensor] : kNoReader;
+  }
+
+ private:
+  void AddRead(int tensor, int position) {
+    if (tensor < 0 || tensor >= num_reads_.size()) return;
+    ++num_reads_[tensor];
+    reader_[tensor] = position;
+  }
+
+  std::vector<int> num_reads_;
+  std::vector<int> reader_;
+};
+
+int64_t NumElements(const TfLiteIntArray* dims) {
+  int64_t count = 1;
+  for (int i = 0; i < dims->size; ++i) count *= dims->data[i];
+  return count;
+}
+
+bool IsConstant(const TfLiteTensor& tensor) {
+  return tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw != nullptr;
+}
+
+// Returns the size of the builtin data of ops with a fused activation, and
+// the offset of that activation in it.
+bool GetFusedActivationField(int builtin_code, size_t* size, size_t* offset) {
+  switch (builtin_code) {
+    case kTfLiteBuiltinConv2d:
+      *size = sizeof(TfLiteConvParams);
+      *offset = offsetof(TfLiteConvParams, activation);
+      return true;
+    case kTfLiteBuiltinDepthwiseConv2d:
+      *size = sizeof(TfLiteDepthwiseConvParams);
+      *offset = offsetof(TfLiteDepthwiseConvParams, activation);
+      return true;
+    case kTfLiteBuiltinFullyConnected:
+      *size = sizeof(TfLiteFullyConnectedParams);
+      *offset = offsetof(TfLiteFullyConnectedParams, activation);
+      return true;
+    case kTfLiteBuiltinAdd:
+      *size = sizeof(TfLiteAddParams);
+      *offset = offsetof(TfLiteAddParams, activation);
+      return true;
+    case kTfLiteBuiltinSub:
+      *size = sizeof(TfLiteSubParams);
+      *offset = offsetof(TfLiteSubParams, activation);
+      return true;
+    case kTfLiteBuiltinMul:
+      *size = sizeof(TfLiteMulParams);
+      *offset = offsetof(TfLiteMulParams, activation);
+      return true;
+    case kTfLiteBuiltinDiv:
+      *size = sizeof(TfLiteDivParams);
+      *offset = offsetof(TfLiteDivParams, activation);
+      return true;
+    default:
+      return false;
+  }
+}
+
+TfLiteFusedActivation GetFusedActivation(const void* builtin_data,
+                                         size_t offset) {
+  TfLiteFusedActivation activation;
+  memcpy(&activation, static_cast<const char*>(builtin_data) + offset,
+         sizeof(activation));
+  return activation;
+}
+
+// Returns the fused activation equivalent to an activation op.
+bool GetActivationOfOp(int builtin_code, TfLiteFusedActivation* activation) {
+  switch (builtin_code) {
+    case kTfLiteBuiltinRelu:
+      *activation = kTfLiteActRelu;
+      return true;
+    case kTfLiteBuiltinRelu6:
+      *activation = kTfLiteActRelu6;
+      return true;
+    case kTfLiteBuiltinReluN1To1:
+      *activation = kTfLiteActReluN1To1;
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::vector<int> ToVector(const TfLiteIntArray* array) {
+  return std::vector<int>(array->data, array->data + array->size);
+}
+
+bool HaveSameQuantization(const TfLiteTensor& a, const TfLiteTensor& b) {
+  return a.type == b.type && a.params.scale == b.params.scale &&
+         a.params.zero_point == b.params.zero_point;
+}
+
+// Folds activation ops into the fused activation of their producers.
+TfLiteStatus FoldActivations(Subgraph* subgraph, std::vector<int>* plan,
+                             OpFusionStats* stats) {
+  const TensorReaders readers(*subgraph, *plan);
+  std::vector<bool> removed(plan->size(), false);
+  for (int position = 0; position < plan->size(); ++position) {
+    if (removed[position]) continue;
+    const auto* producer = subgraph->node_and_registration((*plan)[position]);
+    const TfLiteNode& node = producer->first;
+    size_t builtin_data_size, activation_offset;
+    if (node.delegate != nullptr || node.builtin_data == nullptr ||
+        node.outputs->size != 1 ||
+        !GetFusedActivationField(producer->second.builtin_code,
+                                 &builtin_data_size, &activation_offset) ||
+        GetFusedActivation(node.builtin_data, activation_offset) !=
+            kTfLiteActNone) {
+      continue;
+    }
+    const int output = node.outputs->data[0];
+    const int reader_position = readers.SingleReader(output);
+    if (reader_position == kNoReader || removed[reader_position]) continue;
+    const auto* reader =
+        subgraph->node_and_registration((*plan)[reader_position]);
+    TfLiteFusedActivation activation;
+    if (!GetActivationOfOp(reader->second.builtin_code, &activation) ||
+        reader->first.inputs->size != 1 || reader->first.outputs->size != 1) {
+      continue;
+    }
+    const int activation_output = reader->first.outputs->data[0];
+    // Fused activations clamp to the range of the op output, so quantized
+    // activations must not requantize.
+    const TfLiteTensor& tensor = *subgraph->tensor(output);
+    if ((tensor.type != kTfLiteFloat32 && tensor.type != kTfLiteInt8 &&
+         tensor.type != kTfLiteUInt8) ||
+        !HaveSameQuantization(tensor, *subgraph->tensor(activation_output))) {
+      continue;
+    }
+
+    void* builtin_data = malloc(builtin_data_size);
+    memcpy(builtin_data, node.builtin_data, builtin_data_size);
+    memcpy(static_cast<char*>(builtin_data) + activation_offset, &activation,
+           sizeof(activation));
+    // Adding a node invalidates `producer` and `reader`.
+    const TfLiteRegistration registration = producer->second;
+    const std::vector<int> inputs = ToVector(node.inputs);
+    const std::vector<int> intermediates = ToVector(node.intermediates);
+    int node_index;
+    TF_LITE_ENSURE_STATUS(subgraph->AddNodeWithParameters(
+        inputs, {activation_output}, intermediates, nullptr, 0, builtin_data,
+        &registration, &node_index));
+    (*plan)[position] = node_index;
+    removed[reader_position] = true;
+    if (stats) ++stats->num_folded_activations;
+  }
+
+  std::vector<int> new_plan;
+  for (int position = 0; position < plan->size(); ++position) {
+    if (!removed[position]) new_plan.push_back((*plan)[position]);
+  }
+  *plan = std::move(new_plan);
+  return kTfLiteOk;
+}
+
+// An op of the plan as steps of a fused elementwise chain.
+struct ElementwiseOp {
+  // The tensor running through the chain, and the op's output.
+  int input;
+  int output;
+  // Constant operand of the binary step, if any.
+  int operand = -1;
+  int num_steps = 0;
+  fused_elementwise::StepType steps[2];
+};
+
+bool AddActivationStep(TfLiteFusedActivation activation, ElementwiseOp* op) {
+  switch (activation) {
+    case kTfLiteActNone:
+      return true;
+    case kTfLiteActRelu:
+      op->steps[op->num_steps++] = fused_elementwise::StepType::kRelu;
+      return true;
+    case kTfLiteActRelu6:
+      op->steps[op->num_steps++] = fused_elementwise::StepType::kRelu6;
+      return true;
+    case kTfLiteActReluN1To1:
+      op->steps[op->num_steps++] = fused_elementwise::StepType::kReluN1To1;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns whether `operand` broadcasts to `input` as a single value or as one
+// value per channel, i.e. along the innermost dimension.
+bool IsScalarOrPerChannel(const TfLiteTensor& operand,
+                          const TfLiteTensor& input) {
+  const TfLiteIntArray* dims = operand.dims;
+  if (NumElements(dims) == 1) return true;
+  if (dims->size == 0 || dims->size > input.dims->size) return false;
+  for (int i = 0; i < dims->size - 1; ++i) {
+    if (dims->data[i] != 1) return false;
+  }
+  return dims->data[dims->size - 1] ==
+         input.dims->data[input.dims->size - 1];
+}
+
+bool GetElementwiseOp(const Subgraph& subgraph, const TfLiteNode& node,
+                      const TfLiteRegistration& registration,
+                      ElementwiseOp* op) {
+  using fused_elementwise::StepType;
+  if (node.delegate != nullptr || node.outputs->size != 1) return false;
+  op->output = node.outputs->data[0];
+  if (subgraph.tensor(op->output)->type != kTfLiteFloat32) return false;
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const int tensor = node.inputs->data[i];
+    if (tensor < 0 || subgraph.tensor(tensor)->type != kTfLiteFloat32) {
+      return false;
+    }
+  }
+
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinRelu:
+    case kTfLiteBuiltinRelu6:
+    case kTfLiteBuiltinReluN1To1:
+    case kTfLiteBuiltinTanh:
+    case kTfLiteBuiltinLogistic: {
+      if (node.inputs->size != 1) return false;
+      op->input = node.inputs->data[0];
+      const int code = registration.builtin_code;
+      op->steps[op->num_steps++] =
+          code == kTfLiteBuiltinRelu        ? StepType::kRelu
+          : code == kTfLiteBuiltinRelu6     ? StepType::kRelu6
+          : code == kTfLiteBuiltinReluN1To1 ? StepType::kReluN1To1
+          : code == kTfLiteBuiltinTanh      ? StepType::kTanh
+                                            : StepType::kLogistic;
+      return true;
+    }
+    case kTfLiteBuiltinAdd:
+    case kTfLiteBuiltinSub:
+    case kTfLiteBuiltinMul:
+    case kTfLiteBuiltinDiv: {
+      if (node.inputs->size != 2 || node.builtin_data == nullptr) {
+        return false;
+      }
+      const TfLiteTensor& lhs = *subgraph.tensor(node.inputs->data[0]);
+      const TfLiteTensor& rhs = *subgraph.tensor(node.inputs->data[1]);
+      if (IsConstant(lhs) == IsConstant(rhs)) return false;
+      const bool constant_lhs = IsConstant(lhs);
+      op->input = node.inputs->data[constant_lhs ? 1 : 0];
+      op->operand = node.inputs->data[constant_lhs ? 0 : 1];
+      const TfLiteTensor& input = constant_lhs ? rhs : lhs;
+      const TfLiteTensor& operand = constant_lhs ? lhs : rhs;
+      if (!IsScalarOrPerChannel(operand, input) ||
+          !TfLiteIntArrayEqual(input.dims, subgraph.tensor(op->output)->dims)) {
+        return false;
+      }
+      size_t builtin_data_size, activation_offset;
+      GetFusedActivationField(registration.builtin_code, &builtin_data_size,
+                              &activation_offset);
+      switch (registration.builtin_code) {
+        case kTfLiteBuiltinAdd:
+          op->steps[op->num_steps++] = StepType::kAdd;
+          break;
+        case kTfLiteBuiltinSub:
+          op->steps[op->num_steps++] =
+              constant_lhs ? StepType::kReverseSub : StepType::kSub;
+          break;
+        case kTfLiteBuiltinMul:
+          op->steps[op->num_steps++] = StepType::kMul;
+          break;
+        case kTfLiteBuiltinDiv:
+          op->steps[op->num_steps++] =
+              constant_lhs ? StepType::kReverseDiv : StepType::kDiv;
+          break;
+      }
+      return AddActivationStep(
+          GetFusedActivation(node.builtin_data, activation_offset), op);
+    }
+    default:
+      return false;
+  }
+}
+
+// Replaces chains of elementwise ops by fused elementwise nodes.
+TfLiteStatus FuseElementwiseChains(Subgraph* subgraph,
+                                   const TfLiteRegistration& fused_elementwise,
+                                   std::vector<int>* plan,
+                                   OpFusionStats* stats) {
+  const TensorReaders readers(*subgraph, *plan);
+  std::vector<bool> removed(plan->size(), false);
+  for (int position = 0; position < plan->size(); ++position) {
+    if (removed[position]) continue;
+    std::vector<ElementwiseOp> chain(1);
+    std::vector<int> chain_positions = {position};
+    const auto* head = subgraph->node_and_registration((*plan)[position]);
+    if (!GetElementwiseOp(*subgraph, head->first, head->second, &chain[0])) {
+      continue;
+    }
+    int num_steps = chain[0].num_steps;
+    while (true) {
+      const int next_position = readers.SingleReader(chain.back().output);
+      if (next_position == kNoReader || removed[next_position]) break;
+      const auto* next =
+          subgraph->node_and_registration((*plan)[next_position]);
+      ElementwiseOp op;
+      if (!GetElementwiseOp(*subgraph, next->first, next->second, &op) ||
+          op.input != chain.back().output ||
+          num_steps + op.num_steps > fused_elementwise::kMaxSteps) {
+        break;
+      }
+      num_steps += op.num_steps;
+      chain.push_back(op);
+      chain_positions.push_back(next_position);
+    }
+    if (chain.size() < 2) continue;
+
+    auto* params = static_cast<fused_elementwise::Params*>(
+        malloc(sizeof(fused_elementwise::Params)));
+    params->num_steps = 0;
+    std::vector<int> inputs = {chain[0].input};
+    for (const ElementwiseOp& op : chain) {
+      int input_index = 0;
+      if (op.operand >= 0) {
+        auto it = std::find(inputs.begin() + 1, inputs.end(), op.operand);
+        input_index = it - inputs.begin();
+        if (it == inputs.end()) inputs.push_back(op.operand);
+      }
+      for (int i = 0; i < op.num_steps; ++i) {
+        fused_elementwise::Step& step = params->steps[params->num_steps++];
+        step.type = op.steps[i];
+        // Only the first step of an op is binary.
+        step.input_index = i == 0 ? input_index : 0;
+      }
+    }
+    int node_index;
+    TF_LITE_ENSURE_STATUS(subgraph->AddNodeWithParameters(
+        inputs, {chain.back().output}, {}, nullptr, 0, params,
+        &fused_elementwise, &node_index));
+    (*plan)[position] = node_index;
+    for (int i = 1; i < chain_positions.size(); ++i) {
+      removed[chain_positions[i]] = true;
+    }
+    if (stats) {
+      ++stats->num_fused_chains;
+      stats->num_fused_ops += chain.size();
+    }
+  }
+
+  std::vector<int> new_plan;
+  for (int position = 0; position < plan->size(); ++position) {
+    if (!removed[position]) new_plan.push_back((*plan)[position]);
+  }
+  *plan = std::move(new_plan);
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus FuseOps(Subgraph* subgraph,
+                     const TfLiteRegistration* fused_elementwise,
+                     OpFusionStats* stats) {
+  // Nodes are added to the execution plan as they are created, so the
+  // rewritten plan is built separately.
+  std::vector<int> plan = subgraph->execution_plan();
+  TF_LITE_ENSURE_STATUS(FoldActivations(subgraph, &plan, stats));
+  if (fused_elementwise != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        FuseElementwiseChains(subgraph, *fused_elementwise, &plan, stats));
+  }
+  subgraph->execution_plan() = plan;
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,53 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_OP_FUSION_H_
+#define TENSORFLOW_LITE_OP_FUSION_H_
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+
+namespace tflite {
+
+struct OpFusionStats {
+  // Activation ops folded into the fused activation of their producer.
+  int num_folded_activations = 0;
+  // Fused elementwise nodes added, and the number of ops they replace.
+  int num_fused_chains = 0;
+  int num_fused_ops = 0;
+};
+
+// Rewrites the execution plan of `subgraph` so that fewer ops each read and
+// write a whole tensor. It must be called before delegates are applied.
+//
+// - RELU, RELU6 and RELU_N1_TO_1 ops are folded into the fused activation of
+//   the CONV_2D, DEPTHWISE_CONV_2D, FULLY_CONNECTED, ADD, SUB, MUL or DIV op
+//   that produces their input, if that op has no fused activation yet and,
+//   for quantized tensors, the activation doesn't requantize.
+// - If `fused_elementwise` is not null, chains of two or more float
+//   elementwise ops are replaced by one node running `fused_elementwise`,
+//   see kernels/fused_elementwise.h. The ops of a chain are RELU, RELU6,
+//   RELU_N1_TO_1, TANH, LOGISTIC, and ADD, SUB, MUL or DIV with a constant
+//   operand holding either a single value or one value per channel.
+//
+// Only tensors that are read by a single op and aren't outputs of the
+// subgraph are elided. The replaced nodes stay in the subgraph, but are no
+// longer part of the execution plan. `stats` may be null.
+TfLiteStatus FuseOps(Subgraph* subgraph,
+                     const TfLiteRegistration* fused_elementwise,
+                     OpFusionStats* stats);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_OP_FUSION_H_
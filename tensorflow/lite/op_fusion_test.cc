@@ -0,0 +1,482 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/op_fusion.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/interpreter_options.h"
+#include "tensorflow/lite/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/kernels/fused_elementwise.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace {
+
+namespace fused_elementwise = ops::custom::fused_elementwise;
+
+const float kScalar[] = {0.5f};
+const float kPerChannel[] = {1.0f, -2.0f, 0.25f};
+const float kPerChannelDivisor[] = {2.0f, 4.0f, -8.0f};
+
+// Builds float graphs of [2, 3] tensors out of builtin kernels.
+class OpFusionTest : public ::testing::Test {
+ protected:
+  void AddTensors(int num_tensors) {
+    ASSERT_EQ(interpreter_.AddTensors(num_tensors), kTfLiteOk);
+    for (int i = 0; i < num_tensors; ++i) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {2, 3}, TfLiteQuantization()),
+                kTfLiteOk);
+    }
+  }
+
+  // Changes the type, shape or quantization of a tensor added by AddTensors.
+  void SetTensor(int tensor, TfLiteType type, const std::vector<int>& dims,
+                 TfLiteQuantizationParams quantization = {}) {
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(tensor, type, "", dims,
+                                                        quantization),
+              kTfLiteOk);
+  }
+
+  void SetConstant(int tensor, const std::vector<int>& dims,
+                   const float* data, size_t size) {
+    ASSERT_EQ(interpreter_.SetTensorParametersReadOnly(
+                  tensor, kTfLiteFloat32, "", dims, TfLiteQuantization(),
+                  reinterpret_cast<const char*>(data), size * sizeof(float)),
+              kTfLiteOk);
+  }
+
+  void AddNode(int builtin_code, const std::vector<int>& inputs, int output,
+               void* builtin_data = nullptr) {
+    TfLiteRegistration* registration;
+    switch (builtin_code) {
+      case kTfLiteBuiltinConv2d:
+        registration = ops::builtin::Register_CONV_2D();
+        break;
+      case kTfLiteBuiltinFullyConnected:
+        registration = ops::builtin::Register_FULLY_CONNECTED();
+        break;
+      case kTfLiteBuiltinAdd:
+        registration = ops::builtin::Register_ADD();
+        break;
+      case kTfLiteBuiltinSub:
+        registration = ops::builtin::Register_SUB();
+        break;
+      case kTfLiteBuiltinMul:
+        registration = ops::builtin::Register_MUL();
+        break;
+      case kTfLiteBuiltinDiv:
+        registration = ops::builtin::Register_DIV();
+        break;
+      case kTfLiteBuiltinRelu:
+        registration = ops::builtin::Register_RELU();
+        break;
+      case kTfLiteBuiltinRelu6:
+        registration = ops::builtin::Register_RELU6();
+        break;
+      default:
+        registration = ops::builtin::Register_TANH();
+        break;
+    }
+    registration->builtin_code = builtin_code;
+    ASSERT_EQ(interpreter_.AddNodeWithParameters(inputs, {output}, nullptr, 0,
+                                                 builtin_data, registration),
+              kTfLiteOk);
+  }
+
+  // Builtin data of binary ops, owned by the node they are passed to.
+  template <typename Params>
+  static Params* NewParams() {
+    auto* params = static_cast<Params*>(calloc(1, sizeof(Params)));
+    params->activation = kTfLiteActNone;
+    return params;
+  }
+
+  TfLiteStatus FuseOps(bool with_fused_elementwise) {
+    return tflite::FuseOps(
+        interpreter_.subgraph(0),
+        with_fused_elementwise ? ops::custom::Register_FUSED_ELEMENTWISE()
+                               : nullptr,
+        &stats_);
+  }
+
+  // Returns the node at `position` of the execution plan.
+  const std::pair<TfLiteNode, TfLiteRegistration>& PlanNode(int position) {
+    return *interpreter_.node_and_registration(
+        interpreter_.execution_plan()[position]);
+  }
+
+  std::vector<float> Run(const std::vector<float>& input) {
+    EXPECT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+    std::copy(input.begin(), input.end(),
+              interpreter_.typed_input_tensor<float>(0));
+    EXPECT_EQ(interpreter_.Invoke(), kTfLiteOk);
+    const float* output = interpreter_.typed_output_tensor<float>(0);
+    return std::vector<float>(output, output + input.size());
+  }
+
+  Interpreter interpreter_;
+  OpFusionStats stats_;
+};
+
+TEST_F(OpFusionTest, FoldsReluIntoAdd) {
+  AddTensors(4);
+  SetConstant(1, {1}, kScalar, 1);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({3});
+  AddNode(kTfLiteBuiltinAdd, {0, 1}, 2, NewParams<TfLiteAddParams>());
+  AddNode(kTfLiteBuiltinRelu, {2}, 3);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/false), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 1);
+  EXPECT_EQ(stats_.num_fused_chains, 0);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+  const auto* node_and_registration =
+      interpreter_.node_and_registration(interpreter_.execution_plan()[0]);
+  EXPECT_EQ(node_and_registration->second.builtin_code, kTfLiteBuiltinAdd);
+  EXPECT_EQ(reinterpret_cast<TfLiteAddParams*>(
+                node_and_registration->first.builtin_data)
+                ->activation,
+            kTfLiteActRelu);
+
+  EXPECT_EQ(Run({-2.0f, -1.0f, -0.5f, 0.0f, 1.0f, 2.0f}),
+            std::vector<float>({0.0f, 0.0f, 0.0f, 0.5f, 1.5f, 2.5f}));
+}
+
+TEST_F(OpFusionTest, FoldsReluIntoConv2D) {
+  const float filter[] = {-1.0f};
+  AddTensors(5);
+  SetTensor(0, kTfLiteFloat32, {1, 2, 3, 1});
+  SetConstant(1, {1, 1, 1, 1}, filter, 1);
+  SetConstant(2, {1}, kScalar, 1);
+  SetTensor(3, kTfLiteFloat32, {1, 2, 3, 1});
+  SetTensor(4, kTfLiteFloat32, {1, 2, 3, 1});
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({4});
+  auto* conv_params =
+      static_cast<TfLiteConvParams*>(calloc(1, sizeof(TfLiteConvParams)));
+  conv_params->padding = kTfLitePaddingValid;
+  conv_params->stride_width = 1;
+  conv_params->stride_height = 1;
+  conv_params->dilation_width_factor = 1;
+  conv_params->dilation_height_factor = 1;
+  conv_params->activation = kTfLiteActNone;
+  AddNode(kTfLiteBuiltinConv2d, {0, 1, 2}, 3, conv_params);
+  AddNode(kTfLiteBuiltinRelu, {3}, 4);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 1);
+  EXPECT_EQ(stats_.num_fused_chains, 0);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+  EXPECT_EQ(PlanNode(0).second.builtin_code, kTfLiteBuiltinConv2d);
+  EXPECT_EQ(
+      static_cast<TfLiteConvParams*>(PlanNode(0).first.builtin_data)
+          ->activation,
+      kTfLiteActRelu);
+
+  EXPECT_EQ(Run({-2.0f, -1.0f, -0.5f, 0.0f, 1.0f, 2.0f}),
+            std::vector<float>({2.5f, 1.5f, 1.0f, 0.5f, 0.0f, 0.0f}));
+}
+
+TEST_F(OpFusionTest, FoldsRelu6IntoFullyConnected) {
+  // clang-format off
+  const float weights[] = {
+      4.0f, 0.0f, 0.0f,
+      0.0f, 4.0f, 0.0f,
+      0.0f, 0.0f, 4.0f,
+  };
+  // clang-format on
+  AddTensors(4);
+  SetConstant(1, {3, 3}, weights, 9);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({3});
+  AddNode(kTfLiteBuiltinFullyConnected, {0, 1}, 2,
+          NewParams<TfLiteFullyConnectedParams>());
+  AddNode(kTfLiteBuiltinRelu6, {2}, 3);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 1);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+  EXPECT_EQ(PlanNode(0).second.builtin_code, kTfLiteBuiltinFullyConnected);
+  EXPECT_EQ(static_cast<TfLiteFullyConnectedParams*>(
+                PlanNode(0).first.builtin_data)
+                ->activation,
+            kTfLiteActRelu6);
+
+  EXPECT_EQ(Run({-2.0f, -1.0f, -0.5f, 0.0f, 1.0f, 2.0f}),
+            std::vector<float>({0.0f, 0.0f, 0.0f, 0.0f, 4.0f, 6.0f}));
+}
+
+TEST_F(OpFusionTest, FoldsInt8ReluWithSameQuantization) {
+  const TfLiteQuantizationParams quantization = {0.5f, -1};
+  AddTensors(4);
+  for (int i = 0; i < 4; ++i) SetTensor(i, kTfLiteInt8, {2, 3}, quantization);
+  interpreter_.SetInputs({0, 1});
+  interpreter_.SetOutputs({3});
+  AddNode(kTfLiteBuiltinAdd, {0, 1}, 2, NewParams<TfLiteAddParams>());
+  AddNode(kTfLiteBuiltinRelu, {2}, 3);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 1);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+  EXPECT_EQ(
+      static_cast<TfLiteAddParams*>(PlanNode(0).first.builtin_data)
+          ->activation,
+      kTfLiteActRelu);
+}
+
+TEST_F(OpFusionTest, KeepsInt8ReluThatRequantizes) {
+  const TfLiteQuantizationParams quantization = {0.5f, -1};
+  AddTensors(4);
+  for (int i = 0; i < 3; ++i) SetTensor(i, kTfLiteInt8, {2, 3}, quantization);
+  SetTensor(3, kTfLiteInt8, {2, 3}, {0.25f, -1});
+  interpreter_.SetInputs({0, 1});
+  interpreter_.SetOutputs({3});
+  AddNode(kTfLiteBuiltinAdd, {0, 1}, 2, NewParams<TfLiteAddParams>());
+  AddNode(kTfLiteBuiltinRelu, {2}, 3);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 0);
+  EXPECT_EQ(stats_.num_fused_chains, 0);
+  EXPECT_EQ(interpreter_.execution_plan().size(), 2);
+}
+
+TEST_F(OpFusionTest, FusesElementwiseChain) {
+  AddTensors(7);
+  SetConstant(1, {3}, kPerChannel, 3);
+  SetConstant(3, {1}, kScalar, 1);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({6});
+  AddNode(kTfLiteBuiltinMul, {0, 1}, 2, NewParams<TfLiteMulParams>());
+  auto* add_params = NewParams<TfLiteAddParams>();
+  add_params->activation = kTfLiteActRelu;
+  AddNode(kTfLiteBuiltinAdd, {3, 2}, 4, add_params);
+  AddNode(kTfLiteBuiltinTanh, {4}, 5);
+  AddNode(kTfLiteBuiltinRelu, {5}, 6);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 0);
+  EXPECT_EQ(stats_.num_fused_chains, 1);
+  EXPECT_EQ(stats_.num_fused_ops, 4);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+
+  const std::vector<float> input = {-2.0f, -1.0f, -0.5f, 0.0f, 1.0f, 2.0f};
+  const std::vector<float> output = Run(input);
+  for (int i = 0; i < input.size(); ++i) {
+    const float expected = std::max(
+        0.0f, std::tanh(std::max(0.0f, input[i] * kPerChannel[i % 3] +
+                                           kScalar[0])));
+    EXPECT_NEAR(output[i], expected, 1e-6f) << i;
+  }
+}
+
+TEST_F(OpFusionTest, FusesReversedOpsWithPerChannelOperands) {
+  AddTensors(5);
+  SetConstant(1, {3}, kPerChannel, 3);
+  SetConstant(3, {1, 3}, kPerChannelDivisor, 3);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({4});
+  // The constants are the first operands: c - x and then c / x.
+  AddNode(kTfLiteBuiltinSub, {1, 0}, 2, NewParams<TfLiteSubParams>());
+  AddNode(kTfLiteBuiltinDiv, {3, 2}, 4, NewParams<TfLiteDivParams>());
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_fused_chains, 1);
+  EXPECT_EQ(stats_.num_fused_ops, 2);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+  const auto* params = static_cast<const fused_elementwise::Params*>(
+      PlanNode(0).first.builtin_data);
+  ASSERT_EQ(params->num_steps, 2);
+  EXPECT_EQ(params->steps[0].type, fused_elementwise::StepType::kReverseSub);
+  EXPECT_EQ(params->steps[0].input_index, 1);
+  EXPECT_EQ(params->steps[1].type, fused_elementwise::StepType::kReverseDiv);
+  EXPECT_EQ(params->steps[1].input_index, 2);
+
+  const std::vector<float> input = {-2.0f, -1.0f, -0.5f, 0.0f, 1.0f, 2.0f};
+  const std::vector<float> output = Run(input);
+  for (int i = 0; i < input.size(); ++i) {
+    const float expected =
+        kPerChannelDivisor[i % 3] / (kPerChannel[i % 3] - input[i]);
+    EXPECT_NEAR(output[i], expected, 1e-6f) << i;
+  }
+}
+
+TEST_F(OpFusionTest, KeepsTensorsWithSeveralReaders) {
+  AddTensors(5);
+  SetConstant(1, {1}, kScalar, 1);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({3, 4});
+  AddNode(kTfLiteBuiltinAdd, {0, 1}, 2, NewParams<TfLiteAddParams>());
+  AddNode(kTfLiteBuiltinRelu, {2}, 3);
+  AddNode(kTfLiteBuiltinTanh, {2}, 4);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 0);
+  EXPECT_EQ(stats_.num_fused_chains, 0);
+  EXPECT_EQ(interpreter_.execution_plan().size(), 3);
+}
+
+TEST_F(OpFusionTest, KeepsSubgraphOutputs) {
+  AddTensors(4);
+  SetConstant(1, {1}, kScalar, 1);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({3, 2});
+  AddNode(kTfLiteBuiltinAdd, {0, 1}, 2, NewParams<TfLiteAddParams>());
+  AddNode(kTfLiteBuiltinRelu, {2}, 3);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/true), kTfLiteOk);
+  EXPECT_EQ(stats_.num_folded_activations, 0);
+  EXPECT_EQ(stats_.num_fused_chains, 0);
+  EXPECT_EQ(interpreter_.execution_plan().size(), 2);
+}
+
+TEST_F(OpFusionTest, NeedsFusedElementwiseKernelForChains) {
+  AddTensors(4);
+  interpreter_.SetInputs({0});
+  interpreter_.SetOutputs({3});
+  AddNode(kTfLiteBuiltinTanh, {0}, 1);
+  AddNode(kTfLiteBuiltinRelu, {1}, 2);
+  AddNode(kTfLiteBuiltinTanh, {2}, 3);
+
+  ASSERT_EQ(FuseOps(/*with_fused_elementwise=*/false), kTfLiteOk);
+  EXPECT_EQ(stats_.num_fused_chains, 0);
+  EXPECT_EQ(interpreter_.execution_plan().size(), 3);
+}
+
+// Returns a model computing tanh(relu(input + 0.5)) on a [2, 3] input with
+// separate ADD, RELU and TANH ops.
+std::vector<char> BuildAddReluTanhModel() {
+  flatbuffers::FlatBufferBuilder builder;
+  const std::vector<flatbuffers::Offset<OperatorCode>> operator_codes = {
+      CreateOperatorCode(builder, BuiltinOperator_ADD),
+      CreateOperatorCode(builder, BuiltinOperator_RELU),
+      CreateOperatorCode(builder, BuiltinOperator_TANH)};
+  const std::vector<flatbuffers::Offset<Buffer>> buffers = {
+      CreateBuffer(builder, builder.CreateVector({})),
+      CreateBuffer(builder,
+                   builder.CreateVector(
+                       reinterpret_cast<const uint8_t*>(kScalar),
+                       sizeof(kScalar)))};
+
+  const std::vector<int32_t> shape = {2, 3};
+  const std::vector<int32_t> scalar_shape = {1};
+  const std::vector<flatbuffers::Offset<Tensor>> tensors = {
+      CreateTensor(builder, builder.CreateVector(shape), TensorType_FLOAT32),
+      CreateTensor(builder, builder.CreateVector(scalar_shape),
+                   TensorType_FLOAT32, /*buffer=*/1),
+      CreateTensor(builder, builder.CreateVector(shape), TensorType_FLOAT32),
+      CreateTensor(builder, builder.CreateVector(shape), TensorType_FLOAT32),
+      CreateTensor(builder, builder.CreateVector(shape), TensorType_FLOAT32)};
+
+  const std::vector<int32_t> add_inputs = {0, 1};
+  const std::vector<int32_t> add_outputs = {2};
+  const std::vector<int32_t> relu_inputs = {2};
+  const std::vector<int32_t> relu_outputs = {3};
+  const std::vector<int32_t> tanh_inputs = {3};
+  const std::vector<int32_t> tanh_outputs = {4};
+  const std::vector<flatbuffers::Offset<Operator>> operators = {
+      CreateOperator(builder, /*opcode_index=*/0,
+                     builder.CreateVector(add_inputs),
+                     builder.CreateVector(add_outputs),
+                     BuiltinOptions_AddOptions,
+                     CreateAddOptions(builder).Union()),
+      CreateOperator(builder, /*opcode_index=*/1,
+                     builder.CreateVector(relu_inputs),
+                     builder.CreateVector(relu_outputs)),
+      CreateOperator(builder, /*opcode_index=*/2,
+                     builder.CreateVector(tanh_inputs),
+                     builder.CreateVector(tanh_outputs))};
+
+  const std::vector<int32_t> subgraph_inputs = {0};
+  const std::vector<int32_t> subgraph_outputs = {4};
+  const flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors),
+      builder.CreateVector(subgraph_inputs),
+      builder.CreateVector(subgraph_outputs), builder.CreateVector(operators));
+  builder.Finish(CreateModel(
+      builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(operator_codes),
+      builder.CreateVector(&subgraph, 1),
+      builder.CreateString("op fusion test model"),
+      builder.CreateVector(buffers)));
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+std::vector<float> RunModel(Interpreter* interpreter,
+                            const std::vector<float>& input) {
+  EXPECT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  std::copy(input.begin(), input.end(),
+            interpreter->typed_input_tensor<float>(0));
+  EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  return std::vector<float>(output, output + input.size());
+}
+
+TEST(OpFusionBuilderTest, FusesOpsOnlyWhenEnabled) {
+  const std::vector<char> buffer = BuildAddReluTanhModel();
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromBuffer(buffer.data(), buffer.size());
+  ASSERT_NE(model, nullptr);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+
+  std::unique_ptr<Interpreter> unfused;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver)(&unfused), kTfLiteOk);
+  ASSERT_NE(unfused, nullptr);
+  EXPECT_EQ(unfused->execution_plan().size(), 3);
+
+  // RELU is folded into ADD, which then forms a chain with TANH.
+  InterpreterOptions options;
+  options.SetFuseElementwiseOps();
+  std::unique_ptr<Interpreter> fused;
+  ASSERT_EQ(InterpreterBuilder(*model, resolver, &options)(&fused), kTfLiteOk);
+  ASSERT_NE(fused, nullptr);
+  ASSERT_EQ(fused->execution_plan().size(), 1);
+  const TfLiteRegistration& registration =
+      fused->node_and_registration(fused->execution_plan()[0])->second;
+  EXPECT_EQ(registration.builtin_code, kTfLiteBuiltinCustom);
+  ASSERT_NE(registration.custom_name, nullptr);
+  EXPECT_STREQ(registration.custom_name, fused_elementwise::kOpName);
+
+  const std::vector<float> input = {-2.0f, -1.0f, -0.5f, 0.0f, 1.0f, 2.0f};
+  const std::vector<float> expected = RunModel(unfused.get(), input);
+  const std::vector<float> output = RunModel(fused.get(), input);
+  ASSERT_EQ(output.size(), expected.size());
+  for (int i = 0; i < input.size(); ++i) {
+    EXPECT_NEAR(output[i], expected[i], 1e-6f) << i;
+    EXPECT_NEAR(output[i], std::tanh(std::max(0.0f, input[i] + kScalar[0])),
+                1e-6f)
+        << i;
+  }
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,304 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/signature_batcher.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+
+namespace tflite {
+namespace {
+
+// Weight of the latest invocation in the running average of the invocation
+// time of a batch size.
+constexpr double kInvokeTimeDecay = 0.1;
+
+bool IsBatchableType(TfLiteType type) {
+  return type != kTfLiteString && type != kTfLiteResource &&
+         type != kTfLiteVariant;
+}
+
+}  // namespace
+
+std::unique_ptr<SignatureBatcher> SignatureBatcher::Create(
+    std::unique_ptr<Interpreter> interpreter, const char* signature_key,
+    const Options& options) {
+  ErrorReporter* error_reporter = interpreter->error_reporter();
+  if (options.max_batch_size < 1 || options.max_enqueued_requests < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "SignatureBatcher needs a positive max_batch_size and "
+                         "max_enqueued_requests.");
+    return nullptr;
+  }
+  const std::vector<int>& allowed = options.allowed_batch_sizes;
+  if (!allowed.empty() &&
+      (allowed.front() < 1 || allowed.back() != options.max_batch_size ||
+       std::adjacent_find(allowed.begin(), allowed.end(),
+                          std::greater_equal<int>()) != allowed.end())) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "allowed_batch_sizes must be increasing and end with "
+                         "max_batch_size (%d).",
+                         options.max_batch_size);
+    return nullptr;
+  }
+  SignatureRunner* runner = interpreter->GetSignatureRunner(signature_key);
+  if (runner == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Signature '%s' not found.",
+                         signature_key);
+    return nullptr;
+  }
+
+  std::unique_ptr<SignatureBatcher> batcher(
+      new SignatureBatcher(std::move(interpreter), runner, options));
+  for (const char* name : runner->input_names()) {
+    TfLiteTensor* tensor = runner->input_tensor(name);
+    if (!IsBatchableType(tensor->type) || tensor->dims->size < 1) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Input '%s' of signature '%s' can't be batched.",
+                           name, signature_key);
+      return nullptr;
+    }
+    Input input;
+    input.row_shape.assign(tensor->dims->data + 1,
+                           tensor->dims->data + tensor->dims->size);
+    std::vector<int> shape = input.row_shape;
+    shape.insert(shape.begin(), 1);
+    if (runner->ResizeInputTensor(name, shape) != kTfLiteOk) return nullptr;
+    batcher->inputs_.push_back(std::move(input));
+  }
+  if (runner->AllocateTensors() != kTfLiteOk) return nullptr;
+  batcher->current_batch_size_ = 1;
+  for (size_t i = 0; i < batcher->inputs_.size(); ++i) {
+    batcher->inputs_[i].row_bytes =
+        runner->input_tensor(runner->input_names()[i])->bytes;
+  }
+  for (const char* name : runner->output_names()) {
+    const TfLiteTensor* tensor = runner->output_tensor(name);
+    if (!IsBatchableType(tensor->type) || tensor->dims->size < 1 ||
+        tensor->dims->data[0] != 1) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Output '%s' of signature '%s' can't be batched.",
+                           name, signature_key);
+      return nullptr;
+    }
+    batcher->output_row_bytes_.push_back(tensor->bytes);
+  }
+
+  batcher->batch_thread_ =
+      std::thread(&SignatureBatcher::BatchLoop, batcher.get());
+  return batcher;
+}
+
+SignatureBatcher::SignatureBatcher(std::unique_ptr<Interpreter> interpreter,
+                                   SignatureRunner* runner,
+                                   const Options& options)
+    : options_(options),
+      interpreter_(std::move(interpreter)),
+      runner_(runner) {}
+
+SignatureBatcher::~SignatureBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  request_queued_.notify_all();
+  if (batch_thread_.joinable()) batch_thread_.join();
+}
+
+TfLiteStatus SignatureBatcher::Schedule(Request request) {
+  ErrorReporter* error_reporter = interpreter_->error_reporter();
+  if (request.num_rows < 1 || request.num_rows > options_.max_batch_size) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Request of %d rows, expected 1 to %d rows.",
+                         request.num_rows, options_.max_batch_size);
+    return kTfLiteError;
+  }
+  if (request.inputs.size() != inputs_.size() ||
+      request.outputs.size() != output_row_bytes_.size() || !request.done) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Request has %d inputs and %d outputs, expected %d "
+                         "inputs, %d outputs and a callback.",
+                         static_cast<int>(request.inputs.size()),
+                         static_cast<int>(request.outputs.size()),
+                         static_cast<int>(inputs_.size()),
+                         static_cast<int>(output_row_bytes_.size()));
+    return kTfLiteError;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_ ||
+        queue_.size() >= static_cast<size_t>(options_.max_enqueued_requests)) {
+      TF_LITE_REPORT_ERROR(error_reporter, "SignatureBatcher queue is full.");
+      return kTfLiteError;
+    }
+    queued_rows_ += request.num_rows;
+    queue_.push_back({std::move(request), Clock::now()});
+  }
+  request_queued_.notify_one();
+  return kTfLiteOk;
+}
+
+TfLiteStatus SignatureBatcher::Run(int num_rows,
+                                   const std::vector<const void*>& inputs,
+                                   const std::vector<void*>& outputs) {
+  // Shared with the callback, which may still hold it once `get` returned.
+  auto status = std::make_shared<std::promise<TfLiteStatus>>();
+  std::future<TfLiteStatus> result = status->get_future();
+  Request request;
+  request.num_rows = num_rows;
+  request.inputs = inputs;
+  request.outputs = outputs;
+  request.done = [status](TfLiteStatus s) { status->set_value(s); };
+  TF_LITE_ENSURE_STATUS(Schedule(std::move(request)));
+  return result.get();
+}
+
+SignatureBatcher::Stats SignatureBatcher::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void SignatureBatcher::BatchLoop() {
+  std::vector<QueuedRequest> batch;
+  while (true) {
+    int num_rows = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      request_queued_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      // Queued requests are still run once stopped.
+      if (queue_.empty()) return;
+      request_queued_.wait_until(
+          lock, queue_.front().enqueue_time + BatchTimeout(), [this] {
+            return stop_ || queued_rows_ >= options_.max_batch_size;
+          });
+      while (!queue_.empty() && num_rows + queue_.front().request.num_rows <=
+                                    options_.max_batch_size) {
+        num_rows += queue_.front().request.num_rows;
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      queued_rows_ -= num_rows;
+    }
+    ProcessBatch(&batch, num_rows);
+    batch.clear();
+  }
+}
+
+SignatureBatcher::Clock::duration SignatureBatcher::BatchTimeout() const {
+  const std::chrono::microseconds timeout(options_.batch_timeout_micros);
+  if (options_.max_latency_micros <= 0 || invoke_micros_.empty()) {
+    return timeout;
+  }
+  // Leave enough time to run the largest batch seen so far once the oldest
+  // request stopped waiting.
+  const double slack =
+      options_.max_latency_micros - invoke_micros_.rbegin()->second;
+  return std::min<Clock::duration>(
+      timeout, std::chrono::microseconds(
+                   std::max<int64_t>(0, static_cast<int64_t>(slack))));
+}
+
+int SignatureBatcher::PaddedBatchSize(int num_rows) const {
+  for (int batch_size : options_.allowed_batch_sizes) {
+    if (batch_size >= num_rows) return batch_size;
+  }
+  return num_rows;
+}
+
+TfLiteStatus SignatureBatcher::ResizeBatch(int batch_size) {
+  if (batch_size == current_batch_size_) return kTfLiteOk;
+  // Forget the current size first, so that a failure is retried next time.
+  current_batch_size_ = 0;
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    std::vector<int> shape = inputs_[i].row_shape;
+    shape.insert(shape.begin(), batch_size);
+    TF_LITE_ENSURE_STATUS(
+        runner_->ResizeInputTensor(runner_->input_names()[i], shape));
+  }
+  TF_LITE_ENSURE_STATUS(runner_->AllocateTensors());
+  current_batch_size_ = batch_size;
+  return kTfLiteOk;
+}
+
+TfLiteStatus SignatureBatcher::InvokeBatch(
+    const std::vector<QueuedRequest>& batch, int num_rows, int batch_size) {
+  TF_LITE_ENSURE_STATUS(ResizeBatch(batch_size));
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    const size_t row_bytes = inputs_[i].row_bytes;
+    char* data = runner_->input_tensor(runner_->input_names()[i])->data.raw;
+    for (const QueuedRequest& queued : batch) {
+      const size_t bytes = queued.request.num_rows * row_bytes;
+      std::memcpy(data, queued.request.inputs[i], bytes);
+      data += bytes;
+    }
+    std::memset(data, 0, (batch_size - num_rows) * row_bytes);
+  }
+
+  const Clock::time_point start = Clock::now();
+  TF_LITE_ENSURE_STATUS(runner_->Invoke());
+  const double micros =
+      std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  auto it = invoke_micros_.find(batch_size);
+  if (it == invoke_micros_.end()) {
+    invoke_micros_.emplace(batch_size, micros);
+  } else {
+    it->second += kInvokeTimeDecay * (micros - it->second);
+  }
+
+  for (size_t i = 0; i < output_row_bytes_.size(); ++i) {
+    const TfLiteTensor* tensor =
+        runner_->output_tensor(runner_->output_names()[i]);
+    const size_t row_bytes = output_row_bytes_[i];
+    if (tensor->dims->size < 1 || tensor->dims->data[0] != batch_size ||
+        tensor->bytes != batch_size * row_bytes) {
+      TF_LITE_REPORT_ERROR(interpreter_->error_reporter(),
+                           "Output '%s' is not batch-major.",
+                           runner_->output_names()[i]);
+      return kTfLiteError;
+    }
+    const char* data = tensor->data.raw_const;
+    for (const QueuedRequest& queued : batch) {
+      const size_t bytes = queued.request.num_rows * row_bytes;
+      std::memcpy(queued.request.outputs[i], data, bytes);
+      data += bytes;
+    }
+  }
+  return kTfLiteOk;
+}
+
+void SignatureBatcher::ProcessBatch(std::vector<QueuedRequest>* batch,
+                                    int num_rows) {
+  const int batch_size = PaddedBatchSize(num_rows);
+  const TfLiteStatus status = InvokeBatch(*batch, num_rows, batch_size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.num_batches;
+    stats_.num_rows += num_rows;
+    stats_.num_padding_rows += batch_size - num_rows;
+  }
+  for (QueuedRequest& queued : *batch) {
+    queued.request.done(status);
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,199 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SIGNATURE_BATCHER_H_
+#define TENSORFLOW_LITE_SIGNATURE_BATCHER_H_
+
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+
+/// WARNING: Experimental interface, subject to change
+///
+/// Combines concurrent requests to one signature of a model into batches.
+///
+/// Requests are queued, and a background thread concatenates the requests of
+/// a batch along the first (batch) dimension of every signature input, invokes
+/// the signature once, and splits every output back along its first
+/// dimension. A batch is closed once it holds `max_batch_size` rows, or
+/// `batch_timeout_micros` after its oldest request was queued, whichever comes
+/// first. Batches can be padded to a few allowed sizes, so that the signature
+/// is only resized to a handful of shapes (see also
+/// `InterpreterOptions::SetMemoryPlanCacheSize`).
+///
+/// Usage:
+///
+/// <pre><code>
+/// tflite::SignatureBatcher::Options options;
+/// options.max_batch_size = 16;
+/// options.allowed_batch_sizes = {4, 8, 16};
+/// auto batcher = tflite::SignatureBatcher::Create(
+///     std::move(interpreter), "serving_default", options);
+/// // On any thread, for a request of `n` rows:
+/// tflite::SignatureBatcher::Request request;
+/// request.num_rows = n;
+/// request.inputs = {input_rows};
+/// request.outputs = {output_rows};
+/// request.done = [](TfLiteStatus status) { ... };
+/// batcher->Schedule(std::move(request));
+/// </code></pre>
+///
+/// The signature's inputs and outputs must all be batch-major, i.e. hold one
+/// row per request row along their first dimension, and have a fixed shape
+/// otherwise. String tensors are not supported.
+class SignatureBatcher {
+ public:
+  struct Options {
+    /// Maximum number of rows in a batch, and in a single request.
+    int max_batch_size = 32;
+    /// Maximum time a batch waits for more requests once it holds one.
+    int64_t batch_timeout_micros = 1000;
+    /// If not empty, every batch is padded with zero rows up to the smallest
+    /// of these sizes that fits it. Must be increasing and end with
+    /// `max_batch_size`.
+    std::vector<int> allowed_batch_sizes;
+    /// If positive, a batch is closed early enough for its oldest request to
+    /// be answered within this time, based on the measured latency of the
+    /// largest batches run so far. This trades batch size for latency when
+    /// the load is light.
+    int64_t max_latency_micros = 0;
+    /// Maximum number of queued requests. Schedule() fails beyond that.
+    int max_enqueued_requests = 1024;
+  };
+
+  /// A request of `num_rows` rows. `inputs[i]` holds the rows of the i-th
+  /// signature input, laid out like the input tensor without its first
+  /// dimension, i.e. `num_rows * input_row_bytes(i)` bytes. `outputs[i]`
+  /// receives the `num_rows * output_row_bytes(i)` bytes of the i-th output.
+  /// The buffers must stay valid until `done` has been called with the status
+  /// of the invocation.
+  struct Request {
+    int num_rows = 1;
+    std::vector<const void*> inputs;
+    std::vector<void*> outputs;
+    std::function<void(TfLiteStatus)> done;
+  };
+
+  struct Stats {
+    int64_t num_batches = 0;
+    int64_t num_rows = 0;
+    int64_t num_padding_rows = 0;
+  };
+
+  /// Takes ownership of `interpreter` and serves the signature `signature_key`
+  /// from it. Returns nullptr on failure, after reporting the error to the
+  /// interpreter's error reporter.
+  static std::unique_ptr<SignatureBatcher> Create(
+      std::unique_ptr<Interpreter> interpreter, const char* signature_key,
+      const Options& options);
+
+  /// Runs all queued requests before returning.
+  ~SignatureBatcher();
+
+  SignatureBatcher(const SignatureBatcher&) = delete;
+  SignatureBatcher& operator=(const SignatureBatcher&) = delete;
+
+  /// Names of the signature inputs and outputs, in the order of
+  /// `Request::inputs` and `Request::outputs`.
+  const std::vector<const char*>& input_names() const {
+    return runner_->input_names();
+  }
+  const std::vector<const char*>& output_names() const {
+    return runner_->output_names();
+  }
+
+  /// Size in bytes of one row of the i-th input or output.
+  size_t input_row_bytes(int i) const { return inputs_[i].row_bytes; }
+  size_t output_row_bytes(int i) const { return output_row_bytes_[i]; }
+
+  /// Queues `request`. Returns an error, without calling `request.done`, if
+  /// the request is malformed or the queue is full.
+  TfLiteStatus Schedule(Request request);
+
+  /// Queues a request and blocks until it has been run.
+  TfLiteStatus Run(int num_rows, const std::vector<const void*>& inputs,
+                   const std::vector<void*>& outputs);
+
+  Stats GetStats();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Tensors are looked up by name on every batch, since resizing the inputs
+  // may reallocate the interpreter's tensors.
+  struct Input {
+    // Shape without the batch dimension.
+    std::vector<int> row_shape;
+    size_t row_bytes;
+  };
+
+  struct QueuedRequest {
+    Request request;
+    Clock::time_point enqueue_time;
+  };
+
+  SignatureBatcher(std::unique_ptr<Interpreter> interpreter,
+                   SignatureRunner* runner, const Options& options);
+
+  // Body of the batching thread.
+  void BatchLoop();
+  // Time the oldest queued request may wait for its batch to fill up.
+  Clock::duration BatchTimeout() const;
+  // Smallest allowed batch size holding `num_rows` rows.
+  int PaddedBatchSize(int num_rows) const;
+  // Resizes the signature inputs to `batch_size` rows if necessary.
+  TfLiteStatus ResizeBatch(int batch_size);
+  // Runs `batch`, which holds `num_rows` rows, and completes its requests.
+  void ProcessBatch(std::vector<QueuedRequest>* batch, int num_rows);
+  TfLiteStatus InvokeBatch(const std::vector<QueuedRequest>& batch,
+                           int num_rows, int batch_size);
+
+  const Options options_;
+  std::unique_ptr<Interpreter> interpreter_;
+  // Owned by `interpreter_`, only used by the batching thread after Create.
+  SignatureRunner* runner_;
+  std::vector<Input> inputs_;
+  std::vector<size_t> output_row_bytes_;
+  int current_batch_size_ = 0;
+  // Average invocation time in microseconds per batch size. Only used by the
+  // batching thread.
+  std::map<int, double> invoke_micros_;
+
+  std::mutex mutex_;
+  std::condition_variable request_queued_;
+  // The following are guarded by `mutex_`.
+  std::deque<QueuedRequest> queue_;
+  int queued_rows_ = 0;
+  bool stop_ = false;
+  Stats stats_;
+
+  std::thread batch_thread_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SIGNATURE_BATCHER_H_
@@ -0,0 +1,176 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/signature_batcher.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace {
+
+// The "add" signature of multi_signatures.bin computes `output_0 = x + 2` on
+// a 1-D float tensor, i.e. rows of a single float.
+constexpr char kModelPath[] = "tensorflow/lite/testdata/multi_signatures.bin";
+
+class SignatureBatcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(kModelPath);
+    ASSERT_TRUE(model_);
+  }
+
+  std::unique_ptr<SignatureBatcher> CreateBatcher(
+      const SignatureBatcher::Options& options) {
+    ops::builtin::BuiltinOpResolver resolver;
+    std::unique_ptr<Interpreter> interpreter;
+    if (InterpreterBuilder(*model_, resolver)(&interpreter) != kTfLiteOk) {
+      return nullptr;
+    }
+    return SignatureBatcher::Create(std::move(interpreter), "add", options);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+};
+
+TEST_F(SignatureBatcherTest, RunsSingleRequest) {
+  auto batcher = CreateBatcher(SignatureBatcher::Options());
+  ASSERT_TRUE(batcher);
+  ASSERT_EQ(batcher->input_names().size(), 1);
+  ASSERT_EQ(batcher->output_names().size(), 1);
+  EXPECT_EQ(batcher->input_row_bytes(0), sizeof(float));
+  EXPECT_EQ(batcher->output_row_bytes(0), sizeof(float));
+
+  const float input[3] = {1, 2, 3};
+  float output[3] = {};
+  ASSERT_EQ(batcher->Run(3, {input}, {output}), kTfLiteOk);
+  EXPECT_EQ(output[0], 3);
+  EXPECT_EQ(output[1], 4);
+  EXPECT_EQ(output[2], 5);
+}
+
+TEST_F(SignatureBatcherTest, BatchesConcurrentRequests) {
+  SignatureBatcher::Options options;
+  options.max_batch_size = 8;
+  options.batch_timeout_micros = 100000;
+  auto batcher = CreateBatcher(options);
+  ASSERT_TRUE(batcher);
+
+  constexpr int kNumThreads = 4;
+  constexpr int kNumRequests = 16;
+  std::vector<std::thread> threads;
+  std::atomic<int> num_failures(0);
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kNumRequests; ++i) {
+        const float input[2] = {static_cast<float>(t), static_cast<float>(i)};
+        float output[2] = {};
+        if (batcher->Run(2, {input}, {output}) != kTfLiteOk ||
+            output[0] != t + 2 || output[1] != i + 2) {
+          ++num_failures;
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(num_failures, 0);
+
+  const SignatureBatcher::Stats stats = batcher->GetStats();
+  EXPECT_EQ(stats.num_rows, 2 * kNumThreads * kNumRequests);
+  EXPECT_EQ(stats.num_padding_rows, 0);
+  // Every batch but the last few holds a request of every thread.
+  EXPECT_LT(stats.num_batches, kNumThreads * kNumRequests);
+}
+
+TEST_F(SignatureBatcherTest, PadsToAllowedBatchSizes) {
+  SignatureBatcher::Options options;
+  options.max_batch_size = 8;
+  options.allowed_batch_sizes = {4, 8};
+  options.batch_timeout_micros = 0;
+  auto batcher = CreateBatcher(options);
+  ASSERT_TRUE(batcher);
+
+  const float input[5] = {1, 2, 3, 4, 5};
+  float output[5] = {};
+  ASSERT_EQ(batcher->Run(1, {input}, {output}), kTfLiteOk);
+  ASSERT_EQ(batcher->Run(5, {input}, {output}), kTfLiteOk);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(output[i], input[i] + 2);
+  }
+
+  const SignatureBatcher::Stats stats = batcher->GetStats();
+  EXPECT_EQ(stats.num_batches, 2);
+  EXPECT_EQ(stats.num_rows, 6);
+  EXPECT_EQ(stats.num_padding_rows, 3 + 3);
+}
+
+TEST_F(SignatureBatcherTest, RunsQueuedRequestsOnDestruction) {
+  SignatureBatcher::Options options;
+  options.batch_timeout_micros = 10000000;
+  auto batcher = CreateBatcher(options);
+  ASSERT_TRUE(batcher);
+
+  const float input = 1;
+  float output = 0;
+  TfLiteStatus status = kTfLiteError;
+  SignatureBatcher::Request request;
+  request.inputs = {&input};
+  request.outputs = {&output};
+  request.done = [&status](TfLiteStatus s) { status = s; };
+  ASSERT_EQ(batcher->Schedule(std::move(request)), kTfLiteOk);
+  batcher.reset();
+  EXPECT_EQ(status, kTfLiteOk);
+  EXPECT_EQ(output, 3);
+}
+
+TEST_F(SignatureBatcherTest, RejectsInvalidRequests) {
+  SignatureBatcher::Options options;
+  options.max_batch_size = 4;
+  auto batcher = CreateBatcher(options);
+  ASSERT_TRUE(batcher);
+
+  const float input[5] = {};
+  float output[5] = {};
+  EXPECT_EQ(batcher->Run(5, {input}, {output}), kTfLiteError);
+  EXPECT_EQ(batcher->Run(0, {input}, {output}), kTfLiteError);
+  EXPECT_EQ(batcher->Run(1, {input, input}, {output}), kTfLiteError);
+  EXPECT_EQ(batcher->GetStats().num_batches, 0);
+}
+
+TEST_F(SignatureBatcherTest, RejectsInvalidOptions) {
+  SignatureBatcher::Options options;
+  options.max_batch_size = 8;
+  options.allowed_batch_sizes = {4, 6};
+  EXPECT_FALSE(CreateBatcher(options));
+  options.allowed_batch_sizes = {4, 4, 8};
+  EXPECT_FALSE(CreateBatcher(options));
+
+  ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model_, resolver)(&interpreter), kTfLiteOk);
+  EXPECT_FALSE(SignatureBatcher::Create(std::move(interpreter), "missing",
+                                        SignatureBatcher::Options()));
+}
+
+}  // namespace
+}  // namespace tflite
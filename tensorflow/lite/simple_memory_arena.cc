@@ -160,6 +160,13 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::RestorePlan(const Plan& plan) {
+  committed_ = false;
+  high_water_mark_ = plan.high_water_mark;
+  ordered_allocs_ = plan.ordered_allocs;
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
   underlying_buffer_size_ = 0;
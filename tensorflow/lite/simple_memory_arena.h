@@ -102,6 +102,21 @@ class SimpleMemoryArena {
   // again until Commit() is called & tensor allocations are resolved.
   TfLiteStatus ReleaseBuffer();
 
+  // A snapshot of the allocation plan, i.e. the scheduled allocations and the
+  // resulting high water mark, without the underlying buffer.
+  struct Plan {
+    size_t high_water_mark = 0;
+    std::vector<ArenaAllocWithUsageInterval> ordered_allocs;
+  };
+
+  // Returns a copy of the current allocation plan.
+  Plan SavePlan() const { return Plan{high_water_mark_, ordered_allocs_}; }
+
+  // Replaces the current allocation plan with one previously returned by
+  // SavePlan(). Like ClearPlan(), the arena must be committed & allocations
+  // resolved again before it is used.
+  TfLiteStatus RestorePlan(const Plan& plan);
+
   size_t GetBufferSize() { return underlying_buffer_size_; }
 
   std::intptr_t BasePointer() const {
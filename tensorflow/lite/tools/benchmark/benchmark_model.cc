@@ -15,9 +15,16 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 
+#include <fstream>
 #include <iostream>
+#include <mutex>  // NOLINT
+#include <random>
 #include <sstream>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "absl/types/optional.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
@@ -28,6 +35,8 @@ namespace benchmark {
 using tensorflow::Stat;
 
 constexpr int kMemoryCheckIntervalMs = 50;
+// Seed of the load test arrivals, fixed so that runs are comparable.
+constexpr int kLoadTestSeed = 2022;
 
 BenchmarkParams BenchmarkModel::DefaultParams() {
   BenchmarkParams params;
@@ -48,6 +57,11 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
                   BenchmarkParam::Create<bool>(false));
   params.AddParam("memory_footprint_check_interval_ms",
                   BenchmarkParam::Create<int32_t>(kMemoryCheckIntervalMs));
+  params.AddParam("load_test_requesters", BenchmarkParam::Create<int32_t>(0));
+  params.AddParam("load_test_qps", BenchmarkParam::Create<float>(-1.0f));
+  params.AddParam("load_test_secs", BenchmarkParam::Create<float>(10.0f));
+  params.AddParam("latency_report_file",
+                  BenchmarkParam::Create<std::string>(""));
   return params;
 }
 
@@ -64,6 +78,24 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                    << "First inference: " << warmup_us.first() << ", "
                    << "Warmup (avg): " << warmup_us.avg() << ", "
                    << "Inference (avg): " << inference_us.avg();
+  if (!results.inference_latency_us().empty()) {
+    TFLITE_LOG(INFO) << "Inference latency distribution in us: "
+                     << results.inference_latency_us().ToString();
+  }
+
+  const LoadTestResults& load_test = results.load_test();
+  if (load_test.num_requesters > 0) {
+    TFLITE_LOG(INFO) << "Load test with " << load_test.num_requesters
+                     << " requesters over " << load_test.duration_secs
+                     << " seconds: " << load_test.num_completed << " of "
+                     << load_test.num_arrived << " requests completed ("
+                     << load_test.num_failed << " failed), "
+                     << load_test.achieved_qps() << " QPS achieved.";
+    TFLITE_LOG(INFO) << "Load test request latency in us: "
+                     << load_test.latency_us.ToString();
+    TFLITE_LOG(INFO) << "Load test service time in us: "
+                     << load_test.service_us.ToString();
+  }
 
   if (!init_mem_usage.IsSupported()) return;
   TFLITE_LOG(INFO)
@@ -82,6 +114,58 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   }
 }
 
+void LatencyReportListener::OnBenchmarkStart(const BenchmarkParams& params) {
+  benchmark_name_ = params.Get<std::string>("benchmark_name");
+  if (params.HasParam("graph")) graph_ = params.Get<std::string>("graph");
+}
+
+void LatencyReportListener::OnBenchmarkEnd(const BenchmarkResults& results) {
+  std::ofstream stream(file_path_);
+  if (!stream.good()) {
+    TFLITE_LOG(ERROR) << "Failed to open the latency report " << file_path_;
+    return;
+  }
+  stream << "{\n  \"benchmark_name\": ";
+  WriteJsonString(benchmark_name_, &stream);
+  stream << ",\n  \"graph\": ";
+  WriteJsonString(graph_, &stream);
+  stream << ",\n  \"init_us\": " << results.startup_latency_us();
+  stream << ",\n  \"inference_us\": ";
+  results.inference_latency_us().WriteJson(&stream);
+
+  const LoadTestResults& load_test = results.load_test();
+  if (load_test.num_requesters > 0) {
+    stream << ",\n  \"load_test\": {\"requesters\": "
+           << load_test.num_requesters
+           << ", \"target_qps\": " << load_test.target_qps
+           << ", \"duration_secs\": " << load_test.duration_secs
+           << ", \"arrived\": " << load_test.num_arrived
+           << ", \"completed\": " << load_test.num_completed
+           << ", \"failed\": " << load_test.num_failed
+           << ", \"achieved_qps\": " << load_test.achieved_qps()
+           << ",\n    \"latency_us\": ";
+    load_test.latency_us.WriteJson(&stream);
+    stream << ",\n    \"service_us\": ";
+    load_test.service_us.WriteJson(&stream);
+    stream << "}";
+  }
+
+  if (op_latency_us_ != nullptr && !op_latency_us_->empty()) {
+    stream << ",\n  \"ops\": {";
+    const char* separator = "\n    ";
+    for (const auto& op : *op_latency_us_) {
+      stream << separator;
+      WriteJsonString(op.first, &stream);
+      stream << ": ";
+      op.second.WriteJson(&stream);
+      separator = ",\n    ";
+    }
+    stream << "}";
+  }
+  stream << "\n}\n";
+  TFLITE_LOG(INFO) << "Wrote the latency report to " << file_path_;
+}
+
 std::vector<Flag> BenchmarkModel::GetFlags() {
   return {
       CreateFlag<int32_t>(
@@ -139,7 +223,25 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
       CreateFlag<int32_t>("memory_footprint_check_interval_ms", &params_,
                           "The interval in millisecond between two consecutive "
                           "memory footprint checks. This is only used when "
-                          "--report_peak_memory_footprint is set to true.")};
+                          "--report_peak_memory_footprint is set to true."),
+      CreateFlag<int32_t>(
+          "load_test_requesters", &params_,
+          "If positive, after the regular runs, run the model from this many "
+          "concurrent requesters for --load_test_secs seconds and report the "
+          "request latency distribution."),
+      CreateFlag<float>(
+          "load_test_qps", &params_,
+          "Rate of the load test requests per second. Requests arrive at "
+          "random (Poisson) times whether or not earlier ones completed, and "
+          "their latency includes the time spent waiting for a requester. If "
+          "not positive, every requester sends requests back to back."),
+      CreateFlag<float>("load_test_secs", &params_,
+                        "Duration of the load test in seconds."),
+      CreateFlag<std::string>(
+          "latency_report_file", &params_,
+          "If set, write the latency distributions (and per-op ones when op "
+          "profiling is enabled) as JSON to this file. Reports can be "
+          "compared with latency_regression.py.")};
 }
 
 void BenchmarkModel::LogParams() {
@@ -166,6 +268,13 @@ void BenchmarkModel::LogParams() {
                       "Report the peak memory footprint", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "memory_footprint_check_interval_ms",
                       "Memory footprint check interval (ms)", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "load_test_requesters", "Load test requesters",
+                      verbose);
+  LOG_BENCHMARK_PARAM(float, "load_test_qps", "Load test QPS", verbose);
+  LOG_BENCHMARK_PARAM(float, "load_test_secs", "Load test duration (seconds)",
+                      verbose);
+  LOG_BENCHMARK_PARAM(std::string, "latency_report_file",
+                      "Latency report file", verbose);
 }
 
 TfLiteStatus BenchmarkModel::PrepareInputData() { return kTfLiteOk; }
@@ -174,7 +283,8 @@ TfLiteStatus BenchmarkModel::ResetInputsAndOutputs() { return kTfLiteOk; }
 
 Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
                                   float max_secs, RunType run_type,
-                                  TfLiteStatus* invoke_status) {
+                                  TfLiteStatus* invoke_status,
+                                  LatencyDistribution* latency_us) {
   Stat<int64_t> run_stats;
   TFLITE_LOG(INFO) << "Running benchmark for at least " << min_num_times
                    << " iterations and at least " << min_secs << " seconds but"
@@ -200,6 +310,7 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
     listeners_.OnSingleRunEnd();
 
     run_stats.UpdateStat(end_us - start_us);
+    if (latency_us != nullptr) latency_us->Record(end_us - start_us);
     if (run_frequency > 0) {
       inter_run_sleep_time =
           next_run_finish_time - profiling::time::NowMicros() * 1e-6;
@@ -222,7 +333,103 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
   return run_stats;
 }
 
+TfLiteStatus BenchmarkModel::PrepareRequesters(int num_requesters) {
+  TFLITE_LOG(ERROR) << "Load tests are not supported by this benchmark.";
+  return kTfLiteError;
+}
+
+TfLiteStatus BenchmarkModel::RunRequest(int requester) { return kTfLiteError; }
+
+TfLiteStatus BenchmarkModel::RunLoadTest(LoadTestResults* results) {
+  const int num_requesters = params_.Get<int32_t>("load_test_requesters");
+  const float target_qps = params_.Get<float>("load_test_qps");
+  const bool open_loop = target_qps > 0;
+  TF_LITE_ENSURE_STATUS(PrepareRequesters(num_requesters));
+  TFLITE_LOG(INFO) << "Running load test with " << num_requesters
+                   << " requesters for "
+                   << params_.Get<float>("load_test_secs") << " seconds.";
+
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t end_us =
+      start_us +
+      static_cast<int64_t>(params_.Get<float>("load_test_secs") * 1.e6f);
+  std::mutex mutex;
+  // Open-loop arrivals form a Poisson process. Guarded by `mutex`.
+  std::mt19937 random_engine(kLoadTestSeed);
+  // Only built in open-loop mode, since its rate must be positive.
+  absl::optional<std::exponential_distribution<double>> inter_arrival_us;
+  if (open_loop) inter_arrival_us.emplace(target_qps / 1.e6);
+  double next_arrival_us = start_us;
+  int64_t num_arrived = 0;
+
+  std::vector<LoadTestResults> requester_results(num_requesters);
+  auto requester_loop = [&](int requester) {
+    LoadTestResults& result = requester_results[requester];
+    while (true) {
+      int64_t arrival_us;
+      if (open_loop) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Requests that arrived during the load test but had not started by
+        // its end are counted as arrived but not completed.
+        if (next_arrival_us >= end_us ||
+            profiling::time::NowMicros() >= end_us) {
+          break;
+        }
+        arrival_us = static_cast<int64_t>(next_arrival_us);
+        next_arrival_us += (*inter_arrival_us)(random_engine);
+        ++num_arrived;
+      } else {
+        arrival_us = profiling::time::NowMicros();
+        if (arrival_us >= end_us) break;
+      }
+      const int64_t now_us = profiling::time::NowMicros();
+      util::SleepForSeconds((arrival_us - now_us) * 1.e-6);
+      const int64_t begin_us = profiling::time::NowMicros();
+      const TfLiteStatus status = RunRequest(requester);
+      const int64_t done_us = profiling::time::NowMicros();
+      if (status != kTfLiteOk) {
+        ++result.num_failed;
+        continue;
+      }
+      ++result.num_completed;
+      result.latency_us.Record(done_us - arrival_us);
+      result.service_us.Record(done_us - begin_us);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_requesters; ++i) {
+    threads.emplace_back(requester_loop, i);
+  }
+  requester_loop(0);
+  for (std::thread& thread : threads) thread.join();
+
+  results->num_requesters = num_requesters;
+  results->target_qps = target_qps;
+  results->duration_secs = (profiling::time::NowMicros() - start_us) * 1.e-6f;
+  for (const LoadTestResults& result : requester_results) {
+    results->num_completed += result.num_completed;
+    results->num_failed += result.num_failed;
+    results->latency_us.Merge(result.latency_us);
+    results->service_us.Merge(result.service_us);
+  }
+  if (open_loop) {
+    for (; next_arrival_us < end_us;
+         next_arrival_us += (*inter_arrival_us)(random_engine)) {
+      ++num_arrived;
+    }
+    results->num_arrived = num_arrived;
+  } else {
+    results->num_arrived = results->num_completed + results->num_failed;
+  }
+  return results->num_failed == 0 ? kTfLiteOk : kTfLiteError;
+}
+
 TfLiteStatus BenchmarkModel::ValidateParams() {
+  if (params_.Get<int32_t>("load_test_requesters") > 0 &&
+      params_.Get<float>("load_test_secs") <= 0) {
+    TFLITE_LOG(ERROR) << "--load_test_secs must be positive for a load test.";
+    return kTfLiteError;
+  }
   if (params_.Get<bool>("report_peak_memory_footprint")) {
     const int32_t interval =
         params_.Get<int32_t>("memory_footprint_check_interval_ms");
@@ -277,20 +484,27 @@ TfLiteStatus BenchmarkModel::Run() {
     params_.Set("warmup_min_secs", -1.0f);
     params_.Set("num_runs", 0);
     params_.Set("min_secs", -1.0f);
+    params_.Set("load_test_requesters", 0);
   }
 
   listeners_.OnBenchmarkStart(params_);
   Stat<int64_t> warmup_time_us =
       Run(params_.Get<int32_t>("warmup_runs"),
           params_.Get<float>("warmup_min_secs"), params_.Get<float>("max_secs"),
-          WARMUP, &status);
+          WARMUP, &status, /*latency_us=*/nullptr);
   if (status != kTfLiteOk) {
     return status;
   }
 
+  LatencyDistribution inference_latency_us;
   Stat<int64_t> inference_time_us =
       Run(params_.Get<int32_t>("num_runs"), params_.Get<float>("min_secs"),
-          params_.Get<float>("max_secs"), REGULAR, &status);
+          params_.Get<float>("max_secs"), REGULAR, &status,
+          &inference_latency_us);
+  LoadTestResults load_test;
+  if (status == kTfLiteOk && params_.Get<int32_t>("load_test_requesters") > 0) {
+    status = RunLoadTest(&load_test);
+  }
   const auto overall_mem_usage =
       profiling::memory::GetMemoryUsage() - start_mem_usage;
 
@@ -302,7 +516,9 @@ TfLiteStatus BenchmarkModel::Run() {
 
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
-                             overall_mem_usage, peak_mem_mb});
+                             overall_mem_usage, peak_mem_mb,
+                             std::move(inference_latency_us),
+                             std::move(load_test)});
   return status;
 }
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include <ostream>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/memory_usage_monitor.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/latency_distribution.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 
 namespace tflite {
@@ -39,6 +41,27 @@ enum RunType {
   REGULAR,
 };
 
+// Results of the load test, see --load_test_requesters.
+struct LoadTestResults {
+  int num_requesters = 0;
+  // Rate of the open-loop request arrivals, or <= 0 if every requester sent
+  // its requests back to back.
+  float target_qps = -1.0f;
+  float duration_secs = 0.0f;
+  int64_t num_arrived = 0;
+  int64_t num_completed = 0;
+  int64_t num_failed = 0;
+  // Time from the arrival of a request to its completion, including the time
+  // it waited for a free requester.
+  LatencyDistribution latency_us;
+  // Time spent running each request.
+  LatencyDistribution service_us;
+
+  double achieved_qps() const {
+    return duration_secs > 0 ? num_completed / duration_secs : 0.0;
+  }
+};
+
 class BenchmarkResults {
  public:
   BenchmarkResults() {}
@@ -48,7 +71,9 @@ class BenchmarkResults {
                    tensorflow::Stat<int64_t> inference_time_us,
                    const profiling::memory::MemoryUsage& init_mem_usage,
                    const profiling::memory::MemoryUsage& overall_mem_usage,
-                   float peak_mem_mb)
+                   float peak_mem_mb,
+                   LatencyDistribution inference_latency_us = {},
+                   LoadTestResults load_test = {})
       : model_size_mb_(model_size_mb),
         startup_latency_us_(startup_latency_us),
         input_bytes_(input_bytes),
@@ -56,7 +81,9 @@ class BenchmarkResults {
         inference_time_us_(inference_time_us),
         init_mem_usage_(init_mem_usage),
         overall_mem_usage_(overall_mem_usage),
-        peak_mem_mb_(peak_mem_mb) {}
+        peak_mem_mb_(peak_mem_mb),
+        inference_latency_us_(std::move(inference_latency_us)),
+        load_test_(std::move(load_test)) {}
 
   const double model_size_mb() const { return model_size_mb_; }
   tensorflow::Stat<int64_t> inference_time_us() const {
@@ -78,6 +105,11 @@ class BenchmarkResults {
     return overall_mem_usage_;
   }
   float peak_mem_mb() const { return peak_mem_mb_; }
+  // All the regular inference times, for their percentiles.
+  const LatencyDistribution& inference_latency_us() const {
+    return inference_latency_us_;
+  }
+  const LoadTestResults& load_test() const { return load_test_; }
 
  private:
   double model_size_mb_ = 0.0;
@@ -92,6 +124,8 @@ class BenchmarkResults {
   // platform.
   float peak_mem_mb_ =
       profiling::memory::MemoryUsageMonitor::kInvalidMemUsageMB;
+  LatencyDistribution inference_latency_us_;
+  LoadTestResults load_test_;
 };
 
 class BenchmarkListener {
@@ -165,6 +199,28 @@ class BenchmarkLoggingListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override;
 };
 
+// Benchmark listener that writes the latency distributions of the benchmark
+// as JSON to a file, so that they can be compared to a baseline, e.g. with
+// latency_regression.py.
+class LatencyReportListener : public BenchmarkListener {
+ public:
+  // If not null, `op_latency_us` holds the latency distribution of every op
+  // once the benchmark ends, and must outlive the listener.
+  explicit LatencyReportListener(
+      const std::string& file_path,
+      const LatencyDistributionMap* op_latency_us = nullptr)
+      : file_path_(file_path), op_latency_us_(op_latency_us) {}
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override;
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  const std::string file_path_;
+  const LatencyDistributionMap* const op_latency_us_;
+  std::string benchmark_name_;
+  std::string graph_;
+};
+
 template <typename T>
 Flag CreateFlag(const char* name, BenchmarkParams* params,
                 const std::string& usage) {
@@ -215,9 +271,11 @@ class BenchmarkModel {
   // Get the model file size if it's available.
   virtual int64_t MayGetModelFileSize() { return -1; }
   virtual uint64_t ComputeInputBytes() = 0;
+  // Also records every run time into `latency_us` if it isn't null.
   virtual tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
                                         float max_secs, RunType run_type,
-                                        TfLiteStatus* invoke_status);
+                                        TfLiteStatus* invoke_status,
+                                        LatencyDistribution* latency_us);
   // Prepares input data for benchmark. This can be used to initialize input
   // data that has non-trivial cost.
   virtual TfLiteStatus PrepareInputData();
@@ -225,6 +283,16 @@ class BenchmarkModel {
   virtual TfLiteStatus ResetInputsAndOutputs();
   virtual TfLiteStatus RunImpl() = 0;
 
+  // Sends requests from --load_test_requesters threads for --load_test_secs
+  // seconds. Listeners are not notified of these runs.
+  TfLiteStatus RunLoadTest(LoadTestResults* results);
+  // Prepares the model to be run by `num_requesters` threads at once, one
+  // RunRequest() caller per requester index. Load tests fail unless
+  // subclasses implement this.
+  virtual TfLiteStatus PrepareRequesters(int num_requesters);
+  // Runs the model once on behalf of requester `requester`.
+  virtual TfLiteStatus RunRequest(int requester);
+
   // Create a MemoryUsageMonitor to report peak memory footprint if specified.
   virtual std::unique_ptr<profiling::memory::MemoryUsageMonitor>
   MayCreateMemoryUsageMonitor() const;
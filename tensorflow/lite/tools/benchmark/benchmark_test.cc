@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -418,6 +419,41 @@ TEST(BenchmarkTest, MaxDurationWorks) {
   benchmark.Run();
 }
 
+class LoadTestListener : public BenchmarkListener {
+ public:
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    EXPECT_EQ(results.inference_latency_us().count(),
+              results.inference_time_us().count());
+    const LoadTestResults& load_test = results.load_test();
+    EXPECT_EQ(load_test.num_requesters, 2);
+    EXPECT_GT(load_test.num_completed, 0);
+    EXPECT_EQ(load_test.num_failed, 0);
+    EXPECT_EQ(load_test.latency_us.count(), load_test.num_completed);
+  }
+};
+
+TEST(BenchmarkTest, RunsLoadTestAndWritesLatencyReport) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  const std::string report_path = CreateFilePath("latency_report.json");
+  BenchmarkParams params = CreateParams(2, 0.1f, 150.0f);
+  params.Set<int32_t>("load_test_requesters", 2);
+  params.Set<float>("load_test_qps", 1000.0f);
+  params.Set<float>("load_test_secs", 0.2f);
+  params.Set<bool>("enable_op_profiling", true);
+  params.Set<std::string>("latency_report_file", report_path);
+  TestBenchmark benchmark(std::move(params));
+  LoadTestListener listener;
+  benchmark.AddListener(&listener);
+  EXPECT_EQ(benchmark.Run(), kTfLiteOk);
+
+  std::ifstream report_file(report_path);
+  const std::string report((std::istreambuf_iterator<char>(report_file)),
+                           std::istreambuf_iterator<char>());
+  EXPECT_THAT(report, testing::HasSubstr("\"inference_us\""));
+  EXPECT_THAT(report, testing::HasSubstr("\"load_test\""));
+  EXPECT_THAT(report, testing::HasSubstr("ADD"));
+}
+
 TEST(BenchmarkTest, ParametersArePopulatedWhenInputShapeIsNotSpecified) {
   ASSERT_THAT(g_fp32_model_path, testing::NotNull());
 
@@ -26,6 +26,11 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
 #include "absl/base/attributes.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_replace.h"
@@ -41,6 +46,7 @@ limitations under the License.
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
@@ -119,6 +125,55 @@ class InterpreterStatePrinter : public BenchmarkListener {
   const BenchmarkParams* params_ = nullptr;   // not own the memory.
 };
 
+// Logs what the first inference spends beyond the steady state: the page
+// faults it takes, and how far the weights were loaded ahead of it.
+class FirstInferenceListener : public BenchmarkListener {
+ public:
+  explicit FirstInferenceListener(Interpreter* interpreter)
+      : interpreter_(interpreter) {}
+
+  void OnSingleRunStart(RunType runType) override {
+    if (num_runs_ == 0) GetPageFaults(&major_faults_, &minor_faults_);
+  }
+
+  void OnSingleRunEnd() override {
+    if (num_runs_++ > 0) return;
+    int64_t major_faults = 0;
+    int64_t minor_faults = 0;
+    if (GetPageFaults(&major_faults, &minor_faults)) {
+      TFLITE_LOG(INFO) << "First inference page faults: major="
+                       << major_faults - major_faults_
+                       << ", minor=" << minor_faults - minor_faults_;
+    }
+    const WeightLoader* loader = interpreter_->weight_loader();
+    if (loader == nullptr) return;
+    const WeightLoader::Stats stats = loader->GetStats();
+    TFLITE_LOG(INFO) << "Weights loaded ahead: " << stats.loaded_bytes / 1e6
+                     << " of " << stats.bytes / 1e6 << " MB in "
+                     << stats.num_ranges << " ranges, "
+                     << (stats.done ? "done" : "still loading") << " after "
+                     << stats.load_us / 1e3 << " ms";
+  }
+
+ private:
+  static bool GetPageFaults(int64_t* major_faults, int64_t* minor_faults) {
+#ifdef __linux__
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return false;
+    *major_faults = usage.ru_majflt;
+    *minor_faults = usage.ru_minflt;
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  Interpreter* const interpreter_ = nullptr;  // not own the memory.
+  int num_runs_ = 0;
+  int64_t major_faults_ = 0;
+  int64_t minor_faults_ = 0;
+};
+
 std::vector<std::string> Split(const std::string& str, const char delim) {
   if (str.empty()) {
     return {};
@@ -334,6 +389,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("optimize_memory_for_large_tensors",
                           BenchmarkParam::Create<int32_t>(0));
+  default_params.AddParam("weight_load_policy",
+                          BenchmarkParam::Create<std::string>("on_demand"));
+  default_params.AddParam("fuse_elementwise_ops",
+                          BenchmarkParam::Create<bool>(false));
 
   tools::ProvidedDelegateList delegate_providers(&default_params);
   delegate_providers.AddAllDelegateParams();
@@ -343,7 +402,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
 
 BenchmarkTfLiteModel::BenchmarkTfLiteModel(BenchmarkParams params)
     : BenchmarkModel(std::move(params)),
-      random_engine_(std::random_device()()) {
+      random_engine_(std::random_device()()),
+      op_latency_us_(new LatencyDistributionMap()) {
   AddListener(&log_output_);
 }
 
@@ -355,8 +415,9 @@ void BenchmarkTfLiteModel::CleanUp() {
 BenchmarkTfLiteModel::~BenchmarkTfLiteModel() {
   CleanUp();
 
-  // Destory the owned interpreter earlier than other objects (specially
+  // Destory the owned interpreters earlier than other objects (specially
   // 'owned_delegates_').
+  requester_interpreters_.clear();
   interpreter_.reset();
 }
 
@@ -410,7 +471,16 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
                        "are not used."),
       CreateFlag<int32_t>(
           "optimize_memory_for_large_tensors", &params_,
-          "Optimize memory usage for large tensors with sacrificing latency.")};
+          "Optimize memory usage for large tensors with sacrificing latency."),
+      CreateFlag<std::string>(
+          "weight_load_policy", &params_,
+          "How the weights of the memory-mapped model are loaded: on_demand "
+          "(by the first inference), prefault (before the interpreter is "
+          "ready) or prefetch (in the background)."),
+      CreateFlag<bool>("fuse_elementwise_ops", &params_,
+                       "Fold activations into their producers and fuse "
+                       "chains of float elementwise ops when the "
+                       "interpreter is built.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -453,6 +523,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Release dynamic tensor memory", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "optimize_memory_for_large_tensors",
                       "Optimize memory usage for large tensors", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "weight_load_policy", "Weight load policy",
+                      verbose);
+  LOG_BENCHMARK_PARAM(bool, "fuse_elementwise_ops", "Fuse elementwise ops",
+                      verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -578,11 +652,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  FillInputTensors(interpreter_.get());
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::FillInputTensors(Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -600,8 +679,6 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
-
-  return kTfLiteOk;
 }
 
 TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
@@ -609,7 +686,12 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
   const int32_t num_threads = params_.Get<int32_t>("num_threads");
   const bool use_caching = params_.Get<bool>("use_caching");
 
-  tflite::InterpreterBuilder builder(*model_, *resolver);
+  // Ops are fused while the interpreter is built, the other options are
+  // applied afterwards.
+  InterpreterOptions builder_options;
+  builder_options.SetFuseElementwiseOps(
+      params_.Get<bool>("fuse_elementwise_ops"));
+  tflite::InterpreterBuilder builder(*model_, *resolver, &builder_options);
   if (builder.SetNumThreads(num_threads) != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to set thread number";
     return kTfLiteError;
@@ -637,7 +719,12 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::Init() {
+  // Requester interpreters of a previous run use the model and delegates that
+  // are about to be replaced.
+  requester_interpreters_.clear();
+  const int64_t load_model_start_us = profiling::time::NowMicros();
   TF_LITE_ENSURE_STATUS(LoadModel());
+  const int64_t init_interpreter_start_us = profiling::time::NowMicros();
   TF_LITE_ENSURE_STATUS(InitInterpreter());
 
   // Install profilers if necessary right after interpreter is created so that
@@ -656,20 +743,23 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
                          total_nodes + kProfilingBufferHeadrooms);
   }
 
+  op_latency_us_->clear();
   AddOwnedListener(MayCreateProfilingListener());
+  const std::string latency_report_file =
+      params_.Get<std::string>("latency_report_file");
+  if (!latency_report_file.empty()) {
+    AddOwnedListener(std::unique_ptr<BenchmarkListener>(
+        new LatencyReportListener(latency_report_file, op_latency_us_.get())));
+  }
   AddOwnedListener(std::unique_ptr<BenchmarkListener>(
       new InterpreterStatePrinter(interpreter_.get())));
+  AddOwnedListener(std::unique_ptr<BenchmarkListener>(
+      new FirstInferenceListener(interpreter_.get())));
 
-  interpreter_->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
-
-  InterpreterOptions options;
-  options.SetEnsureDynamicTensorsAreReleased(
-      params_.Get<bool>("release_dynamic_tensors"));
-  options.OptimizeMemoryForLargeTensors(
-      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
-  interpreter_->ApplyOptions(&options);
+  ApplyInterpreterOptions(interpreter_.get());
 
   owned_delegates_.clear();
+  const int64_t apply_delegates_start_us = profiling::time::NowMicros();
 
   // Contains all ids of TfLiteNodes that have been checked to see whether it's
   // delegated or not.
@@ -767,6 +857,7 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     }
   }
 
+  const int64_t allocate_tensors_start_us = profiling::time::NowMicros();
   // Resize all non-string tensors.
   for (int j = 0; j < inputs_.size(); ++j) {
     const InputLayerInfo& input = inputs_[j];
@@ -781,6 +872,17 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
   }
+  const int64_t init_end_us = profiling::time::NowMicros();
+  TFLITE_LOG(INFO) << "Init stages in ms: load model "
+                   << (init_interpreter_start_us - load_model_start_us) / 1e3
+                   << ", build interpreter and apply options "
+                   << (apply_delegates_start_us - init_interpreter_start_us) /
+                          1e3
+                   << ", apply delegates "
+                   << (allocate_tensors_start_us - apply_delegates_start_us) /
+                          1e3
+                   << ", allocate tensors "
+                   << (init_end_us - allocate_tensors_start_us) / 1e3;
 
   AddOwnedListener(
       std::unique_ptr<BenchmarkListener>(new RuyProfileListener()));
@@ -788,6 +890,93 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   return kTfLiteOk;
 }
 
+void BenchmarkTfLiteModel::ApplyInterpreterOptions(Interpreter* interpreter) {
+  interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+
+  InterpreterOptions options;
+  options.SetEnsureDynamicTensorsAreReleased(
+      params_.Get<bool>("release_dynamic_tensors"));
+  options.OptimizeMemoryForLargeTensors(
+      params_.Get<int32_t>("optimize_memory_for_large_tensors"));
+  const std::string weight_load_policy =
+      params_.Get<std::string>("weight_load_policy");
+  if (weight_load_policy == "prefault") {
+    options.SetWeightLoadPolicy(WeightLoadPolicy::kPrefault);
+  } else if (weight_load_policy == "prefetch") {
+    options.SetWeightLoadPolicy(WeightLoadPolicy::kPrefetch);
+  } else if (weight_load_policy != "on_demand") {
+    TFLITE_LOG(WARN) << "Unknown weight_load_policy " << weight_load_policy
+                     << ", weights are loaded on demand.";
+  }
+  interpreter->ApplyOptions(&options);
+}
+
+TfLiteStatus BenchmarkTfLiteModel::CreateRequesterInterpreter(
+    std::unique_ptr<Interpreter>* interpreter) {
+  auto resolver = GetOpResolver();
+  InterpreterOptions builder_options;
+  builder_options.SetFuseElementwiseOps(
+      params_.Get<bool>("fuse_elementwise_ops"));
+  tflite::InterpreterBuilder builder(*model_, *resolver, &builder_options);
+  if (builder.SetNumThreads(params_.Get<int32_t>("num_threads")) !=
+      kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to set thread number";
+    return kTfLiteError;
+  }
+  builder(interpreter);
+  if (!*interpreter) {
+    TFLITE_LOG(ERROR) << "Failed to initialize a requester interpreter";
+    return kTfLiteError;
+  }
+  ApplyInterpreterOptions(interpreter->get());
+
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  for (auto& created_delegate : delegate_providers.CreateAllRankedDelegates()) {
+    owned_delegates_.emplace_back(std::move(created_delegate.delegate));
+    if ((*interpreter)->ModifyGraphWithDelegate(
+            owned_delegates_.back().get()) != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to apply "
+                        << created_delegate.provider->GetName()
+                        << " delegate to a requester interpreter.";
+      return kTfLiteError;
+    }
+  }
+
+  // The input shapes were validated when the benchmarked interpreter was
+  // initialized.
+  auto interpreter_inputs = (*interpreter)->inputs();
+  for (int j = 0; j < inputs_.size(); ++j) {
+    const int i = interpreter_inputs[j];
+    if ((*interpreter)->tensor(i)->type != kTfLiteString) {
+      (*interpreter)->ResizeInputTensor(i, inputs_[j].shape);
+    }
+  }
+  if ((*interpreter)->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to allocate tensors of a requester!";
+    return kTfLiteError;
+  }
+  FillInputTensors(interpreter->get());
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::PrepareRequesters(int num_requesters) {
+  requester_interpreters_.clear();
+  for (int i = 1; i < num_requesters; ++i) {
+    std::unique_ptr<Interpreter> interpreter;
+    TF_LITE_ENSURE_STATUS(CreateRequesterInterpreter(&interpreter));
+    requester_interpreters_.push_back(std::move(interpreter));
+  }
+  FillInputTensors(interpreter_.get());
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunRequest(int requester) {
+  Interpreter* interpreter = requester == 0
+                                 ? interpreter_.get()
+                                 : requester_interpreters_[requester - 1].get();
+  return interpreter->Invoke();
+}
+
 TfLiteStatus BenchmarkTfLiteModel::LoadModel() {
   std::string graph = params_.Get<std::string>("graph");
   model_ = tflite::FlatBufferModel::BuildFromFile(graph.c_str());
@@ -826,7 +1015,8 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      op_latency_us_.get()));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
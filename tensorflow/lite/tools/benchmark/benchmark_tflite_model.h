@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/latency_distribution.h"
 #include "tensorflow/lite/tools/utils.h"
 
 namespace tflite {
@@ -90,6 +91,11 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
 
   int64_t MayGetModelFileSize() override;
 
+  // Requester 0 runs the benchmarked interpreter, the others run interpreters
+  // of their own, set up the same way.
+  TfLiteStatus PrepareRequesters(int num_requesters) override;
+  TfLiteStatus RunRequest(int requester) override;
+
   virtual TfLiteStatus LoadModel();
 
   // Allow subclasses to create a customized Op resolver during init.
@@ -112,11 +118,21 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<tflite::FlatBufferModel> model_;
   std::unique_ptr<tflite::Interpreter> interpreter_;
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
+  // Interpreters of the load test requesters but the first one.
+  std::vector<std::unique_ptr<tflite::Interpreter>> requester_interpreters_;
 
  private:
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Applies the interpreter options from the benchmark params.
+  void ApplyInterpreterOptions(Interpreter* interpreter);
+  // Copies `inputs_data_` into the inputs of `interpreter`.
+  void FillInputTensors(Interpreter* interpreter);
+  // Creates and allocates an interpreter for a load test requester.
+  TfLiteStatus CreateRequesterInterpreter(
+      std::unique_ptr<Interpreter>* interpreter);
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -125,6 +141,9 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
 
   std::vector<std::unique_ptr<BenchmarkListener>> owned_listeners_;
   std::mt19937 random_engine_;
+  // Per-op latencies recorded by the profiling listener. Not a plain member
+  // since the listener is created by a const method.
+  std::unique_ptr<LatencyDistributionMap> op_latency_us_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
@@ -0,0 +1,130 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/latency_distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+struct NamedPercentile {
+  const char* name;
+  double percentile;
+};
+
+// The percentiles reported by WriteJson and ToString.
+constexpr NamedPercentile kReportedPercentiles[] = {
+    {"p50", 50}, {"p90", 90}, {"p99", 99}, {"p999", 99.9}};
+
+}  // namespace
+
+void LatencyDistribution::Record(int64_t latency_us) {
+  if (!samples_.empty() && latency_us < samples_.back()) sorted_ = false;
+  samples_.push_back(latency_us);
+  sum_ += latency_us;
+}
+
+void LatencyDistribution::Merge(const LatencyDistribution& other) {
+  if (other.empty()) return;
+  samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+  sum_ += other.sum_;
+  sorted_ = false;
+}
+
+double LatencyDistribution::mean() const {
+  return samples_.empty() ? 0.0 : static_cast<double>(sum_) / samples_.size();
+}
+
+int64_t LatencyDistribution::max() const {
+  if (samples_.empty()) return 0;
+  Sort();
+  return samples_.back();
+}
+
+int64_t LatencyDistribution::Percentile(double p) const {
+  if (samples_.empty()) return 0;
+  Sort();
+  // Nearest rank: the smallest sample that is at least as large as p percent
+  // of the samples. The epsilon keeps e.g. 99.9% of 1000 samples at rank 999
+  // despite rounding errors.
+  const double rank = std::ceil(p * samples_.size() / 100.0 - 1e-9);
+  const size_t index = std::min<size_t>(
+      samples_.size() - 1, static_cast<size_t>(std::max(rank, 1.0)) - 1);
+  return samples_[index];
+}
+
+void LatencyDistribution::WriteJson(std::ostream* stream) const {
+  (*stream) << "{\"count\": " << count() << ", \"mean_us\": " << mean();
+  for (const NamedPercentile& percentile : kReportedPercentiles) {
+    (*stream) << ", \"" << percentile.name
+              << "_us\": " << Percentile(percentile.percentile);
+  }
+  (*stream) << ", \"max_us\": " << max() << "}";
+}
+
+std::string LatencyDistribution::ToString() const {
+  std::stringstream stream;
+  stream << "count=" << count() << " mean=" << mean();
+  for (const NamedPercentile& percentile : kReportedPercentiles) {
+    stream << " " << percentile.name << "="
+           << Percentile(percentile.percentile);
+  }
+  stream << " max=" << max();
+  return stream.str();
+}
+
+void LatencyDistribution::Sort() const {
+  if (sorted_) return;
+  std::sort(samples_.begin(), samples_.end());
+  sorted_ = true;
+}
+
+void WriteJsonString(const std::string& value, std::ostream* stream) {
+  (*stream) << '"';
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        (*stream) << "\\\"";
+        break;
+      case '\\':
+        (*stream) << "\\\\";
+        break;
+      case '\n':
+        (*stream) << "\\n";
+        break;
+      case '\t':
+        (*stream) << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[7];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          (*stream) << escaped;
+        } else {
+          (*stream) << c;
+        }
+    }
+  }
+  (*stream) << '"';
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,68 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_LATENCY_DISTRIBUTION_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_LATENCY_DISTRIBUTION_H_
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+
+// Collects latency samples, in microseconds, and reports their percentiles.
+//
+// Unlike tensorflow::Stat, all samples are kept so that tail percentiles
+// (e.g. p99.9) are exact.
+class LatencyDistribution {
+ public:
+  void Record(int64_t latency_us);
+  void Merge(const LatencyDistribution& other);
+
+  int64_t count() const { return samples_.size(); }
+  bool empty() const { return samples_.empty(); }
+  double mean() const;
+  int64_t max() const;
+
+  // Returns the nearest-rank percentile `p` in [0, 100] of the samples, or 0
+  // if there are none.
+  int64_t Percentile(double p) const;
+
+  // Writes a JSON object with the count, mean and percentiles of the samples.
+  void WriteJson(std::ostream* stream) const;
+  // Returns a one-line summary, e.g. "count=10 mean=... p50=... ...".
+  std::string ToString() const;
+
+ private:
+  void Sort() const;
+
+  mutable std::vector<int64_t> samples_;
+  mutable bool sorted_ = true;
+  int64_t sum_ = 0;
+};
+
+// Latency distributions keyed by name, e.g. per op.
+using LatencyDistributionMap = std::map<std::string, LatencyDistribution>;
+
+// Writes `value` as a quoted and escaped JSON string.
+void WriteJsonString(const std::string& value, std::ostream* stream);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_LATENCY_DISTRIBUTION_H_
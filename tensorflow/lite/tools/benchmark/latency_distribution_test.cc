@@ -0,0 +1,83 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/latency_distribution.h"
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+TEST(LatencyDistributionTest, Empty) {
+  LatencyDistribution latency;
+  EXPECT_TRUE(latency.empty());
+  EXPECT_EQ(latency.Percentile(50), 0);
+  EXPECT_EQ(latency.max(), 0);
+  EXPECT_EQ(latency.mean(), 0);
+}
+
+TEST(LatencyDistributionTest, NearestRankPercentiles) {
+  LatencyDistribution latency;
+  // Record 1000..1 so that the samples need sorting.
+  for (int i = 1000; i >= 1; --i) latency.Record(i);
+  EXPECT_EQ(latency.count(), 1000);
+  EXPECT_EQ(latency.Percentile(0), 1);
+  EXPECT_EQ(latency.Percentile(50), 500);
+  EXPECT_EQ(latency.Percentile(90), 900);
+  EXPECT_EQ(latency.Percentile(99.9), 999);
+  EXPECT_EQ(latency.Percentile(100), 1000);
+  EXPECT_EQ(latency.max(), 1000);
+  EXPECT_DOUBLE_EQ(latency.mean(), 500.5);
+
+  // New samples are taken into account after sorting.
+  latency.Record(0);
+  EXPECT_EQ(latency.Percentile(0), 0);
+}
+
+TEST(LatencyDistributionTest, Merge) {
+  LatencyDistribution a, b;
+  a.Record(10);
+  a.Record(30);
+  b.Record(20);
+  b.Record(40);
+  a.Merge(b);
+  EXPECT_EQ(a.count(), 4);
+  EXPECT_EQ(a.Percentile(50), 20);
+  EXPECT_EQ(a.max(), 40);
+  EXPECT_DOUBLE_EQ(a.mean(), 25);
+}
+
+TEST(LatencyDistributionTest, WriteJson) {
+  LatencyDistribution latency;
+  latency.Record(7);
+  std::stringstream stream;
+  latency.WriteJson(&stream);
+  EXPECT_EQ(stream.str(),
+            "{\"count\": 1, \"mean_us\": 7, \"p50_us\": 7, \"p90_us\": 7, "
+            "\"p99_us\": 7, \"p999_us\": 7, \"max_us\": 7}");
+}
+
+TEST(LatencyDistributionTest, WriteJsonString) {
+  std::stringstream stream;
+  WriteJsonString("a\"b\\c\n\x01", &stream);
+  EXPECT_EQ(stream.str(), "\"a\\\"b\\\\c\\n\\u0001\"");
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
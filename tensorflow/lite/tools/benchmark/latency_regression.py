@@ -0,0 +1,130 @@
+# Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+r"""Compares benchmark_model latency reports against a baseline.
+
+Reports are written by benchmark_model with --latency_report_file. Every
+latency percentile of the current report that grew by more than --threshold
+(relative) and --min_delta_us (absolute) over the baseline is flagged as a
+regression, as is a drop of the load test throughput by more than --threshold.
+
+Example:
+  latency_regression --baseline=baseline.json --current=current.json \
+      --threshold=0.1 --metrics=p50_us,p99_us
+
+Exits with a non-zero status if any regression is found.
+"""
+import json
+import sys
+
+from absl import app
+from absl import flags
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string("baseline", None, "Path to the baseline latency report.")
+flags.DEFINE_string("current", None, "Path to the current latency report.")
+flags.DEFINE_float("threshold", 0.1,
+                   "Relative increase of a latency that is a regression.")
+flags.DEFINE_float(
+    "min_delta_us", 10.0,
+    "Minimum absolute increase of a latency, in microseconds, that is a "
+    "regression. Avoids flagging noise on very fast ops.")
+flags.DEFINE_list("metrics", ["p50_us", "p90_us", "p99_us"],
+                  "Latency distribution fields to compare.")
+flags.DEFINE_boolean("compare_ops", True,
+                     "Whether to also compare the per-op latencies.")
+
+
+def flatten_report(report, metrics, compare_ops=True):
+  """Returns the compared values of a report, keyed by their path.
+
+  Args:
+    report: Latency report, as loaded from JSON.
+    metrics: Latency distribution fields to return, e.g. ["p50_us"].
+    compare_ops: Whether to include the per-op latencies.
+
+  Returns:
+    A dict from paths such as "load_test/latency_us/p99_us" to values.
+  """
+  values = {}
+
+  def add_distribution(path, distribution):
+    for metric in metrics:
+      if metric in distribution:
+        values[path + "/" + metric] = distribution[metric]
+
+  add_distribution("inference_us", report.get("inference_us", {}))
+  load_test = report.get("load_test")
+  if load_test:
+    add_distribution("load_test/latency_us", load_test.get("latency_us", {}))
+    add_distribution("load_test/service_us", load_test.get("service_us", {}))
+    values["load_test/achieved_qps"] = load_test.get("achieved_qps", 0)
+  if compare_ops:
+    for op, distribution in report.get("ops", {}).items():
+      add_distribution("ops/" + op, distribution)
+  return values
+
+
+def find_regressions(baseline, current, threshold, min_delta_us, metrics,
+                     compare_ops=True):
+  """Returns the regressions of `current` over `baseline`.
+
+  Args:
+    baseline: Baseline latency report, as loaded from JSON.
+    current: Current latency report, as loaded from JSON.
+    threshold: Relative change that is a regression.
+    min_delta_us: Minimum absolute latency increase that is a regression.
+    metrics: Latency distribution fields to compare.
+    compare_ops: Whether to compare the per-op latencies.
+
+  Returns:
+    A list of (path, baseline value, current value) tuples, sorted by path.
+    Values only present in one of the reports are ignored.
+  """
+  baseline_values = flatten_report(baseline, metrics, compare_ops)
+  current_values = flatten_report(current, metrics, compare_ops)
+  regressions = []
+  for path in sorted(set(baseline_values) & set(current_values)):
+    before = baseline_values[path]
+    after = current_values[path]
+    if path.endswith("achieved_qps"):
+      regressed = after < before * (1 - threshold)
+    else:
+      regressed = (after > before * (1 + threshold) and
+                   after - before >= min_delta_us)
+    if regressed:
+      regressions.append((path, before, after))
+  return regressions
+
+
+def main(_):
+  with open(FLAGS.baseline) as baseline_file:
+    baseline = json.load(baseline_file)
+  with open(FLAGS.current) as current_file:
+    current = json.load(current_file)
+  regressions = find_regressions(baseline, current, FLAGS.threshold,
+                                 FLAGS.min_delta_us, FLAGS.metrics,
+                                 FLAGS.compare_ops)
+  for path, before, after in regressions:
+    print("REGRESSION {}: {} -> {} ({:+.1f}%)".format(
+        path, before, after, 100.0 * (after - before) / max(before, 1e-9)))
+  if regressions:
+    sys.exit(1)
+  print("No regressions found.")
+
+
+if __name__ == "__main__":
+  flags.mark_flags_as_required(["baseline", "current"])
+  app.run(main)
@@ -0,0 +1,88 @@
+# Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for latency_regression."""
+from tensorflow.lite.tools.benchmark import latency_regression
+from tensorflow.python.platform import test
+
+
+def _distribution(p50, p99):
+  return {"count": 100, "mean_us": p50, "p50_us": p50, "p99_us": p99}
+
+
+def _report(p50, p99, qps, conv_p50):
+  return {
+      "inference_us": _distribution(p50, p99),
+      "load_test": {
+          "achieved_qps": qps,
+          "latency_us": _distribution(p50, p99),
+      },
+      "ops": {
+          "0:0:CONV_2D": _distribution(conv_p50, conv_p50),
+      },
+  }
+
+
+class LatencyRegressionTest(test.TestCase):
+
+  def testFlattenReport(self):
+    values = latency_regression.flatten_report(
+        _report(100, 200, 50, 40), ["p50_us"])
+    self.assertEqual(
+        values, {
+            "inference_us/p50_us": 100,
+            "load_test/latency_us/p50_us": 100,
+            "load_test/achieved_qps": 50,
+            "ops/0:0:CONV_2D/p50_us": 40,
+        })
+
+  def testNoRegression(self):
+    baseline = _report(100, 200, 50, 40)
+    current = _report(105, 190, 49, 42)
+    self.assertEqual(
+        latency_regression.find_regressions(baseline, current, 0.1, 0,
+                                            ["p50_us", "p99_us"]), [])
+
+  def testFindsRegressions(self):
+    baseline = _report(100, 200, 50, 40)
+    current = _report(100, 300, 40, 80)
+    self.assertEqual(
+        latency_regression.find_regressions(baseline, current, 0.1, 0,
+                                            ["p50_us", "p99_us"]),
+        [("inference_us/p99_us", 200, 300),
+         ("load_test/achieved_qps", 50, 40),
+         ("load_test/latency_us/p99_us", 200, 300),
+         ("ops/0:0:CONV_2D/p50_us", 40, 80),
+         ("ops/0:0:CONV_2D/p99_us", 40, 80)])
+
+  def testMinDeltaAndOps(self):
+    baseline = _report(100, 200, 50, 4)
+    current = _report(100, 200, 50, 8)
+    self.assertEqual(
+        latency_regression.find_regressions(baseline, current, 0.1, 10,
+                                            ["p50_us"]), [])
+    self.assertEqual(
+        latency_regression.find_regressions(
+            baseline, current, 0.1, 0, ["p50_us"], compare_ops=False), [])
+
+  def testIgnoresMissingValues(self):
+    baseline = _report(100, 200, 50, 40)
+    current = {"inference_us": _distribution(100, 200)}
+    self.assertEqual(
+        latency_regression.find_regressions(baseline, current, 0.1, 0,
+                                            ["p50_us", "p99_us"]), [])
+
+
+if __name__ == "__main__":
+  test.main()
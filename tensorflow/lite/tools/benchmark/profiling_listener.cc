@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "tensorflow/lite/tools/logging.h"
 
@@ -26,12 +27,14 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_initial_entries,
     bool allow_dynamic_buffer_increase, const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    LatencyDistributionMap* op_latency_us)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
       interpreter_(interpreter),
-      profiler_(max_num_initial_entries, allow_dynamic_buffer_increase) {
+      profiler_(max_num_initial_entries, allow_dynamic_buffer_increase),
+      op_latency_us_(op_latency_us) {
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
 
@@ -63,6 +66,23 @@ void ProfilingListener::OnSingleRunEnd() {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   run_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (op_latency_us_ != nullptr) RecordOpLatencies(profile_events);
+}
+
+void ProfilingListener::RecordOpLatencies(
+    const std::vector<const profiling::ProfileEvent*>& events) {
+  for (const profiling::ProfileEvent* event : events) {
+    if (event->event_type !=
+            profiling::ProfileEvent::EventType::OPERATOR_INVOKE_EVENT &&
+        event->event_type != profiling::ProfileEvent::EventType::
+                                 DELEGATE_OPERATOR_INVOKE_EVENT) {
+      continue;
+    }
+    const std::string key = std::to_string(event->extra_event_metadata) +
+                            ":" + std::to_string(event->event_metadata) +
+                            ":" + event->tag;
+    (*op_latency_us_)[key].Record(event->elapsed_time);
+  }
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
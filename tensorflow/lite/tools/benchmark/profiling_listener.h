@@ -18,23 +18,29 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/latency_distribution.h"
 
 namespace tflite {
 namespace benchmark {
 
 // Dumps profiling events if profiling is enabled.
+//
+// If `op_latency_us` is not null, the latency of every op in every regular run
+// is also recorded into it, keyed by "<subgraph index>:<node index>:<op>".
 class ProfilingListener : public BenchmarkListener {
  public:
   ProfilingListener(
       Interpreter* interpreter, uint32_t max_num_initial_entries,
       bool allow_dynamic_buffer_increase, const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      LatencyDistributionMap* op_latency_us = nullptr);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -52,8 +58,12 @@ class ProfilingListener : public BenchmarkListener {
  private:
   void WriteOutput(const std::string& header, const string& data,
                    std::ostream* stream);
+  void RecordOpLatencies(
+      const std::vector<const profiling::ProfileEvent*>& events);
+
   Interpreter* interpreter_;
   profiling::BufferedProfiler profiler_;
+  LatencyDistributionMap* op_latency_us_;
 };
 
 }  // namespace benchmark
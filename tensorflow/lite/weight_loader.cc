@@ -0,0 +1,135 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/weight_loader.h"
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <thread>  // NOLINT
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tflite {
+namespace {
+
+size_t GetPageSize() {
+#if defined(_WIN32)
+  return 4096;
+#else
+  const long page_size = sysconf(_SC_PAGESIZE);  // NOLINT
+  return page_size > 0 ? page_size : 4096;
+#endif
+}
+
+int64_t NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+WeightLoader::WeightLoader() : page_size_(GetPageSize()) {}
+
+WeightLoader::~WeightLoader() {
+  stop_ = true;
+  if (thread_.joinable()) thread_.join();
+}
+
+void WeightLoader::AddRange(const void* data, size_t bytes) {
+  if (data == nullptr || bytes == 0) return;
+  const char* begin = static_cast<const char*>(data);
+  const char* end = begin + bytes;
+  if (!ranges_.empty()) {
+    Range& last = ranges_.back();
+    // Merges with the previous range if they share a page.
+    if (PageBegin(begin) < PageEnd(last.end) &&
+        PageBegin(last.begin) < PageEnd(end)) {
+      const char* merged_begin = begin < last.begin ? begin : last.begin;
+      const char* merged_end = end > last.end ? end : last.end;
+      bytes_ += (merged_end - merged_begin) - (last.end - last.begin);
+      last.begin = merged_begin;
+      last.end = merged_end;
+      return;
+    }
+  }
+  ranges_.push_back({begin, end});
+  bytes_ += bytes;
+}
+
+void WeightLoader::Load() {
+  if (started_.exchange(true)) return;
+  LoadRanges();
+}
+
+void WeightLoader::StartAsync() {
+  if (started_.exchange(true)) return;
+  thread_ = std::thread([this]() { LoadRanges(); });
+}
+
+void WeightLoader::Wait() {
+  if (thread_.joinable()) thread_.join();
+}
+
+WeightLoader::Stats WeightLoader::GetStats() const {
+  Stats stats;
+  stats.num_ranges = ranges_.size();
+  stats.bytes = bytes_;
+  stats.loaded_bytes = loaded_bytes_;
+  stats.done = done_;
+  if (started_) {
+    const int64_t start_us = start_us_;
+    const int64_t end_us = stats.done ? end_us_.load() : NowMicros();
+    if (start_us > 0) stats.load_us = end_us - start_us;
+  }
+  return stats;
+}
+
+const char* WeightLoader::PageBegin(const char* address) const {
+  return address - reinterpret_cast<uintptr_t>(address) % page_size_;
+}
+
+const char* WeightLoader::PageEnd(const char* address) const {
+  const char* begin = PageBegin(address);
+  return begin == address ? address : begin + page_size_;
+}
+
+void WeightLoader::LoadRanges() {
+  start_us_ = NowMicros();
+#if !defined(_WIN32)
+  // Lets the kernel read ahead all ranges while the first ones are mapped.
+  for (const Range& range : ranges_) {
+    char* begin = const_cast<char*>(PageBegin(range.begin));
+    madvise(begin, PageEnd(range.end) - begin, MADV_WILLNEED);
+  }
+#endif
+  // Reading one byte of each page maps it, faulting it in if it isn't in the
+  // page cache yet. Only bytes within the ranges are read.
+  volatile char sink = 0;
+  for (const Range& range : ranges_) {
+    if (stop_) break;
+    for (const char* byte = range.begin; byte < range.end;
+         byte = PageBegin(byte) + page_size_) {
+      sink = sink + *reinterpret_cast<const volatile char*>(byte);
+    }
+    loaded_bytes_ += range.end - range.begin;
+  }
+  end_us_ = NowMicros();
+  done_ = !stop_;
+}
+
+}  // namespace tflite
@@ -0,0 +1,103 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_WEIGHT_LOADER_H_
+#define TENSORFLOW_LITE_WEIGHT_LOADER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace tflite {
+
+// Brings the pages of read-only weights, usually backed by a memory-mapped
+// model file, into memory ahead of their first use, so that the first
+// inference does not stall on demand paging.
+//
+// Weights are added in the order they are needed, e.g. in execution order. A
+// range that shares a page with the previous one is merged with it.
+// The pages of all ranges are first advised as needed (madvise(MADV_WILLNEED))
+// so that the kernel starts reading all of them, and then read one byte per
+// page, in order, which maps the pages into the process.
+//
+// Example usage:
+//   WeightLoader loader;
+//   for (...) loader.AddRange(tensor->data.raw, tensor->bytes);
+//   loader.StartAsync();  // Or Load() to block until the pages are mapped.
+class WeightLoader {
+ public:
+  struct Stats {
+    // Number of ranges after merging and their total size.
+    int num_ranges = 0;
+    size_t bytes = 0;
+    // Bytes of the ranges loaded so far.
+    size_t loaded_bytes = 0;
+    // Time spent loading, up to now if loading is still in progress.
+    int64_t load_us = 0;
+    // Whether all ranges are loaded.
+    bool done = false;
+  };
+
+  WeightLoader();
+  // Stops loading, and waits for the loading thread if any.
+  ~WeightLoader();
+  WeightLoader(const WeightLoader&) = delete;
+  WeightLoader& operator=(const WeightLoader&) = delete;
+
+  // Adds `bytes` bytes at `data` to be loaded after all previously added
+  // ranges. Must not be called once loading has started.
+  void AddRange(const void* data, size_t bytes);
+
+  // Loads all ranges in the calling thread.
+  void Load();
+
+  // Loads all ranges in a background thread and returns immediately.
+  void StartAsync();
+
+  // Blocks until the loading started by StartAsync() is done.
+  void Wait();
+
+  // Returns the loading progress. Safe to call while loading.
+  Stats GetStats() const;
+
+ private:
+  struct Range {
+    const char* begin;
+    const char* end;
+  };
+
+  // Returns the start of the page of `address`, and the end of the last page
+  // of a range ending at `address`.
+  const char* PageBegin(const char* address) const;
+  const char* PageEnd(const char* address) const;
+  void LoadRanges();
+
+  const size_t page_size_;
+  std::vector<Range> ranges_;
+  size_t bytes_ = 0;
+
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> started_{false};
+  std::atomic<bool> done_{false};
+  std::atomic<size_t> loaded_bytes_{0};
+  std::atomic<int64_t> start_us_{0};
+  std::atomic<int64_t> end_us_{0};
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_WEIGHT_LOADER_H_
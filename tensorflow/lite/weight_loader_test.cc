@@ -0,0 +1,130 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/weight_loader.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+class WeightLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#if defined(_WIN32)
+    page_size_ = 4096;
+#else
+    page_size_ = sysconf(_SC_PAGESIZE);
+#endif
+    // 8 pages starting at a page boundary.
+    storage_.resize(9 * page_size_);
+    buffer_ = storage_.data() + page_size_ -
+              reinterpret_cast<uintptr_t>(storage_.data()) % page_size_;
+  }
+
+  size_t page_size_ = 0;
+  std::vector<char> storage_;
+  char* buffer_ = nullptr;
+};
+
+TEST_F(WeightLoaderTest, EmptyLoader) {
+  WeightLoader loader;
+  loader.AddRange(nullptr, 16);
+  loader.AddRange(buffer_, 0);
+  loader.Load();
+  const WeightLoader::Stats stats = loader.GetStats();
+  EXPECT_EQ(stats.num_ranges, 0);
+  EXPECT_EQ(stats.bytes, 0u);
+  EXPECT_TRUE(stats.done);
+}
+
+TEST_F(WeightLoaderTest, MergesRangesSharingAPage) {
+  WeightLoader loader;
+  loader.AddRange(buffer_, 16);
+  // Same page as the previous range.
+  loader.AddRange(buffer_ + 64, 16);
+  // Starts on the page where the previous range ends.
+  loader.AddRange(buffer_ + 128, page_size_);
+  // Starts two pages further.
+  loader.AddRange(buffer_ + 4 * page_size_, 16);
+  const WeightLoader::Stats stats = loader.GetStats();
+  EXPECT_EQ(stats.num_ranges, 2);
+  EXPECT_EQ(stats.bytes, 128 + page_size_ + 16);
+  EXPECT_EQ(stats.loaded_bytes, 0u);
+  EXPECT_FALSE(stats.done);
+}
+
+TEST_F(WeightLoaderTest, LoadsAllRanges) {
+  WeightLoader loader;
+  loader.AddRange(buffer_, 3 * page_size_ + 1);
+  loader.AddRange(buffer_ + 6 * page_size_, page_size_);
+  loader.Load();
+  const WeightLoader::Stats stats = loader.GetStats();
+  EXPECT_EQ(stats.num_ranges, 2);
+  EXPECT_EQ(stats.bytes, 4 * page_size_ + 1);
+  EXPECT_EQ(stats.loaded_bytes, stats.bytes);
+  EXPECT_GE(stats.load_us, 0);
+  EXPECT_TRUE(stats.done);
+}
+
+#if !defined(_WIN32)
+TEST_F(WeightLoaderTest, LoadsMappedFileAsync) {
+  char path[] = "/tmp/weight_loader_test_XXXXXX";
+  const int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  const size_t size = 64 * page_size_;
+  std::vector<char> contents(size, 1);
+  ASSERT_EQ(static_cast<size_t>(write(fd, contents.data(), size)), size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ASSERT_NE(data, MAP_FAILED);
+  {
+    WeightLoader loader;
+    loader.AddRange(static_cast<char*>(data) + 10, size - 20);
+    loader.StartAsync();
+    // Starting twice is a no-op.
+    loader.StartAsync();
+    loader.Wait();
+    const WeightLoader::Stats stats = loader.GetStats();
+    EXPECT_EQ(stats.num_ranges, 1);
+    EXPECT_EQ(stats.loaded_bytes, size - 20);
+    EXPECT_TRUE(stats.done);
+  }
+  munmap(data, size);
+  close(fd);
+  unlink(path);
+}
+#endif  // !defined(_WIN32)
+
+TEST_F(WeightLoaderTest, DestructorStopsAsyncLoad) {
+  for (int i = 0; i < 10; ++i) {
+    WeightLoader loader;
+    for (int page = 0; page < 8; page += 2) {
+      loader.AddRange(buffer_ + page * page_size_, page_size_);
+    }
+    loader.StartAsync();
+  }
+}
+
+}  // namespace
+}  // namespace tflite
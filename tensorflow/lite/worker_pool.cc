@@ -0,0 +1,89 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/worker_pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+namespace tflite {
+
+WorkerPool::WorkerPool(int num_threads) {
+  for (int thread_id = 1; thread_id < num_threads; ++thread_id) {
+    workers_.emplace_back([this, thread_id]() { WorkerLoop(thread_id); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkerPool::Run(int num_tasks, const std::function<void(int, int)>& task) {
+  if (num_tasks <= 0) return;
+  if (workers_.empty() || num_tasks == 1) {
+    for (int i = 0; i < num_tasks; ++i) task(0, i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_.store(0);
+    active_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks(/*thread_id=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return active_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::WorkerLoop(int thread_id) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, seen_generation]() {
+        return stop_ || generation_ != seen_generation;
+      });
+      if (stop_) return;
+      seen_generation = generation_;
+    }
+    RunTasks(thread_id);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--active_workers_ == 0) work_done_.notify_one();
+    }
+  }
+}
+
+void WorkerPool::RunTasks(int thread_id) {
+  for (int i = next_task_.fetch_add(1); i < num_tasks_;
+       i = next_task_.fetch_add(1)) {
+    (*task_)(thread_id, i);
+  }
+}
+
+}  // namespace tflite
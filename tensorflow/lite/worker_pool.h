@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_WORKER_POOL_H_
+#define TENSORFLOW_LITE_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of threads running batches of independent tasks on behalf of a
+// single caller. The calling thread takes part in every batch, so a pool of
+// `num_threads` threads spawns `num_threads - 1` workers.
+//
+// Example usage:
+//   WorkerPool pool(4);
+//   pool.Run(num_nodes, [&](int thread_id, int task) { ... });
+class WorkerPool {
+ public:
+  explicit WorkerPool(int num_threads);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Number of threads taking part in a batch, including the caller.
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Runs `task(thread_id, i)` for every `i` in [0, num_tasks) and returns once
+  // all of them have finished. `thread_id` is in [0, num_threads()), where 0
+  // is the calling thread. Must not be called concurrently, nor from a task.
+  void Run(int num_tasks, const std::function<void(int, int)>& task);
+
+ private:
+  void WorkerLoop(int thread_id);
+  void RunTasks(int thread_id);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // The following are guarded by `mutex_`.
+  bool stop_ = false;
+  uint64_t generation_ = 0;
+  int active_workers_ = 0;
+  const std::function<void(int, int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+
+  // Index of the next task of the current batch to be picked up.
+  std::atomic<int> next_task_{0};
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_WORKER_POOL_H_
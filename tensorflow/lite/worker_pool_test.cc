@@ -0,0 +1,66 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/worker_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(WorkerPoolTest, RunsEveryTaskOnce) {
+  WorkerPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 4, 17}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    pool.Run(num_tasks, [&runs](int thread_id, int task) {
+      EXPECT_GE(thread_id, 0);
+      EXPECT_LT(thread_id, 4);
+      runs[task]++;
+    });
+    for (const auto& count : runs) {
+      EXPECT_EQ(count.load(), 1);
+    }
+  }
+}
+
+TEST(WorkerPoolTest, SingleThreadRunsOnCaller) {
+  WorkerPool pool(1);
+  EXPECT_EQ(pool.num_threads(), 1);
+  std::vector<int> order;
+  pool.Run(3, [&order](int thread_id, int task) {
+    EXPECT_EQ(thread_id, 0);
+    order.push_back(task);
+  });
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2}));
+}
+
+TEST(WorkerPoolTest, TasksRunConcurrently) {
+  WorkerPool pool(2);
+  // Each task waits for the other one, which only terminates if both run at
+  // the same time.
+  std::atomic<int> arrived(0);
+  pool.Run(2, [&arrived](int, int) {
+    arrived++;
+    while (arrived.load() < 2) {
+    }
+  });
+  EXPECT_EQ(arrived.load(), 2);
+}
+
+}  // namespace
+}  // namespace tflite